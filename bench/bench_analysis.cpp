@@ -0,0 +1,150 @@
+// Analysis pass benchmarks: the bundled test track and synthetic long inputs
+
+#ifdef TRACKS_WITH_ESSENTIA
+
+#include "analyzer.h"
+#include "config.h"
+#include "events.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+
+namespace {
+
+using tracks::EventType;
+
+// Event sets that each enable one pass (all = every pass)
+tracks::EventFilter family(int id) {
+    switch (id) {
+        case 0:  return {EventType::BEAT};
+        case 1:  return {EventType::MELODY};
+        case 2:  return tracks::streamable_events();  // frame pass without the scan
+        case 3:  return {EventType::CLICK, EventType::SATURATION, EventType::HUM,
+                         EventType::ATTACK, EventType::FADE_IN};  // frame pass with only the scan
+        case 4:  return {EventType::ONSET};
+        default: return tracks::all_events();
+    }
+}
+
+const char* const kFamilyNames[] = {"beat", "melody", "frames", "scan", "onset", "all"};
+
+// 120 BPM kick, a chord pad changing every 4 s, a moving lead line and a
+// little noise: enough structure for every pass to find something
+void write_synthetic_wav(const std::string& path, int seconds, int rate) {
+    const uint32_t samples = static_cast<uint32_t>(seconds) * static_cast<uint32_t>(rate);
+    const double   pi = 3.14159265358979323846;
+    const double   chords[4][3] = {{220.0, 261.63, 329.63}, {174.61, 220.0, 261.63},
+                                   {196.0, 246.94, 293.66}, {164.81, 207.65, 246.94}};
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0.0, 0.005);
+
+    std::ofstream out(path, std::ios::binary);
+    auto put32 = [&](uint32_t v) { out.write(reinterpret_cast<const char*>(&v), 4); };
+    auto put16 = [&](uint16_t v) { out.write(reinterpret_cast<const char*>(&v), 2); };
+    out.write("RIFF", 4);
+    put32(36 + samples * 2);
+    out.write("WAVEfmt ", 8);
+    put32(16);
+    put16(1);  // PCM
+    put16(1);  // mono
+    put32(static_cast<uint32_t>(rate));
+    put32(static_cast<uint32_t>(rate) * 2);
+    put16(2);
+    put16(16);
+    out.write("data", 4);
+    put32(samples * 2);
+
+    for (uint32_t i = 0; i < samples; ++i) {
+        double t    = static_cast<double>(i) / rate;
+        double beat = std::fmod(t, 0.5);
+        double x    = 0.5 * std::exp(-beat * 30.0) * std::sin(2.0 * pi * 60.0 * beat);
+        const double* chord = chords[static_cast<int>(t / 4.0) % 4];
+        for (int k = 0; k < 3; ++k) x += 0.08 * std::sin(2.0 * pi * chord[k] * t);
+        double lead = 440.0 * std::pow(2.0, (static_cast<int>(t * 4.0) % 8) / 12.0);
+        x += 0.1 * std::sin(2.0 * pi * lead * t);
+        x += noise(rng);
+        double clipped = std::max(-1.0, std::min(1.0, x));
+        put16(static_cast<uint16_t>(static_cast<int16_t>(clipped * 32767.0)));
+    }
+}
+
+// Synthetic inputs are written once per length and removed at exit
+class SyntheticInputs {
+public:
+    ~SyntheticInputs() {
+        for (const auto& [seconds, path] : paths_) std::remove(path.c_str());
+    }
+
+    const std::string& get(int seconds, int rate) {
+        auto it = paths_.find(seconds);
+        if (it != paths_.end()) return it->second;
+        std::string path = (std::filesystem::temp_directory_path() /
+                            ("tracks-bench-" + std::to_string(seconds) + "s.wav")).string();
+        write_synthetic_wav(path, seconds, rate);
+        return paths_.emplace(seconds, path).first->second;
+    }
+
+private:
+    std::map<int, std::string> paths_;
+};
+
+SyntheticInputs& synthetic() {
+    static SyntheticInputs inputs;
+    return inputs;
+}
+
+void run_analysis(benchmark::State& state, const std::string& input, int family_id) {
+    tracks::Config cfg;
+    cfg.input_file     = input;
+    cfg.enabled_events = family(family_id);
+    tracks::set_progress_output(false);
+
+    double duration = 0.0;
+    size_t events   = 0;
+    for (auto _ : state) {
+        tracks::Timeline tl = tracks::analyze(cfg);
+        events = tl.size();
+        // track.end is stamped with the duration
+        duration = tl.empty() ? 0.0 : tl[tl.size() - 1].timestamp;
+    }
+    state.SetLabel(kFamilyNames[family_id]);
+    state.counters["events"] = static_cast<double>(events);
+    // Audio seconds per wall second (the real-time factor)
+    state.counters["realtime"] = benchmark::Counter(
+        duration * static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+void BM_AnalyzeTestTrack(benchmark::State& state) {
+    run_analysis(state, TRACKS_SOURCE_DIR "/audio/test.mp3", static_cast<int>(state.range(0)));
+}
+BENCHMARK(BM_AnalyzeTestTrack)
+    ->ArgName("pass")
+    ->DenseRange(0, 5)
+    ->Unit(benchmark::kSecond)
+    ->UseRealTime()
+    ->Iterations(3);
+
+void BM_AnalyzeSynthetic(benchmark::State& state) {
+    tracks::Config defaults;
+    const std::string& input = synthetic().get(static_cast<int>(state.range(1)), defaults.sample_rate);
+    run_analysis(state, input, static_cast<int>(state.range(0)));
+}
+BENCHMARK(BM_AnalyzeSynthetic)
+    ->ArgNames({"pass", "seconds"})
+    ->ArgsProduct({{0, 1, 2, 3, 4, 5}, {60, 600}})
+    ->Unit(benchmark::kSecond)
+    ->UseRealTime()
+    ->Iterations(1);
+
+} // namespace
+
+#endif // TRACKS_WITH_ESSENTIA
@@ -0,0 +1,171 @@
+// Envelope serialization and timeline merge benchmarks
+
+#include "events.h"
+#include "tracks.pb.h"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using tracks::EventType;
+using tracks::Timeline;
+
+// A typical envelope of each shape the analyzer produces: scalar,
+// two-field, string and vector payloads
+struct Sample {
+    const char* name;
+    EventType   type;
+    std::function<void(::tracks::Envelope&)> fill;
+};
+
+std::vector<float> ramp(size_t n) {
+    std::vector<float> v(n);
+    for (size_t i = 0; i < n; ++i) v[i] = 0.1f * static_cast<float>(i) - 0.5f;
+    return v;
+}
+
+const std::vector<Sample>& samples() {
+    static const std::vector<Sample> all = {
+        {"beat", EventType::BEAT,
+         [](::tracks::Envelope& e) { e.mutable_beat()->set_confidence(0.87); }},
+        {"onset", EventType::ONSET,
+         [](::tracks::Envelope& e) { e.mutable_onset()->set_strength(0.42); }},
+        {"loudness", EventType::LOUDNESS,
+         [](::tracks::Envelope& e) { e.mutable_loudness()->set_value(-14.2); }},
+        {"pitch", EventType::PITCH,
+         [](::tracks::Envelope& e) {
+             e.mutable_pitch()->set_frequency(440.0);
+             e.mutable_pitch()->set_confidence(0.9);
+         }},
+        {"key.change", EventType::KEY_CHANGE,
+         [](::tracks::Envelope& e) {
+             e.mutable_key_change()->set_key("F#");
+             e.mutable_key_change()->set_scale("minor");
+             e.mutable_key_change()->set_strength(0.7);
+         }},
+        {"chroma", EventType::CHROMA,
+         [](::tracks::Envelope& e) {
+             auto v = ramp(12);
+             e.mutable_chroma()->mutable_values()->Add(v.begin(), v.end());
+         }},
+        {"mfcc", EventType::MFCC,
+         [](::tracks::Envelope& e) {
+             auto v = ramp(13);
+             e.mutable_mfcc()->mutable_values()->Add(v.begin(), v.end());
+         }},
+        {"bands.mel", EventType::BANDS_MEL,
+         [](::tracks::Envelope& e) {
+             auto v = ramp(40);
+             e.mutable_bands_mel()->mutable_values()->Add(v.begin(), v.end());
+         }},
+    };
+    return all;
+}
+
+// What the analyzer's add_envelope does: size once, serialize straight
+// into the timeline arena
+void BM_AddEnvelope(benchmark::State& state, const Sample* sample) {
+    ::tracks::Envelope env;
+    sample->fill(env);
+    Timeline tl;
+    double t = 0.0;
+    for (auto _ : state) {
+        env.set_timestamp(t);
+        size_t len = env.ByteSizeLong();
+        env.SerializeWithCachedSizesToArray(tl.append(t, sample->type, len));
+        t += 0.01;
+        if (tl.size() == 1 << 16) {
+            state.PauseTiming();
+            tl = Timeline();
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(env.ByteSizeLong()));
+}
+
+// The allocating path: SerializeAsString, then a copy into the timeline
+void BM_SerializeAsString(benchmark::State& state, const Sample* sample) {
+    ::tracks::Envelope env;
+    sample->fill(env);
+    Timeline tl;
+    double t = 0.0;
+    for (auto _ : state) {
+        env.set_timestamp(t);
+        std::string bytes = env.SerializeAsString();
+        tl.append(t, sample->type, bytes.data(), bytes.size());
+        t += 0.01;
+        if (tl.size() == 1 << 16) {
+            state.PauseTiming();
+            tl = Timeline();
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(env.ByteSizeLong()));
+}
+
+const bool registered = [] {
+    for (const auto& s : samples()) {
+        benchmark::RegisterBenchmark((std::string("BM_AddEnvelope/") + s.name).c_str(),
+                                     BM_AddEnvelope, &s);
+        benchmark::RegisterBenchmark((std::string("BM_SerializeAsString/") + s.name).c_str(),
+                                     BM_SerializeAsString, &s);
+    }
+    return true;
+}();
+
+// A timeline as analyze() leaves it before sort(): one sorted run per
+// builder, each spread over the whole track
+Timeline make_runs(size_t events, size_t runs) {
+    ::tracks::Envelope env;
+    env.mutable_onset()->set_strength(0.5);
+    std::string bytes = env.SerializeAsString();
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> jitter(0.0, 1.0);
+    const double duration = 600.0;
+
+    Timeline tl;
+    tl.reserve(events, events * bytes.size());
+    size_t per_run = events / runs;
+    for (size_t r = 0; r < runs; ++r) {
+        double step = duration / static_cast<double>(per_run);
+        double t = jitter(rng) * step;
+        for (size_t i = 0; i < per_run; ++i, t += step) {
+            tl.append(t, EventType::ONSET, bytes.data(), bytes.size());
+        }
+    }
+    return tl;
+}
+
+// The copy of the unsorted timeline is left out through manual timing;
+// pausing the timer around it costs more than a small merge
+void BM_TimelineSort(benchmark::State& state) {
+    const Timeline unsorted = make_runs(static_cast<size_t>(state.range(0)),
+                                        static_cast<size_t>(state.range(1)));
+    for (auto _ : state) {
+        Timeline tl = unsorted;
+        auto start = std::chrono::steady_clock::now();
+        tl.sort();
+        state.SetIterationTime(
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        benchmark::DoNotOptimize(tl[0]);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(unsorted.size()));
+    state.counters["runs"] = static_cast<double>(unsorted.runs());
+}
+
+BENCHMARK(BM_TimelineSort)
+    ->ArgNames({"events", "runs"})
+    ->ArgsProduct({{100000, 1000000, 4000000}, {4, 16, 48}})
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,117 @@
+// Transport send rate over loopback
+
+#include "config.h"
+#include "transport.h"
+#include "tracks.pb.h"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+
+namespace {
+
+using tracks::EventType;
+
+// Drains a loopback port on a thread of its own so the sender measures its
+// own side rather than a full receive buffer
+class Sink {
+public:
+    Sink() : socket_(io_, boost::asio::ip::udp::endpoint(
+                              boost::asio::ip::make_address("127.0.0.1"), 0)) {
+        socket_.set_option(boost::asio::socket_base::receive_buffer_size(8 << 20));
+        timeval timeout{0, 100000};  // wake up to notice stop
+        ::setsockopt(socket_.native_handle(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        thread_ = std::thread([this] {
+            char buf[65536];
+            while (!stop_.load(std::memory_order_relaxed)) {
+                if (::recv(socket_.native_handle(), buf, sizeof(buf), 0) > 0) {
+                    received_.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    ~Sink() {
+        stop_.store(true, std::memory_order_relaxed);
+        thread_.join();
+    }
+
+    uint16_t port() const    { return socket_.local_endpoint().port(); }
+    uint64_t received() const { return received_.load(std::memory_order_relaxed); }
+
+private:
+    boost::asio::io_context      io_;
+    boost::asio::ip::udp::socket socket_;
+    std::atomic<bool>            stop_{false};
+    std::atomic<uint64_t>        received_{0};
+    std::thread                  thread_;
+};
+
+tracks::Config loopback_config(uint16_t port, bool coalesce) {
+    tracks::Config cfg;
+    tracks::Destination dest;
+    dest.address = "127.0.0.1";
+    dest.port    = port;
+    cfg.destinations.push_back(dest);
+    cfg.coalesce = coalesce;
+    return cfg;
+}
+
+std::string mfcc_envelope() {
+    ::tracks::Envelope env;
+    env.set_timestamp(12.5);
+    for (int i = 0; i < 13; ++i) env.mutable_mfcc()->add_values(0.1f * i);
+    return env.SerializeAsString();
+}
+
+void report(benchmark::State& state, const Sink& sink, uint64_t datagrams_before,
+            int64_t events, size_t envelope_bytes) {
+    state.SetItemsProcessed(events);
+    state.SetBytesProcessed(events * static_cast<int64_t>(envelope_bytes));
+    state.counters["datagrams_received"] = benchmark::Counter(
+        static_cast<double>(sink.received() - datagrams_before), benchmark::Counter::kIsRate);
+}
+
+// One envelope per send(), as the emitter does for isolated events
+void BM_TransportSend(benchmark::State& state) {
+    Sink sink;
+    tracks::Transport transport(loopback_config(sink.port(), false));
+    const std::string env = mfcc_envelope();
+    uint64_t before = sink.received();
+
+    for (auto _ : state) {
+        transport.send(EventType::MFCC, env);
+    }
+    report(state, sink, before, state.iterations(), env.size());
+}
+BENCHMARK(BM_TransportSend)->UseRealTime();
+
+// Envelopes sharing a deadline go out through one send_batch(); with
+// coalesce they are packed into EnvelopeBatch datagrams first
+void BM_TransportSendBatch(benchmark::State& state) {
+    Sink sink;
+    const size_t batch = static_cast<size_t>(state.range(0));
+    tracks::Transport transport(loopback_config(sink.port(), state.range(1) != 0));
+    const std::string env = mfcc_envelope();
+    std::vector<EventType>        types(batch, EventType::MFCC);
+    std::vector<std::string_view> views(batch, env);
+    uint64_t before = sink.received();
+
+    for (auto _ : state) {
+        transport.send_batch(types.data(), views.data(), batch);
+    }
+    report(state, sink, before, state.iterations() * static_cast<int64_t>(batch), env.size());
+}
+BENCHMARK(BM_TransportSendBatch)
+    ->ArgNames({"batch", "coalesce"})
+    ->ArgsProduct({{8, 64}, {0, 1}})
+    ->UseRealTime();
+
+} // namespace
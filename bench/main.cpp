@@ -0,0 +1,24 @@
+// tracks-bench: Google Benchmark runner for the analyzer, timeline and
+// transport hot paths. Pass --benchmark_format=json (or --benchmark_out=FILE
+// --benchmark_out_format=json) for machine-readable results.
+
+#include <benchmark/benchmark.h>
+
+#ifdef TRACKS_WITH_ESSENTIA
+#include <essentia/algorithmfactory.h>
+#endif
+
+int main(int argc, char* argv[]) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+#ifdef TRACKS_WITH_ESSENTIA
+    essentia::init();
+#endif
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+#ifdef TRACKS_WITH_ESSENTIA
+    essentia::shutdown();
+#endif
+    return 0;
+}
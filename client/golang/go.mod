@@ -2,4 +2,9 @@ module github.com/davesmith10/tracks/client/golang
 
 go 1.25.5
 
-require google.golang.org/protobuf v1.36.11
+require (
+	golang.org/x/net v0.12.1-0.20231027154334-5ca955b1789c
+	google.golang.org/protobuf v1.36.11
+)
+
+require golang.org/x/sys v0.10.0 // indirect
@@ -9,8 +9,8 @@ import (
 	"strings"
 	"syscall"
 
+	"github.com/davesmith10/tracks/client/golang/receiver"
 	"github.com/davesmith10/tracks/client/golang/trackspb"
-	"google.golang.org/protobuf/proto"
 )
 
 func formatFloats(vals []float32, maxShow int) string {
@@ -172,32 +172,49 @@ func formatEvent(env *trackspb.Envelope) string {
 func main() {
 	multicastGroup := flag.String("multicast-group", "239.255.0.1", "Multicast group address")
 	port := flag.Int("port", 5000, "UDP port")
-	iface := flag.String("interface", "0.0.0.0", "Listen interface address")
+	iface := flag.String("interface", "0.0.0.0", "Network interface (name or address) for the multicast join")
+	readBuffer := flag.Int("read-buffer", 4<<20, "Socket receive buffer in bytes (capped by net.core.rmem_max)")
+	events := flag.String("events", "", "Comma-separated event types to decode and print (default: all); track.* and snapshots always are")
+	showStats := flag.Bool("stats", false, "Print datagram counts and per-sender loss on exit")
 	flag.Parse()
 
 	fmt.Printf("TRACKS Receiver (Go) - listening on %s:%d\n", *multicastGroup, *port)
 
-	groupAddr := net.ParseIP(*multicastGroup)
-	if groupAddr == nil {
-		fmt.Fprintf(os.Stderr, "Error: invalid multicast group %q\n", *multicastGroup)
-		os.Exit(1)
+	cfg := receiver.Config{
+		Group:      *multicastGroup,
+		Port:       *port,
+		ReadBuffer: *readBuffer,
+		Block:      true, // printing is slow; let the socket buffer absorb bursts
+	}
+	if *iface != "0.0.0.0" && *iface != "" {
+		ifi, err := findInterface(*iface)
+		if err != nil {
+			fmt.Fprintf(os.Stderr, "Error: interface %q: %v\n", *iface, err)
+			os.Exit(1)
+		}
+		cfg.Interface = ifi
 	}
 
-	listenAddr := &net.UDPAddr{
-		IP:   net.ParseIP(*iface),
-		Port: *port,
+	subscribed := receiver.AllEvents()
+	if *events != "" {
+		subscribed = []receiver.Event{receiver.TrackStart, receiver.TrackEnd, receiver.TrackPosition,
+			receiver.TrackAbort, receiver.TrackPrepare, receiver.Snapshot}
+		for _, name := range strings.Split(*events, ",") {
+			e, ok := receiver.ParseEvent(strings.TrimSpace(name))
+			if !ok {
+				fmt.Fprintf(os.Stderr, "Error: unknown event type %q\n", name)
+				os.Exit(1)
+			}
+			subscribed = append(subscribed, e)
+		}
 	}
 
-	conn, err := net.ListenMulticastUDP("udp4", nil, &net.UDPAddr{
-		IP:   groupAddr,
-		Port: *port,
-	})
+	rcv, err := receiver.Listen(cfg)
 	if err != nil {
 		fmt.Fprintf(os.Stderr, "Error: listen: %v\n", err)
 		os.Exit(1)
 	}
-	defer conn.Close()
-	_ = listenAddr // interface binding handled by ListenMulticastUDP
+	messages := rcv.Subscribe(4096, subscribed...)
 
 	// Graceful shutdown on Ctrl+C
 	sigCh := make(chan os.Signal, 1)
@@ -205,35 +222,85 @@ func main() {
 	go func() {
 		<-sigCh
 		fmt.Println("\nInterrupted.")
-		conn.Close()
-		os.Exit(0)
+		rcv.Close()
 	}()
 
-	fmt.Println("Waiting for events...\n")
+	runErr := make(chan error, 1)
+	go func() { runErr <- rcv.Run() }()
 
-	buf := make([]byte, 65536)
-	for {
-		n, _, err := conn.ReadFromUDP(buf)
-		if err != nil {
-			// conn.Close() from signal handler causes this
-			break
-		}
+	fmt.Print("Waiting for events...\n\n")
+
+	// Set by track.start; a snapshot arriving while unset means this
+	// receiver joined mid-track, and its contents are shown once
+	inTrack := false
 
-		env := &trackspb.Envelope{}
-		if err := proto.Unmarshal(buf[:n], env); err != nil {
-			fmt.Fprintf(os.Stderr, "failed to parse envelope (%d bytes)\n", n)
+	for m := range messages {
+		env := m.Envelope
+		if m.Event == receiver.Snapshot {
+			fmt.Printf("[%8.3f] snapshot\n", env.GetTimestamp())
+			if !inTrack {
+				for _, state := range m.States {
+					fmt.Println("  " + formatEvent(state))
+				}
+			}
+			inTrack = true
+			rcv.Release(m)
 			continue
 		}
 
 		fmt.Println(formatEvent(env))
 
-		switch env.Event.(type) {
-		case *trackspb.Envelope_TrackEnd:
-			fmt.Println("\nTrack ended.")
-			return
-		case *trackspb.Envelope_TrackAbort:
-			fmt.Println("\nTrack aborted.")
-			return
+		ended := ""
+		switch m.Event {
+		case receiver.TrackStart:
+			inTrack = true
+		case receiver.TrackEnd:
+			ended = "\nTrack ended."
+		case receiver.TrackAbort:
+			ended = "\nTrack aborted."
+		}
+		rcv.Release(m)
+		if ended != "" {
+			fmt.Println(ended)
+			rcv.Close()
+			break
+		}
+	}
+
+	if err := <-runErr; err != nil {
+		fmt.Fprintf(os.Stderr, "Error: receive: %v\n", err)
+	}
+	if *showStats {
+		printStats(rcv.Stats())
+	}
+}
+
+// findInterface looks an interface up by name, or by one of its addresses
+func findInterface(spec string) (*net.Interface, error) {
+	ip := net.ParseIP(spec)
+	if ip == nil {
+		return net.InterfaceByName(spec)
+	}
+	interfaces, err := net.Interfaces()
+	if err != nil {
+		return nil, err
+	}
+	for i := range interfaces {
+		addrs, _ := interfaces[i].Addrs()
+		for _, a := range addrs {
+			if n, ok := a.(*net.IPNet); ok && n.IP.Equal(ip) {
+				return &interfaces[i], nil
+			}
 		}
 	}
+	return nil, fmt.Errorf("no interface has address %s", spec)
+}
+
+func printStats(s receiver.Stats) {
+	fmt.Fprintf(os.Stderr, "%d datagrams, %d envelopes: %d delivered, %d skipped, %d dropped, %d undecodable\n",
+		s.Datagrams, s.Envelopes, s.Delivered, s.Skipped, s.Dropped, s.Undecodable)
+	for addr, l := range s.Senders {
+		fmt.Fprintf(os.Stderr, "  %-21s seq %d, loss %.2f%% (%d), reordered %d, duplicates %d, restarts %d\n",
+			addr, l.Highest, 100*l.Rate(), l.Lost, l.Reordered, l.Duplicates, l.Restarts)
+	}
 }
@@ -0,0 +1,196 @@
+package receiver
+
+import "google.golang.org/protobuf/encoding/protowire"
+
+// Event identifies an Envelope's event by its oneof field number, the same
+// number as the C++ Envelope::EventCase.
+type Event protowire.Number
+
+const (
+	// Transport
+	TrackStart    Event = 10
+	TrackEnd      Event = 11
+	TrackPosition Event = 12
+	TrackAbort    Event = 13
+	TrackPrepare  Event = 14
+
+	// Beat/Rhythm
+	Beat        Event = 20
+	TempoChange Event = 21
+	Downbeat    Event = 22
+
+	// Onset
+	Onset     Event = 30
+	OnsetRate Event = 31
+	Novelty   Event = 32
+
+	// Tonal
+	KeyChange     Event = 40
+	ChordChange   Event = 41
+	Chroma        Event = 42
+	Tuning        Event = 43
+	Dissonance    Event = 44
+	Inharmonicity Event = 45
+
+	// Pitch/Melody
+	Pitch       Event = 50
+	PitchChange Event = 51
+	Melody      Event = 52
+
+	// Loudness/Energy
+	Loudness      Event = 60
+	LoudnessPeak  Event = 61
+	Energy        Event = 62
+	DynamicChange Event = 63
+
+	// Silence/Gap
+	SilenceStart Event = 70
+	SilenceEnd   Event = 71
+	Gap          Event = 72
+
+	// Spectral
+	SpectralCentroid   Event = 80
+	SpectralFlux       Event = 81
+	SpectralComplexity Event = 82
+	SpectralContrast   Event = 83
+	SpectralRolloff    Event = 84
+	Mfcc               Event = 85
+	TimbreChange       Event = 86
+
+	// Bands
+	BandsMel  Event = 90
+	BandsBark Event = 91
+	BandsErb  Event = 92
+	Hfc       Event = 93
+
+	// Structure
+	SegmentBoundary Event = 100
+	FadeIn          Event = 101
+	FadeOut         Event = 102
+
+	// Quality
+	Click         Event = 110
+	Discontinuity Event = 111
+	NoiseBurst    Event = 112
+	Saturation    Event = 113
+	Hum           Event = 114
+
+	// Envelope/Transient
+	EnvelopeEvent Event = 120
+	Attack        Event = 121
+	Decay         Event = 122
+
+	// Containers: Batch is unwrapped by the Receiver and never delivered
+	Batch    Event = 130
+	Snapshot Event = 131
+
+	maxEvent = Snapshot
+)
+
+// Sender event names (tracks --list-events)
+var eventNames = map[Event]string{
+	// Transport
+	TrackStart:    "track.start",
+	TrackEnd:      "track.end",
+	TrackPosition: "track.position",
+	TrackAbort:    "track.abort",
+	TrackPrepare:  "track.prepare",
+
+	// Beat/Rhythm
+	Beat:        "beat",
+	TempoChange: "tempo.change",
+	Downbeat:    "downbeat",
+
+	// Onset
+	Onset:     "onset",
+	OnsetRate: "onset.rate",
+	Novelty:   "novelty",
+
+	// Tonal
+	KeyChange:     "key.change",
+	ChordChange:   "chord.change",
+	Chroma:        "chroma",
+	Tuning:        "tuning",
+	Dissonance:    "dissonance",
+	Inharmonicity: "inharmonicity",
+
+	// Pitch/Melody
+	Pitch:       "pitch",
+	PitchChange: "pitch.change",
+	Melody:      "melody",
+
+	// Loudness/Energy
+	Loudness:      "loudness",
+	LoudnessPeak:  "loudness.peak",
+	Energy:        "energy",
+	DynamicChange: "dynamic.change",
+
+	// Silence/Gap
+	SilenceStart: "silence.start",
+	SilenceEnd:   "silence.end",
+	Gap:          "gap",
+
+	// Spectral
+	SpectralCentroid:   "spectral.centroid",
+	SpectralFlux:       "spectral.flux",
+	SpectralComplexity: "spectral.complexity",
+	SpectralContrast:   "spectral.contrast",
+	SpectralRolloff:    "spectral.rolloff",
+	Mfcc:               "mfcc",
+	TimbreChange:       "timbre.change",
+
+	// Bands
+	BandsMel:  "bands.mel",
+	BandsBark: "bands.bark",
+	BandsErb:  "bands.erb",
+	Hfc:       "hfc",
+
+	// Structure
+	SegmentBoundary: "segment.boundary",
+	FadeIn:          "fade.in",
+	FadeOut:         "fade.out",
+
+	// Quality
+	Click:         "click",
+	Discontinuity: "discontinuity",
+	NoiseBurst:    "noise.burst",
+	Saturation:    "saturation",
+	Hum:           "hum",
+
+	// Envelope/Transient
+	EnvelopeEvent: "envelope",
+	Attack:        "attack",
+	Decay:         "decay",
+
+	// Containers
+	Batch:    "batch",
+	Snapshot: "snapshot",
+}
+
+func (e Event) String() string {
+	if name, ok := eventNames[e]; ok {
+		return name
+	}
+	return "unknown"
+}
+
+// ParseEvent returns the Event with the sender name `name` ("beat", "bands.mel")
+func ParseEvent(name string) (Event, bool) {
+	for e, n := range eventNames {
+		if n == name {
+			return e, true
+		}
+	}
+	return 0, false
+}
+
+// AllEvents returns every event a Receiver can deliver, in field order
+func AllEvents() []Event {
+	var all []Event
+	for e := Event(1); e <= maxEvent; e++ {
+		if _, ok := eventNames[e]; ok && e != Batch {
+			all = append(all, e)
+		}
+	}
+	return all
+}
@@ -0,0 +1,82 @@
+package receiver
+
+// Loss counts one sender's datagrams from Envelope.seq
+type Loss struct {
+	Highest    uint64 // highest seq seen
+	Received   uint64
+	Lost       uint64 // seqs up to Highest never received
+	Reordered  uint64 // arrived after a higher seq
+	Duplicates uint64
+	Restarts   uint64 // seq jumped back: the sender started over
+}
+
+// Rate is the fraction of the expected datagrams that were lost
+func (l Loss) Rate() float64 {
+	if expected := l.Received + l.Lost; expected > 0 {
+		return float64(l.Lost) / float64(expected)
+	}
+	return 0
+}
+
+const lossWindow = 4096 // seqs remembered for duplicate detection
+
+// lossTracker is the Go side of tracks-recv's StreamStats
+type lossTracker struct {
+	first, highest, received uint64
+	reordered, duplicates    uint64
+	restarts                 uint64
+	seen                     [lossWindow / 64]uint64 // bit seq % lossWindow, for seq in (highest - lossWindow, highest]
+}
+
+func (t *lossTracker) test(seq uint64) bool { return t.seen[seq%lossWindow/64]&(1<<(seq%64)) != 0 }
+func (t *lossTracker) set(seq uint64)       { t.seen[seq%lossWindow/64] |= 1 << (seq % 64) }
+func (t *lossTracker) clear(seq uint64)     { t.seen[seq%lossWindow/64] &^= 1 << (seq % 64) }
+
+func (t *lossTracker) add(seq uint64) {
+	if seq == 0 {
+		return // sender without sequence numbers
+	}
+	// A jump back further than the window is a restarted sender
+	if t.received == 0 || (seq < t.highest && t.highest-seq >= lossWindow) {
+		if t.received != 0 {
+			t.restarts++
+		}
+		t.first, t.highest, t.received = seq, seq, 1
+		t.seen = [lossWindow / 64]uint64{}
+		t.set(seq)
+		return
+	}
+	switch {
+	case seq > t.highest:
+		if seq-t.highest >= lossWindow {
+			t.seen = [lossWindow / 64]uint64{}
+		} else {
+			for s := t.highest + 1; s < seq; s++ {
+				t.clear(s)
+			}
+		}
+		t.highest = seq
+		t.set(seq)
+		t.received++
+	case t.test(seq):
+		t.duplicates++
+	default:
+		t.set(seq)
+		t.reordered++
+		t.received++
+	}
+}
+
+func (t *lossTracker) loss() Loss {
+	l := Loss{
+		Highest:    t.highest,
+		Received:   t.received,
+		Reordered:  t.reordered,
+		Duplicates: t.duplicates,
+		Restarts:   t.restarts,
+	}
+	if expected := t.highest - t.first + 1; t.received > 0 && expected > t.received {
+		l.Lost = expected - t.received
+	}
+	return l
+}
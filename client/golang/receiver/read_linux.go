@@ -0,0 +1,49 @@
+package receiver
+
+import (
+	"net"
+	"net/netip"
+	"syscall"
+
+	"golang.org/x/net/ipv4"
+)
+
+// One ReadBatch (recvmmsg(2) on Linux) per wake-up fills as many datagrams
+// as are queued, up to the batch size
+type batchReader struct {
+	conn *ipv4.PacketConn
+	msgs []ipv4.Message
+}
+
+func newBatchReader(conn *net.UDPConn, bufs [][]byte) (*batchReader, error) {
+	r := &batchReader{
+		conn: ipv4.NewPacketConn(conn),
+		msgs: make([]ipv4.Message, len(bufs)),
+	}
+	for i := range bufs {
+		r.msgs[i].Buffers = bufs[i : i+1]
+	}
+	return r, nil
+}
+
+// read waits for datagrams and returns how many it read into the buffers,
+// with their sizes (-1 if truncated) and senders
+func (r *batchReader) read(sizes []int, from []netip.AddrPort) (int, error) {
+	n, err := r.conn.ReadBatch(r.msgs, 0)
+	if err != nil {
+		return 0, err
+	}
+	for i := 0; i < n; i++ {
+		m := &r.msgs[i]
+		sizes[i] = m.N
+		if m.Flags&syscall.MSG_TRUNC != 0 {
+			sizes[i] = -1
+		}
+		from[i] = netip.AddrPort{}
+		if addr, ok := m.Addr.(*net.UDPAddr); ok {
+			ap := addr.AddrPort()
+			from[i] = netip.AddrPortFrom(ap.Addr().Unmap(), ap.Port())
+		}
+	}
+	return n, nil
+}
@@ -0,0 +1,27 @@
+//go:build !linux
+
+package receiver
+
+import (
+	"net"
+	"net/netip"
+)
+
+// Elsewhere each read returns one datagram
+type batchReader struct {
+	conn *net.UDPConn
+	buf  []byte
+}
+
+func newBatchReader(conn *net.UDPConn, bufs [][]byte) (*batchReader, error) {
+	return &batchReader{conn: conn, buf: bufs[0]}, nil
+}
+
+func (r *batchReader) read(sizes []int, from []netip.AddrPort) (int, error) {
+	n, addr, err := r.conn.ReadFromUDPAddrPort(r.buf)
+	if err != nil {
+		return 0, err
+	}
+	sizes[0], from[0] = n, addr
+	return 1, nil
+}
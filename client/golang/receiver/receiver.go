@@ -0,0 +1,295 @@
+// Package receiver receives TRACKS events at high rates. It reads datagrams
+// in batches, unwraps coalesced EnvelopeBatch datagrams, and decodes only
+// the events that were subscribed to, handing each to its subscription's
+// channel. Other events are skipped after reading their tag. Per-sender
+// loss is counted from Envelope.seq.
+//
+//	r, err := receiver.Listen(receiver.Config{ReadBuffer: 8 << 20})
+//	beats := r.Subscribe(256, receiver.Beat, receiver.Onset)
+//	go r.Run()
+//	for m := range beats {
+//		use(m.Envelope)
+//		r.Release(m)
+//	}
+package receiver
+
+import (
+	"errors"
+	"fmt"
+	"net"
+	"net/netip"
+	"sync"
+	"sync/atomic"
+
+	"github.com/davesmith10/tracks/client/golang/trackspb"
+	"google.golang.org/protobuf/proto"
+)
+
+type Config struct {
+	Group     string         // multicast group to join, or a unicast address to listen on (default 239.255.0.1)
+	Port      int            // default 5000
+	Interface *net.Interface // for the multicast join; nil = system default
+
+	ReadBuffer   int  // socket receive buffer (SO_RCVBUF) in bytes; 0 = OS default. Linux caps it at net.core.rmem_max.
+	BatchSize    int  // datagrams per read (default 32)
+	DatagramSize int  // largest datagram read whole (default 65536)
+	Block        bool // wait for a full subscription channel instead of dropping the message
+}
+
+// Message is one delivered event. Envelope is reused once the Message is
+// released.
+type Message struct {
+	Event    Event
+	Envelope *trackspb.Envelope
+	States   []*trackspb.Envelope // Snapshot: the track.start and latest state events it carries
+	From     netip.AddrPort       // sender
+}
+
+// Stats counts what a Receiver has seen since Listen
+type Stats struct {
+	Datagrams   uint64
+	Envelopes   uint64 // after unwrapping batches
+	Delivered   uint64
+	Skipped     uint64 // not subscribed, so never decoded
+	Dropped     uint64 // subscription channel full
+	Undecodable uint64 // malformed, truncated, or a vector delta whose reference frame was lost
+	Senders     map[netip.AddrPort]Loss
+}
+
+type subscription struct {
+	ch chan *Message
+}
+
+type Receiver struct {
+	conn   *net.UDPConn
+	reader *batchReader
+	bufs   [][]byte
+	block  bool
+
+	subs    [maxEvent + 1]*subscription
+	all     []*subscription
+	vectors vectorDecoder
+	pool    sync.Pool
+
+	closed atomic.Bool
+	done   chan struct{}
+
+	datagrams, envelopes, delivered atomic.Uint64
+	skipped, dropped, undecodable   atomic.Uint64
+
+	mu      sync.Mutex // guards senders
+	senders map[netip.AddrPort]*lossTracker
+	last    netip.AddrPort // sender of the previous datagram, and its tracker
+	lastT   *lossTracker
+}
+
+// Listen opens the socket; call Subscribe, then Run
+func Listen(cfg Config) (*Receiver, error) {
+	if cfg.Group == "" {
+		cfg.Group = "239.255.0.1"
+	}
+	if cfg.Port == 0 {
+		cfg.Port = 5000
+	}
+	if cfg.BatchSize <= 0 {
+		cfg.BatchSize = 32
+	}
+	if cfg.DatagramSize <= 0 {
+		cfg.DatagramSize = 65536
+	}
+
+	ip := net.ParseIP(cfg.Group).To4()
+	if ip == nil {
+		return nil, fmt.Errorf("receiver: %q is not an IPv4 address", cfg.Group)
+	}
+	addr := &net.UDPAddr{IP: ip, Port: cfg.Port}
+	var conn *net.UDPConn
+	var err error
+	if ip.IsMulticast() {
+		conn, err = net.ListenMulticastUDP("udp4", cfg.Interface, addr)
+	} else {
+		conn, err = net.ListenUDP("udp4", addr)
+	}
+	if err != nil {
+		return nil, err
+	}
+	if cfg.ReadBuffer > 0 {
+		if err := conn.SetReadBuffer(cfg.ReadBuffer); err != nil {
+			conn.Close()
+			return nil, err
+		}
+	}
+
+	r := &Receiver{
+		conn:    conn,
+		block:   cfg.Block,
+		done:    make(chan struct{}),
+		senders: make(map[netip.AddrPort]*lossTracker),
+	}
+	r.pool.New = func() any { return &Message{Envelope: &trackspb.Envelope{}} }
+	// One allocation for all buffers
+	arena := make([]byte, cfg.BatchSize*cfg.DatagramSize)
+	for i := 0; i < cfg.BatchSize; i++ {
+		r.bufs = append(r.bufs, arena[i*cfg.DatagramSize:(i+1)*cfg.DatagramSize:(i+1)*cfg.DatagramSize])
+	}
+	if r.reader, err = newBatchReader(conn, r.bufs); err != nil {
+		conn.Close()
+		return nil, err
+	}
+	return r, nil
+}
+
+// Subscribe returns a channel that receives `events`, holding up to `depth`
+// undelivered messages. When it is full, further messages are dropped
+// (Stats.Dropped) unless Config.Block is set. An event goes to one
+// subscription: subscribing it again moves it to the new channel. Call
+// before Run; Run closes the channel when it returns.
+func (r *Receiver) Subscribe(depth int, events ...Event) <-chan *Message {
+	sub := &subscription{ch: make(chan *Message, depth)}
+	for _, e := range events {
+		if e > 0 && e <= maxEvent && e != Batch {
+			r.subs[e] = sub
+		}
+	}
+	r.all = append(r.all, sub)
+	return sub.ch
+}
+
+// Release hands a delivered message back for reuse
+func (r *Receiver) Release(m *Message) {
+	m.States = m.States[:0]
+	r.pool.Put(m)
+}
+
+// Run reads and dispatches until Close. It returns nil after Close, or the
+// error that stopped it.
+func (r *Receiver) Run() error {
+	defer func() {
+		for _, sub := range r.all {
+			close(sub.ch)
+		}
+	}()
+	sizes := make([]int, len(r.bufs))
+	from := make([]netip.AddrPort, len(r.bufs))
+	for {
+		n, err := r.reader.read(sizes, from)
+		if err != nil {
+			if r.closed.Load() || errors.Is(err, net.ErrClosed) {
+				return nil
+			}
+			return err
+		}
+		for i := 0; i < n; i++ {
+			if sizes[i] < 0 {
+				r.datagrams.Add(1)
+				r.undecodable.Add(1)
+				continue
+			}
+			r.datagram(r.bufs[i][:sizes[i]], from[i])
+		}
+	}
+}
+
+// Close stops Run
+func (r *Receiver) Close() error {
+	if r.closed.Swap(true) {
+		return nil
+	}
+	close(r.done)
+	return r.conn.Close()
+}
+
+func (r *Receiver) Stats() Stats {
+	s := Stats{
+		Datagrams:   r.datagrams.Load(),
+		Envelopes:   r.envelopes.Load(),
+		Delivered:   r.delivered.Load(),
+		Skipped:     r.skipped.Load(),
+		Dropped:     r.dropped.Load(),
+		Undecodable: r.undecodable.Load(),
+		Senders:     make(map[netip.AddrPort]Loss),
+	}
+	r.mu.Lock()
+	for addr, t := range r.senders {
+		s.Senders[addr] = t.loss()
+	}
+	r.mu.Unlock()
+	return s
+}
+
+func (r *Receiver) datagram(b []byte, from netip.AddrPort) {
+	r.datagrams.Add(1)
+	var p peek
+	if err := peekEnvelope(b, &p); err != nil {
+		r.undecodable.Add(1)
+		return
+	}
+
+	// seq is per datagram: on a batch it is on the outer envelope
+	r.mu.Lock()
+	if r.lastT == nil || from != r.last {
+		if r.lastT = r.senders[from]; r.lastT == nil {
+			r.lastT = &lossTracker{}
+			r.senders[from] = r.lastT
+		}
+		r.last = from
+	}
+	r.lastT.add(p.seq)
+	r.mu.Unlock()
+
+	if p.event != Batch {
+		r.dispatch(b, &p, from)
+		return
+	}
+	err := forEachEnvelope(p.payload, func(inner []byte) {
+		var e peek
+		if peekEnvelope(inner, &e) != nil {
+			r.undecodable.Add(1)
+			return
+		}
+		r.dispatch(inner, &e, from)
+	})
+	if err != nil {
+		r.undecodable.Add(1)
+	}
+}
+
+func (r *Receiver) dispatch(b []byte, p *peek, from netip.AddrPort) {
+	r.envelopes.Add(1)
+	var sub *subscription
+	if p.event > 0 && p.event <= maxEvent {
+		sub = r.subs[p.event]
+	}
+	if sub == nil {
+		r.skipped.Add(1)
+		return
+	}
+
+	m := r.pool.Get().(*Message)
+	if err := proto.Unmarshal(b, m.Envelope); err != nil || !r.vectors.decode(m.Envelope, from) {
+		r.undecodable.Add(1)
+		r.Release(m)
+		return
+	}
+	m.Event, m.From = p.event, from
+	if p.event == Snapshot {
+		m.States = append(m.States, m.Envelope.GetSnapshot().GetEvents()...)
+	}
+
+	if r.block {
+		select {
+		case sub.ch <- m:
+			r.delivered.Add(1)
+		case <-r.done:
+			r.Release(m)
+		}
+		return
+	}
+	select {
+	case sub.ch <- m:
+		r.delivered.Add(1)
+	default:
+		r.dropped.Add(1)
+		r.Release(m)
+	}
+}
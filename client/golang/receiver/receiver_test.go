@@ -0,0 +1,180 @@
+package receiver
+
+import (
+	"math"
+	"net/netip"
+	"testing"
+
+	"github.com/davesmith10/tracks/client/golang/trackspb"
+	"google.golang.org/protobuf/proto"
+)
+
+var (
+	senderA = netip.MustParseAddrPort("192.0.2.1:40000")
+	senderB = netip.MustParseAddrPort("192.0.2.2:40000")
+)
+
+// testReceiver is a Receiver without a socket, fed through datagram()
+func testReceiver() *Receiver {
+	r := &Receiver{
+		done:    make(chan struct{}),
+		senders: make(map[netip.AddrPort]*lossTracker),
+	}
+	r.pool.New = func() any { return &Message{Envelope: &trackspb.Envelope{}} }
+	return r
+}
+
+func marshal(t *testing.T, env *trackspb.Envelope) []byte {
+	t.Helper()
+	b, err := proto.Marshal(env)
+	if err != nil {
+		t.Fatal(err)
+	}
+	return b
+}
+
+func beat(ts float64) *trackspb.Envelope {
+	return &trackspb.Envelope{Timestamp: ts, Event: &trackspb.Envelope_Beat{Beat: &trackspb.Beat{Confidence: 0.5}}}
+}
+
+func TestPeekEnvelope(t *testing.T) {
+	env := beat(1.5)
+	env.Seq, env.SentNs = 7, 123456789
+	b := marshal(t, env)
+
+	var p peek
+	if err := peekEnvelope(b, &p); err != nil {
+		t.Fatal(err)
+	}
+	if p.event != Beat || p.timestamp != 1.5 || p.seq != 7 || p.sentNs != 123456789 {
+		t.Fatalf("peek = %+v", p)
+	}
+	var got trackspb.Beat
+	if err := proto.Unmarshal(p.payload, &got); err != nil || got.GetConfidence() != 0.5 {
+		t.Fatalf("payload = %v, %v", &got, err)
+	}
+	if peekEnvelope(b[:len(b)-1], &p) == nil {
+		t.Fatal("truncated envelope peeked without error")
+	}
+}
+
+func TestBatchDispatch(t *testing.T) {
+	r := testReceiver()
+	beats := r.Subscribe(8, Beat)
+	onset := &trackspb.Envelope{Timestamp: 2, Event: &trackspb.Envelope_Onset{Onset: &trackspb.Onset{Strength: 1}}}
+	batch := &trackspb.Envelope{Seq: 1, Event: &trackspb.Envelope_Batch{Batch: &trackspb.EnvelopeBatch{
+		Events: []*trackspb.Envelope{beat(1), onset, beat(3)},
+	}}}
+	r.datagram(marshal(t, batch), senderA)
+
+	for _, want := range []float64{1, 3} {
+		m := <-beats
+		if m.Event != Beat || m.Envelope.GetTimestamp() != want || m.Envelope.GetBeat().GetConfidence() != 0.5 || m.From != senderA {
+			t.Fatalf("got %v %v from %v, want beat at %v", m.Event, m.Envelope, m.From, want)
+		}
+		r.Release(m)
+	}
+	s := r.Stats()
+	if s.Datagrams != 1 || s.Envelopes != 3 || s.Delivered != 2 || s.Skipped != 1 || s.Undecodable != 0 {
+		t.Fatalf("stats = %+v", s)
+	}
+	if l := s.Senders[senderA]; l.Highest != 1 || l.Received != 1 {
+		t.Fatalf("loss = %+v", l)
+	}
+}
+
+func TestSnapshotStates(t *testing.T) {
+	r := testReceiver()
+	snapshots := r.Subscribe(1, Snapshot)
+	start := &trackspb.Envelope{Event: &trackspb.Envelope_TrackStart{TrackStart: &trackspb.TrackStart{Filename: "a.wav"}}}
+	tempo := &trackspb.Envelope{Timestamp: 4, Event: &trackspb.Envelope_TempoChange{TempoChange: &trackspb.TempoChange{Bpm: 120}}}
+	snap := &trackspb.Envelope{Timestamp: 5, Event: &trackspb.Envelope_Snapshot{Snapshot: &trackspb.Snapshot{
+		Events: []*trackspb.Envelope{start, tempo},
+	}}}
+	r.datagram(marshal(t, snap), senderA)
+
+	m := <-snapshots
+	if m.Envelope.GetSnapshot() == nil {
+		t.Fatal("snapshot envelope has no event")
+	}
+	if len(m.States) != 2 || m.States[0].GetTrackStart().GetFilename() != "a.wav" || m.States[1].GetTempoChange().GetBpm() != 120 {
+		t.Fatalf("states = %v", m.States)
+	}
+}
+
+func TestLossTracker(t *testing.T) {
+	var lt lossTracker
+	for _, seq := range []uint64{1, 2, 4, 3, 3, 10} {
+		lt.add(seq)
+	}
+	want := Loss{Highest: 10, Received: 5, Lost: 5, Reordered: 1, Duplicates: 1}
+	if got := lt.loss(); got != want {
+		t.Fatalf("loss = %+v, want %+v", got, want)
+	}
+
+	lt.add(lossWindow + 20)
+	lt.add(1) // more than a window back
+	if got := lt.loss(); got.Restarts != 1 || got.Highest != 1 || got.Received != 1 || got.Lost != 0 {
+		t.Fatalf("after restart, loss = %+v", got)
+	}
+}
+
+// chroma is an 8-bit quantized Chroma frame with scale 0.5
+func chroma(index uint32, keyframe bool, offset float32, data ...byte) *trackspb.Envelope {
+	return &trackspb.Envelope{Event: &trackspb.Envelope_Chroma{Chroma: &trackspb.Chroma{
+		Quantized: &trackspb.QuantizedVector{Bits: 8, Scale: 0.5, Offset: offset, Data: data, Index: index, Keyframe: keyframe},
+	}}}
+}
+
+func equal(a, b []float32) bool {
+	if len(a) != len(b) {
+		return false
+	}
+	for i := range a {
+		if a[i] != b[i] {
+			return false
+		}
+	}
+	return true
+}
+
+func TestVectorDecode(t *testing.T) {
+	var d vectorDecoder
+	steps := []struct {
+		env  *trackspb.Envelope
+		from netip.AddrPort
+		ok   bool
+		want []float32
+	}{
+		{chroma(0, true, 1, 0, 2, 4), senderA, true, []float32{1, 2, 3}},
+		{chroma(1, false, -1, 2, 0, 4), senderA, true, []float32{1, 1, 4}},
+		// Another sender's frames are their own chain
+		{chroma(1, false, 0, 0, 0, 0), senderB, false, nil},
+		// Frame 2 is lost: deltas fail until the next keyframe
+		{chroma(3, false, 0, 2, 2, 2), senderA, false, nil},
+		{chroma(4, false, 0, 2, 2, 2), senderA, false, nil},
+		{chroma(5, true, 0, 2, 4, 6), senderA, true, []float32{1, 2, 3}},
+		{chroma(6, false, 0, 2, 0, 0), senderA, true, []float32{2, 2, 3}},
+		// The index wraps: a delta at index 0 follows the last uint32
+		{chroma(math.MaxUint32, true, 0, 8, 8, 8), senderB, true, []float32{4, 4, 4}},
+		{chroma(0, false, 0, 2, 0, 0), senderB, true, []float32{5, 4, 4}},
+	}
+	for i, s := range steps {
+		ok := d.decode(s.env, s.from)
+		c := s.env.GetChroma()
+		if ok != s.ok || (ok && (!equal(c.GetValues(), s.want) || c.GetQuantized() != nil)) {
+			t.Fatalf("step %d: ok = %v, values = %v, quantized = %v; want %v, %v", i, ok, c.GetValues(), c.GetQuantized(), s.ok, s.want)
+		}
+	}
+
+	// Unquantized and non-vector events pass through
+	plain := &trackspb.Envelope{Event: &trackspb.Envelope_Mfcc{Mfcc: &trackspb.Mfcc{Values: []float32{1, 2}}}}
+	if !d.decode(plain, senderA) || !equal(plain.GetMfcc().GetValues(), []float32{1, 2}) || !d.decode(beat(0), senderA) {
+		t.Fatal("pass-through event rejected or changed")
+	}
+	bad := chroma(0, true, 0, 1)
+	bad.GetChroma().Quantized.Bits = 12
+	if d.decode(bad, senderA) {
+		t.Fatal("12-bit vector decoded")
+	}
+}
@@ -0,0 +1,89 @@
+package receiver
+
+import (
+	"net/netip"
+
+	"github.com/davesmith10/tracks/client/golang/trackspb"
+)
+
+type vectorFrame struct {
+	index  uint32
+	values []float32
+}
+
+// vectorKey identifies one delta chain: each sender's frames of a type
+type vectorKey struct {
+	from netip.AddrPort
+	kind Event
+}
+
+// vectorDecoder expands quantized vector events (sender vector encoding)
+// back into Values, keeping the previous frame of each sender and type for
+// deltas.
+type vectorDecoder struct {
+	previous map[vectorKey]vectorFrame
+}
+
+// decode reports false for a delta whose reference frame was never seen;
+// such an event should be dropped.
+func (d *vectorDecoder) decode(env *trackspb.Envelope, from netip.AddrPort) bool {
+	var quantized **trackspb.QuantizedVector
+	var values *[]float32
+	var kind Event
+	switch e := env.Event.(type) {
+	case *trackspb.Envelope_Chroma:
+		quantized, values, kind = &e.Chroma.Quantized, &e.Chroma.Values, Chroma
+	case *trackspb.Envelope_SpectralContrast:
+		quantized, values, kind = &e.SpectralContrast.Quantized, &e.SpectralContrast.Values, SpectralContrast
+	case *trackspb.Envelope_Mfcc:
+		quantized, values, kind = &e.Mfcc.Quantized, &e.Mfcc.Values, Mfcc
+	case *trackspb.Envelope_BandsMel:
+		quantized, values, kind = &e.BandsMel.Quantized, &e.BandsMel.Values, BandsMel
+	case *trackspb.Envelope_BandsBark:
+		quantized, values, kind = &e.BandsBark.Quantized, &e.BandsBark.Values, BandsBark
+	case *trackspb.Envelope_BandsErb:
+		quantized, values, kind = &e.BandsErb.Quantized, &e.BandsErb.Values, BandsErb
+	default:
+		return true
+	}
+
+	q := *quantized
+	if q == nil {
+		return true
+	}
+	bits, data := q.GetBits(), q.GetData()
+	if bits != 8 && bits != 16 {
+		return false
+	}
+	scale, offset := q.GetScale(), q.GetOffset()
+
+	width := int(bits / 8)
+	n := len(data) / width
+	// A delta needs exactly the frame before it
+	key := vectorKey{from, kind}
+	prev, seen := d.previous[key]
+	delta := !q.GetKeyframe()
+	if delta && (!seen || prev.index+1 != q.GetIndex() || len(prev.values) != n) {
+		return false
+	}
+
+	out := make([]float32, n)
+	for i := range out {
+		s := uint32(data[i*width])
+		if width == 2 {
+			s |= uint32(data[i*width+1]) << 8
+		}
+		// Explicit conversions keep the arithmetic unfused, matching the sender
+		v := offset + float32(float32(s)*scale)
+		if delta {
+			v = float32(prev.values[i] + v)
+		}
+		out[i] = v
+	}
+	if d.previous == nil {
+		d.previous = make(map[vectorKey]vectorFrame)
+	}
+	d.previous[key] = vectorFrame{index: q.GetIndex(), values: out}
+	*values, *quantized = out, nil
+	return true
+}
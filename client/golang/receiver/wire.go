@@ -0,0 +1,106 @@
+package receiver
+
+import (
+	"math"
+
+	"google.golang.org/protobuf/encoding/protowire"
+)
+
+// Envelope fields read at the wire level, so that every datagram's seq is
+// counted and batches are unwrapped without parsing the events nobody
+// subscribed to
+const (
+	timestampField protowire.Number = 1
+	seqField       protowire.Number = 2
+	sentNsField    protowire.Number = 3
+	firstEvent     protowire.Number = 10
+
+	eventsField protowire.Number = 1 // EnvelopeBatch.events, Snapshot.events
+)
+
+// peek holds an Envelope's top-level fields, read without parsing it: which
+// event it holds and where that event's bytes are, plus the per-datagram
+// fields. A Go port of src/envelope_peek.h.
+type peek struct {
+	event     Event
+	payload   []byte // the event member's serialized message
+	timestamp float64
+	seq       uint64
+	sentNs    uint64
+}
+
+func peekEnvelope(b []byte, p *peek) error {
+	*p = peek{}
+	for len(b) > 0 {
+		num, typ, n := protowire.ConsumeTag(b)
+		if n < 0 {
+			return protowire.ParseError(n)
+		}
+		b = b[n:]
+		switch {
+		case num == timestampField && typ == protowire.Fixed64Type:
+			v, m := protowire.ConsumeFixed64(b)
+			if m < 0 {
+				return protowire.ParseError(m)
+			}
+			p.timestamp = math.Float64frombits(v)
+			b = b[m:]
+		case num == seqField && typ == protowire.VarintType:
+			v, m := protowire.ConsumeVarint(b)
+			if m < 0 {
+				return protowire.ParseError(m)
+			}
+			p.seq = v
+			b = b[m:]
+		case num == sentNsField && typ == protowire.Fixed64Type:
+			v, m := protowire.ConsumeFixed64(b)
+			if m < 0 {
+				return protowire.ParseError(m)
+			}
+			p.sentNs = v
+			b = b[m:]
+		case num >= firstEvent && typ == protowire.BytesType:
+			// Event members are all messages; the last one wins, as in a parse
+			v, m := protowire.ConsumeBytes(b)
+			if m < 0 {
+				return protowire.ParseError(m)
+			}
+			p.event, p.payload = Event(num), v
+			b = b[m:]
+		default:
+			m := protowire.ConsumeFieldValue(num, typ, b)
+			if m < 0 {
+				return protowire.ParseError(m)
+			}
+			b = b[m:]
+		}
+	}
+	return nil
+}
+
+// forEachEnvelope calls fn with each serialized Envelope in the events field
+// of an EnvelopeBatch or Snapshot payload, in order
+func forEachEnvelope(b []byte, fn func([]byte)) error {
+	for len(b) > 0 {
+		num, typ, n := protowire.ConsumeTag(b)
+		if n < 0 {
+			return protowire.ParseError(n)
+		}
+		b = b[n:]
+		if num == eventsField && typ == protowire.BytesType {
+			v, m := protowire.ConsumeBytes(b)
+			if m < 0 {
+				return protowire.ParseError(m)
+			}
+			fn(v)
+			b = b[m:]
+			continue
+		}
+		m := protowire.ConsumeFieldValue(num, typ, b)
+		if m < 0 {
+			return protowire.ParseError(m)
+		}
+		b = b[m:]
+	}
+	return nil
+}
@@ -1,7 +1,7 @@
 // Code generated by protoc-gen-go. DO NOT EDIT.
 // versions:
 // 	protoc-gen-go v1.36.11
-// 	protoc        v3.14.0
+// 	protoc        v3.21.12
 // source: tracks.proto
 
 package trackspb
@@ -23,13 +23,16 @@ const (
 
 type Envelope struct {
 	state     protoimpl.MessageState `protogen:"open.v1"`
-	Timestamp float64                `protobuf:"fixed64,1,opt,name=timestamp,proto3" json:"timestamp,omitempty"` // seconds from start of file
+	Timestamp float64                `protobuf:"fixed64,1,opt,name=timestamp,proto3" json:"timestamp,omitempty"`         // seconds from start of file
+	Seq       uint64                 `protobuf:"varint,2,opt,name=seq,proto3" json:"seq,omitempty"`                      // datagram number per sender, from 1 (set by the transport)
+	SentNs    uint64                 `protobuf:"fixed64,3,opt,name=sent_ns,json=sentNs,proto3" json:"sent_ns,omitempty"` // sender CLOCK_MONOTONIC at send time, nanoseconds
 	// Types that are valid to be assigned to Event:
 	//
 	//	*Envelope_TrackStart
 	//	*Envelope_TrackEnd
 	//	*Envelope_TrackPosition
 	//	*Envelope_TrackAbort
+	//	*Envelope_TrackPrepare
 	//	*Envelope_Beat
 	//	*Envelope_TempoChange
 	//	*Envelope_Downbeat
@@ -74,6 +77,8 @@ type Envelope struct {
 	//	*Envelope_EnvelopeEvent
 	//	*Envelope_Attack
 	//	*Envelope_Decay
+	//	*Envelope_Batch
+	//	*Envelope_Snapshot
 	Event         isEnvelope_Event `protobuf_oneof:"event"`
 	unknownFields protoimpl.UnknownFields
 	sizeCache     protoimpl.SizeCache
@@ -116,6 +121,20 @@ func (x *Envelope) GetTimestamp() float64 {
 	return 0
 }
 
+func (x *Envelope) GetSeq() uint64 {
+	if x != nil {
+		return x.Seq
+	}
+	return 0
+}
+
+func (x *Envelope) GetSentNs() uint64 {
+	if x != nil {
+		return x.SentNs
+	}
+	return 0
+}
+
 func (x *Envelope) GetEvent() isEnvelope_Event {
 	if x != nil {
 		return x.Event
@@ -159,6 +178,15 @@ func (x *Envelope) GetTrackAbort() *TrackAbort {
 	return nil
 }
 
+func (x *Envelope) GetTrackPrepare() *TrackPrepare {
+	if x != nil {
+		if x, ok := x.Event.(*Envelope_TrackPrepare); ok {
+			return x.TrackPrepare
+		}
+	}
+	return nil
+}
+
 func (x *Envelope) GetBeat() *Beat {
 	if x != nil {
 		if x, ok := x.Event.(*Envelope_Beat); ok {
@@ -555,6 +583,24 @@ func (x *Envelope) GetDecay() *Decay {
 	return nil
 }
 
+func (x *Envelope) GetBatch() *EnvelopeBatch {
+	if x != nil {
+		if x, ok := x.Event.(*Envelope_Batch); ok {
+			return x.Batch
+		}
+	}
+	return nil
+}
+
+func (x *Envelope) GetSnapshot() *Snapshot {
+	if x != nil {
+		if x, ok := x.Event.(*Envelope_Snapshot); ok {
+			return x.Snapshot
+		}
+	}
+	return nil
+}
+
 type isEnvelope_Event interface {
 	isEnvelope_Event()
 }
@@ -576,6 +622,10 @@ type Envelope_TrackAbort struct {
 	TrackAbort *TrackAbort `protobuf:"bytes,13,opt,name=track_abort,json=trackAbort,proto3,oneof"`
 }
 
+type Envelope_TrackPrepare struct {
+	TrackPrepare *TrackPrepare `protobuf:"bytes,14,opt,name=track_prepare,json=trackPrepare,proto3,oneof"`
+}
+
 type Envelope_Beat struct {
 	// Beat/Rhythm 20-29
 	Beat *Beat `protobuf:"bytes,20,opt,name=beat,proto3,oneof"`
@@ -763,6 +813,15 @@ type Envelope_Decay struct {
 	Decay *Decay `protobuf:"bytes,122,opt,name=decay,proto3,oneof"`
 }
 
+type Envelope_Batch struct {
+	// Container 130-131
+	Batch *EnvelopeBatch `protobuf:"bytes,130,opt,name=batch,proto3,oneof"`
+}
+
+type Envelope_Snapshot struct {
+	Snapshot *Snapshot `protobuf:"bytes,131,opt,name=snapshot,proto3,oneof"`
+}
+
 func (*Envelope_TrackStart) isEnvelope_Event() {}
 
 func (*Envelope_TrackEnd) isEnvelope_Event() {}
@@ -771,6 +830,8 @@ func (*Envelope_TrackPosition) isEnvelope_Event() {}
 
 func (*Envelope_TrackAbort) isEnvelope_Event() {}
 
+func (*Envelope_TrackPrepare) isEnvelope_Event() {}
+
 func (*Envelope_Beat) isEnvelope_Event() {}
 
 func (*Envelope_TempoChange) isEnvelope_Event() {}
@@ -859,6 +920,192 @@ func (*Envelope_Attack) isEnvelope_Event() {}
 
 func (*Envelope_Decay) isEnvelope_Event() {}
 
+func (*Envelope_Batch) isEnvelope_Event() {}
+
+func (*Envelope_Snapshot) isEnvelope_Event() {}
+
+// Compact form of a vector event's values (sender vector encoding):
+// value[i] = offset + scale * q[i], plus value[i] of the previous frame of
+// the same type (index - 1) unless keyframe is set.
+type QuantizedVector struct {
+	state         protoimpl.MessageState `protogen:"open.v1"`
+	Bits          uint32                 `protobuf:"varint,1,opt,name=bits,proto3" json:"bits,omitempty"` // 8 or 16
+	Scale         float32                `protobuf:"fixed32,2,opt,name=scale,proto3" json:"scale,omitempty"`
+	Offset        float32                `protobuf:"fixed32,3,opt,name=offset,proto3" json:"offset,omitempty"`
+	Data          []byte                 `protobuf:"bytes,4,opt,name=data,proto3" json:"data,omitempty"`          // one little-endian unsigned q per value
+	Index         uint32                 `protobuf:"varint,5,opt,name=index,proto3" json:"index,omitempty"`       // frame number of this type, counting every frame sent
+	Keyframe      bool                   `protobuf:"varint,6,opt,name=keyframe,proto3" json:"keyframe,omitempty"` // absolute; otherwise a delta from frame index - 1
+	unknownFields protoimpl.UnknownFields
+	sizeCache     protoimpl.SizeCache
+}
+
+func (x *QuantizedVector) Reset() {
+	*x = QuantizedVector{}
+	mi := &file_tracks_proto_msgTypes[1]
+	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+	ms.StoreMessageInfo(mi)
+}
+
+func (x *QuantizedVector) String() string {
+	return protoimpl.X.MessageStringOf(x)
+}
+
+func (*QuantizedVector) ProtoMessage() {}
+
+func (x *QuantizedVector) ProtoReflect() protoreflect.Message {
+	mi := &file_tracks_proto_msgTypes[1]
+	if x != nil {
+		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+		if ms.LoadMessageInfo() == nil {
+			ms.StoreMessageInfo(mi)
+		}
+		return ms
+	}
+	return mi.MessageOf(x)
+}
+
+// Deprecated: Use QuantizedVector.ProtoReflect.Descriptor instead.
+func (*QuantizedVector) Descriptor() ([]byte, []int) {
+	return file_tracks_proto_rawDescGZIP(), []int{1}
+}
+
+func (x *QuantizedVector) GetBits() uint32 {
+	if x != nil {
+		return x.Bits
+	}
+	return 0
+}
+
+func (x *QuantizedVector) GetScale() float32 {
+	if x != nil {
+		return x.Scale
+	}
+	return 0
+}
+
+func (x *QuantizedVector) GetOffset() float32 {
+	if x != nil {
+		return x.Offset
+	}
+	return 0
+}
+
+func (x *QuantizedVector) GetData() []byte {
+	if x != nil {
+		return x.Data
+	}
+	return nil
+}
+
+func (x *QuantizedVector) GetIndex() uint32 {
+	if x != nil {
+		return x.Index
+	}
+	return 0
+}
+
+func (x *QuantizedVector) GetKeyframe() bool {
+	if x != nil {
+		return x.Keyframe
+	}
+	return false
+}
+
+// Several envelopes sharing one datagram (sender --coalesce). The outer
+// timestamp is unset; each inner envelope carries its own. Batches never nest.
+type EnvelopeBatch struct {
+	state         protoimpl.MessageState `protogen:"open.v1"`
+	Events        []*Envelope            `protobuf:"bytes,1,rep,name=events,proto3" json:"events,omitempty"`
+	unknownFields protoimpl.UnknownFields
+	sizeCache     protoimpl.SizeCache
+}
+
+func (x *EnvelopeBatch) Reset() {
+	*x = EnvelopeBatch{}
+	mi := &file_tracks_proto_msgTypes[2]
+	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+	ms.StoreMessageInfo(mi)
+}
+
+func (x *EnvelopeBatch) String() string {
+	return protoimpl.X.MessageStringOf(x)
+}
+
+func (*EnvelopeBatch) ProtoMessage() {}
+
+func (x *EnvelopeBatch) ProtoReflect() protoreflect.Message {
+	mi := &file_tracks_proto_msgTypes[2]
+	if x != nil {
+		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+		if ms.LoadMessageInfo() == nil {
+			ms.StoreMessageInfo(mi)
+		}
+		return ms
+	}
+	return mi.MessageOf(x)
+}
+
+// Deprecated: Use EnvelopeBatch.ProtoReflect.Descriptor instead.
+func (*EnvelopeBatch) Descriptor() ([]byte, []int) {
+	return file_tracks_proto_rawDescGZIP(), []int{2}
+}
+
+func (x *EnvelopeBatch) GetEvents() []*Envelope {
+	if x != nil {
+		return x.Events
+	}
+	return nil
+}
+
+// Current state of the playing track, sent with every track.position so a
+// receiver that joined late catches up within one heartbeat. The outer
+// timestamp is the position; events holds the track.start and the latest
+// event of each state type (key, tempo, chord, tuning, segment, silence),
+// each with its original timestamp.
+type Snapshot struct {
+	state         protoimpl.MessageState `protogen:"open.v1"`
+	Events        []*Envelope            `protobuf:"bytes,1,rep,name=events,proto3" json:"events,omitempty"`
+	unknownFields protoimpl.UnknownFields
+	sizeCache     protoimpl.SizeCache
+}
+
+func (x *Snapshot) Reset() {
+	*x = Snapshot{}
+	mi := &file_tracks_proto_msgTypes[3]
+	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+	ms.StoreMessageInfo(mi)
+}
+
+func (x *Snapshot) String() string {
+	return protoimpl.X.MessageStringOf(x)
+}
+
+func (*Snapshot) ProtoMessage() {}
+
+func (x *Snapshot) ProtoReflect() protoreflect.Message {
+	mi := &file_tracks_proto_msgTypes[3]
+	if x != nil {
+		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+		if ms.LoadMessageInfo() == nil {
+			ms.StoreMessageInfo(mi)
+		}
+		return ms
+	}
+	return mi.MessageOf(x)
+}
+
+// Deprecated: Use Snapshot.ProtoReflect.Descriptor instead.
+func (*Snapshot) Descriptor() ([]byte, []int) {
+	return file_tracks_proto_rawDescGZIP(), []int{3}
+}
+
+func (x *Snapshot) GetEvents() []*Envelope {
+	if x != nil {
+		return x.Events
+	}
+	return nil
+}
+
 type TrackStart struct {
 	state         protoimpl.MessageState `protogen:"open.v1"`
 	Filename      string                 `protobuf:"bytes,1,opt,name=filename,proto3" json:"filename,omitempty"`
@@ -871,7 +1118,7 @@ type TrackStart struct {
 
 func (x *TrackStart) Reset() {
 	*x = TrackStart{}
-	mi := &file_tracks_proto_msgTypes[1]
+	mi := &file_tracks_proto_msgTypes[4]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -883,7 +1130,7 @@ func (x *TrackStart) String() string {
 func (*TrackStart) ProtoMessage() {}
 
 func (x *TrackStart) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[1]
+	mi := &file_tracks_proto_msgTypes[4]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -896,7 +1143,7 @@ func (x *TrackStart) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use TrackStart.ProtoReflect.Descriptor instead.
 func (*TrackStart) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{1}
+	return file_tracks_proto_rawDescGZIP(), []int{4}
 }
 
 func (x *TrackStart) GetFilename() string {
@@ -935,7 +1182,7 @@ type TrackEnd struct {
 
 func (x *TrackEnd) Reset() {
 	*x = TrackEnd{}
-	mi := &file_tracks_proto_msgTypes[2]
+	mi := &file_tracks_proto_msgTypes[5]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -947,7 +1194,7 @@ func (x *TrackEnd) String() string {
 func (*TrackEnd) ProtoMessage() {}
 
 func (x *TrackEnd) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[2]
+	mi := &file_tracks_proto_msgTypes[5]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -960,7 +1207,7 @@ func (x *TrackEnd) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use TrackEnd.ProtoReflect.Descriptor instead.
 func (*TrackEnd) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{2}
+	return file_tracks_proto_rawDescGZIP(), []int{5}
 }
 
 type TrackPosition struct {
@@ -972,7 +1219,7 @@ type TrackPosition struct {
 
 func (x *TrackPosition) Reset() {
 	*x = TrackPosition{}
-	mi := &file_tracks_proto_msgTypes[3]
+	mi := &file_tracks_proto_msgTypes[6]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -984,7 +1231,7 @@ func (x *TrackPosition) String() string {
 func (*TrackPosition) ProtoMessage() {}
 
 func (x *TrackPosition) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[3]
+	mi := &file_tracks_proto_msgTypes[6]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -997,7 +1244,7 @@ func (x *TrackPosition) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use TrackPosition.ProtoReflect.Descriptor instead.
 func (*TrackPosition) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{3}
+	return file_tracks_proto_rawDescGZIP(), []int{6}
 }
 
 func (x *TrackPosition) GetPosition() float64 {
@@ -1016,7 +1263,7 @@ type TrackAbort struct {
 
 func (x *TrackAbort) Reset() {
 	*x = TrackAbort{}
-	mi := &file_tracks_proto_msgTypes[4]
+	mi := &file_tracks_proto_msgTypes[7]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1028,7 +1275,7 @@ func (x *TrackAbort) String() string {
 func (*TrackAbort) ProtoMessage() {}
 
 func (x *TrackAbort) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[4]
+	mi := &file_tracks_proto_msgTypes[7]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1041,7 +1288,7 @@ func (x *TrackAbort) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use TrackAbort.ProtoReflect.Descriptor instead.
 func (*TrackAbort) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{4}
+	return file_tracks_proto_rawDescGZIP(), []int{7}
 }
 
 func (x *TrackAbort) GetReason() string {
@@ -1051,6 +1298,58 @@ func (x *TrackAbort) GetReason() string {
 	return ""
 }
 
+type TrackPrepare struct {
+	state         protoimpl.MessageState `protogen:"open.v1"`
+	Countdown     float64                `protobuf:"fixed64,1,opt,name=countdown,proto3" json:"countdown,omitempty"` // seconds until track.start
+	Filename      string                 `protobuf:"bytes,2,opt,name=filename,proto3" json:"filename,omitempty"`     // canonical (absolute) file path
+	unknownFields protoimpl.UnknownFields
+	sizeCache     protoimpl.SizeCache
+}
+
+func (x *TrackPrepare) Reset() {
+	*x = TrackPrepare{}
+	mi := &file_tracks_proto_msgTypes[8]
+	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+	ms.StoreMessageInfo(mi)
+}
+
+func (x *TrackPrepare) String() string {
+	return protoimpl.X.MessageStringOf(x)
+}
+
+func (*TrackPrepare) ProtoMessage() {}
+
+func (x *TrackPrepare) ProtoReflect() protoreflect.Message {
+	mi := &file_tracks_proto_msgTypes[8]
+	if x != nil {
+		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
+		if ms.LoadMessageInfo() == nil {
+			ms.StoreMessageInfo(mi)
+		}
+		return ms
+	}
+	return mi.MessageOf(x)
+}
+
+// Deprecated: Use TrackPrepare.ProtoReflect.Descriptor instead.
+func (*TrackPrepare) Descriptor() ([]byte, []int) {
+	return file_tracks_proto_rawDescGZIP(), []int{8}
+}
+
+func (x *TrackPrepare) GetCountdown() float64 {
+	if x != nil {
+		return x.Countdown
+	}
+	return 0
+}
+
+func (x *TrackPrepare) GetFilename() string {
+	if x != nil {
+		return x.Filename
+	}
+	return ""
+}
+
 type Beat struct {
 	state         protoimpl.MessageState `protogen:"open.v1"`
 	Confidence    float64                `protobuf:"fixed64,1,opt,name=confidence,proto3" json:"confidence,omitempty"`
@@ -1060,7 +1359,7 @@ type Beat struct {
 
 func (x *Beat) Reset() {
 	*x = Beat{}
-	mi := &file_tracks_proto_msgTypes[5]
+	mi := &file_tracks_proto_msgTypes[9]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1072,7 +1371,7 @@ func (x *Beat) String() string {
 func (*Beat) ProtoMessage() {}
 
 func (x *Beat) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[5]
+	mi := &file_tracks_proto_msgTypes[9]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1085,7 +1384,7 @@ func (x *Beat) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Beat.ProtoReflect.Descriptor instead.
 func (*Beat) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{5}
+	return file_tracks_proto_rawDescGZIP(), []int{9}
 }
 
 func (x *Beat) GetConfidence() float64 {
@@ -1104,7 +1403,7 @@ type TempoChange struct {
 
 func (x *TempoChange) Reset() {
 	*x = TempoChange{}
-	mi := &file_tracks_proto_msgTypes[6]
+	mi := &file_tracks_proto_msgTypes[10]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1116,7 +1415,7 @@ func (x *TempoChange) String() string {
 func (*TempoChange) ProtoMessage() {}
 
 func (x *TempoChange) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[6]
+	mi := &file_tracks_proto_msgTypes[10]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1129,7 +1428,7 @@ func (x *TempoChange) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use TempoChange.ProtoReflect.Descriptor instead.
 func (*TempoChange) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{6}
+	return file_tracks_proto_rawDescGZIP(), []int{10}
 }
 
 func (x *TempoChange) GetBpm() float64 {
@@ -1148,7 +1447,7 @@ type Downbeat struct {
 
 func (x *Downbeat) Reset() {
 	*x = Downbeat{}
-	mi := &file_tracks_proto_msgTypes[7]
+	mi := &file_tracks_proto_msgTypes[11]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1160,7 +1459,7 @@ func (x *Downbeat) String() string {
 func (*Downbeat) ProtoMessage() {}
 
 func (x *Downbeat) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[7]
+	mi := &file_tracks_proto_msgTypes[11]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1173,7 +1472,7 @@ func (x *Downbeat) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Downbeat.ProtoReflect.Descriptor instead.
 func (*Downbeat) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{7}
+	return file_tracks_proto_rawDescGZIP(), []int{11}
 }
 
 func (x *Downbeat) GetConfidence() float64 {
@@ -1192,7 +1491,7 @@ type Onset struct {
 
 func (x *Onset) Reset() {
 	*x = Onset{}
-	mi := &file_tracks_proto_msgTypes[8]
+	mi := &file_tracks_proto_msgTypes[12]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1204,7 +1503,7 @@ func (x *Onset) String() string {
 func (*Onset) ProtoMessage() {}
 
 func (x *Onset) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[8]
+	mi := &file_tracks_proto_msgTypes[12]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1217,7 +1516,7 @@ func (x *Onset) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Onset.ProtoReflect.Descriptor instead.
 func (*Onset) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{8}
+	return file_tracks_proto_rawDescGZIP(), []int{12}
 }
 
 func (x *Onset) GetStrength() float64 {
@@ -1236,7 +1535,7 @@ type OnsetRate struct {
 
 func (x *OnsetRate) Reset() {
 	*x = OnsetRate{}
-	mi := &file_tracks_proto_msgTypes[9]
+	mi := &file_tracks_proto_msgTypes[13]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1248,7 +1547,7 @@ func (x *OnsetRate) String() string {
 func (*OnsetRate) ProtoMessage() {}
 
 func (x *OnsetRate) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[9]
+	mi := &file_tracks_proto_msgTypes[13]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1261,7 +1560,7 @@ func (x *OnsetRate) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use OnsetRate.ProtoReflect.Descriptor instead.
 func (*OnsetRate) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{9}
+	return file_tracks_proto_rawDescGZIP(), []int{13}
 }
 
 func (x *OnsetRate) GetRate() float64 {
@@ -1280,7 +1579,7 @@ type Novelty struct {
 
 func (x *Novelty) Reset() {
 	*x = Novelty{}
-	mi := &file_tracks_proto_msgTypes[10]
+	mi := &file_tracks_proto_msgTypes[14]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1292,7 +1591,7 @@ func (x *Novelty) String() string {
 func (*Novelty) ProtoMessage() {}
 
 func (x *Novelty) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[10]
+	mi := &file_tracks_proto_msgTypes[14]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1305,7 +1604,7 @@ func (x *Novelty) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Novelty.ProtoReflect.Descriptor instead.
 func (*Novelty) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{10}
+	return file_tracks_proto_rawDescGZIP(), []int{14}
 }
 
 func (x *Novelty) GetValue() float64 {
@@ -1326,7 +1625,7 @@ type KeyChange struct {
 
 func (x *KeyChange) Reset() {
 	*x = KeyChange{}
-	mi := &file_tracks_proto_msgTypes[11]
+	mi := &file_tracks_proto_msgTypes[15]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1338,7 +1637,7 @@ func (x *KeyChange) String() string {
 func (*KeyChange) ProtoMessage() {}
 
 func (x *KeyChange) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[11]
+	mi := &file_tracks_proto_msgTypes[15]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1351,7 +1650,7 @@ func (x *KeyChange) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use KeyChange.ProtoReflect.Descriptor instead.
 func (*KeyChange) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{11}
+	return file_tracks_proto_rawDescGZIP(), []int{15}
 }
 
 func (x *KeyChange) GetKey() string {
@@ -1385,7 +1684,7 @@ type ChordChange struct {
 
 func (x *ChordChange) Reset() {
 	*x = ChordChange{}
-	mi := &file_tracks_proto_msgTypes[12]
+	mi := &file_tracks_proto_msgTypes[16]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1397,7 +1696,7 @@ func (x *ChordChange) String() string {
 func (*ChordChange) ProtoMessage() {}
 
 func (x *ChordChange) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[12]
+	mi := &file_tracks_proto_msgTypes[16]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1410,7 +1709,7 @@ func (x *ChordChange) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use ChordChange.ProtoReflect.Descriptor instead.
 func (*ChordChange) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{12}
+	return file_tracks_proto_rawDescGZIP(), []int{16}
 }
 
 func (x *ChordChange) GetChord() string {
@@ -1430,13 +1729,14 @@ func (x *ChordChange) GetStrength() float64 {
 type Chroma struct {
 	state         protoimpl.MessageState `protogen:"open.v1"`
 	Values        []float32              `protobuf:"fixed32,1,rep,packed,name=values,proto3" json:"values,omitempty"` // 12-dim HPCP
+	Quantized     *QuantizedVector       `protobuf:"bytes,2,opt,name=quantized,proto3" json:"quantized,omitempty"`    // set instead of values when quantized
 	unknownFields protoimpl.UnknownFields
 	sizeCache     protoimpl.SizeCache
 }
 
 func (x *Chroma) Reset() {
 	*x = Chroma{}
-	mi := &file_tracks_proto_msgTypes[13]
+	mi := &file_tracks_proto_msgTypes[17]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1448,7 +1748,7 @@ func (x *Chroma) String() string {
 func (*Chroma) ProtoMessage() {}
 
 func (x *Chroma) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[13]
+	mi := &file_tracks_proto_msgTypes[17]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1461,7 +1761,7 @@ func (x *Chroma) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Chroma.ProtoReflect.Descriptor instead.
 func (*Chroma) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{13}
+	return file_tracks_proto_rawDescGZIP(), []int{17}
 }
 
 func (x *Chroma) GetValues() []float32 {
@@ -1471,6 +1771,13 @@ func (x *Chroma) GetValues() []float32 {
 	return nil
 }
 
+func (x *Chroma) GetQuantized() *QuantizedVector {
+	if x != nil {
+		return x.Quantized
+	}
+	return nil
+}
+
 type Tuning struct {
 	state         protoimpl.MessageState `protogen:"open.v1"`
 	Frequency     float64                `protobuf:"fixed64,1,opt,name=frequency,proto3" json:"frequency,omitempty"` // Hz, deviation from A440
@@ -1480,7 +1787,7 @@ type Tuning struct {
 
 func (x *Tuning) Reset() {
 	*x = Tuning{}
-	mi := &file_tracks_proto_msgTypes[14]
+	mi := &file_tracks_proto_msgTypes[18]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1492,7 +1799,7 @@ func (x *Tuning) String() string {
 func (*Tuning) ProtoMessage() {}
 
 func (x *Tuning) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[14]
+	mi := &file_tracks_proto_msgTypes[18]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1505,7 +1812,7 @@ func (x *Tuning) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Tuning.ProtoReflect.Descriptor instead.
 func (*Tuning) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{14}
+	return file_tracks_proto_rawDescGZIP(), []int{18}
 }
 
 func (x *Tuning) GetFrequency() float64 {
@@ -1524,7 +1831,7 @@ type Dissonance struct {
 
 func (x *Dissonance) Reset() {
 	*x = Dissonance{}
-	mi := &file_tracks_proto_msgTypes[15]
+	mi := &file_tracks_proto_msgTypes[19]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1536,7 +1843,7 @@ func (x *Dissonance) String() string {
 func (*Dissonance) ProtoMessage() {}
 
 func (x *Dissonance) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[15]
+	mi := &file_tracks_proto_msgTypes[19]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1549,7 +1856,7 @@ func (x *Dissonance) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Dissonance.ProtoReflect.Descriptor instead.
 func (*Dissonance) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{15}
+	return file_tracks_proto_rawDescGZIP(), []int{19}
 }
 
 func (x *Dissonance) GetValue() float64 {
@@ -1568,7 +1875,7 @@ type Inharmonicity struct {
 
 func (x *Inharmonicity) Reset() {
 	*x = Inharmonicity{}
-	mi := &file_tracks_proto_msgTypes[16]
+	mi := &file_tracks_proto_msgTypes[20]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1580,7 +1887,7 @@ func (x *Inharmonicity) String() string {
 func (*Inharmonicity) ProtoMessage() {}
 
 func (x *Inharmonicity) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[16]
+	mi := &file_tracks_proto_msgTypes[20]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1593,7 +1900,7 @@ func (x *Inharmonicity) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Inharmonicity.ProtoReflect.Descriptor instead.
 func (*Inharmonicity) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{16}
+	return file_tracks_proto_rawDescGZIP(), []int{20}
 }
 
 func (x *Inharmonicity) GetValue() float64 {
@@ -1613,7 +1920,7 @@ type Pitch struct {
 
 func (x *Pitch) Reset() {
 	*x = Pitch{}
-	mi := &file_tracks_proto_msgTypes[17]
+	mi := &file_tracks_proto_msgTypes[21]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1625,7 +1932,7 @@ func (x *Pitch) String() string {
 func (*Pitch) ProtoMessage() {}
 
 func (x *Pitch) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[17]
+	mi := &file_tracks_proto_msgTypes[21]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1638,7 +1945,7 @@ func (x *Pitch) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Pitch.ProtoReflect.Descriptor instead.
 func (*Pitch) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{17}
+	return file_tracks_proto_rawDescGZIP(), []int{21}
 }
 
 func (x *Pitch) GetFrequency() float64 {
@@ -1665,7 +1972,7 @@ type PitchChange struct {
 
 func (x *PitchChange) Reset() {
 	*x = PitchChange{}
-	mi := &file_tracks_proto_msgTypes[18]
+	mi := &file_tracks_proto_msgTypes[22]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1677,7 +1984,7 @@ func (x *PitchChange) String() string {
 func (*PitchChange) ProtoMessage() {}
 
 func (x *PitchChange) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[18]
+	mi := &file_tracks_proto_msgTypes[22]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1690,7 +1997,7 @@ func (x *PitchChange) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use PitchChange.ProtoReflect.Descriptor instead.
 func (*PitchChange) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{18}
+	return file_tracks_proto_rawDescGZIP(), []int{22}
 }
 
 func (x *PitchChange) GetFromHz() float64 {
@@ -1716,7 +2023,7 @@ type Melody struct {
 
 func (x *Melody) Reset() {
 	*x = Melody{}
-	mi := &file_tracks_proto_msgTypes[19]
+	mi := &file_tracks_proto_msgTypes[23]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1728,7 +2035,7 @@ func (x *Melody) String() string {
 func (*Melody) ProtoMessage() {}
 
 func (x *Melody) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[19]
+	mi := &file_tracks_proto_msgTypes[23]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1741,7 +2048,7 @@ func (x *Melody) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Melody.ProtoReflect.Descriptor instead.
 func (*Melody) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{19}
+	return file_tracks_proto_rawDescGZIP(), []int{23}
 }
 
 func (x *Melody) GetFrequency() float64 {
@@ -1760,7 +2067,7 @@ type Loudness struct {
 
 func (x *Loudness) Reset() {
 	*x = Loudness{}
-	mi := &file_tracks_proto_msgTypes[20]
+	mi := &file_tracks_proto_msgTypes[24]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1772,7 +2079,7 @@ func (x *Loudness) String() string {
 func (*Loudness) ProtoMessage() {}
 
 func (x *Loudness) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[20]
+	mi := &file_tracks_proto_msgTypes[24]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1785,7 +2092,7 @@ func (x *Loudness) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Loudness.ProtoReflect.Descriptor instead.
 func (*Loudness) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{20}
+	return file_tracks_proto_rawDescGZIP(), []int{24}
 }
 
 func (x *Loudness) GetValue() float64 {
@@ -1804,7 +2111,7 @@ type LoudnessPeak struct {
 
 func (x *LoudnessPeak) Reset() {
 	*x = LoudnessPeak{}
-	mi := &file_tracks_proto_msgTypes[21]
+	mi := &file_tracks_proto_msgTypes[25]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1816,7 +2123,7 @@ func (x *LoudnessPeak) String() string {
 func (*LoudnessPeak) ProtoMessage() {}
 
 func (x *LoudnessPeak) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[21]
+	mi := &file_tracks_proto_msgTypes[25]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1829,7 +2136,7 @@ func (x *LoudnessPeak) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use LoudnessPeak.ProtoReflect.Descriptor instead.
 func (*LoudnessPeak) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{21}
+	return file_tracks_proto_rawDescGZIP(), []int{25}
 }
 
 func (x *LoudnessPeak) GetValue() float64 {
@@ -1848,7 +2155,7 @@ type Energy struct {
 
 func (x *Energy) Reset() {
 	*x = Energy{}
-	mi := &file_tracks_proto_msgTypes[22]
+	mi := &file_tracks_proto_msgTypes[26]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1860,7 +2167,7 @@ func (x *Energy) String() string {
 func (*Energy) ProtoMessage() {}
 
 func (x *Energy) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[22]
+	mi := &file_tracks_proto_msgTypes[26]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1873,7 +2180,7 @@ func (x *Energy) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Energy.ProtoReflect.Descriptor instead.
 func (*Energy) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{22}
+	return file_tracks_proto_rawDescGZIP(), []int{26}
 }
 
 func (x *Energy) GetValue() float64 {
@@ -1892,7 +2199,7 @@ type DynamicChange struct {
 
 func (x *DynamicChange) Reset() {
 	*x = DynamicChange{}
-	mi := &file_tracks_proto_msgTypes[23]
+	mi := &file_tracks_proto_msgTypes[27]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1904,7 +2211,7 @@ func (x *DynamicChange) String() string {
 func (*DynamicChange) ProtoMessage() {}
 
 func (x *DynamicChange) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[23]
+	mi := &file_tracks_proto_msgTypes[27]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1917,7 +2224,7 @@ func (x *DynamicChange) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use DynamicChange.ProtoReflect.Descriptor instead.
 func (*DynamicChange) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{23}
+	return file_tracks_proto_rawDescGZIP(), []int{27}
 }
 
 func (x *DynamicChange) GetMagnitude() float64 {
@@ -1935,7 +2242,7 @@ type SilenceStart struct {
 
 func (x *SilenceStart) Reset() {
 	*x = SilenceStart{}
-	mi := &file_tracks_proto_msgTypes[24]
+	mi := &file_tracks_proto_msgTypes[28]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1947,7 +2254,7 @@ func (x *SilenceStart) String() string {
 func (*SilenceStart) ProtoMessage() {}
 
 func (x *SilenceStart) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[24]
+	mi := &file_tracks_proto_msgTypes[28]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1960,7 +2267,7 @@ func (x *SilenceStart) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use SilenceStart.ProtoReflect.Descriptor instead.
 func (*SilenceStart) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{24}
+	return file_tracks_proto_rawDescGZIP(), []int{28}
 }
 
 type SilenceEnd struct {
@@ -1971,7 +2278,7 @@ type SilenceEnd struct {
 
 func (x *SilenceEnd) Reset() {
 	*x = SilenceEnd{}
-	mi := &file_tracks_proto_msgTypes[25]
+	mi := &file_tracks_proto_msgTypes[29]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -1983,7 +2290,7 @@ func (x *SilenceEnd) String() string {
 func (*SilenceEnd) ProtoMessage() {}
 
 func (x *SilenceEnd) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[25]
+	mi := &file_tracks_proto_msgTypes[29]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -1996,7 +2303,7 @@ func (x *SilenceEnd) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use SilenceEnd.ProtoReflect.Descriptor instead.
 func (*SilenceEnd) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{25}
+	return file_tracks_proto_rawDescGZIP(), []int{29}
 }
 
 type Gap struct {
@@ -2008,7 +2315,7 @@ type Gap struct {
 
 func (x *Gap) Reset() {
 	*x = Gap{}
-	mi := &file_tracks_proto_msgTypes[26]
+	mi := &file_tracks_proto_msgTypes[30]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2020,7 +2327,7 @@ func (x *Gap) String() string {
 func (*Gap) ProtoMessage() {}
 
 func (x *Gap) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[26]
+	mi := &file_tracks_proto_msgTypes[30]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2033,7 +2340,7 @@ func (x *Gap) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Gap.ProtoReflect.Descriptor instead.
 func (*Gap) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{26}
+	return file_tracks_proto_rawDescGZIP(), []int{30}
 }
 
 func (x *Gap) GetDuration() float64 {
@@ -2052,7 +2359,7 @@ type SpectralCentroid struct {
 
 func (x *SpectralCentroid) Reset() {
 	*x = SpectralCentroid{}
-	mi := &file_tracks_proto_msgTypes[27]
+	mi := &file_tracks_proto_msgTypes[31]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2064,7 +2371,7 @@ func (x *SpectralCentroid) String() string {
 func (*SpectralCentroid) ProtoMessage() {}
 
 func (x *SpectralCentroid) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[27]
+	mi := &file_tracks_proto_msgTypes[31]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2077,7 +2384,7 @@ func (x *SpectralCentroid) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use SpectralCentroid.ProtoReflect.Descriptor instead.
 func (*SpectralCentroid) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{27}
+	return file_tracks_proto_rawDescGZIP(), []int{31}
 }
 
 func (x *SpectralCentroid) GetValue() float64 {
@@ -2096,7 +2403,7 @@ type SpectralFlux struct {
 
 func (x *SpectralFlux) Reset() {
 	*x = SpectralFlux{}
-	mi := &file_tracks_proto_msgTypes[28]
+	mi := &file_tracks_proto_msgTypes[32]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2108,7 +2415,7 @@ func (x *SpectralFlux) String() string {
 func (*SpectralFlux) ProtoMessage() {}
 
 func (x *SpectralFlux) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[28]
+	mi := &file_tracks_proto_msgTypes[32]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2121,7 +2428,7 @@ func (x *SpectralFlux) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use SpectralFlux.ProtoReflect.Descriptor instead.
 func (*SpectralFlux) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{28}
+	return file_tracks_proto_rawDescGZIP(), []int{32}
 }
 
 func (x *SpectralFlux) GetValue() float64 {
@@ -2140,7 +2447,7 @@ type SpectralComplexity struct {
 
 func (x *SpectralComplexity) Reset() {
 	*x = SpectralComplexity{}
-	mi := &file_tracks_proto_msgTypes[29]
+	mi := &file_tracks_proto_msgTypes[33]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2152,7 +2459,7 @@ func (x *SpectralComplexity) String() string {
 func (*SpectralComplexity) ProtoMessage() {}
 
 func (x *SpectralComplexity) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[29]
+	mi := &file_tracks_proto_msgTypes[33]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2165,7 +2472,7 @@ func (x *SpectralComplexity) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use SpectralComplexity.ProtoReflect.Descriptor instead.
 func (*SpectralComplexity) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{29}
+	return file_tracks_proto_rawDescGZIP(), []int{33}
 }
 
 func (x *SpectralComplexity) GetValue() float64 {
@@ -2178,13 +2485,14 @@ func (x *SpectralComplexity) GetValue() float64 {
 type SpectralContrast struct {
 	state         protoimpl.MessageState `protogen:"open.v1"`
 	Values        []float32              `protobuf:"fixed32,1,rep,packed,name=values,proto3" json:"values,omitempty"` // multi-band contrast
+	Quantized     *QuantizedVector       `protobuf:"bytes,2,opt,name=quantized,proto3" json:"quantized,omitempty"`    // set instead of values when quantized
 	unknownFields protoimpl.UnknownFields
 	sizeCache     protoimpl.SizeCache
 }
 
 func (x *SpectralContrast) Reset() {
 	*x = SpectralContrast{}
-	mi := &file_tracks_proto_msgTypes[30]
+	mi := &file_tracks_proto_msgTypes[34]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2196,7 +2504,7 @@ func (x *SpectralContrast) String() string {
 func (*SpectralContrast) ProtoMessage() {}
 
 func (x *SpectralContrast) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[30]
+	mi := &file_tracks_proto_msgTypes[34]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2209,7 +2517,7 @@ func (x *SpectralContrast) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use SpectralContrast.ProtoReflect.Descriptor instead.
 func (*SpectralContrast) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{30}
+	return file_tracks_proto_rawDescGZIP(), []int{34}
 }
 
 func (x *SpectralContrast) GetValues() []float32 {
@@ -2219,6 +2527,13 @@ func (x *SpectralContrast) GetValues() []float32 {
 	return nil
 }
 
+func (x *SpectralContrast) GetQuantized() *QuantizedVector {
+	if x != nil {
+		return x.Quantized
+	}
+	return nil
+}
+
 type SpectralRolloff struct {
 	state         protoimpl.MessageState `protogen:"open.v1"`
 	Value         float64                `protobuf:"fixed64,1,opt,name=value,proto3" json:"value,omitempty"` // Hz
@@ -2228,7 +2543,7 @@ type SpectralRolloff struct {
 
 func (x *SpectralRolloff) Reset() {
 	*x = SpectralRolloff{}
-	mi := &file_tracks_proto_msgTypes[31]
+	mi := &file_tracks_proto_msgTypes[35]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2240,7 +2555,7 @@ func (x *SpectralRolloff) String() string {
 func (*SpectralRolloff) ProtoMessage() {}
 
 func (x *SpectralRolloff) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[31]
+	mi := &file_tracks_proto_msgTypes[35]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2253,7 +2568,7 @@ func (x *SpectralRolloff) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use SpectralRolloff.ProtoReflect.Descriptor instead.
 func (*SpectralRolloff) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{31}
+	return file_tracks_proto_rawDescGZIP(), []int{35}
 }
 
 func (x *SpectralRolloff) GetValue() float64 {
@@ -2266,13 +2581,14 @@ func (x *SpectralRolloff) GetValue() float64 {
 type Mfcc struct {
 	state         protoimpl.MessageState `protogen:"open.v1"`
 	Values        []float32              `protobuf:"fixed32,1,rep,packed,name=values,proto3" json:"values,omitempty"` // 13-dim
+	Quantized     *QuantizedVector       `protobuf:"bytes,2,opt,name=quantized,proto3" json:"quantized,omitempty"`    // set instead of values when quantized
 	unknownFields protoimpl.UnknownFields
 	sizeCache     protoimpl.SizeCache
 }
 
 func (x *Mfcc) Reset() {
 	*x = Mfcc{}
-	mi := &file_tracks_proto_msgTypes[32]
+	mi := &file_tracks_proto_msgTypes[36]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2284,7 +2600,7 @@ func (x *Mfcc) String() string {
 func (*Mfcc) ProtoMessage() {}
 
 func (x *Mfcc) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[32]
+	mi := &file_tracks_proto_msgTypes[36]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2297,7 +2613,7 @@ func (x *Mfcc) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Mfcc.ProtoReflect.Descriptor instead.
 func (*Mfcc) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{32}
+	return file_tracks_proto_rawDescGZIP(), []int{36}
 }
 
 func (x *Mfcc) GetValues() []float32 {
@@ -2307,6 +2623,13 @@ func (x *Mfcc) GetValues() []float32 {
 	return nil
 }
 
+func (x *Mfcc) GetQuantized() *QuantizedVector {
+	if x != nil {
+		return x.Quantized
+	}
+	return nil
+}
+
 type TimbreChange struct {
 	state         protoimpl.MessageState `protogen:"open.v1"`
 	Distance      float64                `protobuf:"fixed64,1,opt,name=distance,proto3" json:"distance,omitempty"` // MFCC distance from previous frame
@@ -2316,7 +2639,7 @@ type TimbreChange struct {
 
 func (x *TimbreChange) Reset() {
 	*x = TimbreChange{}
-	mi := &file_tracks_proto_msgTypes[33]
+	mi := &file_tracks_proto_msgTypes[37]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2328,7 +2651,7 @@ func (x *TimbreChange) String() string {
 func (*TimbreChange) ProtoMessage() {}
 
 func (x *TimbreChange) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[33]
+	mi := &file_tracks_proto_msgTypes[37]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2341,7 +2664,7 @@ func (x *TimbreChange) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use TimbreChange.ProtoReflect.Descriptor instead.
 func (*TimbreChange) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{33}
+	return file_tracks_proto_rawDescGZIP(), []int{37}
 }
 
 func (x *TimbreChange) GetDistance() float64 {
@@ -2354,13 +2677,14 @@ func (x *TimbreChange) GetDistance() float64 {
 type BandsMel struct {
 	state         protoimpl.MessageState `protogen:"open.v1"`
 	Values        []float32              `protobuf:"fixed32,1,rep,packed,name=values,proto3" json:"values,omitempty"`
+	Quantized     *QuantizedVector       `protobuf:"bytes,2,opt,name=quantized,proto3" json:"quantized,omitempty"` // set instead of values when quantized
 	unknownFields protoimpl.UnknownFields
 	sizeCache     protoimpl.SizeCache
 }
 
 func (x *BandsMel) Reset() {
 	*x = BandsMel{}
-	mi := &file_tracks_proto_msgTypes[34]
+	mi := &file_tracks_proto_msgTypes[38]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2372,7 +2696,7 @@ func (x *BandsMel) String() string {
 func (*BandsMel) ProtoMessage() {}
 
 func (x *BandsMel) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[34]
+	mi := &file_tracks_proto_msgTypes[38]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2385,7 +2709,7 @@ func (x *BandsMel) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use BandsMel.ProtoReflect.Descriptor instead.
 func (*BandsMel) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{34}
+	return file_tracks_proto_rawDescGZIP(), []int{38}
 }
 
 func (x *BandsMel) GetValues() []float32 {
@@ -2395,16 +2719,24 @@ func (x *BandsMel) GetValues() []float32 {
 	return nil
 }
 
+func (x *BandsMel) GetQuantized() *QuantizedVector {
+	if x != nil {
+		return x.Quantized
+	}
+	return nil
+}
+
 type BandsBark struct {
 	state         protoimpl.MessageState `protogen:"open.v1"`
 	Values        []float32              `protobuf:"fixed32,1,rep,packed,name=values,proto3" json:"values,omitempty"`
+	Quantized     *QuantizedVector       `protobuf:"bytes,2,opt,name=quantized,proto3" json:"quantized,omitempty"` // set instead of values when quantized
 	unknownFields protoimpl.UnknownFields
 	sizeCache     protoimpl.SizeCache
 }
 
 func (x *BandsBark) Reset() {
 	*x = BandsBark{}
-	mi := &file_tracks_proto_msgTypes[35]
+	mi := &file_tracks_proto_msgTypes[39]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2416,7 +2748,7 @@ func (x *BandsBark) String() string {
 func (*BandsBark) ProtoMessage() {}
 
 func (x *BandsBark) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[35]
+	mi := &file_tracks_proto_msgTypes[39]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2429,7 +2761,7 @@ func (x *BandsBark) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use BandsBark.ProtoReflect.Descriptor instead.
 func (*BandsBark) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{35}
+	return file_tracks_proto_rawDescGZIP(), []int{39}
 }
 
 func (x *BandsBark) GetValues() []float32 {
@@ -2439,16 +2771,24 @@ func (x *BandsBark) GetValues() []float32 {
 	return nil
 }
 
+func (x *BandsBark) GetQuantized() *QuantizedVector {
+	if x != nil {
+		return x.Quantized
+	}
+	return nil
+}
+
 type BandsErb struct {
 	state         protoimpl.MessageState `protogen:"open.v1"`
 	Values        []float32              `protobuf:"fixed32,1,rep,packed,name=values,proto3" json:"values,omitempty"`
+	Quantized     *QuantizedVector       `protobuf:"bytes,2,opt,name=quantized,proto3" json:"quantized,omitempty"` // set instead of values when quantized
 	unknownFields protoimpl.UnknownFields
 	sizeCache     protoimpl.SizeCache
 }
 
 func (x *BandsErb) Reset() {
 	*x = BandsErb{}
-	mi := &file_tracks_proto_msgTypes[36]
+	mi := &file_tracks_proto_msgTypes[40]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2460,7 +2800,7 @@ func (x *BandsErb) String() string {
 func (*BandsErb) ProtoMessage() {}
 
 func (x *BandsErb) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[36]
+	mi := &file_tracks_proto_msgTypes[40]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2473,7 +2813,7 @@ func (x *BandsErb) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use BandsErb.ProtoReflect.Descriptor instead.
 func (*BandsErb) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{36}
+	return file_tracks_proto_rawDescGZIP(), []int{40}
 }
 
 func (x *BandsErb) GetValues() []float32 {
@@ -2483,6 +2823,13 @@ func (x *BandsErb) GetValues() []float32 {
 	return nil
 }
 
+func (x *BandsErb) GetQuantized() *QuantizedVector {
+	if x != nil {
+		return x.Quantized
+	}
+	return nil
+}
+
 type Hfc struct {
 	state         protoimpl.MessageState `protogen:"open.v1"`
 	Value         float64                `protobuf:"fixed64,1,opt,name=value,proto3" json:"value,omitempty"`
@@ -2492,7 +2839,7 @@ type Hfc struct {
 
 func (x *Hfc) Reset() {
 	*x = Hfc{}
-	mi := &file_tracks_proto_msgTypes[37]
+	mi := &file_tracks_proto_msgTypes[41]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2504,7 +2851,7 @@ func (x *Hfc) String() string {
 func (*Hfc) ProtoMessage() {}
 
 func (x *Hfc) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[37]
+	mi := &file_tracks_proto_msgTypes[41]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2517,7 +2864,7 @@ func (x *Hfc) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Hfc.ProtoReflect.Descriptor instead.
 func (*Hfc) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{37}
+	return file_tracks_proto_rawDescGZIP(), []int{41}
 }
 
 func (x *Hfc) GetValue() float64 {
@@ -2535,7 +2882,7 @@ type SegmentBoundary struct {
 
 func (x *SegmentBoundary) Reset() {
 	*x = SegmentBoundary{}
-	mi := &file_tracks_proto_msgTypes[38]
+	mi := &file_tracks_proto_msgTypes[42]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2547,7 +2894,7 @@ func (x *SegmentBoundary) String() string {
 func (*SegmentBoundary) ProtoMessage() {}
 
 func (x *SegmentBoundary) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[38]
+	mi := &file_tracks_proto_msgTypes[42]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2560,7 +2907,7 @@ func (x *SegmentBoundary) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use SegmentBoundary.ProtoReflect.Descriptor instead.
 func (*SegmentBoundary) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{38}
+	return file_tracks_proto_rawDescGZIP(), []int{42}
 }
 
 type FadeIn struct {
@@ -2572,7 +2919,7 @@ type FadeIn struct {
 
 func (x *FadeIn) Reset() {
 	*x = FadeIn{}
-	mi := &file_tracks_proto_msgTypes[39]
+	mi := &file_tracks_proto_msgTypes[43]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2584,7 +2931,7 @@ func (x *FadeIn) String() string {
 func (*FadeIn) ProtoMessage() {}
 
 func (x *FadeIn) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[39]
+	mi := &file_tracks_proto_msgTypes[43]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2597,7 +2944,7 @@ func (x *FadeIn) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use FadeIn.ProtoReflect.Descriptor instead.
 func (*FadeIn) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{39}
+	return file_tracks_proto_rawDescGZIP(), []int{43}
 }
 
 func (x *FadeIn) GetEndTime() float64 {
@@ -2616,7 +2963,7 @@ type FadeOut struct {
 
 func (x *FadeOut) Reset() {
 	*x = FadeOut{}
-	mi := &file_tracks_proto_msgTypes[40]
+	mi := &file_tracks_proto_msgTypes[44]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2628,7 +2975,7 @@ func (x *FadeOut) String() string {
 func (*FadeOut) ProtoMessage() {}
 
 func (x *FadeOut) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[40]
+	mi := &file_tracks_proto_msgTypes[44]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2641,7 +2988,7 @@ func (x *FadeOut) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use FadeOut.ProtoReflect.Descriptor instead.
 func (*FadeOut) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{40}
+	return file_tracks_proto_rawDescGZIP(), []int{44}
 }
 
 func (x *FadeOut) GetStartTime() float64 {
@@ -2659,7 +3006,7 @@ type Click struct {
 
 func (x *Click) Reset() {
 	*x = Click{}
-	mi := &file_tracks_proto_msgTypes[41]
+	mi := &file_tracks_proto_msgTypes[45]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2671,7 +3018,7 @@ func (x *Click) String() string {
 func (*Click) ProtoMessage() {}
 
 func (x *Click) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[41]
+	mi := &file_tracks_proto_msgTypes[45]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2684,7 +3031,7 @@ func (x *Click) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Click.ProtoReflect.Descriptor instead.
 func (*Click) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{41}
+	return file_tracks_proto_rawDescGZIP(), []int{45}
 }
 
 type Discontinuity struct {
@@ -2695,7 +3042,7 @@ type Discontinuity struct {
 
 func (x *Discontinuity) Reset() {
 	*x = Discontinuity{}
-	mi := &file_tracks_proto_msgTypes[42]
+	mi := &file_tracks_proto_msgTypes[46]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2707,7 +3054,7 @@ func (x *Discontinuity) String() string {
 func (*Discontinuity) ProtoMessage() {}
 
 func (x *Discontinuity) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[42]
+	mi := &file_tracks_proto_msgTypes[46]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2720,7 +3067,7 @@ func (x *Discontinuity) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Discontinuity.ProtoReflect.Descriptor instead.
 func (*Discontinuity) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{42}
+	return file_tracks_proto_rawDescGZIP(), []int{46}
 }
 
 type NoiseBurst struct {
@@ -2731,7 +3078,7 @@ type NoiseBurst struct {
 
 func (x *NoiseBurst) Reset() {
 	*x = NoiseBurst{}
-	mi := &file_tracks_proto_msgTypes[43]
+	mi := &file_tracks_proto_msgTypes[47]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2743,7 +3090,7 @@ func (x *NoiseBurst) String() string {
 func (*NoiseBurst) ProtoMessage() {}
 
 func (x *NoiseBurst) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[43]
+	mi := &file_tracks_proto_msgTypes[47]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2756,7 +3103,7 @@ func (x *NoiseBurst) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use NoiseBurst.ProtoReflect.Descriptor instead.
 func (*NoiseBurst) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{43}
+	return file_tracks_proto_rawDescGZIP(), []int{47}
 }
 
 type Saturation struct {
@@ -2768,7 +3115,7 @@ type Saturation struct {
 
 func (x *Saturation) Reset() {
 	*x = Saturation{}
-	mi := &file_tracks_proto_msgTypes[44]
+	mi := &file_tracks_proto_msgTypes[48]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2780,7 +3127,7 @@ func (x *Saturation) String() string {
 func (*Saturation) ProtoMessage() {}
 
 func (x *Saturation) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[44]
+	mi := &file_tracks_proto_msgTypes[48]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2793,7 +3140,7 @@ func (x *Saturation) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Saturation.ProtoReflect.Descriptor instead.
 func (*Saturation) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{44}
+	return file_tracks_proto_rawDescGZIP(), []int{48}
 }
 
 func (x *Saturation) GetDuration() float64 {
@@ -2812,7 +3159,7 @@ type Hum struct {
 
 func (x *Hum) Reset() {
 	*x = Hum{}
-	mi := &file_tracks_proto_msgTypes[45]
+	mi := &file_tracks_proto_msgTypes[49]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2824,7 +3171,7 @@ func (x *Hum) String() string {
 func (*Hum) ProtoMessage() {}
 
 func (x *Hum) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[45]
+	mi := &file_tracks_proto_msgTypes[49]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2837,7 +3184,7 @@ func (x *Hum) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Hum.ProtoReflect.Descriptor instead.
 func (*Hum) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{45}
+	return file_tracks_proto_rawDescGZIP(), []int{49}
 }
 
 func (x *Hum) GetFrequency() float64 {
@@ -2856,7 +3203,7 @@ type EnvelopeEvent struct {
 
 func (x *EnvelopeEvent) Reset() {
 	*x = EnvelopeEvent{}
-	mi := &file_tracks_proto_msgTypes[46]
+	mi := &file_tracks_proto_msgTypes[50]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2868,7 +3215,7 @@ func (x *EnvelopeEvent) String() string {
 func (*EnvelopeEvent) ProtoMessage() {}
 
 func (x *EnvelopeEvent) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[46]
+	mi := &file_tracks_proto_msgTypes[50]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2881,7 +3228,7 @@ func (x *EnvelopeEvent) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use EnvelopeEvent.ProtoReflect.Descriptor instead.
 func (*EnvelopeEvent) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{46}
+	return file_tracks_proto_rawDescGZIP(), []int{50}
 }
 
 func (x *EnvelopeEvent) GetValue() float64 {
@@ -2900,7 +3247,7 @@ type Attack struct {
 
 func (x *Attack) Reset() {
 	*x = Attack{}
-	mi := &file_tracks_proto_msgTypes[47]
+	mi := &file_tracks_proto_msgTypes[51]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2912,7 +3259,7 @@ func (x *Attack) String() string {
 func (*Attack) ProtoMessage() {}
 
 func (x *Attack) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[47]
+	mi := &file_tracks_proto_msgTypes[51]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2925,7 +3272,7 @@ func (x *Attack) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Attack.ProtoReflect.Descriptor instead.
 func (*Attack) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{47}
+	return file_tracks_proto_rawDescGZIP(), []int{51}
 }
 
 func (x *Attack) GetLogAttackTime() float64 {
@@ -2937,14 +3284,14 @@ func (x *Attack) GetLogAttackTime() float64 {
 
 type Decay struct {
 	state         protoimpl.MessageState `protogen:"open.v1"`
-	Value         float64                `protobuf:"fixed64,1,opt,name=value,proto3" json:"value,omitempty"`
+	Value         float64                `protobuf:"fixed64,1,opt,name=value,proto3" json:"value,omitempty"` // fall after the attack peak, dB per second
 	unknownFields protoimpl.UnknownFields
 	sizeCache     protoimpl.SizeCache
 }
 
 func (x *Decay) Reset() {
 	*x = Decay{}
-	mi := &file_tracks_proto_msgTypes[48]
+	mi := &file_tracks_proto_msgTypes[52]
 	ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 	ms.StoreMessageInfo(mi)
 }
@@ -2956,7 +3303,7 @@ func (x *Decay) String() string {
 func (*Decay) ProtoMessage() {}
 
 func (x *Decay) ProtoReflect() protoreflect.Message {
-	mi := &file_tracks_proto_msgTypes[48]
+	mi := &file_tracks_proto_msgTypes[52]
 	if x != nil {
 		ms := protoimpl.X.MessageStateOf(protoimpl.Pointer(x))
 		if ms.LoadMessageInfo() == nil {
@@ -2969,7 +3316,7 @@ func (x *Decay) ProtoReflect() protoreflect.Message {
 
 // Deprecated: Use Decay.ProtoReflect.Descriptor instead.
 func (*Decay) Descriptor() ([]byte, []int) {
-	return file_tracks_proto_rawDescGZIP(), []int{48}
+	return file_tracks_proto_rawDescGZIP(), []int{52}
 }
 
 func (x *Decay) GetValue() float64 {
@@ -2983,16 +3330,19 @@ var File_tracks_proto protoreflect.FileDescriptor
 
 const file_tracks_proto_rawDesc = "" +
 	"\n" +
-	"\ftracks.proto\x12\x06tracks\"\xf4\x13\n" +
+	"\ftracks.proto\x12\x06tracks\"\xbd\x15\n" +
 	"\bEnvelope\x12\x1c\n" +
-	"\ttimestamp\x18\x01 \x01(\x01R\ttimestamp\x125\n" +
+	"\ttimestamp\x18\x01 \x01(\x01R\ttimestamp\x12\x10\n" +
+	"\x03seq\x18\x02 \x01(\x04R\x03seq\x12\x17\n" +
+	"\asent_ns\x18\x03 \x01(\x06R\x06sentNs\x125\n" +
 	"\vtrack_start\x18\n" +
 	" \x01(\v2\x12.tracks.TrackStartH\x00R\n" +
 	"trackStart\x12/\n" +
 	"\ttrack_end\x18\v \x01(\v2\x10.tracks.TrackEndH\x00R\btrackEnd\x12>\n" +
 	"\x0etrack_position\x18\f \x01(\v2\x15.tracks.TrackPositionH\x00R\rtrackPosition\x125\n" +
 	"\vtrack_abort\x18\r \x01(\v2\x12.tracks.TrackAbortH\x00R\n" +
-	"trackAbort\x12\"\n" +
+	"trackAbort\x12;\n" +
+	"\rtrack_prepare\x18\x0e \x01(\v2\x14.tracks.TrackPrepareH\x00R\ftrackPrepare\x12\"\n" +
 	"\x04beat\x18\x14 \x01(\v2\f.tracks.BeatH\x00R\x04beat\x128\n" +
 	"\ftempo_change\x18\x15 \x01(\v2\x13.tracks.TempoChangeH\x00R\vtempoChange\x12.\n" +
 	"\bdownbeat\x18\x16 \x01(\v2\x10.tracks.DownbeatH\x00R\bdownbeat\x12%\n" +
@@ -3045,8 +3395,21 @@ const file_tracks_proto_rawDesc = "" +
 	"\x03hum\x18r \x01(\v2\v.tracks.HumH\x00R\x03hum\x12>\n" +
 	"\x0eenvelope_event\x18x \x01(\v2\x15.tracks.EnvelopeEventH\x00R\renvelopeEvent\x12(\n" +
 	"\x06attack\x18y \x01(\v2\x0e.tracks.AttackH\x00R\x06attack\x12%\n" +
-	"\x05decay\x18z \x01(\v2\r.tracks.DecayH\x00R\x05decayB\a\n" +
-	"\x05event\"\x81\x01\n" +
+	"\x05decay\x18z \x01(\v2\r.tracks.DecayH\x00R\x05decay\x12.\n" +
+	"\x05batch\x18\x82\x01 \x01(\v2\x15.tracks.EnvelopeBatchH\x00R\x05batch\x12/\n" +
+	"\bsnapshot\x18\x83\x01 \x01(\v2\x10.tracks.SnapshotH\x00R\bsnapshotB\a\n" +
+	"\x05event\"\x99\x01\n" +
+	"\x0fQuantizedVector\x12\x12\n" +
+	"\x04bits\x18\x01 \x01(\rR\x04bits\x12\x14\n" +
+	"\x05scale\x18\x02 \x01(\x02R\x05scale\x12\x16\n" +
+	"\x06offset\x18\x03 \x01(\x02R\x06offset\x12\x12\n" +
+	"\x04data\x18\x04 \x01(\fR\x04data\x12\x14\n" +
+	"\x05index\x18\x05 \x01(\rR\x05index\x12\x1a\n" +
+	"\bkeyframe\x18\x06 \x01(\bR\bkeyframe\"9\n" +
+	"\rEnvelopeBatch\x12(\n" +
+	"\x06events\x18\x01 \x03(\v2\x10.tracks.EnvelopeR\x06events\"4\n" +
+	"\bSnapshot\x12(\n" +
+	"\x06events\x18\x01 \x03(\v2\x10.tracks.EnvelopeR\x06events\"\x81\x01\n" +
 	"\n" +
 	"TrackStart\x12\x1a\n" +
 	"\bfilename\x18\x01 \x01(\tR\bfilename\x12\x1a\n" +
@@ -3060,7 +3423,10 @@ const file_tracks_proto_rawDesc = "" +
 	"\bposition\x18\x01 \x01(\x01R\bposition\"$\n" +
 	"\n" +
 	"TrackAbort\x12\x16\n" +
-	"\x06reason\x18\x01 \x01(\tR\x06reason\"&\n" +
+	"\x06reason\x18\x01 \x01(\tR\x06reason\"H\n" +
+	"\fTrackPrepare\x12\x1c\n" +
+	"\tcountdown\x18\x01 \x01(\x01R\tcountdown\x12\x1a\n" +
+	"\bfilename\x18\x02 \x01(\tR\bfilename\"&\n" +
 	"\x04Beat\x12\x1e\n" +
 	"\n" +
 	"confidence\x18\x01 \x01(\x01R\n" +
@@ -3083,9 +3449,10 @@ const file_tracks_proto_rawDesc = "" +
 	"\bstrength\x18\x03 \x01(\x01R\bstrength\"?\n" +
 	"\vChordChange\x12\x14\n" +
 	"\x05chord\x18\x01 \x01(\tR\x05chord\x12\x1a\n" +
-	"\bstrength\x18\x02 \x01(\x01R\bstrength\" \n" +
+	"\bstrength\x18\x02 \x01(\x01R\bstrength\"W\n" +
 	"\x06Chroma\x12\x16\n" +
-	"\x06values\x18\x01 \x03(\x02R\x06values\"&\n" +
+	"\x06values\x18\x01 \x03(\x02R\x06values\x125\n" +
+	"\tquantized\x18\x02 \x01(\v2\x17.tracks.QuantizedVectorR\tquantized\"&\n" +
 	"\x06Tuning\x12\x1c\n" +
 	"\tfrequency\x18\x01 \x01(\x01R\tfrequency\"\"\n" +
 	"\n" +
@@ -3121,21 +3488,26 @@ const file_tracks_proto_rawDesc = "" +
 	"\fSpectralFlux\x12\x14\n" +
 	"\x05value\x18\x01 \x01(\x01R\x05value\"*\n" +
 	"\x12SpectralComplexity\x12\x14\n" +
-	"\x05value\x18\x01 \x01(\x01R\x05value\"*\n" +
+	"\x05value\x18\x01 \x01(\x01R\x05value\"a\n" +
 	"\x10SpectralContrast\x12\x16\n" +
-	"\x06values\x18\x01 \x03(\x02R\x06values\"'\n" +
+	"\x06values\x18\x01 \x03(\x02R\x06values\x125\n" +
+	"\tquantized\x18\x02 \x01(\v2\x17.tracks.QuantizedVectorR\tquantized\"'\n" +
 	"\x0fSpectralRolloff\x12\x14\n" +
-	"\x05value\x18\x01 \x01(\x01R\x05value\"\x1e\n" +
+	"\x05value\x18\x01 \x01(\x01R\x05value\"U\n" +
 	"\x04Mfcc\x12\x16\n" +
-	"\x06values\x18\x01 \x03(\x02R\x06values\"*\n" +
+	"\x06values\x18\x01 \x03(\x02R\x06values\x125\n" +
+	"\tquantized\x18\x02 \x01(\v2\x17.tracks.QuantizedVectorR\tquantized\"*\n" +
 	"\fTimbreChange\x12\x1a\n" +
-	"\bdistance\x18\x01 \x01(\x01R\bdistance\"\"\n" +
+	"\bdistance\x18\x01 \x01(\x01R\bdistance\"Y\n" +
 	"\bBandsMel\x12\x16\n" +
-	"\x06values\x18\x01 \x03(\x02R\x06values\"#\n" +
+	"\x06values\x18\x01 \x03(\x02R\x06values\x125\n" +
+	"\tquantized\x18\x02 \x01(\v2\x17.tracks.QuantizedVectorR\tquantized\"Z\n" +
 	"\tBandsBark\x12\x16\n" +
-	"\x06values\x18\x01 \x03(\x02R\x06values\"\"\n" +
+	"\x06values\x18\x01 \x03(\x02R\x06values\x125\n" +
+	"\tquantized\x18\x02 \x01(\v2\x17.tracks.QuantizedVectorR\tquantized\"Y\n" +
 	"\bBandsErb\x12\x16\n" +
-	"\x06values\x18\x01 \x03(\x02R\x06values\"\x1b\n" +
+	"\x06values\x18\x01 \x03(\x02R\x06values\x125\n" +
+	"\tquantized\x18\x02 \x01(\v2\x17.tracks.QuantizedVectorR\tquantized\"\x1b\n" +
 	"\x03Hfc\x12\x14\n" +
 	"\x05value\x18\x01 \x01(\x01R\x05value\"\x11\n" +
 	"\x0fSegmentBoundary\"#\n" +
@@ -3172,112 +3544,127 @@ func file_tracks_proto_rawDescGZIP() []byte {
 	return file_tracks_proto_rawDescData
 }
 
-var file_tracks_proto_msgTypes = make([]protoimpl.MessageInfo, 49)
+var file_tracks_proto_msgTypes = make([]protoimpl.MessageInfo, 53)
 var file_tracks_proto_goTypes = []any{
 	(*Envelope)(nil),           // 0: tracks.Envelope
-	(*TrackStart)(nil),         // 1: tracks.TrackStart
-	(*TrackEnd)(nil),           // 2: tracks.TrackEnd
-	(*TrackPosition)(nil),      // 3: tracks.TrackPosition
-	(*TrackAbort)(nil),         // 4: tracks.TrackAbort
-	(*Beat)(nil),               // 5: tracks.Beat
-	(*TempoChange)(nil),        // 6: tracks.TempoChange
-	(*Downbeat)(nil),           // 7: tracks.Downbeat
-	(*Onset)(nil),              // 8: tracks.Onset
-	(*OnsetRate)(nil),          // 9: tracks.OnsetRate
-	(*Novelty)(nil),            // 10: tracks.Novelty
-	(*KeyChange)(nil),          // 11: tracks.KeyChange
-	(*ChordChange)(nil),        // 12: tracks.ChordChange
-	(*Chroma)(nil),             // 13: tracks.Chroma
-	(*Tuning)(nil),             // 14: tracks.Tuning
-	(*Dissonance)(nil),         // 15: tracks.Dissonance
-	(*Inharmonicity)(nil),      // 16: tracks.Inharmonicity
-	(*Pitch)(nil),              // 17: tracks.Pitch
-	(*PitchChange)(nil),        // 18: tracks.PitchChange
-	(*Melody)(nil),             // 19: tracks.Melody
-	(*Loudness)(nil),           // 20: tracks.Loudness
-	(*LoudnessPeak)(nil),       // 21: tracks.LoudnessPeak
-	(*Energy)(nil),             // 22: tracks.Energy
-	(*DynamicChange)(nil),      // 23: tracks.DynamicChange
-	(*SilenceStart)(nil),       // 24: tracks.SilenceStart
-	(*SilenceEnd)(nil),         // 25: tracks.SilenceEnd
-	(*Gap)(nil),                // 26: tracks.Gap
-	(*SpectralCentroid)(nil),   // 27: tracks.SpectralCentroid
-	(*SpectralFlux)(nil),       // 28: tracks.SpectralFlux
-	(*SpectralComplexity)(nil), // 29: tracks.SpectralComplexity
-	(*SpectralContrast)(nil),   // 30: tracks.SpectralContrast
-	(*SpectralRolloff)(nil),    // 31: tracks.SpectralRolloff
-	(*Mfcc)(nil),               // 32: tracks.Mfcc
-	(*TimbreChange)(nil),       // 33: tracks.TimbreChange
-	(*BandsMel)(nil),           // 34: tracks.BandsMel
-	(*BandsBark)(nil),          // 35: tracks.BandsBark
-	(*BandsErb)(nil),           // 36: tracks.BandsErb
-	(*Hfc)(nil),                // 37: tracks.Hfc
-	(*SegmentBoundary)(nil),    // 38: tracks.SegmentBoundary
-	(*FadeIn)(nil),             // 39: tracks.FadeIn
-	(*FadeOut)(nil),            // 40: tracks.FadeOut
-	(*Click)(nil),              // 41: tracks.Click
-	(*Discontinuity)(nil),      // 42: tracks.Discontinuity
-	(*NoiseBurst)(nil),         // 43: tracks.NoiseBurst
-	(*Saturation)(nil),         // 44: tracks.Saturation
-	(*Hum)(nil),                // 45: tracks.Hum
-	(*EnvelopeEvent)(nil),      // 46: tracks.EnvelopeEvent
-	(*Attack)(nil),             // 47: tracks.Attack
-	(*Decay)(nil),              // 48: tracks.Decay
+	(*QuantizedVector)(nil),    // 1: tracks.QuantizedVector
+	(*EnvelopeBatch)(nil),      // 2: tracks.EnvelopeBatch
+	(*Snapshot)(nil),           // 3: tracks.Snapshot
+	(*TrackStart)(nil),         // 4: tracks.TrackStart
+	(*TrackEnd)(nil),           // 5: tracks.TrackEnd
+	(*TrackPosition)(nil),      // 6: tracks.TrackPosition
+	(*TrackAbort)(nil),         // 7: tracks.TrackAbort
+	(*TrackPrepare)(nil),       // 8: tracks.TrackPrepare
+	(*Beat)(nil),               // 9: tracks.Beat
+	(*TempoChange)(nil),        // 10: tracks.TempoChange
+	(*Downbeat)(nil),           // 11: tracks.Downbeat
+	(*Onset)(nil),              // 12: tracks.Onset
+	(*OnsetRate)(nil),          // 13: tracks.OnsetRate
+	(*Novelty)(nil),            // 14: tracks.Novelty
+	(*KeyChange)(nil),          // 15: tracks.KeyChange
+	(*ChordChange)(nil),        // 16: tracks.ChordChange
+	(*Chroma)(nil),             // 17: tracks.Chroma
+	(*Tuning)(nil),             // 18: tracks.Tuning
+	(*Dissonance)(nil),         // 19: tracks.Dissonance
+	(*Inharmonicity)(nil),      // 20: tracks.Inharmonicity
+	(*Pitch)(nil),              // 21: tracks.Pitch
+	(*PitchChange)(nil),        // 22: tracks.PitchChange
+	(*Melody)(nil),             // 23: tracks.Melody
+	(*Loudness)(nil),           // 24: tracks.Loudness
+	(*LoudnessPeak)(nil),       // 25: tracks.LoudnessPeak
+	(*Energy)(nil),             // 26: tracks.Energy
+	(*DynamicChange)(nil),      // 27: tracks.DynamicChange
+	(*SilenceStart)(nil),       // 28: tracks.SilenceStart
+	(*SilenceEnd)(nil),         // 29: tracks.SilenceEnd
+	(*Gap)(nil),                // 30: tracks.Gap
+	(*SpectralCentroid)(nil),   // 31: tracks.SpectralCentroid
+	(*SpectralFlux)(nil),       // 32: tracks.SpectralFlux
+	(*SpectralComplexity)(nil), // 33: tracks.SpectralComplexity
+	(*SpectralContrast)(nil),   // 34: tracks.SpectralContrast
+	(*SpectralRolloff)(nil),    // 35: tracks.SpectralRolloff
+	(*Mfcc)(nil),               // 36: tracks.Mfcc
+	(*TimbreChange)(nil),       // 37: tracks.TimbreChange
+	(*BandsMel)(nil),           // 38: tracks.BandsMel
+	(*BandsBark)(nil),          // 39: tracks.BandsBark
+	(*BandsErb)(nil),           // 40: tracks.BandsErb
+	(*Hfc)(nil),                // 41: tracks.Hfc
+	(*SegmentBoundary)(nil),    // 42: tracks.SegmentBoundary
+	(*FadeIn)(nil),             // 43: tracks.FadeIn
+	(*FadeOut)(nil),            // 44: tracks.FadeOut
+	(*Click)(nil),              // 45: tracks.Click
+	(*Discontinuity)(nil),      // 46: tracks.Discontinuity
+	(*NoiseBurst)(nil),         // 47: tracks.NoiseBurst
+	(*Saturation)(nil),         // 48: tracks.Saturation
+	(*Hum)(nil),                // 49: tracks.Hum
+	(*EnvelopeEvent)(nil),      // 50: tracks.EnvelopeEvent
+	(*Attack)(nil),             // 51: tracks.Attack
+	(*Decay)(nil),              // 52: tracks.Decay
 }
 var file_tracks_proto_depIdxs = []int32{
-	1,  // 0: tracks.Envelope.track_start:type_name -> tracks.TrackStart
-	2,  // 1: tracks.Envelope.track_end:type_name -> tracks.TrackEnd
-	3,  // 2: tracks.Envelope.track_position:type_name -> tracks.TrackPosition
-	4,  // 3: tracks.Envelope.track_abort:type_name -> tracks.TrackAbort
-	5,  // 4: tracks.Envelope.beat:type_name -> tracks.Beat
-	6,  // 5: tracks.Envelope.tempo_change:type_name -> tracks.TempoChange
-	7,  // 6: tracks.Envelope.downbeat:type_name -> tracks.Downbeat
-	8,  // 7: tracks.Envelope.onset:type_name -> tracks.Onset
-	9,  // 8: tracks.Envelope.onset_rate:type_name -> tracks.OnsetRate
-	10, // 9: tracks.Envelope.novelty:type_name -> tracks.Novelty
-	11, // 10: tracks.Envelope.key_change:type_name -> tracks.KeyChange
-	12, // 11: tracks.Envelope.chord_change:type_name -> tracks.ChordChange
-	13, // 12: tracks.Envelope.chroma:type_name -> tracks.Chroma
-	14, // 13: tracks.Envelope.tuning:type_name -> tracks.Tuning
-	15, // 14: tracks.Envelope.dissonance:type_name -> tracks.Dissonance
-	16, // 15: tracks.Envelope.inharmonicity:type_name -> tracks.Inharmonicity
-	17, // 16: tracks.Envelope.pitch:type_name -> tracks.Pitch
-	18, // 17: tracks.Envelope.pitch_change:type_name -> tracks.PitchChange
-	19, // 18: tracks.Envelope.melody:type_name -> tracks.Melody
-	20, // 19: tracks.Envelope.loudness:type_name -> tracks.Loudness
-	21, // 20: tracks.Envelope.loudness_peak:type_name -> tracks.LoudnessPeak
-	22, // 21: tracks.Envelope.energy:type_name -> tracks.Energy
-	23, // 22: tracks.Envelope.dynamic_change:type_name -> tracks.DynamicChange
-	24, // 23: tracks.Envelope.silence_start:type_name -> tracks.SilenceStart
-	25, // 24: tracks.Envelope.silence_end:type_name -> tracks.SilenceEnd
-	26, // 25: tracks.Envelope.gap:type_name -> tracks.Gap
-	27, // 26: tracks.Envelope.spectral_centroid:type_name -> tracks.SpectralCentroid
-	28, // 27: tracks.Envelope.spectral_flux:type_name -> tracks.SpectralFlux
-	29, // 28: tracks.Envelope.spectral_complexity:type_name -> tracks.SpectralComplexity
-	30, // 29: tracks.Envelope.spectral_contrast:type_name -> tracks.SpectralContrast
-	31, // 30: tracks.Envelope.spectral_rolloff:type_name -> tracks.SpectralRolloff
-	32, // 31: tracks.Envelope.mfcc:type_name -> tracks.Mfcc
-	33, // 32: tracks.Envelope.timbre_change:type_name -> tracks.TimbreChange
-	34, // 33: tracks.Envelope.bands_mel:type_name -> tracks.BandsMel
-	35, // 34: tracks.Envelope.bands_bark:type_name -> tracks.BandsBark
-	36, // 35: tracks.Envelope.bands_erb:type_name -> tracks.BandsErb
-	37, // 36: tracks.Envelope.hfc:type_name -> tracks.Hfc
-	38, // 37: tracks.Envelope.segment_boundary:type_name -> tracks.SegmentBoundary
-	39, // 38: tracks.Envelope.fade_in:type_name -> tracks.FadeIn
-	40, // 39: tracks.Envelope.fade_out:type_name -> tracks.FadeOut
-	41, // 40: tracks.Envelope.click:type_name -> tracks.Click
-	42, // 41: tracks.Envelope.discontinuity:type_name -> tracks.Discontinuity
-	43, // 42: tracks.Envelope.noise_burst:type_name -> tracks.NoiseBurst
-	44, // 43: tracks.Envelope.saturation:type_name -> tracks.Saturation
-	45, // 44: tracks.Envelope.hum:type_name -> tracks.Hum
-	46, // 45: tracks.Envelope.envelope_event:type_name -> tracks.EnvelopeEvent
-	47, // 46: tracks.Envelope.attack:type_name -> tracks.Attack
-	48, // 47: tracks.Envelope.decay:type_name -> tracks.Decay
-	48, // [48:48] is the sub-list for method output_type
-	48, // [48:48] is the sub-list for method input_type
-	48, // [48:48] is the sub-list for extension type_name
-	48, // [48:48] is the sub-list for extension extendee
-	0,  // [0:48] is the sub-list for field type_name
+	4,  // 0: tracks.Envelope.track_start:type_name -> tracks.TrackStart
+	5,  // 1: tracks.Envelope.track_end:type_name -> tracks.TrackEnd
+	6,  // 2: tracks.Envelope.track_position:type_name -> tracks.TrackPosition
+	7,  // 3: tracks.Envelope.track_abort:type_name -> tracks.TrackAbort
+	8,  // 4: tracks.Envelope.track_prepare:type_name -> tracks.TrackPrepare
+	9,  // 5: tracks.Envelope.beat:type_name -> tracks.Beat
+	10, // 6: tracks.Envelope.tempo_change:type_name -> tracks.TempoChange
+	11, // 7: tracks.Envelope.downbeat:type_name -> tracks.Downbeat
+	12, // 8: tracks.Envelope.onset:type_name -> tracks.Onset
+	13, // 9: tracks.Envelope.onset_rate:type_name -> tracks.OnsetRate
+	14, // 10: tracks.Envelope.novelty:type_name -> tracks.Novelty
+	15, // 11: tracks.Envelope.key_change:type_name -> tracks.KeyChange
+	16, // 12: tracks.Envelope.chord_change:type_name -> tracks.ChordChange
+	17, // 13: tracks.Envelope.chroma:type_name -> tracks.Chroma
+	18, // 14: tracks.Envelope.tuning:type_name -> tracks.Tuning
+	19, // 15: tracks.Envelope.dissonance:type_name -> tracks.Dissonance
+	20, // 16: tracks.Envelope.inharmonicity:type_name -> tracks.Inharmonicity
+	21, // 17: tracks.Envelope.pitch:type_name -> tracks.Pitch
+	22, // 18: tracks.Envelope.pitch_change:type_name -> tracks.PitchChange
+	23, // 19: tracks.Envelope.melody:type_name -> tracks.Melody
+	24, // 20: tracks.Envelope.loudness:type_name -> tracks.Loudness
+	25, // 21: tracks.Envelope.loudness_peak:type_name -> tracks.LoudnessPeak
+	26, // 22: tracks.Envelope.energy:type_name -> tracks.Energy
+	27, // 23: tracks.Envelope.dynamic_change:type_name -> tracks.DynamicChange
+	28, // 24: tracks.Envelope.silence_start:type_name -> tracks.SilenceStart
+	29, // 25: tracks.Envelope.silence_end:type_name -> tracks.SilenceEnd
+	30, // 26: tracks.Envelope.gap:type_name -> tracks.Gap
+	31, // 27: tracks.Envelope.spectral_centroid:type_name -> tracks.SpectralCentroid
+	32, // 28: tracks.Envelope.spectral_flux:type_name -> tracks.SpectralFlux
+	33, // 29: tracks.Envelope.spectral_complexity:type_name -> tracks.SpectralComplexity
+	34, // 30: tracks.Envelope.spectral_contrast:type_name -> tracks.SpectralContrast
+	35, // 31: tracks.Envelope.spectral_rolloff:type_name -> tracks.SpectralRolloff
+	36, // 32: tracks.Envelope.mfcc:type_name -> tracks.Mfcc
+	37, // 33: tracks.Envelope.timbre_change:type_name -> tracks.TimbreChange
+	38, // 34: tracks.Envelope.bands_mel:type_name -> tracks.BandsMel
+	39, // 35: tracks.Envelope.bands_bark:type_name -> tracks.BandsBark
+	40, // 36: tracks.Envelope.bands_erb:type_name -> tracks.BandsErb
+	41, // 37: tracks.Envelope.hfc:type_name -> tracks.Hfc
+	42, // 38: tracks.Envelope.segment_boundary:type_name -> tracks.SegmentBoundary
+	43, // 39: tracks.Envelope.fade_in:type_name -> tracks.FadeIn
+	44, // 40: tracks.Envelope.fade_out:type_name -> tracks.FadeOut
+	45, // 41: tracks.Envelope.click:type_name -> tracks.Click
+	46, // 42: tracks.Envelope.discontinuity:type_name -> tracks.Discontinuity
+	47, // 43: tracks.Envelope.noise_burst:type_name -> tracks.NoiseBurst
+	48, // 44: tracks.Envelope.saturation:type_name -> tracks.Saturation
+	49, // 45: tracks.Envelope.hum:type_name -> tracks.Hum
+	50, // 46: tracks.Envelope.envelope_event:type_name -> tracks.EnvelopeEvent
+	51, // 47: tracks.Envelope.attack:type_name -> tracks.Attack
+	52, // 48: tracks.Envelope.decay:type_name -> tracks.Decay
+	2,  // 49: tracks.Envelope.batch:type_name -> tracks.EnvelopeBatch
+	3,  // 50: tracks.Envelope.snapshot:type_name -> tracks.Snapshot
+	0,  // 51: tracks.EnvelopeBatch.events:type_name -> tracks.Envelope
+	0,  // 52: tracks.Snapshot.events:type_name -> tracks.Envelope
+	1,  // 53: tracks.Chroma.quantized:type_name -> tracks.QuantizedVector
+	1,  // 54: tracks.SpectralContrast.quantized:type_name -> tracks.QuantizedVector
+	1,  // 55: tracks.Mfcc.quantized:type_name -> tracks.QuantizedVector
+	1,  // 56: tracks.BandsMel.quantized:type_name -> tracks.QuantizedVector
+	1,  // 57: tracks.BandsBark.quantized:type_name -> tracks.QuantizedVector
+	1,  // 58: tracks.BandsErb.quantized:type_name -> tracks.QuantizedVector
+	59, // [59:59] is the sub-list for method output_type
+	59, // [59:59] is the sub-list for method input_type
+	59, // [59:59] is the sub-list for extension type_name
+	59, // [59:59] is the sub-list for extension extendee
+	0,  // [0:59] is the sub-list for field type_name
 }
 
 func init() { file_tracks_proto_init() }
@@ -3290,6 +3677,7 @@ func file_tracks_proto_init() {
 		(*Envelope_TrackEnd)(nil),
 		(*Envelope_TrackPosition)(nil),
 		(*Envelope_TrackAbort)(nil),
+		(*Envelope_TrackPrepare)(nil),
 		(*Envelope_Beat)(nil),
 		(*Envelope_TempoChange)(nil),
 		(*Envelope_Downbeat)(nil),
@@ -3334,6 +3722,8 @@ func file_tracks_proto_init() {
 		(*Envelope_EnvelopeEvent)(nil),
 		(*Envelope_Attack)(nil),
 		(*Envelope_Decay)(nil),
+		(*Envelope_Batch)(nil),
+		(*Envelope_Snapshot)(nil),
 	}
 	type x struct{}
 	out := protoimpl.TypeBuilder{
@@ -3341,7 +3731,7 @@ func file_tracks_proto_init() {
 			GoPackagePath: reflect.TypeOf(x{}).PkgPath(),
 			RawDescriptor: unsafe.Slice(unsafe.StringData(file_tracks_proto_rawDesc), len(file_tracks_proto_rawDesc)),
 			NumEnums:      0,
-			NumMessages:   49,
+			NumMessages:   53,
 			NumExtensions: 0,
 			NumServices:   0,
 		},
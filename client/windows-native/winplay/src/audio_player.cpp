@@ -1,6 +1,15 @@
 #define MINIAUDIO_IMPLEMENTATION
 #include "audio_player.h"
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
+#include <cstring>
+
+static constexpr double    kPrebufferSeconds = 0.25;  // decoded before prepare() returns
+static constexpr double    kRingSeconds      = 2.0;   // decoded ahead at most
+static constexpr ma_uint32 kChunkFrames      = 4096;  // decoder thread read size
+static constexpr double    kTolerance        = 0.002; // sync error left alone
+static constexpr double    kJumpSeconds      = 0.1;   // larger errors are corrected at once
 
 AudioPlayer::AudioPlayer() = default;
 
@@ -8,30 +17,182 @@ AudioPlayer::~AudioPlayer() {
     stop();
 }
 
+int64_t AudioPlayer::now_ns() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count();
+}
+
+void AudioPlayer::publish_anchor(uint64_t frame, int64_t heard_ns) {
+    uint32_t v = anchor_version_.load(std::memory_order_relaxed);
+    anchor_version_.store(v + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    anchor_frame_.store(frame, std::memory_order_relaxed);
+    anchor_ns_.store(heard_ns, std::memory_order_relaxed);
+    anchor_version_.store(v + 2, std::memory_order_release);
+}
+
+void AudioPlayer::read_anchor(uint64_t& frame, int64_t& heard_ns) const {
+    for (;;) {
+        uint32_t v = anchor_version_.load(std::memory_order_acquire);
+        if (v & 1) continue;
+        frame    = anchor_frame_.load(std::memory_order_relaxed);
+        heard_ns = anchor_ns_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (anchor_version_.load(std::memory_order_relaxed) == v) return;
+    }
+}
+
 void AudioPlayer::data_callback(ma_device* device, void* output,
                                  const void* /*input*/, ma_uint32 frame_count) {
     auto* player = static_cast<AudioPlayer*>(device->pUserData);
-    if (player->finished_.load(std::memory_order_relaxed)) {
-        // Fill silence once finished
-        ma_uint32 bytes = frame_count * ma_get_bytes_per_frame(
-            device->playback.format, device->playback.channels);
-        memset(output, 0, bytes);
+    player->render(static_cast<float*>(output), frame_count);
+}
+
+void AudioPlayer::render(float* out, ma_uint32 frame_count) {
+    const ma_uint32 ch = channels_;
+    ma_uint32 done = 0;
+
+    auto silence = [&](ma_uint32 n) {
+        memset(out + done * ch, 0, static_cast<size_t>(n) * ch * sizeof(float));
+        done += n;
+    };
+    auto frames_to_ns = [&](uint64_t n) {
+        return static_cast<int64_t>(n * 1000000000ull / sample_rate_);
+    };
+
+    // A steady-state callback runs once a period is free, never early, so
+    // the earliest-running one of the last second fixes the device clock;
+    // refreshing it every second follows drift against steady_clock
+    int64_t base = now_ns() - frames_to_ns(device_frames_);
+    if (device_frames_ == 0 || base < base_ns_) base_ns_ = base;
+    window_min_ns_ = window_frames_ == 0 ? base : std::min(window_min_ns_, base);
+    window_frames_ += frame_count;
+    if (window_frames_ >= sample_rate_) {
+        base_ns_ = window_min_ns_;
+        window_frames_ = 0;
+    }
+    const int64_t heard_ns = base_ns_ + frames_to_ns(device_frames_) + latency_ns_;  // out[0] at the speaker
+    device_frames_ += frame_count;
+
+    if (finished_.load(std::memory_order_relaxed)) {
+        silence(frame_count);
         return;
     }
 
-    ma_uint64 frames_read = 0;
-    ma_decoder_read_pcm_frames(&player->decoder_, output, frame_count, &frames_read);
+    // Scheduled start: silence up to the frame that is heard at start_ns_
+    if (!started_) {
+        int64_t lead_ns = start_ns_.load(std::memory_order_relaxed) - heard_ns;
+        if (lead_ns > 0) {
+            uint64_t lead = static_cast<uint64_t>(lead_ns) * sample_rate_ / 1000000000ull;
+            if (lead >= frame_count) {
+                silence(frame_count);
+                return;
+            }
+            silence(static_cast<ma_uint32>(lead));
+        }
+        started_ = true;
+    }
 
-    player->frames_played_.fetch_add(frames_read, std::memory_order_relaxed);
+    // Drift correction: skip frames when behind, repeat the last one when
+    // ahead. Small errors are spread at 1% of a callback, large ones (a bad
+    // start, an underrun) are taken at once.
+    int64_t adjust = correction_.load(std::memory_order_relaxed);
+    int64_t repeat = 0;
+    if (adjust != 0) {
+        int64_t jump  = static_cast<int64_t>(kJumpSeconds * sample_rate_);
+        int64_t limit = std::llabs(adjust) >= jump
+            ? std::llabs(adjust)
+            : std::max<int64_t>(1, frame_count / 100);
+        int64_t step = std::clamp(adjust, -limit, limit);
+        if (step > 0) {
+            ma_uint32 skip = static_cast<ma_uint32>(
+                std::min<int64_t>(step, ma_pcm_rb_available_read(&ring_)));
+            ma_pcm_rb_seek_read(&ring_, skip);
+            next_frame_ += skip;
+            step = skip;
+        } else {
+            repeat = std::min<int64_t>(-step, frame_count - done);
+            step = -repeat;
+        }
+        // A newer target from correct() wins over this one
+        correction_.compare_exchange_strong(adjust, adjust - step, std::memory_order_relaxed);
+    }
+
+    publish_anchor(next_frame_, heard_ns + frames_to_ns(done));
+
+    ma_uint32 want = frame_count - done - static_cast<ma_uint32>(repeat);
+    while (want > 0) {
+        ma_uint32 n = want;
+        void*     src = nullptr;
+        if (ma_pcm_rb_acquire_read(&ring_, &n, &src) != MA_SUCCESS || n == 0) break;
+        memcpy(out + done * ch, src, static_cast<size_t>(n) * ch * sizeof(float));
+        ma_pcm_rb_commit_read(&ring_, n);
+        done += n;
+        want -= n;
+        next_frame_ += n;
+    }
+
+    if (want > 0) {
+        if (end_of_file_.load(std::memory_order_acquire) && ma_pcm_rb_available_read(&ring_) == 0) {
+            finished_.store(true, std::memory_order_relaxed);
+        } else {
+            underruns_.fetch_add(1, std::memory_order_relaxed);
+        }
+        silence(want);
+    }
+
+    // Held frames go at the end, as copies of the last frame played
+    for (int64_t i = 0; i < repeat; ++i, ++done) {
+        if (done == 0) {
+            memset(out, 0, ch * sizeof(float));
+        } else {
+            memcpy(out + done * ch, out + (done - 1) * ch, ch * sizeof(float));
+        }
+    }
+}
 
-    if (frames_read < frame_count) {
-        // Fill remaining with silence
-        ma_uint32 bytes_per_frame = ma_get_bytes_per_frame(
-            device->playback.format, device->playback.channels);
-        memset(static_cast<char*>(output) + frames_read * bytes_per_frame,
-               0, (frame_count - frames_read) * bytes_per_frame);
-        player->finished_.store(true, std::memory_order_relaxed);
+void AudioPlayer::decode_loop() {
+    while (!stop_decoding_.load(std::memory_order_relaxed)) {
+        if (ma_pcm_rb_available_write(&ring_) < kChunkFrames) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        ma_uint32 n = kChunkFrames;
+        void*     dst = nullptr;
+        if (ma_pcm_rb_acquire_write(&ring_, &n, &dst) != MA_SUCCESS) break;
+
+        ma_uint64 read = 0;
+        ma_decoder_read_pcm_frames(&decoder_, dst, n, &read);
+        ma_pcm_rb_commit_write(&ring_, static_cast<ma_uint32>(read));
+        if (read < n) break;  // end of file (or a decode error)
     }
+    end_of_file_.store(!stop_decoding_.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+void AudioPlayer::start_decoding() {
+    stop_decoding_.store(false, std::memory_order_relaxed);
+    end_of_file_.store(false, std::memory_order_relaxed);
+    decoder_thread_ = std::thread([this] { decode_loop(); });
+}
+
+void AudioPlayer::stop_decoding() {
+    stop_decoding_.store(true, std::memory_order_relaxed);
+    if (decoder_thread_.joinable()) decoder_thread_.join();
+    stop_decoding_.store(false, std::memory_order_relaxed);
+}
+
+bool AudioPlayer::wait_for_prebuffer() {
+    const ma_uint32 target = static_cast<ma_uint32>(kPrebufferSeconds * sample_rate_);
+    auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (ma_pcm_rb_available_read(&ring_) < target &&
+           !end_of_file_.load(std::memory_order_acquire)) {
+        if (Clock::now() > deadline) {
+            fprintf(stderr, "Error: decoder too slow to fill the prebuffer\n");
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
 }
 
 bool AudioPlayer::prepare(const std::string& path) {
@@ -48,36 +209,67 @@ bool AudioPlayer::prepare(const std::string& path) {
     }
     decoder_initialized_ = true;
     sample_rate_ = decoder_.outputSampleRate;
+    channels_    = decoder_.outputChannels;
 
-    // Get total length
-    ma_decoder_get_length_in_pcm_frames(&decoder_, &total_frames_);
+    // The length is not queried: for MP3 that means decoding the whole
+    // file. The duration comes from track.start instead.
+
+    result = ma_pcm_rb_init(ma_format_f32, channels_,
+                            static_cast<ma_uint32>(kRingSeconds * sample_rate_),
+                            nullptr, nullptr, &ring_);
+    if (result != MA_SUCCESS) {
+        fprintf(stderr, "Error: failed to allocate the playback buffer (error %d)\n", result);
+        stop();
+        return false;
+    }
+    ring_initialized_ = true;
 
     // Configure playback device
     ma_device_config config = ma_device_config_init(ma_device_type_playback);
     config.playback.format = decoder_.outputFormat;
     config.playback.channels = decoder_.outputChannels;
     config.sampleRate = decoder_.outputSampleRate;
+    config.performanceProfile = ma_performance_profile_low_latency;
     config.dataCallback = data_callback;
     config.pUserData = this;
 
     result = ma_device_init(nullptr, &config, &device_);
     if (result != MA_SUCCESS) {
         fprintf(stderr, "Error: failed to initialize audio device (error %d)\n", result);
-        ma_decoder_uninit(&decoder_);
-        decoder_initialized_ = false;
+        stop();
         return false;
     }
     device_initialized_ = true;
 
-    frames_played_.store(0, std::memory_order_relaxed);
-    finished_.store(false, std::memory_order_relaxed);
+    // A callback runs when one period has been played; the others still
+    // queued play before its frames
+    ma_uint32 rate = device_.playback.internalSampleRate ? device_.playback.internalSampleRate
+                                                         : sample_rate_;
+    ma_uint32 queued = device_.playback.internalPeriods > 1 ? device_.playback.internalPeriods - 1 : 0;
+    latency_ns_ = static_cast<int64_t>(
+        static_cast<uint64_t>(device_.playback.internalPeriodSizeInFrames) * queued *
+        1000000000ull / rate);
 
+    start_decoding();
+    if (!wait_for_prebuffer()) {
+        stop();
+        return false;
+    }
     return true;
 }
 
 bool AudioPlayer::start() {
+    return start_at(Clock::now());
+}
+
+bool AudioPlayer::start_at(Clock::time_point when) {
     if (!device_initialized_) return false;
 
+    start_ns_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        when.time_since_epoch()).count(), std::memory_order_relaxed);
+    publish_anchor(next_frame_, start_ns_.load(std::memory_order_relaxed));
+    if (ma_device_is_started(&device_)) return true;
+
     ma_result result = ma_device_start(&device_);
     if (result != MA_SUCCESS) {
         fprintf(stderr, "Error: failed to start audio device (error %d)\n", result);
@@ -86,30 +278,77 @@ bool AudioPlayer::start() {
     return true;
 }
 
+bool AudioPlayer::seek(double seconds) {
+    if (!decoder_initialized_ || seconds < 0.0) return false;
+    if (device_initialized_ && ma_device_is_started(&device_)) return false;
+
+    stop_decoding();
+    ma_uint64 frame = static_cast<ma_uint64>(seconds * sample_rate_);
+    if (ma_decoder_seek_to_pcm_frame(&decoder_, frame) != MA_SUCCESS) {
+        fprintf(stderr, "Error: failed to seek to %.3fs\n", seconds);
+        return false;
+    }
+    ma_pcm_rb_reset(&ring_);
+    next_frame_ = frame;
+    publish_anchor(frame, 0);
+
+    start_decoding();
+    return wait_for_prebuffer();
+}
+
 void AudioPlayer::stop() {
     if (device_initialized_) {
         ma_device_uninit(&device_);
         device_initialized_ = false;
     }
+    stop_decoding();
+    if (ring_initialized_) {
+        ma_pcm_rb_uninit(&ring_);
+        ring_initialized_ = false;
+    }
     if (decoder_initialized_) {
         ma_decoder_uninit(&decoder_);
         decoder_initialized_ = false;
     }
-    frames_played_.store(0, std::memory_order_relaxed);
+    end_of_file_.store(false, std::memory_order_relaxed);
     finished_.store(false, std::memory_order_relaxed);
+    start_ns_.store(0, std::memory_order_relaxed);
+    correction_.store(0, std::memory_order_relaxed);
+    underruns_.store(0, std::memory_order_relaxed);
+    started_ = false;
+    device_frames_ = 0;
+    window_frames_ = 0;
+    next_frame_ = 0;
+    publish_anchor(0, 0);
     sample_rate_ = 0;
-    total_frames_ = 0;
+    channels_ = 0;
+    latency_ns_ = 0;
+    duration_ = 0.0;
 }
 
 double AudioPlayer::get_position_seconds() const {
     if (sample_rate_ == 0) return 0.0;
-    return static_cast<double>(frames_played_.load(std::memory_order_relaxed))
-           / static_cast<double>(sample_rate_);
+    uint64_t frame;
+    int64_t  heard_ns;
+    read_anchor(frame, heard_ns);
+    double position = static_cast<double>(frame) / static_cast<double>(sample_rate_);
+    int64_t since = heard_ns ? now_ns() - heard_ns : 0;
+    return since > 0 ? position + static_cast<double>(since) / 1e9 : position;
 }
 
-double AudioPlayer::get_duration_seconds() const {
+double AudioPlayer::correct(double expected) {
     if (sample_rate_ == 0) return 0.0;
-    return static_cast<double>(total_frames_) / static_cast<double>(sample_rate_);
+    double error = get_position_seconds() - expected;
+    if (std::fabs(error) < kTolerance) {
+        correction_.store(0, std::memory_order_relaxed);
+    } else {
+        correction_.store(std::llround(-error * sample_rate_), std::memory_order_relaxed);
+    }
+    return error;
+}
+
+double AudioPlayer::get_duration_seconds() const {
+    return duration_;
 }
 
 bool AudioPlayer::is_finished() const {
@@ -2,48 +2,119 @@
 
 #include "miniaudio.h"
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <string>
+#include <thread>
 
+// Plays one file through miniaudio. A decoder thread streams PCM into a
+// ring buffer ahead of the device callback, so opening a long file only
+// waits for a short prebuffer and the callback never touches the file.
+// Playback can be scheduled to begin at a point in time (device latency
+// accounted for) and nudged by a few frames per callback to follow the
+// emitter's clock.
 class AudioPlayer {
 public:
+    using Clock = std::chrono::steady_clock;
+
     AudioPlayer();
     ~AudioPlayer();
 
     AudioPlayer(const AudioPlayer&) = delete;
     AudioPlayer& operator=(const AudioPlayer&) = delete;
 
-    // Decode file and configure device, but don't start playback yet.
+    // Open the file, configure the device and decode a short prebuffer,
+    // but don't start playback yet.
     bool prepare(const std::string& path);
 
-    // Begin playback.
+    // Begin playback now.
     bool start();
 
+    // Start the device now and play silence until the first frame can be
+    // heard at `when`.
+    bool start_at(Clock::time_point when);
+
+    // Move the read position of a prepared file (before start()).
+    bool seek(double seconds);
+
     // Stop playback and release resources.
     void stop();
 
-    // Current playback position in seconds.
+    // Playback position being heard right now, in seconds.
     double get_position_seconds() const;
 
-    // Total duration in seconds (available after prepare).
+    // Steer playback toward `expected`, the position that should be heard
+    // now. Returns the error in seconds (positive = audio ahead).
+    double correct(double expected);
+
+    // Total duration in seconds (0 until set; see set_duration).
     double get_duration_seconds() const;
+    void   set_duration_seconds(double seconds) { duration_ = seconds; }
 
-    // True when decoder has reached end of file.
+    // True when the whole file has been played.
     bool is_finished() const;
 
     // True when a file is prepared or playing.
     bool is_active() const;
 
+    // Callbacks that found the prebuffer empty before the end of the file.
+    uint64_t underruns() const { return underruns_.load(std::memory_order_relaxed); }
+
 private:
     static void data_callback(ma_device* device, void* output,
-                               const void* input, ma_uint32 frame_count);
+                              const void* input, ma_uint32 frame_count);
+    void render(float* out, ma_uint32 frame_count);
+
+    void start_decoding();
+    void stop_decoding();
+    void decode_loop();
+    bool wait_for_prebuffer();
+
+    int64_t now_ns() const;
+
+    // Last (source frame, time it is heard) pair published by the callback
+    void publish_anchor(uint64_t frame, int64_t heard_ns);
+    void read_anchor(uint64_t& frame, int64_t& heard_ns) const;
 
     ma_decoder decoder_{};
     ma_device device_{};
+    ma_pcm_rb ring_{};
     bool decoder_initialized_ = false;
     bool device_initialized_ = false;
+    bool ring_initialized_ = false;
+
+    std::thread       decoder_thread_;
+    std::atomic<bool> stop_decoding_{false};
+    std::atomic<bool> end_of_file_{false};    // decoder reached the end
+    std::atomic<bool> finished_{false};       // ... and the ring is drained
 
-    std::atomic<ma_uint64> frames_played_{0};
-    std::atomic<bool> finished_{false};
     ma_uint32 sample_rate_ = 0;
-    ma_uint64 total_frames_ = 0;
+    ma_uint32 channels_ = 0;
+    int64_t   latency_ns_ = 0;                // steady-state callback to speaker
+
+    // Device clock, callback thread only. The first callbacks prefill the
+    // device buffer in a burst and later ones may run late, so the time a
+    // frame is rendered is taken from the frame count and the earliest-
+    // running recent callback rather than from each call.
+    uint64_t  device_frames_ = 0;             // frames rendered since the device started
+    int64_t   base_ns_ = 0;                   // steady-state render time of device frame 0
+    int64_t   window_min_ns_ = 0;             // candidate base_ns_ of this window
+    uint64_t  window_frames_ = 0;
+    double    duration_ = 0.0;
+
+    // Scheduled start (start_at); the callback plays silence before it
+    std::atomic<int64_t> start_ns_{0};
+    bool                 started_ = false;    // callback thread only
+
+    // Source frame the next frame read from the ring belongs to
+    uint64_t next_frame_ = 0;                 // callback thread only, or stopped
+
+    // Frames to skip (> 0) or repeat (< 0), set by correct()
+    std::atomic<int64_t> correction_{0};
+
+    std::atomic<uint32_t> anchor_version_{0};  // seqlock around the anchor
+    std::atomic<uint64_t> anchor_frame_{0};
+    std::atomic<int64_t>  anchor_ns_{0};
+
+    std::atomic<uint64_t> underruns_{0};
 };
@@ -0,0 +1,24 @@
+#include "clock_sync.h"
+#include <algorithm>
+
+static constexpr auto kHalfWindow = std::chrono::seconds(5);
+
+void ClockSync::observe(uint64_t sent_ns, Clock::time_point received) {
+    int64_t local = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        received.time_since_epoch()).count();
+    int64_t offset = local - static_cast<int64_t>(sent_ns);
+
+    if (!observed_ || received - window_start_ >= kHalfWindow) {
+        previous_min_ = observed_ ? current_min_ : kNone;
+        current_min_  = kNone;
+        window_start_ = received;
+    }
+    current_min_ = std::min(current_min_, offset);
+    observed_ = true;
+}
+
+ClockSync::Clock::time_point ClockSync::to_local(uint64_t sent_ns) const {
+    int64_t offset = std::min(current_min_, previous_min_);
+    return Clock::time_point(std::chrono::duration_cast<Clock::duration>(
+        std::chrono::nanoseconds(static_cast<int64_t>(sent_ns) + offset)));
+}
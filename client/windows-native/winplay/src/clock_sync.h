@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+// Maps the emitter's clock (Envelope.sent_ns, its CLOCK_MONOTONIC) to this
+// machine's steady_clock. The two share neither epoch nor exact rate, so
+// the offset is the smallest (receive time - sent_ns) seen recently: the
+// datagrams that were delayed least. Events are acted on when they arrive,
+// so this is also the mapping that keeps audio in step with them. The
+// minimum is taken over a sliding window so slow drift between the clocks
+// is followed.
+class ClockSync {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Records one datagram stamped `sent_ns` by the emitter, received at `received`
+    void observe(uint64_t sent_ns, Clock::time_point received);
+
+    // True once any stamped datagram has been observed
+    bool synced() const { return observed_; }
+
+    // Local time corresponding to emitter time `sent_ns`
+    Clock::time_point to_local(uint64_t sent_ns) const;
+
+private:
+    static constexpr int64_t kNone = std::numeric_limits<int64_t>::max();
+
+    // Two half windows: the minimum is over the current and previous one
+    int64_t           current_min_  = kNone;
+    int64_t           previous_min_ = kNone;
+    Clock::time_point window_start_{};
+    bool              observed_ = false;
+};
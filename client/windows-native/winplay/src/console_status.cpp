@@ -21,14 +21,16 @@ void ConsoleStatus::print_prepare(const std::string& filename, double countdown)
 }
 
 void ConsoleStatus::update_playing(const std::string& filename,
-                                    double position, double duration) {
+                                    double position, double duration,
+                                    double sync_error) {
     std::string pos_str = format_time(position);
     std::string dur_str = format_time(duration);
     std::string bar = make_progress_bar(
         duration > 0.0 ? position / duration : 0.0);
 
-    fprintf(stdout, "\r[PLAYING] %s  %s / %s  %s",
-            filename.c_str(), pos_str.c_str(), dur_str.c_str(), bar.c_str());
+    fprintf(stdout, "\r[PLAYING] %s  %s / %s  %s  sync %+5.1fms",
+            filename.c_str(), pos_str.c_str(), dur_str.c_str(), bar.c_str(),
+            sync_error * 1000.0);
     fflush(stdout);
     on_progress_line_ = true;
 }
@@ -7,8 +7,9 @@ class ConsoleStatus {
 public:
     void print_banner(uint16_t port);
     void print_prepare(const std::string& filename, double countdown);
+    // sync_error: playback minus the emitter's position, in seconds
     void update_playing(const std::string& filename,
-                        double position, double duration);
+                        double position, double duration, double sync_error);
     void print_ended();
     void print_aborted(const std::string& reason);
     void print_shutdown();
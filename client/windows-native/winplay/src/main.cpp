@@ -7,9 +7,12 @@
 #include "audio_player.h"
 #include "path_translator.h"
 #include "console_status.h"
+#include "clock_sync.h"
+#include "envelope_peek.h"
 #include "tracks.pb.h"
 
 #include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -27,6 +30,31 @@ static BOOL WINAPI ctrl_handler(DWORD type) {
 
 enum class State { WAITING, PREPARED, PLAYING, STOPPED };
 
+using Clock = std::chrono::steady_clock;
+
+// Joining a track in progress: how far ahead to schedule the first frame,
+// so the file can be opened and the device started before it is due
+static constexpr auto kJoinLead = std::chrono::milliseconds(500);
+
+// Events this player acts on; only these are parsed
+static bool wanted(uint32_t event) {
+    switch (event) {
+        case tracks::Envelope::kTrackStart:
+        case tracks::Envelope::kTrackEnd:
+        case tracks::Envelope::kTrackPosition:
+        case tracks::Envelope::kTrackAbort:
+        case tracks::Envelope::kTrackPrepare:
+        case tracks::Envelope::kSnapshot:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static double seconds_between(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double>(to - from).count();
+}
+
 static std::string basename_of(const std::string& path) {
     auto pos = path.find_last_of("/\\");
     return (pos != std::string::npos) ? path.substr(pos + 1) : path;
@@ -64,83 +92,161 @@ int main(int argc, char* argv[]) {
     UdpReceiver receiver(port);
     AudioPlayer player;
     PathTranslator translator(distro);
+    ClockSync sync;
 
     State state = State::WAITING;
     std::string current_file;
     double current_duration = 0.0;
+    double sync_error = 0.0;
+
+    // When the current datagram left the emitter, in local time
+    Clock::time_point sent_at;
 
     char buf[65536];
 
-    while (!g_shutdown.load(std::memory_order_relaxed) && state != State::STOPPED) {
-        int len = receiver.receive(buf, sizeof(buf));
+    // Joins a track at `position` (as of sent_at): seeks ahead by the lead
+    // and schedules that frame for when the emitter will be there
+    auto join = [&](const std::string& filename, double duration, double position) {
+        if (filename.empty()) return;  // live input (tracks --live): nothing to play
 
-        if (len > 0) {
-            tracks::Envelope env;
-            if (!env.ParseFromArray(buf, len)) {
-                fprintf(stderr, "Warning: failed to parse envelope (%d bytes)\n", len);
-                continue;
-            }
+        std::string win_path = translator.translate(filename);
+        current_file = basename_of(filename);
+        current_duration = duration;
 
-            switch (env.event_case()) {
-                case tracks::Envelope::kTrackPrepare: {
-                    const auto& e = env.track_prepare();
-                    std::string win_path = translator.translate(e.filename());
-                    current_file = basename_of(e.filename());
-                    status.print_prepare(current_file, e.countdown());
-
-                    if (!player.prepare(win_path)) {
-                        fprintf(stderr, "Error: failed to prepare: %s\n", win_path.c_str());
-                        state = State::STOPPED;
-                    } else {
-                        current_duration = player.get_duration_seconds();
-                        state = State::PREPARED;
-                    }
-                    break;
+        Clock::time_point when = Clock::now() + kJoinLead;
+        if (!player.prepare(win_path) ||
+            !player.seek(position + seconds_between(sent_at, when)) ||
+            !player.start_at(when)) {
+            fprintf(stderr, "Error: failed to join playback of %s\n", win_path.c_str());
+            state = State::STOPPED;
+        } else {
+            player.set_duration_seconds(duration);
+            state = State::PLAYING;
+        }
+    };
+
+    // Reacts to one transport event
+    auto handle = [&](const tracks::Envelope& env) {
+        switch (env.event_case()) {
+            case tracks::Envelope::kTrackPrepare: {
+                const auto& e = env.track_prepare();
+                std::string win_path = translator.translate(e.filename());
+                current_file = basename_of(e.filename());
+                status.print_prepare(current_file, e.countdown());
+
+                // The device starts now and plays silence until track.start
+                // is due, so the first frame lands on time whatever the
+                // device latency
+                auto when = sent_at + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(e.countdown()));
+                if (!player.prepare(win_path) || !player.start_at(when)) {
+                    fprintf(stderr, "Error: failed to prepare: %s\n", win_path.c_str());
+                    state = State::STOPPED;
+                } else {
+                    state = State::PREPARED;
                 }
+                break;
+            }
 
-                case tracks::Envelope::kTrackStart: {
-                    if (state == State::PREPARED || state == State::WAITING) {
-                        // If we got TrackStart without TrackPrepare, try to prepare from TrackStart info
-                        if (state == State::WAITING) {
-                            const auto& e = env.track_start();
-                            std::string win_path = translator.translate(e.filename());
-                            current_file = basename_of(e.filename());
-                            current_duration = e.duration();
-
-                            if (!player.prepare(win_path)) {
-                                fprintf(stderr, "Error: failed to prepare: %s\n", win_path.c_str());
-                                state = State::STOPPED;
-                                break;
-                            }
-                        }
-
-                        if (player.start()) {
-                            state = State::PLAYING;
-                        } else {
-                            fprintf(stderr, "Error: failed to start playback\n");
-                            state = State::STOPPED;
-                        }
-                    }
-                    break;
+            case tracks::Envelope::kTrackStart: {
+                const auto& e = env.track_start();
+                if (state == State::PREPARED) {
+                    current_duration = e.duration();
+                    player.set_duration_seconds(e.duration());
+                    state = State::PLAYING;
+                } else if (state == State::WAITING) {
+                    // TrackStart without TrackPrepare: join from the beginning
+                    join(e.filename(), e.duration(), 0.0);
                 }
+                break;
+            }
 
-                case tracks::Envelope::kTrackEnd: {
-                    player.stop();
-                    status.print_ended();
-                    state = State::STOPPED;
-                    break;
+            case tracks::Envelope::kTrackPosition: {
+                // The emitter's heartbeat: steer toward where it is now
+                if (state == State::PLAYING) {
+                    double expected = env.track_position().position() +
+                                      seconds_between(sent_at, Clock::now());
+                    sync_error = player.correct(expected);
                 }
+                break;
+            }
 
-                case tracks::Envelope::kTrackAbort: {
-                    player.stop();
-                    status.print_aborted(env.track_abort().reason());
-                    state = State::STOPPED;
+            case tracks::Envelope::kTrackEnd: {
+                player.stop();
+                status.print_ended();
+                state = State::STOPPED;
+                break;
+            }
+
+            case tracks::Envelope::kTrackAbort: {
+                player.stop();
+                status.print_aborted(env.track_abort().reason());
+                state = State::STOPPED;
+                break;
+            }
+
+            case tracks::Envelope::kSnapshot: {
+                // Joined mid-track: start the file from the snapshot's position
+                if (state != State::WAITING) break;
+                for (const auto& inner : env.snapshot().events()) {
+                    if (inner.event_case() != tracks::Envelope::kTrackStart) continue;
+                    const auto& e = inner.track_start();
+                    join(e.filename(), e.duration(), env.timestamp());
                     break;
                 }
+                break;
+            }
 
-                default:
-                    // Ignore all MIR analysis events
-                    break;
+            default:
+                break;
+        }
+    };
+
+    // MIR analysis events are ignored: their type is read from the wire and
+    // only transport events are parsed
+    tracks::Envelope env;
+    auto dispatch = [&](const uint8_t* data, size_t size) {
+        tracks::EnvelopePeek peek;
+        if (!tracks::peek_envelope(data, size, peek)) {
+            fprintf(stderr, "Warning: failed to parse envelope (%zu bytes)\n", size);
+            return;
+        }
+        if (!wanted(peek.event) || state == State::STOPPED) return;
+        if (!env.ParseFromArray(data, static_cast<int>(size))) {
+            fprintf(stderr, "Warning: failed to parse envelope (%zu bytes)\n", size);
+            return;
+        }
+        handle(env);
+    };
+
+    while (!g_shutdown.load(std::memory_order_relaxed) && state != State::STOPPED) {
+        int len = receiver.receive(buf, sizeof(buf));
+
+        if (len > 0) {
+            Clock::time_point received = Clock::now();
+            const auto* data = reinterpret_cast<const uint8_t*>(buf);
+            tracks::EnvelopePeek peek;
+            if (!tracks::peek_envelope(data, static_cast<size_t>(len), peek)) {
+                fprintf(stderr, "Warning: failed to parse envelope (%d bytes)\n", len);
+                continue;
+            }
+
+            // Emitters that stamp datagrams let late ones be placed in time;
+            // otherwise each is taken to have been sent as it arrived
+            if (peek.sent_ns != 0) {
+                sync.observe(peek.sent_ns, received);
+                sent_at = sync.to_local(peek.sent_ns);
+            } else {
+                sent_at = received;
+            }
+
+            // A coalesced datagram (EnvelopeBatch) carries several envelopes
+            if (peek.event == tracks::Envelope::kBatch) {
+                if (!tracks::for_each_envelope(peek.payload, peek.payload_size, dispatch)) {
+                    fprintf(stderr, "Warning: failed to parse batch (%d bytes)\n", len);
+                }
+            } else {
+                dispatch(data, static_cast<size_t>(len));
             }
         }
 
@@ -148,7 +254,7 @@ int main(int argc, char* argv[]) {
         if (state == State::PLAYING) {
             status.update_playing(current_file,
                                   player.get_position_seconds(),
-                                  current_duration);
+                                  current_duration, sync_error);
 
             if (player.is_finished()) {
                 status.print_ended();
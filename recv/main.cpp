@@ -1,32 +1,53 @@
 #include "tracks.pb.h"
+#include "envelope_peek.h"
+#include "vector_codec.h"
 
 #include <boost/asio.hpp>
 #include <boost/program_options.hpp>
-#include <iostream>
-#include <sstream>
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bitset>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
 
 namespace po = boost::program_options;
 using boost::asio::ip::udp;
 using boost::asio::ip::address;
 
-static std::string format_floats(const google::protobuf::RepeatedField<float>& vals, int max_show = 4) {
-    std::ostringstream os;
-    os << "[";
+static void append_floats(std::string& out, const google::protobuf::RepeatedField<float>& vals,
+                          int max_show = 4) {
+    char buf[32];
+    out += "[";
     int n = vals.size();
     for (int i = 0; i < n && i < max_show; ++i) {
-        if (i > 0) os << ",";
-        char buf[16];
+        if (i > 0) out += ",";
         snprintf(buf, sizeof(buf), "%.3f", vals[i]);
-        os << buf;
+        out += buf;
+    }
+    if (n > max_show) {
+        snprintf(buf, sizeof(buf), ",...%d total", n);
+        out += buf;
     }
-    if (n > max_show) os << ",..." << n << " total";
-    os << "]";
-    return os.str();
+    out += "]";
 }
 
-static std::string format_event(const tracks::Envelope& env) {
-    std::string result;
+// Appends one line for `env` to `result` (reused across events, so steady
+// state formatting does not allocate)
+static void format_event(const tracks::Envelope& env, std::string& result) {
     char buf[256];
 
     snprintf(buf, sizeof(buf), "[%8.3f] ", env.timestamp());
@@ -120,7 +141,8 @@ static std::string format_event(const tracks::Envelope& env) {
             break;
         }
         case tracks::Envelope::kChroma:
-            result += "chroma            values=" + format_floats(env.chroma().values());
+            result += "chroma            values=";
+            append_floats(result, env.chroma().values());
             break;
         case tracks::Envelope::kTuning: {
             const auto& e = env.tuning();
@@ -223,7 +245,8 @@ static std::string format_event(const tracks::Envelope& env) {
             break;
         }
         case tracks::Envelope::kSpectralContrast:
-            result += "spectral.contrast values=" + format_floats(env.spectral_contrast().values());
+            result += "spectral.contrast values=";
+            append_floats(result, env.spectral_contrast().values());
             break;
         case tracks::Envelope::kSpectralRolloff: {
             const auto& e = env.spectral_rolloff();
@@ -232,7 +255,8 @@ static std::string format_event(const tracks::Envelope& env) {
             break;
         }
         case tracks::Envelope::kMfcc:
-            result += "mfcc              values=" + format_floats(env.mfcc().values());
+            result += "mfcc              values=";
+            append_floats(result, env.mfcc().values());
             break;
         case tracks::Envelope::kTimbreChange: {
             const auto& e = env.timbre_change();
@@ -243,13 +267,16 @@ static std::string format_event(const tracks::Envelope& env) {
 
         // Bands
         case tracks::Envelope::kBandsMel:
-            result += "bands.mel         values=" + format_floats(env.bands_mel().values());
+            result += "bands.mel         values=";
+            append_floats(result, env.bands_mel().values());
             break;
         case tracks::Envelope::kBandsBark:
-            result += "bands.bark        values=" + format_floats(env.bands_bark().values());
+            result += "bands.bark        values=";
+            append_floats(result, env.bands_bark().values());
             break;
         case tracks::Envelope::kBandsErb:
-            result += "bands.erb         values=" + format_floats(env.bands_erb().values());
+            result += "bands.erb         values=";
+            append_floats(result, env.bands_erb().values());
             break;
         case tracks::Envelope::kHfc: {
             const auto& e = env.hfc();
@@ -318,17 +345,278 @@ static std::string format_event(const tracks::Envelope& env) {
             break;
         }
 
+        // Container
+        case tracks::Envelope::kSnapshot: {
+            snprintf(buf, sizeof(buf), "snapshot          events=%d", env.snapshot().events_size());
+            result += buf;
+            break;
+        }
+
         default:
             result += "unknown";
             break;
     }
-    return result;
+    result += "\n";
+}
+
+// Same clock the sender stamps sent_ns with
+static int64_t monotonic_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// "a.b.c.d:port" for a sender_key()
+static std::string sender_name(uint64_t key) {
+    uint32_t addr = static_cast<uint32_t>(key >> 16);
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u:%u", addr >> 24, (addr >> 16) & 0xff,
+             (addr >> 8) & 0xff, addr & 0xff, static_cast<unsigned>(key & 0xffff));
+    return buf;
+}
+
+// Receive-side facts about a datagram, taken by the receive thread
+struct DatagramInfo {
+    int64_t  received_ns;  // CLOCK_MONOTONIC when recvmmsg returned it
+    uint32_t addr;         // sender IPv4 address, host byte order
+    uint16_t port;         // sender port, host byte order
+};
+
+// A sender's address and port as one map key
+static uint64_t sender_key(const DatagramInfo& info) {
+    return (static_cast<uint64_t>(info.addr) << 16) | info.port;
+}
+
+// --- DatagramRing ---
+// Single-producer/single-consumer byte ring between the receive thread and
+// the output thread. Records are a 4-byte length, the DatagramInfo and the
+// datagram, padded to 8 bytes; a record that would straddle the end is
+// preceded by a wrap marker and written at the start instead.
+
+class DatagramRing {
+public:
+    // `bytes` is rounded up to a power of two
+    explicit DatagramRing(size_t bytes) {
+        size_t cap = 4096;
+        while (cap < bytes) cap <<= 1;
+        mask_ = cap - 1;
+        buf_.reset(new char[cap]);
+    }
+
+    // False (datagram dropped) if the ring is full
+    bool push(const DatagramInfo& info, const char* data, uint32_t len) {
+        size_t cap  = mask_ + 1;
+        size_t need = record_size(len);
+        if (need > cap / 2) return false;
+
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t used = head - tail_.load(std::memory_order_acquire);
+        size_t room = cap - (head & mask_);  // contiguous bytes before the end
+        size_t pad  = need > room ? room : 0;
+        if (cap - used < pad + need) return false;
+
+        if (pad) {
+            std::memcpy(&buf_[head & mask_], &kWrap, sizeof(kWrap));
+            head += pad;
+        }
+        char* rec = &buf_[head & mask_];
+        std::memcpy(rec, &len, sizeof(len));
+        std::memcpy(rec + kInfoAt, &info, sizeof(info));
+        std::memcpy(rec + kDataAt, data, len);
+        head_.store(head + need, std::memory_order_release);
+        return true;
+    }
+
+    // Calls fn(info, data, len) for every queued datagram; returns how many
+    template <class Fn>
+    size_t drain(Fn&& fn) {
+        size_t tail  = tail_.load(std::memory_order_relaxed);
+        size_t head  = head_.load(std::memory_order_acquire);
+        size_t count = 0;
+        while (tail != head) {
+            uint32_t len;
+            std::memcpy(&len, &buf_[tail & mask_], sizeof(len));
+            if (len == kWrap) {
+                tail += (mask_ + 1) - (tail & mask_);
+                continue;
+            }
+            const char*  rec = &buf_[tail & mask_];
+            DatagramInfo info;
+            std::memcpy(&info, rec + kInfoAt, sizeof(info));
+            fn(info, rec + kDataAt, len);
+            tail += record_size(len);
+            ++count;
+        }
+        tail_.store(tail, std::memory_order_release);
+        return count;
+    }
+
+private:
+    static constexpr uint32_t kWrap   = 0xffffffffu;
+    static constexpr size_t   kInfoAt = 8;
+    static constexpr size_t   kDataAt = kInfoAt + sizeof(DatagramInfo);
+
+    static size_t record_size(uint32_t len) { return (kDataAt + len + 7) & ~size_t(7); }
+
+    size_t                  mask_;
+    std::unique_ptr<char[]> buf_;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+};
+
+// --- Stats ---
+// Per-type event counts (by Envelope field number) and datagram loss
+
+struct Stats {
+    std::array<uint64_t, 256> events{};  // field number -> count
+    uint64_t datagrams = 0;
+    uint64_t undecodable = 0;            // parse failures + unresolvable deltas
+
+    // Rates over `seconds`, or with rates = false plain counts
+    void print(const char* label, double seconds, bool rates,
+               uint64_t kernel_drops, uint64_t ring_drops) const {
+        const auto* desc = tracks::Envelope::descriptor();
+        uint64_t total = 0;
+        for (auto n : events) total += n;
+        double per = rates ? seconds : 1.0;
+        const char* unit = rates ? "/s" : "";
+        int         prec = rates ? 1 : 0;
+
+        char buf[192];
+        snprintf(buf, sizeof(buf),
+                 "%s %.1fs: %.*f%s datagrams, %.*f%s events, dropped kernel %llu ring %llu, undecodable %llu",
+                 label, seconds, prec, datagrams / per, unit, prec, total / per, unit,
+                 static_cast<unsigned long long>(kernel_drops),
+                 static_cast<unsigned long long>(ring_drops),
+                 static_cast<unsigned long long>(undecodable));
+        std::string line = buf;
+        for (size_t f = 0; f < events.size(); ++f) {
+            if (!events[f]) continue;
+            const auto* field = desc->FindFieldByNumber(static_cast<int>(f));
+            snprintf(buf, sizeof(buf), "\n  %-20s %10.*f%s", field ? field->name().c_str() : "?",
+                     prec, events[f] / per, unit);
+            line += buf;
+        }
+        std::cerr << line << std::endl;
+    }
+};
+
+// --- StreamStats ---
+// Loss, reordering and delay of one sender's datagrams, from Envelope.seq
+// and Envelope.sent_ns. The sender's and receiver's monotonic clocks differ
+// by an unknown offset, so delay is measured above the smallest
+// send-to-receive difference seen (`base`): the queueing and jitter part of
+// the latency, which is what buffers have to absorb. On one host both clocks
+// agree and base is the actual minimum latency.
+
+class StreamStats {
+public:
+    void add(uint64_t seq, uint64_t sent_ns, int64_t received_ns) {
+        if (seq == 0) return;  // sender without sequence numbers
+        delays_.push_back(received_ns - static_cast<int64_t>(sent_ns));
+
+        // A jump back further than the window is a restarted sender
+        if (received_ == 0 || (seq < highest_ && highest_ - seq >= kWindow)) {
+            if (received_ != 0) restarts_++;
+            first_ = highest_ = seq;
+            received_ = 1;
+            seen_.reset();
+            seen_[seq % kWindow] = true;
+            return;
+        }
+        if (seq > highest_) {
+            if (seq - highest_ >= kWindow) {
+                seen_.reset();
+            } else {
+                for (uint64_t s = highest_ + 1; s < seq; ++s) seen_[s % kWindow] = false;
+            }
+            highest_ = seq;
+            seen_[seq % kWindow] = true;
+            received_++;
+        } else if (seen_[seq % kWindow]) {
+            duplicates_++;
+        } else {
+            seen_[seq % kWindow] = true;
+            reordered_++;
+            received_++;
+        }
+    }
+
+    // Prints loss so far and the delay since the last report; the final
+    // report adds the delay histogram of the whole run
+    void report(const std::string& name, bool final_report) {
+        if (received_ == 0) return;
+
+        for (int64_t d : delays_) base_ = std::min(base_, d);
+        for (int64_t& d : delays_) {
+            d -= base_;
+            uint64_t us = static_cast<uint64_t>(d) / 1000;
+            size_t bucket = 0;
+            while (us && bucket + 1 < histogram_.size()) { us >>= 1; ++bucket; }
+            histogram_[bucket]++;
+        }
+
+        uint64_t expected = highest_ - first_ + 1;
+        uint64_t lost     = expected > received_ ? expected - received_ : 0;
+        char buf[256];
+        snprintf(buf, sizeof(buf),
+                 "  %-21s seq %llu, loss %.2f%% (%llu), reordered %llu, duplicates %llu",
+                 name.c_str(), static_cast<unsigned long long>(highest_),
+                 100.0 * static_cast<double>(lost) / static_cast<double>(expected),
+                 static_cast<unsigned long long>(lost),
+                 static_cast<unsigned long long>(reordered_),
+                 static_cast<unsigned long long>(duplicates_));
+        std::string line = buf;
+        if (restarts_) {
+            snprintf(buf, sizeof(buf), ", restarts %llu", static_cast<unsigned long long>(restarts_));
+            line += buf;
+        }
+        if (!delays_.empty()) {
+            auto at = [&](double q) {
+                size_t k = std::min(delays_.size() - 1, static_cast<size_t>(q * delays_.size()));
+                std::nth_element(delays_.begin(), delays_.begin() + k, delays_.end());
+                return delays_[k] / 1e3;
+            };
+            double p50 = at(0.50), p99 = at(0.99);
+            double max = *std::max_element(delays_.begin(), delays_.end()) / 1e3;
+            snprintf(buf, sizeof(buf), "\n  %-21s delay base %.0f us, above base p50 %.0f us, p99 %.0f us, max %.0f us",
+                     "", base_ / 1e3, p50, p99, max);
+            line += buf;
+        }
+        if (final_report) {
+            for (size_t b = 0; b < histogram_.size(); ++b) {
+                if (!histogram_[b]) continue;
+                unsigned long long lo = b ? 1ULL << (b - 1) : 0, hi = 1ULL << b;
+                snprintf(buf, sizeof(buf), "\n    %6llu-%-6llu us %10llu", lo, hi,
+                         static_cast<unsigned long long>(histogram_[b]));
+                line += buf;
+            }
+        }
+        delays_.clear();
+        std::cerr << line << std::endl;
+    }
+
+private:
+    static constexpr uint64_t kWindow = 4096;  // seqs remembered for duplicate detection
+
+    uint64_t first_ = 0, highest_ = 0, received_ = 0;
+    uint64_t reordered_ = 0, duplicates_ = 0, restarts_ = 0;
+    std::bitset<kWindow>      seen_;   // seen_[seq % kWindow] for seq in (highest_ - kWindow, highest_]
+    int64_t                   base_ = std::numeric_limits<int64_t>::max();
+    std::vector<int64_t>      delays_;     // ns, since the last report
+    std::array<uint64_t, 32>  histogram_{};  // log2 buckets of delay above base, in us
+};
+
+static std::atomic<bool> g_stop{false};
+
+static void signal_handler(int) {
+    g_stop.store(true, std::memory_order_relaxed);
 }
 
 int main(int argc, char* argv[]) {
     std::string multicast_group = "239.255.0.1";
     uint16_t port = 5000;
     std::string listen_addr = "0.0.0.0";
+    int rcvbuf = 4 << 20;
 
     po::options_description desc("TRACKS Receiver");
     desc.add_options()
@@ -336,6 +624,9 @@ int main(int argc, char* argv[]) {
         ("multicast-group", po::value<std::string>(&multicast_group), "Multicast group address")
         ("port,p", po::value<uint16_t>(&port), "UDP port")
         ("interface", po::value<std::string>(&listen_addr), "Listen interface address")
+        ("quiet,q", "Do not print events (they are counted from their tags, not parsed)")
+        ("stats", "Print per-type event rates and drops every second (to stderr)")
+        ("rcvbuf", po::value<int>(&rcvbuf), "Socket receive buffer size in bytes (default 4 MiB)")
     ;
 
     po::variables_map vm;
@@ -350,6 +641,8 @@ int main(int argc, char* argv[]) {
         std::cout << desc << "\n";
         return 0;
     }
+    const bool quiet = vm.count("quiet") > 0;
+    const bool stats = vm.count("stats") > 0;
 
     std::cout << "TRACKS Receiver - listening on " << multicast_group << ":" << port << std::endl;
 
@@ -363,36 +656,241 @@ int main(int argc, char* argv[]) {
     socket.set_option(boost::asio::ip::multicast::join_group(
         address::from_string(multicast_group)));
 
+    // Room for bursts while the output thread is busy; the kernel reports
+    // what it still had to drop through SO_RXQ_OVFL
+    int fd = socket.native_handle();
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one));
+    timeval poll{0, 200000};  // wake up to notice the end of the stream
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &poll, sizeof(poll));
+
+    std::signal(SIGINT,  signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
     std::cout << "Waiting for events...\n" << std::endl;
 
-    std::array<char, 65536> recv_buf;
-    for (;;) {
-        udp::endpoint sender;
-        boost::system::error_code ec;
-        size_t len = socket.receive_from(boost::asio::buffer(recv_buf), sender, 0, ec);
-        if (ec) {
-            std::cerr << "recv error: " << ec.message() << std::endl;
-            continue;
-        }
+    DatagramRing           ring(8 << 20);
+    std::atomic<uint64_t>  kernel_drops{0}, ring_drops{0};
+    std::atomic<bool>      ended{false};
 
-        tracks::Envelope env;
-        if (!env.ParseFromArray(recv_buf.data(), len)) {
-            std::cerr << "failed to parse envelope (" << len << " bytes)" << std::endl;
-            continue;
-        }
+    // Output thread: decode, count, format, write
+    std::thread output([&] {
+        // Parsing into an arena recycles the submessage memory instead of
+        // allocating per packet; the arena is reset once it has grown
+        static char arena_block[256 << 10];
+        google::protobuf::ArenaOptions options;
+        options.initial_block      = arena_block;
+        options.initial_block_size = sizeof(arena_block);
+        google::protobuf::Arena arena(options);
+        auto* env = google::protobuf::Arena::CreateMessage<tracks::Envelope>(&arena);
+        size_t since_reset = 0;
+
+        // Quantized vector events are expanded before printing; a delta whose
+        // reference frame was lost is skipped until the next absolute frame.
+        // Senders are keyed by address and port (sender_key).
+        std::map<uint64_t, tracks::VectorDecoder> vectors;  // each sender's delta chains
+        Stats total, window;
+        std::map<uint64_t, StreamStats> streams;
+        std::string out;
+        out.reserve(1 << 16);
+        bool done = false;
+        const char* end_note = nullptr;
+
+        auto started = std::chrono::steady_clock::now();
+        auto window_start = started;
 
-        std::cout << format_event(env) << std::endl;
+        // Set by track.start; a snapshot arriving while unset means this
+        // receiver joined mid-track, and its contents are shown once
+        bool in_track = false;
 
         // Exit after track.end or track.abort
-        if (env.event_case() == tracks::Envelope::kTrackEnd) {
-            std::cout << "\nTrack ended." << std::endl;
-            break;
+        auto handle = [&](tracks::Envelope& e, uint64_t sender) {
+            if (!vectors[sender].decode(e)) {
+                window.undecodable++;
+                return;
+            }
+            window.events[std::min<size_t>(e.event_case(), window.events.size() - 1)]++;
+            if (!quiet) format_event(e, out);
+            if (e.event_case() == tracks::Envelope::kSnapshot) {
+                if (!in_track && !quiet) {
+                    for (const auto& state : e.snapshot().events()) {
+                        out += "  ";
+                        format_event(state, out);
+                    }
+                }
+                in_track = true;
+            } else if (e.event_case() == tracks::Envelope::kTrackStart) {
+                in_track = true;
+            } else if (e.event_case() == tracks::Envelope::kTrackEnd) {
+                end_note = "\nTrack ended.\n";
+                done = true;
+            } else if (e.event_case() == tracks::Envelope::kTrackAbort) {
+                end_note = "\nTrack aborted.\n";
+                done = true;
+            }
+        };
+
+        auto flush_window = [&](bool final_report) {
+            auto now = std::chrono::steady_clock::now();
+            double secs = std::chrono::duration<double>(now - window_start).count();
+            for (size_t f = 0; f < total.events.size(); ++f) total.events[f] += window.events[f];
+            total.datagrams   += window.datagrams;
+            total.undecodable += window.undecodable;
+            if (stats && !final_report && secs > 0) {
+                window.print("stats", secs, true, kernel_drops.load(), ring_drops.load());
+                for (auto& [key, stream] : streams) stream.report(sender_name(key), false);
+            }
+            window = Stats();
+            window_start = now;
+        };
+
+        // Quiet: nothing is printed, so events are only counted, straight
+        // from their wire tags. Vector deltas are then not checked.
+        auto count_quiet = [&](const tracks::EnvelopePeek& peek) {
+            window.events[std::min<size_t>(peek.event, window.events.size() - 1)]++;
+            if (peek.event == tracks::Envelope::kTrackEnd) {
+                end_note = "\nTrack ended.\n";
+                done = true;
+            } else if (peek.event == tracks::Envelope::kTrackAbort) {
+                end_note = "\nTrack aborted.\n";
+                done = true;
+            }
+        };
+
+        while (!done) {
+            size_t n = ring.drain([&](const DatagramInfo& info, const char* data, uint32_t len) {
+                if (done) return;
+                window.datagrams++;
+                if (quiet) {
+                    tracks::EnvelopePeek peek;
+                    bool ok = tracks::peek_envelope(data, len, peek);
+                    if (ok && stats) {
+                        streams[sender_key(info)].add(peek.seq, peek.sent_ns, info.received_ns);
+                    }
+                    if (ok && peek.event == tracks::Envelope::kBatch) {
+                        ok = tracks::for_each_envelope(peek.payload, peek.payload_size,
+                                                       [&](const uint8_t* inner, size_t size) {
+                            tracks::EnvelopePeek e;
+                            if (done) return;
+                            if (tracks::peek_envelope(inner, size, e)) {
+                                count_quiet(e);
+                            } else {
+                                window.undecodable++;
+                            }
+                        });
+                    } else if (ok) {
+                        count_quiet(peek);
+                    }
+                    if (!ok) window.undecodable++;
+                    return;
+                }
+                if (++since_reset >= 4096) {
+                    arena.Reset();
+                    env = google::protobuf::Arena::CreateMessage<tracks::Envelope>(&arena);
+                    since_reset = 0;
+                }
+                if (!env->ParseFromArray(data, static_cast<int>(len))) {
+                    window.undecodable++;
+                    if (!quiet) {
+                        char buf[64];
+                        snprintf(buf, sizeof(buf), "failed to parse envelope (%u bytes)\n", len);
+                        std::cerr << buf;
+                    }
+                    return;
+                }
+                // seq and sent_ns are per datagram: on a batch they are on
+                // the outer envelope
+                uint64_t sender = sender_key(info);
+                if (stats) streams[sender].add(env->seq(), env->sent_ns(), info.received_ns);
+                // A coalesced datagram carries several envelopes in send order
+                if (env->event_case() == tracks::Envelope::kBatch) {
+                    for (auto& inner : *env->mutable_batch()->mutable_events()) {
+                        handle(inner, sender);
+                        if (done) break;
+                    }
+                } else {
+                    handle(*env, sender);
+                }
+            });
+
+            // Write what this pass formatted in one go
+            if (!out.empty()) {
+                fwrite(out.data(), 1, out.size(), stdout);
+                fflush(stdout);
+                out.clear();
+            }
+            if (stats && std::chrono::steady_clock::now() - window_start >= std::chrono::seconds(1)) {
+                flush_window(false);
+            }
+            if (done) break;
+            if (g_stop.load(std::memory_order_relaxed)) {
+                end_note = "\nInterrupted.\n";
+                break;
+            }
+            if (n == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
-        if (env.event_case() == tracks::Envelope::kTrackAbort) {
-            std::cout << "\nTrack aborted." << std::endl;
-            break;
+
+        if (end_note) fputs(end_note, stdout);
+        fflush(stdout);
+        if (stats) {
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+            flush_window(true);
+            total.print("total", secs, false, kernel_drops.load(), ring_drops.load());
+            for (auto& [key, stream] : streams) stream.report(sender_name(key), true);
+        }
+        ended.store(true, std::memory_order_release);
+    });
+
+    // Receive thread (this one): batch datagrams into the ring, nothing else
+    constexpr unsigned kBatch = 32;
+    constexpr size_t   kMaxDatagram = 65536;
+    std::unique_ptr<char[]> bufs(new char[kBatch * kMaxDatagram]);
+    std::array<mmsghdr, kBatch> msgs{};
+    std::array<iovec, kBatch>   iovs{};
+    std::array<sockaddr_in, kBatch> names{};
+    std::array<std::array<char, CMSG_SPACE(sizeof(uint32_t))>, kBatch> control{};
+
+    while (!ended.load(std::memory_order_acquire)) {
+        for (unsigned i = 0; i < kBatch; ++i) {
+            iovs[i].iov_base = &bufs[i * kMaxDatagram];
+            iovs[i].iov_len  = kMaxDatagram;
+            msghdr& h = msgs[i].msg_hdr;
+            h = msghdr{};
+            h.msg_iov        = &iovs[i];
+            h.msg_iovlen     = 1;
+            h.msg_name       = &names[i];
+            h.msg_namelen    = sizeof(names[i]);
+            h.msg_control    = control[i].data();
+            h.msg_controllen = control[i].size();
+        }
+
+        int n = ::recvmmsg(fd, msgs.data(), kBatch, MSG_WAITFORONE, nullptr);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "recv error: " << std::strerror(errno) << std::endl;
+            }
+            continue;
+        }
+
+        int64_t received_ns = monotonic_ns();
+        for (int i = 0; i < n; ++i) {
+            DatagramInfo info{received_ns, ntohl(names[i].sin_addr.s_addr), ntohs(names[i].sin_port)};
+            if (!ring.push(info, &bufs[i * kMaxDatagram], msgs[i].msg_len)) {
+                ring_drops.fetch_add(1, std::memory_order_relaxed);
+            }
+            // Cumulative count of datagrams the socket dropped
+            msghdr& h = msgs[i].msg_hdr;
+            for (cmsghdr* c = CMSG_FIRSTHDR(&h); c; c = CMSG_NXTHDR(&h, c)) {
+                if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SO_RXQ_OVFL) {
+                    uint32_t dropped;
+                    std::memcpy(&dropped, CMSG_DATA(c), sizeof(dropped));
+                    kernel_drops.store(dropped, std::memory_order_relaxed);
+                }
+            }
         }
     }
 
+    output.join();
     return 0;
 }
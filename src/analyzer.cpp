@@ -1,13 +1,30 @@
 #include "analyzer.h"
+#include "segmenter.h"
+#include "signal_scan.h"
+#include "stats.h"
 #include "tracks.pb.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
 #include <cmath>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
 
 #include <essentia/algorithmfactory.h>
 #include <essentia/streaming/algorithms/poolstorage.h>
+#include <essentia/streaming/algorithms/vectorinput.h>
+#include <essentia/streaming/streamingalgorithm.h>
 #include <essentia/scheduler/network.h>
 #include <essentia/utils/tnt/tnt2vector.h>
 
@@ -23,11 +40,69 @@ static double frame_to_time(int frame_idx, int hop_size, int sample_rate) {
     return static_cast<double>(frame_idx) * hop_size / sample_rate;
 }
 
+static EventType event_type_of(const ::tracks::Envelope& env) {
+    using E = ::tracks::Envelope;
+    switch (env.event_case()) {
+        case E::kTrackStart:         return EventType::TRACK_START;
+        case E::kTrackEnd:           return EventType::TRACK_END;
+        case E::kTrackPosition:      return EventType::TRACK_POSITION;
+        case E::kTrackAbort:         return EventType::TRACK_ABORT;
+        case E::kTrackPrepare:       return EventType::TRACK_PREPARE;
+        case E::kBeat:               return EventType::BEAT;
+        case E::kTempoChange:        return EventType::TEMPO_CHANGE;
+        case E::kDownbeat:           return EventType::DOWNBEAT;
+        case E::kOnset:              return EventType::ONSET;
+        case E::kOnsetRate:          return EventType::ONSET_RATE;
+        case E::kNovelty:            return EventType::NOVELTY;
+        case E::kKeyChange:          return EventType::KEY_CHANGE;
+        case E::kChordChange:        return EventType::CHORD_CHANGE;
+        case E::kChroma:             return EventType::CHROMA;
+        case E::kTuning:             return EventType::TUNING;
+        case E::kDissonance:         return EventType::DISSONANCE;
+        case E::kInharmonicity:      return EventType::INHARMONICITY;
+        case E::kPitch:              return EventType::PITCH;
+        case E::kPitchChange:        return EventType::PITCH_CHANGE;
+        case E::kMelody:             return EventType::MELODY;
+        case E::kLoudness:           return EventType::LOUDNESS;
+        case E::kLoudnessPeak:       return EventType::LOUDNESS_PEAK;
+        case E::kEnergy:             return EventType::ENERGY;
+        case E::kDynamicChange:      return EventType::DYNAMIC_CHANGE;
+        case E::kSilenceStart:       return EventType::SILENCE_START;
+        case E::kSilenceEnd:         return EventType::SILENCE_END;
+        case E::kGap:                return EventType::GAP;
+        case E::kSpectralCentroid:   return EventType::SPECTRAL_CENTROID;
+        case E::kSpectralFlux:       return EventType::SPECTRAL_FLUX;
+        case E::kSpectralComplexity: return EventType::SPECTRAL_COMPLEXITY;
+        case E::kSpectralContrast:   return EventType::SPECTRAL_CONTRAST;
+        case E::kSpectralRolloff:    return EventType::SPECTRAL_ROLLOFF;
+        case E::kMfcc:               return EventType::MFCC;
+        case E::kTimbreChange:       return EventType::TIMBRE_CHANGE;
+        case E::kBandsMel:           return EventType::BANDS_MEL;
+        case E::kBandsBark:          return EventType::BANDS_BARK;
+        case E::kBandsErb:           return EventType::BANDS_ERB;
+        case E::kHfc:                return EventType::HFC;
+        case E::kSegmentBoundary:    return EventType::SEGMENT_BOUNDARY;
+        case E::kFadeIn:             return EventType::FADE_IN;
+        case E::kFadeOut:            return EventType::FADE_OUT;
+        case E::kClick:              return EventType::CLICK;
+        case E::kDiscontinuity:      return EventType::DISCONTINUITY;
+        case E::kNoiseBurst:         return EventType::NOISE_BURST;
+        case E::kSaturation:         return EventType::SATURATION;
+        case E::kHum:                return EventType::HUM;
+        case E::kEnvelopeEvent:      return EventType::ENVELOPE;
+        case E::kAttack:             return EventType::ATTACK;
+        case E::kDecay:              return EventType::DECAY;
+        case E::kBatch:
+        case E::kSnapshot:
+        case E::EVENT_NOT_SET: break;
+    }
+    throw std::logic_error("envelope has no event set");
+}
+
+// Serializes straight into the timeline arena (no intermediate string)
 static void add_envelope(Timeline& tl, double ts, const ::tracks::Envelope& env) {
-    TimelineEvent te;
-    te.timestamp = ts;
-    te.serialized = env.SerializeAsString();
-    tl.push_back(te);
+    size_t len = env.ByteSizeLong();
+    env.SerializeWithCachedSizesToArray(tl.append(ts, event_type_of(env), len));
 }
 
 static bool needs_any(const EventFilter& filter, std::initializer_list<EventType> types) {
@@ -37,135 +112,1007 @@ static bool needs_any(const EventFilter& filter, std::initializer_list<EventType
     return false;
 }
 
+// Event types computed from the windowed spectrum (or its frames)
+static bool needs_spectral(const EventFilter& filter) {
+    return needs_any(filter, {
+        EventType::SPECTRAL_CENTROID, EventType::SPECTRAL_FLUX,
+        EventType::SPECTRAL_COMPLEXITY, EventType::SPECTRAL_CONTRAST,
+        EventType::SPECTRAL_ROLLOFF, EventType::MFCC, EventType::TIMBRE_CHANGE,
+        EventType::BANDS_MEL, EventType::BANDS_BARK, EventType::BANDS_ERB, EventType::HFC,
+        EventType::CHROMA, EventType::KEY_CHANGE, EventType::CHORD_CHANGE,
+        EventType::TUNING, EventType::DISSONANCE, EventType::INHARMONICITY,
+        EventType::PITCH, EventType::PITCH_CHANGE,
+        EventType::SEGMENT_BOUNDARY, EventType::NOVELTY});
+}
+
+// Event types computed from the time-domain signal scan
+static bool needs_scan(const EventFilter& filter) {
+    return needs_any(filter, {
+        EventType::CLICK, EventType::DISCONTINUITY, EventType::NOISE_BURST,
+        EventType::SATURATION, EventType::HUM,
+        EventType::ENVELOPE, EventType::ATTACK, EventType::DECAY,
+        EventType::FADE_IN, EventType::FADE_OUT, EventType::DOWNBEAT});
+}
+
+// Progress output; analyze-batch turns it off and reports per file instead.
+static std::atomic<bool> g_progress{true};
+
+void set_progress_output(bool enabled) { g_progress.store(enabled); }
+bool progress_output() { return g_progress.load(std::memory_order_relaxed); }
+
+// std::cout, or a stream that discards everything when progress is off
+static std::ostream& progress() {
+    thread_local std::ostream discard(nullptr);
+    return progress_output() ? std::cout : discard;
+}
+
+// Passes may run on several threads; keep their progress lines whole.
+static std::mutex g_log_mutex;
+
+static void log_progress(const std::string& line) {
+    if (!progress_output()) return;
+    std::lock_guard<std::mutex> lock(g_log_mutex);
+    std::cout << line << std::endl;
+}
+
+// Essentia's algorithm factory and FFT plan setup are not safe to call
+// concurrently, so passes build their networks under this lock and release
+// it before Network::run().
+static std::mutex g_build_mutex;
+
+// --- Audio source ---
+// With cfg.shared_decode the file is decoded and resampled once into `signal`
+// and every pass streams from that buffer through a VectorInput. Otherwise
+// each pass opens its own MonoLoader. The shared buffer holds 4 bytes per
+// sample (about 10 MB per minute at 44.1 kHz, 1.3 GB for two hours), so
+// inputs longer than cfg.shared_decode_max are decoded per pass instead.
+
+struct AudioSource {
+    std::string       filename;
+    Real              sample_rate = 0;
+    bool              shared = false;
+    std::vector<Real> signal;
+};
+
+// Samples handed downstream per VectorInput process() call
+static constexpr int kSourceChunk = 1024;
+
+// Duration in seconds from the file's header (MetadataReader); 0 if unknown
+static double probe_duration(const std::string& filename) {
+    try {
+        std::unique_lock<std::mutex> lock(g_build_mutex);
+        std::unique_ptr<standard::Algorithm> reader(standard::AlgorithmFactory::instance()
+            .create("MetadataReader", "filename", filename));
+        lock.unlock();
+
+        std::string title, artist, album, comment, genre, track, date;
+        Pool        tags;
+        int         duration = 0, bitrate = 0, sample_rate = 0, channels = 0;
+        reader->output("title").set(title);
+        reader->output("artist").set(artist);
+        reader->output("album").set(album);
+        reader->output("comment").set(comment);
+        reader->output("genre").set(genre);
+        reader->output("tracknumber").set(track);
+        reader->output("date").set(date);
+        reader->output("tagPool").set(tags);
+        reader->output("duration").set(duration);
+        reader->output("bitrate").set(bitrate);
+        reader->output("sampleRate").set(sample_rate);
+        reader->output("channels").set(channels);
+        reader->compute();
+        return duration;
+    } catch (const std::exception&) {
+        return 0.0;  // no TagLib, or a format it does not read
+    }
+}
+
+static void open_audio(const Config& cfg, AudioSource& audio) {
+    audio.filename    = cfg.input_file;
+    audio.sample_rate = Real(cfg.sample_rate);
+    audio.shared      = cfg.shared_decode;
+    if (!audio.shared) return;
+
+    // An input of unknown length is decoded once, as before the limit
+    if (cfg.shared_decode_max > 0) {
+        double seconds = probe_duration(audio.filename);
+        if (seconds > cfg.shared_decode_max) {
+            progress() << "  Long input (" << static_cast<int>(seconds / 60)
+                       << " min): decoding per pass" << std::endl;
+            audio.shared = false;
+            return;
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(g_build_mutex);
+    auto* loader = standard::AlgorithmFactory::instance().create("MonoLoader",
+        "filename", audio.filename,
+        "sampleRate", audio.sample_rate);
+    lock.unlock();
+
+    progress() << "  Decoding audio..." << std::endl;
+    loader->output("audio").set(audio.signal);
+    loader->compute();
+    delete loader;
+}
+
+// Creates the root algorithm of a pass network. The network takes ownership.
+static Algorithm* create_source(const AudioSource& audio) {
+    if (audio.shared) {
+        return new VectorInput<Real, kSourceChunk>(&audio.signal);
+    }
+    return streaming::AlgorithmFactory::instance().create("MonoLoader",
+        "filename", audio.filename,
+        "sampleRate", audio.sample_rate);
+}
+
+// PCM output of an algorithm returned by create_source()
+static SourceBase& audio_output(const AudioSource& audio, Algorithm* source) {
+    return source->output(audio.shared ? "data" : "audio");
+}
+
 // --- Pass: Beat tracking ---
 
-static double run_beat_pass(const Config& cfg, Pool& pool) {
+static double run_beat_pass(const Config& cfg, const AudioSource& audio, Pool& pool) {
+    std::unique_lock<std::mutex> lock(g_build_mutex);
     auto& factory = streaming::AlgorithmFactory::instance();
 
-    Algorithm* loader = factory.create("MonoLoader",
-        "filename", cfg.input_file,
-        "sampleRate", Real(cfg.sample_rate));
+    Algorithm* source = create_source(audio);
 
     Algorithm* beatTracker = factory.create("BeatTrackerMultiFeature");
 
-    loader->output("audio")           >> beatTracker->input("signal");
+    SourceBase& pcm = audio_output(audio, source);
+    pcm                               >> beatTracker->input("signal");
     beatTracker->output("ticks")      >> PC(pool, "rhythm.ticks");
     beatTracker->output("confidence") >> PC(pool, "rhythm.confidence");
 
-    std::cout << "  Analyzing beats..." << std::endl;
-    Network network(loader);
+    log_progress("  Analyzing beats...");
+    Network network(source);
+    lock.unlock();
     network.run();
 
-    long totalSamples = loader->output("audio").totalProduced();
+    long totalSamples = pcm.totalProduced();
     return static_cast<double>(totalSamples) / cfg.sample_rate;
 }
 
 // --- Pass: Onset detection ---
 
-static void run_onset_pass(const Config& cfg, Pool& pool) {
+static void run_onset_pass(const AudioSource& audio, Pool& pool) {
+    std::unique_lock<std::mutex> lock(g_build_mutex);
     auto& factory = streaming::AlgorithmFactory::instance();
 
-    Algorithm* loader = factory.create("MonoLoader",
-        "filename", cfg.input_file,
-        "sampleRate", Real(cfg.sample_rate));
+    Algorithm* source = create_source(audio);
 
     Algorithm* onsetRate = factory.create("OnsetRate");
 
-    loader->output("audio")           >> onsetRate->input("signal");
+    SourceBase& pcm = audio_output(audio, source);
+    pcm                               >> onsetRate->input("signal");
     onsetRate->output("onsetTimes")   >> PC(pool, "rhythm.onsetTimes");
-    onsetRate->output("onsetRate")    >> NOWHERE;
+    onsetRate->output("onsetRate")    >> PC(pool, "rhythm.onsetRate");
 
-    std::cout << "  Analyzing onsets..." << std::endl;
-    Network network(loader);
+    log_progress("  Analyzing onsets...");
+    Network network(source);
+    lock.unlock();
     network.run();
 }
 
-// --- Pass: Silence detection ---
+// --- Frame network planner ---
+// The frame-based passes (silence, loudness/energy, spectral) share a single
+// network. The planner creates one FrameCutter per distinct
+// (frame, hop, silentFrames) key, and one Windowing -> Spectrum chain per key
+// when a consumer asks for it, then fans those out to every consumer, so
+// frames and FFTs are computed once per file and resolution. Each feature
+// family takes its frame and hop size from resolution(cfg, family); families
+// left at the defaults share one framing.
+
+struct FramingKey {
+    int         frame_size;
+    int         hop_size;
+    std::string silent_frames;  // FrameCutter "silentFrames": "keep" or "noise"
+
+    bool operator<(const FramingKey& o) const {
+        return std::tie(frame_size, hop_size, silent_frames) <
+               std::tie(o.frame_size, o.hop_size, o.silent_frames);
+    }
+};
 
-static void run_silence_pass(const Config& cfg, Pool& pool) {
-    auto& factory = streaming::AlgorithmFactory::instance();
+static FramingKey framing_for(const Config& cfg, const char* family, const char* silent_frames) {
+    Resolution r = resolution(cfg, family);
+    return {r.frame_size, r.hop_size, silent_frames};
+}
 
-    Algorithm* loader = factory.create("MonoLoader",
-        "filename", cfg.input_file,
-        "sampleRate", Real(cfg.sample_rate));
+class FramePlan {
+public:
+    explicit FramePlan(const AudioSource& audio)
+        : source_(create_source(audio)), pcm_(audio_output(audio, source_)) {}
+    // Frames of another source's PCM; the network takes ownership of `source`
+    FramePlan(Algorithm* source, SourceBase& pcm) : source_(source), pcm_(pcm) {}
 
-    Algorithm* frameCutter = factory.create("FrameCutter",
-        "frameSize", cfg.frame_size,
-        "hopSize", cfg.hop_size,
-        "silentFrames", std::string("keep"));
+    Algorithm* source() const { return source_; }
+    SourceBase& pcm() const   { return pcm_; }
 
-    Algorithm* silence = factory.create("StartStopSilence",
-        "threshold", -60);
+    // Time-domain frames for `key`
+    SourceBase& frames(const FramingKey& key) {
+        return framing(key).cutter->output("frame");
+    }
+
+    // Hann-windowed magnitude spectrum of the frames for `key`
+    SourceBase& spectrum(const FramingKey& key) {
+        Framing& f = framing(key);
+        if (!f.spectrum) {
+            f.spectrum = streaming::AlgorithmFactory::instance().create("Spectrum");
+            windowed(f) >> f.spectrum->input("frame");
+        }
+        return f.spectrum->output("spectrum");
+    }
 
-    loader->output("audio")        >> frameCutter->input("signal");
-    frameCutter->output("frame")   >> silence->input("frame");
-    silence->output("startFrame")  >> PC(pool, "silence.startFrame");
-    silence->output("stopFrame")   >> PC(pool, "silence.stopFrame");
+    // Magnitude and phase of the Hann-windowed FFT of the frames for `key`,
+    // as the "magnitude" and "phase" outputs of a CartesianToPolar
+    Algorithm& polar(const FramingKey& key) {
+        Framing& f = framing(key);
+        if (!f.polar) {
+            auto& factory = streaming::AlgorithmFactory::instance();
+            Algorithm* fft = factory.create("FFT",
+                "size", key.frame_size);
+            f.polar = factory.create("CartesianToPolar");
+            windowed(f)        >> fft->input("frame");
+            fft->output("fft") >> f.polar->input("complex");
+        }
+        return *f.polar;
+    }
 
-    std::cout << "  Analyzing silence..." << std::endl;
-    Network network(loader);
-    network.run();
+private:
+    struct Framing {
+        Algorithm* cutter    = nullptr;
+        Algorithm* windowing = nullptr;
+        Algorithm* spectrum  = nullptr;
+        Algorithm* polar     = nullptr;
+    };
+
+    SourceBase& windowed(Framing& f) {
+        if (!f.windowing) {
+            f.windowing = streaming::AlgorithmFactory::instance().create("Windowing",
+                "type", std::string("hann"));
+            f.cutter->output("frame") >> f.windowing->input("frame");
+        }
+        return f.windowing->output("frame");
+    }
+
+    Framing& framing(const FramingKey& key) {
+        Framing& f = framings_[key];
+        if (!f.cutter) {
+            f.cutter = streaming::AlgorithmFactory::instance().create("FrameCutter",
+                "frameSize", key.frame_size,
+                "hopSize", key.hop_size,
+                "silentFrames", key.silent_frames);
+            pcm_ >> f.cutter->input("signal");
+        }
+        return f;
+    }
+
+    Algorithm*                    source_;
+    SourceBase&                   pcm_;
+    std::map<FramingKey, Framing> framings_;
+};
+
+// --- Feature sinks ---
+// Frame consumers hand every descriptor they produce to a FeatureSink, which
+// decides what becomes of it (the FrameAssembler below, in both modes).
+
+class FeatureSink {
+public:
+    virtual ~FeatureSink() = default;
+    // One Real per frame of `framing`
+    virtual void real(SourceBase& src, const std::string& name, const FramingKey& framing) = 0;
+    // One std::vector<Real> per frame of `framing`
+    virtual void vector(SourceBase& src, const std::string& name, const FramingKey& framing) = 0;
+    // Anything else (strings, frame indices, whole-file results)
+    virtual void store(SourceBase& src, const std::string& name) = 0;
+};
+
+// --- Frame kernels ---
+// The per-frame and per-track loops of the change detectors. Reductions
+// keep four independent sums, so the compiler can vectorize them without
+// reassociating floating point.
+
+// Squared Euclidean distance
+static double squared_distance(const Real* a, const Real* b, size_t n) {
+    double acc[4] = {0.0, 0.0, 0.0, 0.0};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (size_t k = 0; k < 4; ++k) {
+            double d = static_cast<double>(a[i + k] - b[i + k]);
+            acc[k] += d * d;
+        }
+    }
+    double sum = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    for (; i < n; ++i) {
+        double d = static_cast<double>(a[i] - b[i]);
+        sum += d * d;
+    }
+    return sum;
+}
+
+// Sum of the positive parts of cur - prev
+static double rectified_rise(const double* cur, const double* prev, size_t n) {
+    double acc[4] = {0.0, 0.0, 0.0, 0.0};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (size_t k = 0; k < 4; ++k) acc[k] += std::max(cur[i + k] - prev[i + k], 0.0);
+    }
+    double sum = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    for (; i < n; ++i) sum += std::max(cur[i] - prev[i], 0.0);
+    return sum;
+}
+
+// Frames 0 < i < n-1 above both neighbours and at least `floor`. The
+// comparisons combine without branches; only a hit takes one.
+static void local_peaks(const Real* v, size_t n, Real floor, std::vector<uint32_t>& out) {
+    for (size_t i = 1; i + 1 < n; ++i) {
+        bool peak = (v[i] > v[i - 1]) & (v[i] > v[i + 1]) & (v[i] >= floor);
+        if (peak) out.push_back(static_cast<uint32_t>(i));
+    }
+}
+
+// Frames 0 < i < n whose step from the previous frame exceeds `threshold`
+static void jumps(const Real* v, size_t n, double threshold, std::vector<uint32_t>& out) {
+    for (size_t i = 1; i < n; ++i) {
+        double diff = std::abs(static_cast<double>(v[i]) - static_cast<double>(v[i - 1]));
+        if (diff > threshold) out.push_back(static_cast<uint32_t>(i));
+    }
+}
+
+// --- Frame assembler ---
+// Turns frames into events as they arrive: FrameTap sinks hand each
+// descriptor token to the FrameAssembler, which emits a frame's events once
+// every descriptor for it is in, with the same throttling and thresholds in
+// batch and streaming mode.
+//
+// Streaming mode sends the events to an EventQueue. Thresholds that a whole
+// file would take from the track maximum (loudness.peak, dynamic.change) use
+// the running maximum instead, loudness.peak is decided one frame late since
+// it needs the following frame, and segment.boundary comes from the online
+// segmenter, several seconds late.
+//
+// Batch mode appends them to a Timeline instead, and keeps in a FrameStore
+// only what the whole-file builders need: loudness for the track maximum,
+// the online segment boundaries (which would break the timeline's order),
+// and the MFCC matrix for SBic. Whole-file descriptors (silence, key,
+// chords) go to the Pool.
+
+// Per-frame descriptors kept for the whole-file builders, in contiguous arrays
+struct FrameStore {
+    bool              keep_loudness = false;
+    bool              keep_mfcc     = false;
+    std::vector<Real> loudness;        // one per frame
+    std::vector<Real> mfcc;            // mfcc_size per frame, frame after frame
+    size_t            mfcc_size = 0;
+    int               loudness_hop = 0;  // of the families they come from
+    int               mfcc_hop     = 0;
+    std::vector<double> boundaries;    // from the online segmenter, in seconds
+
+    size_t mfcc_frames() const { return mfcc_size ? mfcc.size() / mfcc_size : 0; }
+};
+
+// Thrown from a FrameTap to unwind Network::run() once the emitter cancels
+struct StreamCancelled {};
+
+class FrameAssembler : public FeatureSink {
+public:
+    // Streaming: events go to `queue`
+    FrameAssembler(const Config& cfg, const EventFilter& filter, EventQueue& queue)
+        : cfg_(cfg), filter_(filter), queue_(&queue) { init(); }
+    // Batch: events go to `tl`, whole-file descriptors to `pool`
+    FrameAssembler(const Config& cfg, const EventFilter& filter, Timeline& tl, Pool& pool,
+                   FrameStore& store)
+        : cfg_(cfg), filter_(filter), timeline_(&tl), pool_(&pool), store_(&store) { init(); }
+
+    void real(SourceBase& src, const std::string& name, const FramingKey& framing) override;
+    void vector(SourceBase& src, const std::string& name, const FramingKey& framing) override;
+    // Streaming has no use for whole-file results; unused outputs still need a sink
+    void store(SourceBase& src, const std::string& name) override {
+        if (pool_) {
+            src >> PC(*pool_, name);
+        } else {
+            src >> NOWHERE;
+        }
+    }
+
+    void push(size_t channel, Real value) {
+        channels_[channel].push(&value, 1);
+        drain();
+    }
+    void push(size_t channel, const std::vector<Real>& value) {
+        channels_[channel].push(value.data(), value.size());
+        drain();
+    }
+
+    // Frames emitted by the group that emitted most
+    int frames() const {
+        int n = 0;
+        for (const auto& g : groups_) n = std::max(n, g.frame);
+        return n;
+    }
+
+    // After Network::run(): emits what the detectors still hold back
+    void finish();
+
+    // Stamp events with the capture time of each frame's last sample
+    void set_live(LiveInput* live) { live_ = live; }
+
+private:
+    // The descriptors emit_frame() reads, resolved from their names once
+    // when the consumers are attached
+    enum Feature : size_t {
+        kLoudness, kEnergy, kCentroid, kFlux, kComplexity, kContrast, kRolloff, kHfc,
+        kMfcc, kMel, kBark, kErb, kHpcp, kDissonance, kInharmonicity, kPitch,
+        kPitchConfidence, kOnsetDetection, kFeatures
+    };
+
+    // Tokens waiting for the rest of their frame, back to back in one
+    // array. A channel takes the width of its first token; later ones are
+    // padded or cut to it.
+    struct Channel {
+        size_t            group  = 0;
+        std::vector<Real> values;
+        size_t            width  = 0;
+        size_t            head   = 0;  // offset of the oldest token
+        size_t            tokens = 0;
+        bool              sized  = false;
+
+        bool        empty() const { return tokens == 0; }
+        const Real* front() const { return values.data() + head; }
+
+        void push(const Real* v, size_t n) {
+            if (!sized) { width = n; sized = true; }
+            size_t copy = std::min(n, width);
+            values.insert(values.end(), v, v + copy);
+            values.resize(values.size() + width - copy, 0.0f);
+            ++tokens;
+        }
+        void pop() {
+            head += width;
+            --tokens;
+            // Compact once the consumed part is at least half: amortized O(1)
+            if (head * 2 >= values.size()) {
+                values.erase(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(head));
+                head = 0;
+            }
+        }
+    };
+
+    // Channels with one frame and hop size, assembled into frames together
+    struct Group {
+        int                 frame_size = 0;
+        int                 hop_size   = 0;
+        int                 frame      = 0;  // next to emit
+        std::vector<size_t> channels;
+    };
+
+    struct Values {
+        const Real* data = nullptr;
+        size_t      size = 0;
+        explicit operator bool() const { return data != nullptr; }
+    };
+
+    size_t add_channel(const std::string& name, bool is_vector, const FramingKey& framing) {
+        static const char* const names[kFeatures] = {
+            "loudness.values", "energy.values", "spectral.centroid", "spectral.flux",
+            "spectral.complexity", "spectral.contrast", "spectral.rolloff", "spectral.hfc",
+            "spectral.mfcc", "bands.mel", "bands.bark", "bands.erb", "tonal.hpcp",
+            "tonal.dissonance", "tonal.inharmonicity", "pitch.values", "pitch.confidence",
+            "onset.detection",
+        };
+        size_t group = 0;
+        while (group < groups_.size() && (groups_[group].frame_size != framing.frame_size ||
+                                          groups_[group].hop_size != framing.hop_size)) {
+            ++group;
+        }
+        if (group == groups_.size()) groups_.push_back(Group{framing.frame_size, framing.hop_size, 0, {}});
+        size_t index = channels_.size();
+        channels_.emplace_back();
+        channels_.back().group = group;
+        groups_[group].channels.push_back(index);
+
+        for (size_t f = 0; f < kFeatures; ++f) {
+            if (name != names[f]) continue;
+            channel_of_[f] = static_cast<int>(index);
+            is_vector_[f]  = is_vector;
+            if (f == kLoudness && store_) store_->loudness_hop = framing.hop_size;
+            if (f == kMfcc) {
+                if (store_) store_->mfcc_hop = framing.hop_size;
+                if (want(EventType::SEGMENT_BOUNDARY)) {
+                    segmenter_ = std::make_unique<OnlineSegmenter>(cfg_.sample_rate, framing.hop_size);
+                    segmenter_hop_ = framing.hop_size;
+                }
+            }
+        }
+        return index;
+    }
+
+    double next_time(const Group& g) const {
+        return frame_to_time(g.frame, g.hop_size, cfg_.sample_rate);
+    }
+
+    bool ready(const Group& g) const {
+        for (size_t c : g.channels) {
+            if (channels_[c].empty()) return false;
+        }
+        return true;
+    }
+
+    // Emits frames in time order across the groups, each once all of its
+    // descriptors are in. The time of a group's next frame is known before
+    // its tokens arrive, so the earliest group is waited for while the others
+    // queue up; finish() passes over groups that will get no more tokens.
+    void drain(bool flush = false) {
+        for (;;) {
+            const Group* next = nullptr;
+            for (const auto& g : groups_) {
+                if (flush && !ready(g)) continue;
+                if (!next || next_time(g) < next_time(*next)) next = &g;
+            }
+            if (!next || !ready(*next)) return;
+            current_ = static_cast<size_t>(next - groups_.data());
+
+            Group& g = groups_[current_];
+            if (live_) {
+                // Frames are centered on their timestamp
+                uint64_t last = static_cast<uint64_t>(g.frame) * g.hop_size + g.frame_size / 2 - 1;
+                captured_ns_ = live_->captured_ns(last);
+            }
+            emit_frame();
+            for (size_t c : g.channels) channels_[c].pop();
+            if (queue_) queue_->set_analyzed(next_time(g));
+            ++g.frame;
+        }
+    }
+
+    // Frame index and hop of the group being emitted
+    int frame() const { return groups_[current_].frame; }
+    int hop() const   { return groups_[current_].hop_size; }
+
+    // Descriptors of the group being emitted; the others read as missing
+    const Channel* channel_at(Feature f) const {
+        int c = channel_of_[f];
+        if (c < 0) return nullptr;
+        const Channel& ch = channels_[static_cast<size_t>(c)];
+        return ch.group == current_ ? &ch : nullptr;
+    }
+
+    const Real* real_at(Feature f) const {
+        const Channel* ch = channel_at(f);
+        return ch && !is_vector_[f] ? ch->front() : nullptr;
+    }
+
+    Values vector_at(Feature f) const {
+        const Channel* ch = channel_at(f);
+        if (!ch || !is_vector_[f]) return {};
+        return {ch->front(), ch->width};
+    }
+
+    bool want(EventType et) const { return wanted_[static_cast<size_t>(et)]; }
+
+    // Throttle to one event per continuous_interval per type
+    bool due(EventType et, double t) {
+        double& last = last_emit_[static_cast<size_t>(et)];
+        if ((t - last) < cfg_.continuous_interval) return false;
+        last = t;
+        return true;
+    }
+
+    void emit(double t, const ::tracks::Envelope& env) {
+        if (timeline_) {
+            add_envelope(*timeline_, t, env);
+            return;
+        }
+        size_t len = env.ByteSizeLong();
+        if (len > EventQueue::kMaxBytes) {
+            throw std::length_error("Envelope does not fit an EventQueue slot");
+        }
+        EventQueue::Slot* slot = queue_->claim();
+        if (!slot) throw StreamCancelled{};
+        slot->timestamp = t;
+        slot->type      = event_type_of(env);
+        slot->length    = static_cast<uint32_t>(len);
+        slot->captured_ns = captured_ns_;
+        env.SerializeWithCachedSizesToArray(slot->data);
+        queue_->publish();
+    }
+
+    // The setters are lambdas, so each call site compiles to its own inlined
+    // kernel; want() comes first to keep unwanted types to a bit test
+    template <typename Set>
+    void throttled_real(EventType et, Feature f, double t, Set set) {
+        if (!want(et)) return;
+        const Real* v = real_at(f);
+        if (!v || !due(et, t)) return;
+        ::tracks::Envelope env; env.set_timestamp(t);
+        set(env, static_cast<double>(*v));
+        emit(t, env);
+    }
+
+    template <typename Set>
+    void throttled_vector(EventType et, Feature f, double t, Set set) {
+        if (!want(et)) return;
+        Values v = vector_at(f);
+        if (!v || !due(et, t)) return;
+        ::tracks::Envelope env; env.set_timestamp(t);
+        set(env, v);
+        emit(t, env);
+    }
+
+    // Copies a frame into a repeated float field in one reserve and copy
+    template <typename Message>
+    static void set_values(Message* m, Values v) {
+        m->mutable_values()->Add(v.data, v.data + v.size);
+    }
+
+    void init() {
+        channel_of_.fill(-1);
+        is_vector_.fill(false);
+        last_emit_.fill(-std::numeric_limits<double>::infinity());
+        for (auto et : filter_) wanted_.set(static_cast<size_t>(et));
+    }
+
+    void keep_frame();
+    void emit_boundary(int64_t frame);
+    void emit_loudness(double t);
+    void emit_novelty(double t);
+    void emit_onset();
+    void emit_frame();
+
+    const Config&      cfg_;
+    const EventFilter& filter_;
+    EventQueue*        queue_    = nullptr;  // streaming
+    Timeline*          timeline_ = nullptr;  // batch
+    Pool*              pool_     = nullptr;
+    FrameStore*        store_    = nullptr;
+
+    std::vector<Channel>                channels_;
+    std::vector<Group>                  groups_;
+    size_t                              current_ = 0;  // group being emitted
+    std::array<int, kFeatures>          channel_of_;   // -1 = not attached
+    std::array<bool, kFeatures>         is_vector_;
+    std::bitset<kEventTypeCount>            wanted_;
+    std::array<double, kEventTypeCount>     last_emit_;
+    LiveInput*                          live_ = nullptr;
+    int64_t                             captured_ns_ = 0;  // of the frame being emitted
+
+    // Running state for the change detectors
+    Real                max_loudness_ = 0.0f;
+    Real                loudness_[2]  = {0.0f, 0.0f};  // frames i-2, i-1
+    std::vector<Real>   prev_mfcc_;
+    std::vector<double> log_mel_, prev_log_mel_;       // log-compressed mel bands
+    double              novelty_peak_ = 0.0;
+    double              odf_[2]       = {0.0, 0.0};    // onset detection, frames i-2, i-1
+    std::vector<double> odf_window_;                   // kOnsetWindow before frame i-1, a ring
+    size_t              odf_next_     = 0;
+    double              odf_sum_      = 0.0;           // of the window, and of its squares
+    double              odf_sq_sum_   = 0.0;
+    double              odf_max_      = 0.0;
+    double              last_onset_   = -std::numeric_limits<double>::infinity();
+    Real                prev_pitch_   = 0.0f;
+    std::unique_ptr<OnlineSegmenter> segmenter_;
+    int                              segmenter_hop_ = 0;
+};
+
+// Streaming sink that forwards each token to a FrameAssembler channel
+template <typename T>
+class FrameTap : public Algorithm {
+public:
+    FrameTap(FrameAssembler& owner, size_t channel) : owner_(owner), channel_(channel) {
+        setName("FrameTap");
+        declareInput(input_, 1, "data", "one descriptor value per frame");
+    }
+
+    AlgorithmStatus process() override {
+        AlgorithmStatus status = acquireData();
+        if (status != OK) return status;
+        owner_.push(channel_, input_.firstToken());
+        releaseData();
+        return OK;
+    }
+
+    void declareParameters() override {}
+
+private:
+    Sink<T>         input_;
+    FrameAssembler& owner_;
+    size_t          channel_;
+};
+
+void FrameAssembler::real(SourceBase& src, const std::string& name, const FramingKey& framing) {
+    src >> (new FrameTap<Real>(*this, add_channel(name, false, framing)))->input("data");
 }
 
-// --- Pass: Loudness & Energy (frame-level) ---
+void FrameAssembler::vector(SourceBase& src, const std::string& name, const FramingKey& framing) {
+    src >> (new FrameTap<std::vector<Real>>(*this, add_channel(name, true, framing)))->input("data");
+}
+
+void FrameAssembler::keep_frame() {
+    if (store_->keep_loudness) {
+        if (const Real* v = real_at(kLoudness)) store_->loudness.push_back(*v);
+    }
+    if (store_->keep_mfcc) {
+        // The channel is rectangular already
+        if (Values v = vector_at(kMfcc)) {
+            store_->mfcc_size = v.size;
+            store_->mfcc.insert(store_->mfcc.end(), v.data, v.data + v.size);
+        }
+    }
+}
+
+void FrameAssembler::emit_boundary(int64_t frame) {
+    if (frame < 0) return;
+    double t = frame_to_time(static_cast<int>(frame), segmenter_hop_, cfg_.sample_rate);
+    if (store_) {
+        store_->boundaries.push_back(t);
+        return;
+    }
+    ::tracks::Envelope env; env.set_timestamp(t);
+    env.mutable_segment_boundary();
+    emit(t, env);
+}
+
+void FrameAssembler::finish() {
+    drain(true);
+    if (segmenter_) emit_boundary(segmenter_->finish());
+}
+
+void FrameAssembler::emit_loudness(double t) {
+    const Real* v = real_at(kLoudness);
+    if (!v) return;
+    Real value = *v;
+    max_loudness_ = std::max(max_loudness_, value);
+
+    // Local maximum at the previous frame, now that its successor is known
+    if (want(EventType::LOUDNESS_PEAK) && frame() >= 2) {
+        Real peak = loudness_[1];
+        if (peak > loudness_[0] && peak > value && peak >= max_loudness_ * 0.9f) {
+            double pt = frame_to_time(frame() - 1, hop(), cfg_.sample_rate);
+            ::tracks::Envelope env; env.set_timestamp(pt);
+            env.mutable_loudness_peak()->set_value(static_cast<double>(peak));
+            emit(pt, env);
+        }
+    }
+
+    if (want(EventType::LOUDNESS) && due(EventType::LOUDNESS, t)) {
+        ::tracks::Envelope env; env.set_timestamp(t);
+        env.mutable_loudness()->set_value(static_cast<double>(value));
+        emit(t, env);
+    }
 
-static void run_loudness_energy_pass(const Config& cfg, Pool& pool) {
+    if (want(EventType::DYNAMIC_CHANGE) && frame() > 0) {
+        double diff = std::abs(static_cast<double>(value) - static_cast<double>(loudness_[1]));
+        double mag_thresh = static_cast<double>(max_loudness_) * 0.3;
+        if (mag_thresh > 0.0 && diff > mag_thresh) {
+            ::tracks::Envelope env; env.set_timestamp(t);
+            env.mutable_dynamic_change()->set_magnitude(diff);
+            emit(t, env);
+        }
+    }
+
+    loudness_[0] = loudness_[1];
+    loudness_[1] = value;
+}
+
+// novelty: the half-wave rectified rise of the log-compressed mel bands
+// from one frame to the next (the detection function of NoveltyCurve).
+// It is peaky, so each event carries the maximum since the previous one
+// rather than a sample of it.
+// Each frame's bands are compressed once and kept for the next one.
+void FrameAssembler::emit_novelty(double t) {
+    if (!want(EventType::NOVELTY)) return;
+    Values mel = vector_at(kMel);
+    if (!mel) return;
+
+    log_mel_.resize(mel.size);
+    for (size_t b = 0; b < mel.size; ++b) {
+        log_mel_[b] = std::log1p(1000.0 * static_cast<double>(mel.data[b]));
+    }
+    if (!prev_log_mel_.empty()) {
+        double novelty = rectified_rise(log_mel_.data(), prev_log_mel_.data(),
+                                        std::min(log_mel_.size(), prev_log_mel_.size()));
+        novelty_peak_ = std::max(novelty_peak_, novelty);
+
+        if (due(EventType::NOVELTY, t)) {
+            ::tracks::Envelope env; env.set_timestamp(t);
+            env.mutable_novelty()->set_value(novelty_peak_);
+            emit(t, env);
+            novelty_peak_ = 0.0;
+        }
+    }
+    log_mel_.swap(prev_log_mel_);
+}
+
+// onset (streaming and live): causal peak picking on the OnsetDetection
+// function. Frame i-1 is an onset once frame i shows it was a local maximum
+// more than kOnsetDeviations standard deviations above the mean of the
+// kOnsetWindow seconds before it, and above a small fraction of the
+// largest value so far, which keeps noise in quiet passages out. Nothing
+// is picked until kOnsetWarmup seconds are in the window, and of onsets
+// closer than kOnsetMinInterval the first is kept. Strength is the peak
+// over that largest value.
+static constexpr double kOnsetWindow      = 0.5;   // seconds
+static constexpr double kOnsetWarmup      = 0.1;   // seconds
+static constexpr double kOnsetDeviations  = 2.0;
+static constexpr double kOnsetFloor       = 0.05;  // of the running maximum
+static constexpr double kOnsetMinInterval = 0.05;  // seconds
+
+void FrameAssembler::emit_onset() {
+    if (!want(EventType::ONSET)) return;
+    const Real* v = real_at(kOnsetDetection);
+    if (!v) return;
+    double value = static_cast<double>(*v);
+    const double frames_per_second = cfg_.sample_rate / static_cast<double>(hop());
+    if (odf_window_.empty()) {
+        auto frames = static_cast<size_t>(kOnsetWindow * frames_per_second);
+        odf_window_.assign(std::max<size_t>(frames, 2), 0.0);
+    }
+
+    if (frame() >= 2) {
+        // Frame i-2 joins the window, which now ends just before the candidate
+        double& slot = odf_window_[odf_next_];
+        odf_sum_    += odf_[0] - slot;
+        odf_sq_sum_ += odf_[0] * odf_[0] - slot * slot;
+        slot         = odf_[0];
+        odf_next_    = (odf_next_ + 1) % odf_window_.size();
+
+        double peak = odf_[1];
+        size_t seen = std::min(static_cast<size_t>(frame() - 1), odf_window_.size());
+        double mean = odf_sum_ / static_cast<double>(seen);
+        double var  = std::max(odf_sq_sum_ / static_cast<double>(seen) - mean * mean, 0.0);
+        double pt   = frame_to_time(frame() - 1, hop(), cfg_.sample_rate);
+        bool warm   = static_cast<double>(seen) >= std::max(kOnsetWarmup * frames_per_second, 2.0);
+        if (warm && peak > odf_[0] && peak >= value &&
+            peak > mean + kOnsetDeviations * std::sqrt(var) &&
+            peak > kOnsetFloor * odf_max_ && pt - last_onset_ >= kOnsetMinInterval) {
+            ::tracks::Envelope env; env.set_timestamp(pt);
+            env.mutable_onset()->set_strength(odf_max_ > 0.0 ? std::min(peak / odf_max_, 1.0) : 1.0);
+            emit(pt, env);
+            last_onset_ = pt;
+        }
+    }
+
+    odf_max_ = std::max(odf_max_, value);
+    odf_[0]  = odf_[1];
+    odf_[1]  = value;
+}
+
+void FrameAssembler::emit_frame() {
+    double t = frame_to_time(frame(), hop(), cfg_.sample_rate);
+
+    if (store_) keep_frame();
+    emit_loudness(t);
+    throttled_real(EventType::ENERGY, kEnergy, t,
+        [](::tracks::Envelope& env, double v) { env.mutable_energy()->set_value(v); });
+
+    throttled_real(EventType::SPECTRAL_CENTROID, kCentroid, t,
+        [](::tracks::Envelope& env, double v) { env.mutable_spectral_centroid()->set_value(v); });
+    throttled_real(EventType::SPECTRAL_FLUX, kFlux, t,
+        [](::tracks::Envelope& env, double v) { env.mutable_spectral_flux()->set_value(v); });
+    throttled_real(EventType::SPECTRAL_COMPLEXITY, kComplexity, t,
+        [](::tracks::Envelope& env, double v) { env.mutable_spectral_complexity()->set_value(v); });
+    throttled_vector(EventType::SPECTRAL_CONTRAST, kContrast, t,
+        [](::tracks::Envelope& env, Values v) { set_values(env.mutable_spectral_contrast(), v); });
+    throttled_real(EventType::SPECTRAL_ROLLOFF, kRolloff, t,
+        [](::tracks::Envelope& env, double v) { env.mutable_spectral_rolloff()->set_value(v); });
+    throttled_real(EventType::HFC, kHfc, t,
+        [](::tracks::Envelope& env, double v) { env.mutable_hfc()->set_value(v); });
+    throttled_vector(EventType::MFCC, kMfcc, t,
+        [](::tracks::Envelope& env, Values v) { set_values(env.mutable_mfcc(), v); });
+
+    // TimbreChange — Euclidean MFCC distance to the previous frame
+    if (Values mfcc = vector_at(kMfcc)) {
+        if (want(EventType::TIMBRE_CHANGE) && !prev_mfcc_.empty()) {
+            size_t n = std::min(mfcc.size, prev_mfcc_.size());
+            double dist = std::sqrt(squared_distance(mfcc.data, prev_mfcc_.data(), n));
+            if (dist > 50.0) {
+                ::tracks::Envelope env; env.set_timestamp(t);
+                env.mutable_timbre_change()->set_distance(dist);
+                emit(t, env);
+            }
+        }
+        prev_mfcc_.assign(mfcc.data, mfcc.data + mfcc.size);
+        if (segmenter_) emit_boundary(segmenter_->push(mfcc.data, mfcc.size));
+    }
+
+    emit_novelty(t);
+    emit_onset();
+    throttled_vector(EventType::BANDS_MEL, kMel, t,
+        [](::tracks::Envelope& env, Values v) { set_values(env.mutable_bands_mel(), v); });
+    throttled_vector(EventType::BANDS_BARK, kBark, t,
+        [](::tracks::Envelope& env, Values v) { set_values(env.mutable_bands_bark(), v); });
+    throttled_vector(EventType::BANDS_ERB, kErb, t,
+        [](::tracks::Envelope& env, Values v) { set_values(env.mutable_bands_erb(), v); });
+
+    throttled_vector(EventType::CHROMA, kHpcp, t,
+        [](::tracks::Envelope& env, Values v) { set_values(env.mutable_chroma(), v); });
+    throttled_real(EventType::DISSONANCE, kDissonance, t,
+        [](::tracks::Envelope& env, double v) { env.mutable_dissonance()->set_value(v); });
+    throttled_real(EventType::INHARMONICITY, kInharmonicity, t,
+        [](::tracks::Envelope& env, double v) { env.mutable_inharmonicity()->set_value(v); });
+
+    // Pitch (voiced above 0.3 confidence) and pitch changes (above 0.5)
+    const Real* freq_p = real_at(kPitch);
+    const Real* conf_p = real_at(kPitchConfidence);
+    if (freq_p && conf_p) {
+        Real freq = *freq_p;
+        Real conf = *conf_p;
+
+        if (want(EventType::PITCH) && conf > 0.3f && due(EventType::PITCH, t)) {
+            ::tracks::Envelope env; env.set_timestamp(t);
+            auto* p = env.mutable_pitch();
+            p->set_frequency(static_cast<double>(freq));
+            p->set_confidence(static_cast<double>(conf));
+            emit(t, env);
+        }
+
+        if (want(EventType::PITCH_CHANGE) && frame() > 0 && conf > 0.5f &&
+            prev_pitch_ > 0.0f && freq > 0.0f) {
+            double ratio = static_cast<double>(freq) / static_cast<double>(prev_pitch_);
+            if (ratio > 1.06 || ratio < 0.94) {
+                ::tracks::Envelope env; env.set_timestamp(t);
+                auto* pc = env.mutable_pitch_change();
+                pc->set_from_hz(static_cast<double>(prev_pitch_));
+                pc->set_to_hz(static_cast<double>(freq));
+                emit(t, env);
+            }
+        }
+
+        if (conf > 0.3f) prev_pitch_ = freq;
+    }
+}
+
+// --- Frame consumers: Silence detection ---
+
+static void attach_silence(FramePlan& plan, const Config& cfg, FeatureSink& out) {
     auto& factory = streaming::AlgorithmFactory::instance();
+    FramingKey framing = framing_for(cfg, "silence", "keep");
 
-    Algorithm* loader = factory.create("MonoLoader",
-        "filename", cfg.input_file,
-        "sampleRate", Real(cfg.sample_rate));
+    Algorithm* silence = factory.create("StartStopSilence",
+        "threshold", -60);
 
-    Algorithm* frameCutter = factory.create("FrameCutter",
-        "frameSize", cfg.frame_size,
-        "hopSize", cfg.hop_size,
-        "silentFrames", std::string("keep"));
+    plan.frames(framing)           >> silence->input("frame");
+    out.store(silence->output("startFrame"), "silence.startFrame");
+    out.store(silence->output("stopFrame"), "silence.stopFrame");
+}
+
+// --- Frame consumers: Loudness & Energy (frame-level) ---
+
+static void attach_loudness_energy(FramePlan& plan, const Config& cfg, FeatureSink& out) {
+    auto& factory = streaming::AlgorithmFactory::instance();
+    FramingKey framing = framing_for(cfg, "loudness", "keep");
 
     Algorithm* loudness = factory.create("Loudness");
     Algorithm* energy   = factory.create("Energy");
 
-    loader->output("audio")        >> frameCutter->input("signal");
-    frameCutter->output("frame")   >> loudness->input("signal");
-    frameCutter->output("frame")   >> energy->input("array");
-    loudness->output("loudness")   >> PC(pool, "loudness.values");
-    energy->output("energy")       >> PC(pool, "energy.values");
-
-    std::cout << "  Analyzing loudness & energy..." << std::endl;
-    Network network(loader);
-    network.run();
+    plan.frames(framing)           >> loudness->input("signal");
+    plan.frames(framing)           >> energy->input("array");
+    out.real(loudness->output("loudness"), "loudness.values", framing);
+    out.real(energy->output("energy"), "energy.values", framing);
 }
 
-// --- Pass: Spectral analysis (big combined pass) ---
-// MonoLoader -> FrameCutter -> Windowing -> Spectrum
+// --- Frame consumers: Spectral analysis ---
+// FrameCutter -> Windowing -> Spectrum
 // Then fan out to: MFCC, MelBands, BarkBands, ERBBands,
 //   SpectralComplexity, SpectralContrast, Flux, RollOff, HFC,
 //   SpectralPeaks -> HPCP -> Key + ChordsDetection
-//   SpectralPeaks -> Dissonance, Inharmonicity
+//                 -> Dissonance, Inharmonicity
 //   PitchYinFFT
 // Also: SpectralCentroidTime from frames (time-domain)
+// The SpectralPeaks branch is framed at the tonal resolution and PitchYinFFT
+// at the pitch one; with the defaults all three share one spectrum.
 
-static void run_spectral_pass(const Config& cfg, Pool& pool, const EventFilter& filter) {
+static void attach_spectral(FramePlan& plan, const Config& cfg, FeatureSink& out,
+                            const EventFilter& filter) {
     auto& factory = streaming::AlgorithmFactory::instance();
+    FramingKey framing = framing_for(cfg, "spectral", "noise");
+    FramingKey tonal   = framing_for(cfg, "tonal", "noise");
+    FramingKey pitch   = framing_for(cfg, "pitch", "noise");
 
-    int spectrumSize = cfg.frame_size / 2 + 1;
-
-    Algorithm* loader = factory.create("MonoLoader",
-        "filename", cfg.input_file,
-        "sampleRate", Real(cfg.sample_rate));
-
-    Algorithm* frameCutter = factory.create("FrameCutter",
-        "frameSize", cfg.frame_size,
-        "hopSize", cfg.hop_size,
-        "silentFrames", std::string("noise"));
-
-    Algorithm* windowing = factory.create("Windowing",
-        "type", std::string("hann"));
-
-    Algorithm* spectrum = factory.create("Spectrum");
-
-    loader->output("audio")      >> frameCutter->input("signal");
-    frameCutter->output("frame") >> windowing->input("frame");
-    windowing->output("frame")   >> spectrum->input("frame");
+    int spectrumSize = framing.frame_size / 2 + 1;
 
     // SpectralCentroidTime operates on time-domain frames
     bool want_centroid = filter.count(EventType::SPECTRAL_CENTROID);
@@ -173,8 +1120,8 @@ static void run_spectral_pass(const Config& cfg, Pool& pool, const EventFilter&
     if (want_centroid) {
         centroid = factory.create("SpectralCentroidTime",
             "sampleRate", Real(cfg.sample_rate));
-        frameCutter->output("frame") >> centroid->input("array");
-        centroid->output("centroid")  >> PC(pool, "spectral.centroid");
+        plan.frames(framing)          >> centroid->input("array");
+        out.real(centroid->output("centroid"), "spectral.centroid", framing);
     }
 
     // --- Spectrum consumers ---
@@ -187,20 +1134,20 @@ static void run_spectral_pass(const Config& cfg, Pool& pool, const EventFilter&
         mfcc = factory.create("MFCC",
             "inputSize", spectrumSize,
             "sampleRate", Real(cfg.sample_rate));
-        spectrum->output("spectrum") >> mfcc->input("spectrum");
-        mfcc->output("mfcc")  >> PC(pool, "spectral.mfcc");
+        plan.spectrum(framing) >> mfcc->input("spectrum");
+        out.vector(mfcc->output("mfcc"), "spectral.mfcc", framing);
         mfcc->output("bands") >> NOWHERE;
     }
 
-    // MelBands
-    bool want_mel = filter.count(EventType::BANDS_MEL);
+    // MelBands (also the novelty curve)
+    bool want_mel = needs_any(filter, {EventType::BANDS_MEL, EventType::NOVELTY});
     Algorithm* melBands = nullptr;
     if (want_mel) {
         melBands = factory.create("MelBands",
             "inputSize", spectrumSize,
             "sampleRate", Real(cfg.sample_rate));
-        spectrum->output("spectrum") >> melBands->input("spectrum");
-        melBands->output("bands")    >> PC(pool, "bands.mel");
+        plan.spectrum(framing)       >> melBands->input("spectrum");
+        out.vector(melBands->output("bands"), "bands.mel", framing);
     }
 
     // BarkBands
@@ -209,8 +1156,8 @@ static void run_spectral_pass(const Config& cfg, Pool& pool, const EventFilter&
     if (want_bark) {
         barkBands = factory.create("BarkBands",
             "sampleRate", Real(cfg.sample_rate));
-        spectrum->output("spectrum") >> barkBands->input("spectrum");
-        barkBands->output("bands")   >> PC(pool, "bands.bark");
+        plan.spectrum(framing)       >> barkBands->input("spectrum");
+        out.vector(barkBands->output("bands"), "bands.bark", framing);
     }
 
     // ERBBands
@@ -220,8 +1167,8 @@ static void run_spectral_pass(const Config& cfg, Pool& pool, const EventFilter&
         erbBands = factory.create("ERBBands",
             "inputSize", spectrumSize,
             "sampleRate", Real(cfg.sample_rate));
-        spectrum->output("spectrum") >> erbBands->input("spectrum");
-        erbBands->output("bands")    >> PC(pool, "bands.erb");
+        plan.spectrum(framing)       >> erbBands->input("spectrum");
+        out.vector(erbBands->output("bands"), "bands.erb", framing);
     }
 
     // SpectralComplexity
@@ -230,8 +1177,8 @@ static void run_spectral_pass(const Config& cfg, Pool& pool, const EventFilter&
     if (want_complexity) {
         complexity = factory.create("SpectralComplexity",
             "sampleRate", Real(cfg.sample_rate));
-        spectrum->output("spectrum")         >> complexity->input("spectrum");
-        complexity->output("spectralComplexity") >> PC(pool, "spectral.complexity");
+        plan.spectrum(framing)                   >> complexity->input("spectrum");
+        out.real(complexity->output("spectralComplexity"), "spectral.complexity", framing);
     }
 
     // SpectralContrast
@@ -239,9 +1186,10 @@ static void run_spectral_pass(const Config& cfg, Pool& pool, const EventFilter&
     Algorithm* contrast = nullptr;
     if (want_contrast) {
         contrast = factory.create("SpectralContrast",
+            "frameSize", framing.frame_size,
             "sampleRate", Real(cfg.sample_rate));
-        spectrum->output("spectrum")            >> contrast->input("spectrum");
-        contrast->output("spectralContrast")    >> PC(pool, "spectral.contrast");
+        plan.spectrum(framing)                  >> contrast->input("spectrum");
+        out.vector(contrast->output("spectralContrast"), "spectral.contrast", framing);
         contrast->output("spectralValley")      >> NOWHERE;
     }
 
@@ -250,8 +1198,8 @@ static void run_spectral_pass(const Config& cfg, Pool& pool, const EventFilter&
     Algorithm* flux = nullptr;
     if (want_flux) {
         flux = factory.create("Flux");
-        spectrum->output("spectrum") >> flux->input("spectrum");
-        flux->output("flux")         >> PC(pool, "spectral.flux");
+        plan.spectrum(framing)       >> flux->input("spectrum");
+        out.real(flux->output("flux"), "spectral.flux", framing);
     }
 
     // RollOff
@@ -260,8 +1208,8 @@ static void run_spectral_pass(const Config& cfg, Pool& pool, const EventFilter&
     if (want_rolloff) {
         rolloff = factory.create("RollOff",
             "sampleRate", Real(cfg.sample_rate));
-        spectrum->output("spectrum") >> rolloff->input("spectrum");
-        rolloff->output("rollOff")   >> PC(pool, "spectral.rolloff");
+        plan.spectrum(framing)       >> rolloff->input("spectrum");
+        out.real(rolloff->output("rollOff"), "spectral.rolloff", framing);
     }
 
     // HFC
@@ -270,13 +1218,13 @@ static void run_spectral_pass(const Config& cfg, Pool& pool, const EventFilter&
     if (want_hfc) {
         hfcAlgo = factory.create("HFC",
             "sampleRate", Real(cfg.sample_rate));
-        spectrum->output("spectrum") >> hfcAlgo->input("spectrum");
-        hfcAlgo->output("hfc")       >> PC(pool, "spectral.hfc");
+        plan.spectrum(framing)       >> hfcAlgo->input("spectrum");
+        out.real(hfcAlgo->output("hfc"), "spectral.hfc", framing);
     }
 
-    // SpectralPeaks — needed for HPCP, Dissonance, Inharmonicity
-    // Note: Dissonance and Inharmonicity crash on 0 Hz peaks, so we use a
-    // separate SpectralPeaks with minFrequency for those.
+    // SpectralPeaks — one instance feeds HPCP, Dissonance and Inharmonicity.
+    // Dissonance and Inharmonicity crash on 0 Hz peaks, hence minFrequency;
+    // HPCP ignores everything below its own 40 Hz minFrequency anyway.
     bool want_hpcp = needs_any(filter, {EventType::CHROMA, EventType::KEY_CHANGE,
                                          EventType::CHORD_CHANGE, EventType::TUNING});
     bool want_diss_inharm = needs_any(filter, {EventType::DISSONANCE, EventType::INHARMONICITY});
@@ -284,62 +1232,48 @@ static void run_spectral_pass(const Config& cfg, Pool& pool, const EventFilter&
 
     if (want_peaks) {
         Algorithm* spectralPeaks = factory.create("SpectralPeaks",
-            "sampleRate", Real(cfg.sample_rate));
-        spectrum->output("spectrum") >> spectralPeaks->input("spectrum");
+            "sampleRate", Real(cfg.sample_rate),
+            "minFrequency", Real(20.0));
+        plan.spectrum(tonal)         >> spectralPeaks->input("spectrum");
 
         if (want_hpcp) {
             Algorithm* hpcp = factory.create("HPCP");
             spectralPeaks->output("frequencies") >> hpcp->input("frequencies");
             spectralPeaks->output("magnitudes")  >> hpcp->input("magnitudes");
-            hpcp->output("hpcp")                 >> PC(pool, "tonal.hpcp");
+            out.vector(hpcp->output("hpcp"), "tonal.hpcp", tonal);
 
             // Key (streaming composite — accumulates HPCPs internally)
             if (needs_any(filter, {EventType::KEY_CHANGE})) {
                 Algorithm* key = factory.create("Key");
                 hpcp->output("hpcp")    >> key->input("pcp");
-                key->output("key")      >> PC(pool, "tonal.key");
-                key->output("scale")    >> PC(pool, "tonal.scale");
-                key->output("strength") >> PC(pool, "tonal.keyStrength");
+                out.store(key->output("key"), "tonal.key");
+                out.store(key->output("scale"), "tonal.scale");
+                out.store(key->output("strength"), "tonal.keyStrength");
             }
 
             // ChordsDetection
             if (filter.count(EventType::CHORD_CHANGE)) {
                 Algorithm* chords = factory.create("ChordsDetection",
                     "sampleRate", Real(cfg.sample_rate),
-                    "hopSize", cfg.hop_size);
+                    "hopSize", tonal.hop_size);
                 hpcp->output("hpcp")         >> chords->input("pcp");
-                chords->output("chords")     >> PC(pool, "tonal.chords");
-                chords->output("strength")   >> PC(pool, "tonal.chordStrength");
+                out.store(chords->output("chords"), "tonal.chords");
+                out.store(chords->output("strength"), "tonal.chordStrength");
             }
         }
 
-        if (!want_hpcp) {
-            // Still need to sink the peaks outputs if HPCP doesn't consume them
-            spectralPeaks->output("frequencies") >> NOWHERE;
-            spectralPeaks->output("magnitudes")  >> NOWHERE;
+        if (filter.count(EventType::DISSONANCE)) {
+            Algorithm* diss = factory.create("Dissonance");
+            spectralPeaks->output("frequencies") >> diss->input("frequencies");
+            spectralPeaks->output("magnitudes")  >> diss->input("magnitudes");
+            out.real(diss->output("dissonance"), "tonal.dissonance", tonal);
         }
 
-        // Dissonance & Inharmonicity use a filtered SpectralPeaks (minFrequency > 0)
-        if (want_diss_inharm) {
-            Algorithm* filteredPeaks = factory.create("SpectralPeaks",
-                "sampleRate", Real(cfg.sample_rate),
-                "minFrequency", Real(20.0));
-            spectrum->output("spectrum") >> filteredPeaks->input("spectrum");
-
-            if (filter.count(EventType::DISSONANCE)) {
-                Algorithm* diss = factory.create("Dissonance");
-                filteredPeaks->output("frequencies") >> diss->input("frequencies");
-                filteredPeaks->output("magnitudes")  >> diss->input("magnitudes");
-                diss->output("dissonance")           >> PC(pool, "tonal.dissonance");
-            }
-
-            if (filter.count(EventType::INHARMONICITY)) {
-                Algorithm* inharm = factory.create("Inharmonicity");
-                filteredPeaks->output("frequencies") >> inharm->input("frequencies");
-                filteredPeaks->output("magnitudes")  >> inharm->input("magnitudes");
-                inharm->output("inharmonicity")      >> PC(pool, "tonal.inharmonicity");
-            }
-
+        if (filter.count(EventType::INHARMONICITY)) {
+            Algorithm* inharm = factory.create("Inharmonicity");
+            spectralPeaks->output("frequencies") >> inharm->input("frequencies");
+            spectralPeaks->output("magnitudes")  >> inharm->input("magnitudes");
+            out.real(inharm->output("inharmonicity"), "tonal.inharmonicity", tonal);
         }
     }
 
@@ -348,58 +1282,202 @@ static void run_spectral_pass(const Config& cfg, Pool& pool, const EventFilter&
     Algorithm* pitchYin = nullptr;
     if (want_pitch) {
         pitchYin = factory.create("PitchYinFFT",
+            "frameSize", pitch.frame_size,
             "sampleRate", Real(cfg.sample_rate));
-        spectrum->output("spectrum")        >> pitchYin->input("spectrum");
-        pitchYin->output("pitch")           >> PC(pool, "pitch.values");
-        pitchYin->output("pitchConfidence") >> PC(pool, "pitch.confidence");
+        plan.spectrum(pitch)                >> pitchYin->input("spectrum");
+        out.real(pitchYin->output("pitch"), "pitch.values", pitch);
+        out.real(pitchYin->output("pitchConfidence"), "pitch.confidence", pitch);
     }
+}
 
-    // If spectrum has no consumers at all, sink it
-    bool spectrum_has_consumer = want_mfcc || want_mel || want_bark || want_erb ||
-        want_complexity || want_contrast || want_flux || want_rolloff || want_hfc ||
-        want_peaks || want_pitch || want_diss_inharm;
-    if (!spectrum_has_consumer) {
-        spectrum->output("spectrum") >> NOWHERE;
+// --- Frame consumers: Onset detection (streaming and live) ---
+// The complex-domain OnsetDetection function, framed at the spectral
+// resolution; the FrameAssembler picks its peaks as frames arrive. Batch
+// analysis takes onsets from the whole-file OnsetRate pass instead.
+
+static void attach_onset(FramePlan& plan, const Config& cfg, FeatureSink& out) {
+    auto& factory = streaming::AlgorithmFactory::instance();
+    FramingKey framing = framing_for(cfg, "spectral", "noise");
+
+    Algorithm& polar     = plan.polar(framing);
+    Algorithm* detection = factory.create("OnsetDetection",
+        "method", std::string("complex"),
+        "sampleRate", Real(cfg.sample_rate));
+    polar.output("magnitude") >> detection->input("spectrum");
+    polar.output("phase")     >> detection->input("phase");
+    out.real(detection->output("onsetDetection"), "onset.detection", framing);
+}
+
+// --- PCM consumer: Time-domain signal scan ---
+// Hands the PCM stream to a SignalScanner in the chunks it arrives in, so
+// the scan rides on the frame network's decode.
+
+class ScanTap : public Algorithm {
+public:
+    explicit ScanTap(SignalScanner& scanner) : scanner_(scanner) {
+        setName("ScanTap");
+        declareInput(input_, 1, "signal", "mono PCM");
     }
 
-    std::cout << "  Analyzing spectral features..." << std::endl;
-    Network network(loader);
+    AlgorithmStatus process() override {
+        int n = std::min(input_.available(), kSourceChunk);
+        if (n == 0) return NO_INPUT;
+        input_.setAcquireSize(n);
+        input_.setReleaseSize(n);
+        AlgorithmStatus status = acquireData();
+        if (status != OK) return status;
+        scanner_.process(input_.tokens().data(), static_cast<size_t>(n));
+        releaseData();
+        return OK;
+    }
+
+    void declareParameters() override {}
+
+private:
+    Sink<Real>     input_;
+    SignalScanner& scanner_;
+};
+
+static void attach_signal_scan(FramePlan& plan, SignalScanner& scanner) {
+    plan.pcm() >> (new ScanTap(scanner))->input("signal");
+}
+
+// --- Pass: Frame-based features (silence, loudness/energy, spectral, scan) ---
+// Frame-local events go straight to `events`, stamped by frame, so a frame
+// past the end of the signal may leave some after `duration`. loudness,
+// loudness.peak and dynamic.change need the track maximum and are built
+// afterwards from store.loudness, and segment.boundary from store.boundaries
+// (online) or store.mfcc (SBic).
+
+static void run_frame_pass(const Config& cfg, const AudioSource& audio, Pool& pool,
+                           const EventFilter& filter, SignalScanner* scanner,
+                           Timeline& events, FrameStore& store) {
+    std::unique_lock<std::mutex> lock(g_build_mutex);
+    FramePlan plan(audio);
+
+    EventFilter direct = filter;
+    for (auto et : {EventType::LOUDNESS, EventType::LOUDNESS_PEAK, EventType::DYNAMIC_CHANGE}) {
+        if (direct.erase(et)) store.keep_loudness = true;
+    }
+    if (cfg.segmentation == "sbic" && direct.erase(EventType::SEGMENT_BOUNDARY)) {
+        store.keep_mfcc = true;
+    }
+    FrameAssembler out(cfg, direct, events, pool, store);
+
+    if (needs_any(filter, {EventType::SILENCE_START, EventType::SILENCE_END, EventType::GAP})) {
+        attach_silence(plan, cfg, out);
+    }
+    if (needs_any(filter, {EventType::LOUDNESS, EventType::LOUDNESS_PEAK, EventType::ENERGY,
+                           EventType::DYNAMIC_CHANGE})) {
+        attach_loudness_energy(plan, cfg, out);
+    }
+    if (needs_spectral(filter)) {
+        attach_spectral(plan, cfg, out, filter);
+    }
+    if (scanner) {
+        attach_signal_scan(plan, *scanner);
+    }
+
+    log_progress("  Analyzing frame features...");
+    Network network(plan.source());
+    lock.unlock();
     network.run();
+    out.finish();
+    if (scanner) scanner->finish();
 }
 
 // --- Pass: Melody (PredominantPitchMelodia) ---
 
-static void run_melody_pass(const Config& cfg, Pool& pool) {
+static void run_melody_pass(const Config& cfg, const AudioSource& audio, Pool& pool) {
+    std::unique_lock<std::mutex> lock(g_build_mutex);
     auto& factory = streaming::AlgorithmFactory::instance();
 
-    Algorithm* loader = factory.create("MonoLoader",
-        "filename", cfg.input_file,
-        "sampleRate", Real(cfg.sample_rate));
+    Algorithm* source = create_source(audio);
 
+    Resolution r = resolution(cfg, "melody");
     Algorithm* melody = factory.create("PredominantPitchMelodia",
         "sampleRate", Real(cfg.sample_rate),
-        "frameSize", cfg.frame_size,
-        "hopSize", cfg.hop_size);
+        "frameSize", r.frame_size,
+        "hopSize", r.hop_size);
 
-    loader->output("audio")              >> melody->input("signal");
+    SourceBase& pcm = audio_output(audio, source);
+    pcm                                  >> melody->input("signal");
     melody->output("pitch")              >> PC(pool, "melody.pitch");
     melody->output("pitchConfidence")    >> PC(pool, "melody.confidence");
 
-    std::cout << "  Analyzing melody..." << std::endl;
-    Network network(loader);
+    log_progress("  Analyzing melody...");
+    Network network(source);
+    lock.unlock();
     network.run();
 }
 
-// --- Build timeline from pool data ---
+// --- Pass scheduling ---
+// Passes build independent networks, so they run on a small pool of worker
+// threads, each writing into its own Pool. The pools are merged once every
+// pass has finished.
+
+using PassFn = std::function<void(Pool&)>;
+
+struct Pass {
+    std::string name;  // stage name in the stats ("pass.beat", ...)
+    PassFn      fn;
+};
+
+static int resolve_jobs(int jobs) {
+    if (jobs > 0) return jobs;
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? static_cast<int>(hw) : 1;
+}
+
+// Appends each pass's timings to `stages`, in queue order
+static void run_passes(const std::vector<Pass>& passes, int jobs, Pool& pool,
+                       std::vector<StageStats>& stages) {
+    if (passes.empty()) return;
+
+    std::vector<Pool> pools(passes.size());
+    std::vector<StageStats> timings(passes.size());
+    std::vector<std::exception_ptr> errors(passes.size());
+    std::atomic<size_t> next{0};
+
+    auto worker = [&]() {
+        for (size_t i = next++; i < passes.size(); i = next++) {
+            try {
+                StageTimer timer;
+                passes[i].fn(pools[i]);
+                timings[i] = timer.finish(passes[i].name);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    size_t n_threads = std::min(static_cast<size_t>(resolve_jobs(jobs)), passes.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < n_threads; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : threads) t.join();
+
+    for (auto& e : errors) {
+        if (e) std::rethrow_exception(e);
+    }
+    for (auto& p : pools) {
+        pool.merge(p);
+    }
+    stages.insert(stages.end(), timings.begin(), timings.end());
+}
+
+// --- Build whole-file events (from pool data and the frame store) ---
 
 static void build_beat_events(const Pool& pool, const EventFilter& filter, Timeline& tl) {
     if (!filter.count(EventType::BEAT)) return;
     if (!pool.contains<std::vector<Real>>("rhythm.ticks")) return;
 
     const auto& ticks = pool.value<std::vector<Real>>("rhythm.ticks");
-    std::vector<Real> confidences;
+    const std::vector<Real>* confidences = nullptr;
     if (pool.contains<std::vector<Real>>("rhythm.confidence")) {
-        confidences = pool.value<std::vector<Real>>("rhythm.confidence");
+        confidences = &pool.value<std::vector<Real>>("rhythm.confidence");
     }
 
     for (size_t i = 0; i < ticks.size(); ++i) {
@@ -407,12 +1485,12 @@ static void build_beat_events(const Pool& pool, const EventFilter& filter, Timel
         double t = static_cast<double>(ticks[i]);
         env.set_timestamp(t);
         auto* beat = env.mutable_beat();
-        if (i < confidences.size()) {
-            beat->set_confidence(static_cast<double>(confidences[i]));
+        if (confidences && i < confidences->size()) {
+            beat->set_confidence(static_cast<double>((*confidences)[i]));
         }
         add_envelope(tl, t, env);
     }
-    std::cout << "    " << ticks.size() << " beats" << std::endl;
+    progress() << "    " << ticks.size() << " beats" << std::endl;
 }
 
 static void build_onset_events(const Pool& pool, const EventFilter& filter, Timeline& tl) {
@@ -420,14 +1498,157 @@ static void build_onset_events(const Pool& pool, const EventFilter& filter, Time
     if (!pool.contains<std::vector<Real>>("rhythm.onsetTimes")) return;
 
     const auto& onsets = pool.value<std::vector<Real>>("rhythm.onsetTimes");
-    for (size_t i = 0; i < onsets.size(); ++i) {
-        ::tracks::Envelope env;
-        double t = static_cast<double>(onsets[i]);
-        env.set_timestamp(t);
-        env.mutable_onset()->set_strength(1.0);
+    for (size_t i = 0; i < onsets.size(); ++i) {
+        ::tracks::Envelope env;
+        double t = static_cast<double>(onsets[i]);
+        env.set_timestamp(t);
+        env.mutable_onset()->set_strength(1.0);
+        add_envelope(tl, t, env);
+    }
+    progress() << "    " << onsets.size() << " onsets" << std::endl;
+}
+
+// --- Tempo and downbeat builders (from the beat ticks) ---
+// tempo.change: the local tempo is 60 / the median of the 8 beat intervals
+// around each beat. One event gives the opening tempo, then one each time a
+// tempo more than 4% away holds for 4 beats.
+// downbeat: assumes 4 beats to the bar. In each 8-bar window the bar
+// position whose beats are loudest on average (per-hop peak level from the
+// signal scan) is the downbeat; it is kept from the previous window unless
+// another position is clearly louder.
+
+static constexpr double kTempoTolerance = 0.04;
+static constexpr size_t kTempoHold      = 4;     // beats
+static constexpr size_t kBeatsPerBar    = 4;
+static constexpr size_t kDownbeatWindow = 32;    // beats
+static constexpr double kAccentWindow   = 0.03;  // s either side of a beat
+static constexpr double kPhaseSwitch    = 1.1;   // accent ratio to move the downbeat
+
+static void build_tempo_events(const Pool& pool, const SignalScan& scan,
+                                const EventFilter& filter, const Config& cfg, Timeline& tl) {
+    bool want_tempo    = filter.count(EventType::TEMPO_CHANGE);
+    bool want_downbeat = filter.count(EventType::DOWNBEAT);
+    if (!want_tempo && !want_downbeat) return;
+    if (!pool.contains<std::vector<Real>>("rhythm.ticks")) return;
+
+    const auto& ticks = pool.value<std::vector<Real>>("rhythm.ticks");
+    size_t n = ticks.size();
+    if (n < 2) return;
+
+    if (want_tempo) {
+        std::vector<double> bpm(n);
+        std::vector<double> intervals;
+        for (size_t i = 0; i < n; ++i) {
+            size_t lo = i > 4 ? i - 3 : 1;
+            size_t hi = std::min(i + 4, n - 1);
+            intervals.clear();
+            for (size_t j = lo; j <= hi; ++j) {
+                intervals.push_back(static_cast<double>(ticks[j] - ticks[j - 1]));
+            }
+            auto mid = intervals.begin() + static_cast<long>(intervals.size() / 2);
+            std::nth_element(intervals.begin(), mid, intervals.end());
+            bpm[i] = *mid > 0.0 ? 60.0 / *mid : 0.0;
+        }
+
+        auto close_to = [](double a, double b) { return std::abs(a - b) <= kTempoTolerance * b; };
+        double current = 0.0;
+        int count = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (bpm[i] <= 0.0 || (current > 0.0 && close_to(bpm[i], current))) continue;
+            size_t held = 1;
+            while (i + held < n && held < kTempoHold && close_to(bpm[i + held], bpm[i])) ++held;
+            if (current > 0.0 && held < kTempoHold) continue;
+
+            double t = static_cast<double>(ticks[i]);
+            ::tracks::Envelope env; env.set_timestamp(t);
+            env.mutable_tempo_change()->set_bpm(bpm[i]);
+            add_envelope(tl, t, env);
+            current = bpm[i];
+            count++;
+        }
+        if (count > 0) progress() << "    " << count << " tempo changes" << std::endl;
+    }
+
+    if (want_downbeat && !scan.peak.empty()) {
+        const auto& peak = scan.peak;
+        double hop = static_cast<double>(cfg.hop_size) / cfg.sample_rate;
+
+        std::vector<double> accent(n, 0.0);
+        for (size_t i = 0; i < n; ++i) {
+            double t  = static_cast<double>(ticks[i]);
+            size_t lo = static_cast<size_t>(std::max(0.0, (t - kAccentWindow) / hop));
+            size_t hi = std::min(static_cast<size_t>((t + kAccentWindow) / hop) + 1, peak.size());
+            for (size_t h = lo; h < hi; ++h) accent[i] = std::max(accent[i], static_cast<double>(peak[h]));
+        }
+
+        size_t phase = kBeatsPerBar;  // none yet
+        int count = 0;
+        for (size_t start = 0; start < n; start += kDownbeatWindow) {
+            size_t end = std::min(start + kDownbeatWindow, n);
+            double mean[kBeatsPerBar] = {};
+            int    beats[kBeatsPerBar] = {};
+            for (size_t i = start; i < end; ++i) {
+                mean[i % kBeatsPerBar] += accent[i];
+                beats[i % kBeatsPerBar]++;
+            }
+            double total = 0.0;
+            size_t best = 0;
+            for (size_t k = 0; k < kBeatsPerBar; ++k) {
+                if (beats[k] > 0) mean[k] /= beats[k];
+                total += mean[k];
+                if (mean[k] > mean[best]) best = k;
+            }
+            if (phase == kBeatsPerBar || mean[best] > kPhaseSwitch * mean[phase]) phase = best;
+
+            // 0 when every bar position is as loud, 1 when only the downbeat sounds
+            double share = total > 0.0 ? mean[phase] / total : 0.0;
+            double confidence = std::clamp((share - 1.0 / kBeatsPerBar) / (1.0 - 1.0 / kBeatsPerBar),
+                                           0.0, 1.0);
+            for (size_t i = start; i < end; ++i) {
+                if (i % kBeatsPerBar != phase) continue;
+                double t = static_cast<double>(ticks[i]);
+                ::tracks::Envelope env; env.set_timestamp(t);
+                env.mutable_downbeat()->set_confidence(confidence);
+                add_envelope(tl, t, env);
+                count++;
+            }
+        }
+        progress() << "    " << count << " downbeats" << std::endl;
+    }
+}
+
+// onset.rate: onsets per second over a 2 s window centered on each
+// continuous_interval step (OnsetRate itself only gives the track average)
+
+static constexpr double kOnsetRateWindow = 2.0;
+
+static void build_onset_rate_events(const Pool& pool, const EventFilter& filter,
+                                     const Config& cfg, double duration, Timeline& tl) {
+    if (!filter.count(EventType::ONSET_RATE)) return;
+    if (!pool.contains<std::vector<Real>>("rhythm.onsetTimes")) return;
+
+    const auto& onsets = pool.value<std::vector<Real>>("rhythm.onsetTimes");
+    size_t lo = 0, hi = 0;
+    int count = 0;
+    for (double t = 0.0; t < duration; t += cfg.continuous_interval) {
+        double from = std::max(0.0, t - kOnsetRateWindow / 2);
+        double to   = std::min(duration, t + kOnsetRateWindow / 2);
+        while (lo < onsets.size() && onsets[lo] < from) ++lo;
+        while (hi < onsets.size() && onsets[hi] < to) ++hi;
+        if (to <= from) break;
+
+        ::tracks::Envelope env; env.set_timestamp(t);
+        env.mutable_onset_rate()->set_rate(static_cast<double>(hi - lo) / (to - from));
         add_envelope(tl, t, env);
+        count++;
     }
-    std::cout << "    " << onsets.size() << " onsets" << std::endl;
+    progress() << "    " << count << " onset.rate";
+    if (pool.contains<std::vector<Real>>("rhythm.onsetRate") &&
+        !pool.value<std::vector<Real>>("rhythm.onsetRate").empty()) {
+        progress() << " (" << pool.value<std::vector<Real>>("rhythm.onsetRate").back()
+                   << " onsets/s overall)";
+    }
+    progress() << std::endl;
 }
 
 static void build_silence_events(const Pool& pool, const EventFilter& filter,
@@ -444,8 +1665,9 @@ static void build_silence_events(const Pool& pool, const EventFilter& filter,
 
     int startFrame = static_cast<int>(starts.back());
     int stopFrame  = static_cast<int>(stops.back());
-    double startTime = frame_to_time(startFrame, cfg.hop_size, cfg.sample_rate);
-    double stopTime  = frame_to_time(stopFrame, cfg.hop_size, cfg.sample_rate);
+    int hop = resolution(cfg, "silence").hop_size;
+    double startTime = frame_to_time(startFrame, hop, cfg.sample_rate);
+    double stopTime  = frame_to_time(stopFrame, hop, cfg.sample_rate);
     int silence_count = 0;
 
     if (startFrame > 0 && startTime > 0.05) {
@@ -484,280 +1706,84 @@ static void build_silence_events(const Pool& pool, const EventFilter& filter,
         }
     }
 
-    std::cout << "    " << silence_count << " silence events"
+    progress() << "    " << silence_count << " silence events"
               << " (start=" << startFrame << " stop=" << stopFrame << ")" << std::endl;
 }
 
-static void build_loudness_events(const Pool& pool, const EventFilter& filter,
+static void build_loudness_events(const FrameStore& store, const EventFilter& filter,
                                    const Config& cfg, double duration, Timeline& tl) {
     bool want_loudness = filter.count(EventType::LOUDNESS);
     bool want_peak     = filter.count(EventType::LOUDNESS_PEAK);
     bool want_dynamic  = filter.count(EventType::DYNAMIC_CHANGE);
     if (!want_loudness && !want_peak && !want_dynamic) return;
-    if (!pool.contains<std::vector<Real>>("loudness.values")) return;
 
-    const auto& values = pool.value<std::vector<Real>>("loudness.values");
+    const auto& values = store.loudness;
     if (values.empty()) return;
 
-    double interval = cfg.continuous_interval;
-    double last_emit_time = -interval;
-    int loudness_count = 0, peak_count = 0, dynamic_count = 0;
+    auto time_of = [&](size_t i) {
+        return frame_to_time(static_cast<int>(i), store.loudness_hop, cfg.sample_rate);
+    };
+    // Frames up to the end of the signal
+    size_t n = values.size();
+    while (n > 0 && time_of(n - 1) > duration) --n;
 
     Real max_loudness = *std::max_element(values.begin(), values.end());
-    Real peak_threshold = max_loudness * 0.9f;
-
-    for (size_t i = 0; i < values.size(); ++i) {
-        double t = frame_to_time(static_cast<int>(i), cfg.hop_size, cfg.sample_rate);
-        if (t > duration) break;
+    int loudness_count = 0, peak_count = 0, dynamic_count = 0;
 
-        if (want_loudness && (t - last_emit_time) >= interval) {
+    if (want_loudness) {
+        double interval = cfg.continuous_interval;
+        double last_emit_time = -interval;
+        for (size_t i = 0; i < n; ++i) {
+            double t = time_of(i);
+            if ((t - last_emit_time) < interval) continue;
             ::tracks::Envelope env; env.set_timestamp(t);
             env.mutable_loudness()->set_value(static_cast<double>(values[i]));
             add_envelope(tl, t, env);
             last_emit_time = t;
             loudness_count++;
         }
-
-        if (want_peak && i > 0 && i < values.size() - 1) {
-            if (values[i] > values[i-1] && values[i] > values[i+1] &&
-                values[i] >= peak_threshold) {
-                ::tracks::Envelope env; env.set_timestamp(t);
-                env.mutable_loudness_peak()->set_value(static_cast<double>(values[i]));
-                add_envelope(tl, t, env);
-                peak_count++;
-            }
-        }
-
-        if (want_dynamic && i > 0) {
-            double diff = std::abs(static_cast<double>(values[i]) - static_cast<double>(values[i-1]));
-            double mag_thresh = static_cast<double>(max_loudness) * 0.3;
-            if (mag_thresh > 0.0 && diff > mag_thresh) {
-                ::tracks::Envelope env; env.set_timestamp(t);
-                env.mutable_dynamic_change()->set_magnitude(diff);
-                add_envelope(tl, t, env);
-                dynamic_count++;
-            }
-        }
-    }
-
-    if (loudness_count > 0) std::cout << "    " << loudness_count << " loudness" << std::endl;
-    if (peak_count > 0)     std::cout << "    " << peak_count << " loudness peaks" << std::endl;
-    if (dynamic_count > 0)  std::cout << "    " << dynamic_count << " dynamic changes" << std::endl;
-}
-
-static void build_energy_events(const Pool& pool, const EventFilter& filter,
-                                 const Config& cfg, double duration, Timeline& tl) {
-    if (!filter.count(EventType::ENERGY)) return;
-    if (!pool.contains<std::vector<Real>>("energy.values")) return;
-
-    const auto& values = pool.value<std::vector<Real>>("energy.values");
-    if (values.empty()) return;
-
-    double interval = cfg.continuous_interval;
-    double last_emit_time = -interval;
-    int count = 0;
-
-    for (size_t i = 0; i < values.size(); ++i) {
-        double t = frame_to_time(static_cast<int>(i), cfg.hop_size, cfg.sample_rate);
-        if (t > duration) break;
-        if ((t - last_emit_time) >= interval) {
-            ::tracks::Envelope env; env.set_timestamp(t);
-            env.mutable_energy()->set_value(static_cast<double>(values[i]));
-            add_envelope(tl, t, env);
-            last_emit_time = t;
-            count++;
-        }
     }
-    std::cout << "    " << count << " energy" << std::endl;
-}
 
-// --- Spectral continuous event builders (throttled) ---
-
-static void build_throttled_real_events(const Pool& pool, const std::string& pool_key,
-                                         const Config& cfg, double duration, Timeline& tl,
-                                         const char* label,
-                                         std::function<void(::tracks::Envelope&, double)> setter) {
-    if (!pool.contains<std::vector<Real>>(pool_key)) return;
-    const auto& values = pool.value<std::vector<Real>>(pool_key);
-    if (values.empty()) return;
-
-    double interval = cfg.continuous_interval;
-    double last_emit = -interval;
-    int count = 0;
-
-    for (size_t i = 0; i < values.size(); ++i) {
-        double t = frame_to_time(static_cast<int>(i), cfg.hop_size, cfg.sample_rate);
-        if (t > duration) break;
-        if ((t - last_emit) >= interval) {
+    // The detectors find their frames in one tight loop each; only the hits
+    // become envelopes
+    std::vector<uint32_t> hits;
+    if (want_peak) {
+        // A peak needs its successor, which may lie past the end
+        local_peaks(values.data(), std::min(values.size(), n + 1), max_loudness * 0.9f, hits);
+        for (uint32_t i : hits) {
+            if (i >= n) break;
+            double t = time_of(i);
             ::tracks::Envelope env; env.set_timestamp(t);
-            setter(env, static_cast<double>(values[i]));
+            env.mutable_loudness_peak()->set_value(static_cast<double>(values[i]));
             add_envelope(tl, t, env);
-            last_emit = t;
-            count++;
+            peak_count++;
         }
     }
-    std::cout << "    " << count << " " << label << std::endl;
-}
-
-static void build_throttled_vector_events(const Pool& pool, const std::string& pool_key,
-                                            const Config& cfg, double duration, Timeline& tl,
-                                            const char* label,
-                                            std::function<void(::tracks::Envelope&, const std::vector<Real>&)> setter) {
-    if (!pool.contains<std::vector<std::vector<Real>>>(pool_key)) return;
-    const auto& frames = pool.value<std::vector<std::vector<Real>>>(pool_key);
-    if (frames.empty()) return;
-
-    double interval = cfg.continuous_interval;
-    double last_emit = -interval;
-    int count = 0;
 
-    for (size_t i = 0; i < frames.size(); ++i) {
-        double t = frame_to_time(static_cast<int>(i), cfg.hop_size, cfg.sample_rate);
-        if (t > duration) break;
-        if ((t - last_emit) >= interval) {
+    double mag_thresh = static_cast<double>(max_loudness) * 0.3;
+    if (want_dynamic && mag_thresh > 0.0) {
+        hits.clear();
+        jumps(values.data(), n, mag_thresh, hits);
+        for (uint32_t i : hits) {
+            double t = time_of(i);
+            double diff = std::abs(static_cast<double>(values[i]) - static_cast<double>(values[i - 1]));
             ::tracks::Envelope env; env.set_timestamp(t);
-            setter(env, frames[i]);
+            env.mutable_dynamic_change()->set_magnitude(diff);
             add_envelope(tl, t, env);
-            last_emit = t;
-            count++;
-        }
-    }
-    std::cout << "    " << count << " " << label << std::endl;
-}
-
-static void build_spectral_events(const Pool& pool, const EventFilter& filter,
-                                    const Config& cfg, double duration, Timeline& tl) {
-    // SpectralCentroid (Real per frame)
-    if (filter.count(EventType::SPECTRAL_CENTROID)) {
-        build_throttled_real_events(pool, "spectral.centroid", cfg, duration, tl,
-            "spectral.centroid", [](::tracks::Envelope& env, double v) {
-                env.mutable_spectral_centroid()->set_value(v);
-            });
-    }
-
-    // SpectralFlux
-    if (filter.count(EventType::SPECTRAL_FLUX)) {
-        build_throttled_real_events(pool, "spectral.flux", cfg, duration, tl,
-            "spectral.flux", [](::tracks::Envelope& env, double v) {
-                env.mutable_spectral_flux()->set_value(v);
-            });
-    }
-
-    // SpectralComplexity
-    if (filter.count(EventType::SPECTRAL_COMPLEXITY)) {
-        build_throttled_real_events(pool, "spectral.complexity", cfg, duration, tl,
-            "spectral.complexity", [](::tracks::Envelope& env, double v) {
-                env.mutable_spectral_complexity()->set_value(v);
-            });
-    }
-
-    // SpectralContrast (vector per frame)
-    if (filter.count(EventType::SPECTRAL_CONTRAST)) {
-        build_throttled_vector_events(pool, "spectral.contrast", cfg, duration, tl,
-            "spectral.contrast", [](::tracks::Envelope& env, const std::vector<Real>& v) {
-                auto* sc = env.mutable_spectral_contrast();
-                for (auto val : v) sc->add_values(val);
-            });
-    }
-
-    // SpectralRolloff
-    if (filter.count(EventType::SPECTRAL_ROLLOFF)) {
-        build_throttled_real_events(pool, "spectral.rolloff", cfg, duration, tl,
-            "spectral.rolloff", [](::tracks::Envelope& env, double v) {
-                env.mutable_spectral_rolloff()->set_value(v);
-            });
-    }
-
-    // HFC
-    if (filter.count(EventType::HFC)) {
-        build_throttled_real_events(pool, "spectral.hfc", cfg, duration, tl,
-            "hfc", [](::tracks::Envelope& env, double v) {
-                env.mutable_hfc()->set_value(v);
-            });
-    }
-
-    // MFCC (vector per frame)
-    if (filter.count(EventType::MFCC)) {
-        build_throttled_vector_events(pool, "spectral.mfcc", cfg, duration, tl,
-            "mfcc", [](::tracks::Envelope& env, const std::vector<Real>& v) {
-                auto* m = env.mutable_mfcc();
-                for (auto val : v) m->add_values(val);
-            });
-    }
-
-    // TimbreChange — derived from MFCC distance between consecutive frames
-    if (filter.count(EventType::TIMBRE_CHANGE)) {
-        if (pool.contains<std::vector<std::vector<Real>>>("spectral.mfcc")) {
-            const auto& mfccs = pool.value<std::vector<std::vector<Real>>>("spectral.mfcc");
-            int count = 0;
-            for (size_t i = 1; i < mfccs.size(); ++i) {
-                double t = frame_to_time(static_cast<int>(i), cfg.hop_size, cfg.sample_rate);
-                if (t > duration) break;
-
-                // Euclidean distance between consecutive MFCC vectors
-                double dist = 0.0;
-                size_t n = std::min(mfccs[i].size(), mfccs[i-1].size());
-                for (size_t j = 0; j < n; ++j) {
-                    double d = static_cast<double>(mfccs[i][j] - mfccs[i-1][j]);
-                    dist += d * d;
-                }
-                dist = std::sqrt(dist);
-
-                // Threshold: emit when distance > 50 (tunable heuristic)
-                if (dist > 50.0) {
-                    ::tracks::Envelope env; env.set_timestamp(t);
-                    env.mutable_timbre_change()->set_distance(dist);
-                    add_envelope(tl, t, env);
-                    count++;
-                }
-            }
-            if (count > 0) std::cout << "    " << count << " timbre changes" << std::endl;
+            dynamic_count++;
         }
     }
-}
-
-// --- Band event builders ---
-
-static void build_band_events(const Pool& pool, const EventFilter& filter,
-                                const Config& cfg, double duration, Timeline& tl) {
-    if (filter.count(EventType::BANDS_MEL)) {
-        build_throttled_vector_events(pool, "bands.mel", cfg, duration, tl,
-            "bands.mel", [](::tracks::Envelope& env, const std::vector<Real>& v) {
-                auto* b = env.mutable_bands_mel();
-                for (auto val : v) b->add_values(val);
-            });
-    }
-
-    if (filter.count(EventType::BANDS_BARK)) {
-        build_throttled_vector_events(pool, "bands.bark", cfg, duration, tl,
-            "bands.bark", [](::tracks::Envelope& env, const std::vector<Real>& v) {
-                auto* b = env.mutable_bands_bark();
-                for (auto val : v) b->add_values(val);
-            });
-    }
 
-    if (filter.count(EventType::BANDS_ERB)) {
-        build_throttled_vector_events(pool, "bands.erb", cfg, duration, tl,
-            "bands.erb", [](::tracks::Envelope& env, const std::vector<Real>& v) {
-                auto* b = env.mutable_bands_erb();
-                for (auto val : v) b->add_values(val);
-            });
-    }
+    if (loudness_count > 0) progress() << "    " << loudness_count << " loudness" << std::endl;
+    if (peak_count > 0)     progress() << "    " << peak_count << " loudness peaks" << std::endl;
+    if (dynamic_count > 0)  progress() << "    " << dynamic_count << " dynamic changes" << std::endl;
 }
 
 // --- Tonal event builders ---
 
+// Key and chords; chroma, dissonance and inharmonicity are frame-local
 static void build_tonal_events(const Pool& pool, const EventFilter& filter,
                                 const Config& cfg, double duration, Timeline& tl) {
-    // Chroma (HPCP, vector per frame)
-    if (filter.count(EventType::CHROMA)) {
-        build_throttled_vector_events(pool, "tonal.hpcp", cfg, duration, tl,
-            "chroma", [](::tracks::Envelope& env, const std::vector<Real>& v) {
-                auto* c = env.mutable_chroma();
-                for (auto val : v) c->add_values(val);
-            });
-    }
-
     // Key change — the streaming Key algo outputs final key only;
     // we emit a single key.change event
     if (filter.count(EventType::KEY_CHANGE)) {
@@ -765,18 +1791,19 @@ static void build_tonal_events(const Pool& pool, const EventFilter& filter,
             pool.contains<std::vector<std::string>>("tonal.scale")) {
             const auto& keys   = pool.value<std::vector<std::string>>("tonal.key");
             const auto& scales = pool.value<std::vector<std::string>>("tonal.scale");
-            std::vector<Real> strengths;
+            const std::vector<Real>* strengths = nullptr;
             if (pool.contains<std::vector<Real>>("tonal.keyStrength")) {
-                strengths = pool.value<std::vector<Real>>("tonal.keyStrength");
+                strengths = &pool.value<std::vector<Real>>("tonal.keyStrength");
             }
             if (!keys.empty()) {
                 ::tracks::Envelope env; env.set_timestamp(0.0);
                 auto* kc = env.mutable_key_change();
                 kc->set_key(keys.back());
                 kc->set_scale(scales.empty() ? "" : scales.back());
-                kc->set_strength(strengths.empty() ? 0.0 : static_cast<double>(strengths.back()));
+                kc->set_strength(!strengths || strengths->empty()
+                                     ? 0.0 : static_cast<double>(strengths->back()));
                 add_envelope(tl, 0.0, env);
-                std::cout << "    key: " << keys.back() << " " << (scales.empty() ? "" : scales.back()) << std::endl;
+                progress() << "    key: " << keys.back() << " " << (scales.empty() ? "" : scales.back()) << std::endl;
             }
         }
     }
@@ -785,106 +1812,32 @@ static void build_tonal_events(const Pool& pool, const EventFilter& filter,
     if (filter.count(EventType::CHORD_CHANGE)) {
         if (pool.contains<std::vector<std::string>>("tonal.chords")) {
             const auto& chords = pool.value<std::vector<std::string>>("tonal.chords");
-            std::vector<Real> strengths;
+            const std::vector<Real>* strengths = nullptr;
             if (pool.contains<std::vector<Real>>("tonal.chordStrength")) {
-                strengths = pool.value<std::vector<Real>>("tonal.chordStrength");
+                strengths = &pool.value<std::vector<Real>>("tonal.chordStrength");
             }
 
             std::string prev_chord;
+            int hop = resolution(cfg, "tonal").hop_size;
             int count = 0;
             for (size_t i = 0; i < chords.size(); ++i) {
                 if (chords[i] != prev_chord) {
-                    double t = frame_to_time(static_cast<int>(i), cfg.hop_size, cfg.sample_rate);
+                    double t = frame_to_time(static_cast<int>(i), hop, cfg.sample_rate);
                     if (t > duration) break;
                     ::tracks::Envelope env; env.set_timestamp(t);
                     auto* cc = env.mutable_chord_change();
                     cc->set_chord(chords[i]);
-                    if (i < strengths.size()) {
-                        cc->set_strength(static_cast<double>(strengths[i]));
+                    if (strengths && i < strengths->size()) {
+                        cc->set_strength(static_cast<double>((*strengths)[i]));
                     }
                     add_envelope(tl, t, env);
                     prev_chord = chords[i];
                     count++;
                 }
             }
-            if (count > 0) std::cout << "    " << count << " chord changes" << std::endl;
-        }
-    }
-
-    // Dissonance
-    if (filter.count(EventType::DISSONANCE)) {
-        build_throttled_real_events(pool, "tonal.dissonance", cfg, duration, tl,
-            "dissonance", [](::tracks::Envelope& env, double v) {
-                env.mutable_dissonance()->set_value(v);
-            });
-    }
-
-    // Inharmonicity
-    if (filter.count(EventType::INHARMONICITY)) {
-        build_throttled_real_events(pool, "tonal.inharmonicity", cfg, duration, tl,
-            "inharmonicity", [](::tracks::Envelope& env, double v) {
-                env.mutable_inharmonicity()->set_value(v);
-            });
-    }
-}
-
-// --- Pitch event builders ---
-
-static void build_pitch_events(const Pool& pool, const EventFilter& filter,
-                                const Config& cfg, double duration, Timeline& tl) {
-    bool want_pitch  = filter.count(EventType::PITCH);
-    bool want_change = filter.count(EventType::PITCH_CHANGE);
-    if (!want_pitch && !want_change) return;
-    if (!pool.contains<std::vector<Real>>("pitch.values")) return;
-
-    const auto& pitches     = pool.value<std::vector<Real>>("pitch.values");
-    std::vector<Real> confs;
-    if (pool.contains<std::vector<Real>>("pitch.confidence")) {
-        confs = pool.value<std::vector<Real>>("pitch.confidence");
-    }
-
-    double interval = cfg.continuous_interval;
-    double last_emit = -interval;
-    int pitch_count = 0, change_count = 0;
-    Real prev_pitch = 0.0f;
-
-    for (size_t i = 0; i < pitches.size(); ++i) {
-        double t = frame_to_time(static_cast<int>(i), cfg.hop_size, cfg.sample_rate);
-        if (t > duration) break;
-
-        Real freq = pitches[i];
-        Real conf = (i < confs.size()) ? confs[i] : 0.0f;
-
-        // Continuous pitch (throttled)
-        if (want_pitch && (t - last_emit) >= interval && conf > 0.3f) {
-            ::tracks::Envelope env; env.set_timestamp(t);
-            auto* p = env.mutable_pitch();
-            p->set_frequency(static_cast<double>(freq));
-            p->set_confidence(static_cast<double>(conf));
-            add_envelope(tl, t, env);
-            last_emit = t;
-            pitch_count++;
-        }
-
-        // Pitch change: significant jump with good confidence
-        if (want_change && i > 0 && conf > 0.5f && prev_pitch > 0.0f && freq > 0.0f) {
-            double ratio = static_cast<double>(freq) / static_cast<double>(prev_pitch);
-            // More than a semitone change (ratio > ~1.06 or < ~0.94)
-            if (ratio > 1.06 || ratio < 0.94) {
-                ::tracks::Envelope env; env.set_timestamp(t);
-                auto* pc = env.mutable_pitch_change();
-                pc->set_from_hz(static_cast<double>(prev_pitch));
-                pc->set_to_hz(static_cast<double>(freq));
-                add_envelope(tl, t, env);
-                change_count++;
-            }
+            if (count > 0) progress() << "    " << count << " chord changes" << std::endl;
         }
-
-        if (conf > 0.3f) prev_pitch = freq;
     }
-
-    if (pitch_count > 0)  std::cout << "    " << pitch_count << " pitch" << std::endl;
-    if (change_count > 0) std::cout << "    " << change_count << " pitch changes" << std::endl;
 }
 
 // --- Melody event builder ---
@@ -902,9 +1855,8 @@ static void build_melody_events(const Pool& pool, const EventFilter& filter,
     // Flatten — the composite outputs one big vector
     const auto& pitches = pitch_vecs[0];
 
-    // PredominantPitchMelodia uses its own hop size (default 128)
-    // We need to compute time based on that hop
-    int melody_hop = cfg.hop_size;  // it uses our configured hop
+    // PredominantPitchMelodia runs at the melody resolution's hop
+    int melody_hop = resolution(cfg, "melody").hop_size;
 
     double interval = cfg.continuous_interval;
     double last_emit = -interval;
@@ -925,54 +1877,212 @@ static void build_melody_events(const Pool& pool, const EventFilter& filter,
             count++;
         }
     }
-    if (count > 0) std::cout << "    " << count << " melody" << std::endl;
+    if (count > 0) progress() << "    " << count << " melody" << std::endl;
 }
 
-// --- Segmentation event builder (SBic in standard mode from MFCC pool) ---
+// --- Segmentation event builder ---
+// Online: the boundaries the frame pass found. SBic: standard mode over the
+// whole MFCC matrix, slower and with more memory but it can revise a split
+// with everything after it.
 
-static void build_segmentation_events(const Pool& pool, const EventFilter& filter,
+static void add_boundary(Timeline& tl, double t) {
+    ::tracks::Envelope env; env.set_timestamp(t);
+    env.mutable_segment_boundary();
+    add_envelope(tl, t, env);
+}
+
+static void build_segmentation_events(FrameStore& store, const EventFilter& filter,
                                         const Config& cfg, double duration, Timeline& tl) {
     if (!filter.count(EventType::SEGMENT_BOUNDARY)) return;
-    if (!pool.contains<std::vector<std::vector<Real>>>("spectral.mfcc")) return;
 
-    const auto& mfccs = pool.value<std::vector<std::vector<Real>>>("spectral.mfcc");
-    if (mfccs.size() < 10) return;  // need enough frames
+    int count = 0;
+    if (cfg.segmentation != "sbic") {
+        for (double t : store.boundaries) {
+            if (t > 0.0 && t < duration) {
+                add_boundary(tl, t);
+                count++;
+            }
+        }
+        if (count > 0) progress() << "    " << count << " segment boundaries" << std::endl;
+        return;
+    }
+    if (store.mfcc_frames() < 10) return;  // need enough frames
 
     // Build feature matrix for SBic (standard mode)
     // SBic expects TNT::Array2D<Real> with features as rows, frames as columns
-    size_t n_coeff = mfccs[0].size();
-    size_t n_frames = mfccs.size();
+    size_t n_coeff = store.mfcc_size;
+    size_t n_frames = store.mfcc_frames();
 
     TNT::Array2D<Real> features(static_cast<int>(n_coeff), static_cast<int>(n_frames));
     for (size_t f = 0; f < n_frames; ++f) {
-        for (size_t c = 0; c < n_coeff && c < mfccs[f].size(); ++c) {
-            features[static_cast<int>(c)][static_cast<int>(f)] = mfccs[f][c];
+        const Real* frame = &store.mfcc[f * n_coeff];
+        for (size_t c = 0; c < n_coeff; ++c) {
+            features[static_cast<int>(c)][static_cast<int>(f)] = frame[c];
         }
     }
+    std::vector<Real>().swap(store.mfcc);  // SBic only needs the transposed copy
 
+    std::unique_lock<std::mutex> lock(g_build_mutex);
     auto* sbic = essentia::standard::AlgorithmFactory::instance().create("SBic");
     sbic->configure();
+    lock.unlock();
 
     std::vector<Real> segmentation;
     sbic->input("features").set(features);
     sbic->output("segmentation").set(segmentation);
     sbic->compute();
 
-    int count = 0;
     // SBic returns frame indices including first and last
     for (size_t i = 1; i < segmentation.size() - 1; ++i) {
         int frame = static_cast<int>(segmentation[i]);
-        double t = frame_to_time(frame, cfg.hop_size, cfg.sample_rate);
+        double t = frame_to_time(frame, store.mfcc_hop, cfg.sample_rate);
         if (t > 0.0 && t < duration) {
-            ::tracks::Envelope env; env.set_timestamp(t);
-            env.mutable_segment_boundary();
-            add_envelope(tl, t, env);
+            add_boundary(tl, t);
             count++;
         }
     }
 
     delete sbic;
-    if (count > 0) std::cout << "    " << count << " segment boundaries" << std::endl;
+    if (count > 0) progress() << "    " << count << " segment boundaries" << std::endl;
+}
+
+// --- Quality and envelope builders (from the signal scan) ---
+
+static void build_quality_events(const SignalScan& scan, const EventFilter& filter, Timeline& tl) {
+    auto report = [](size_t n, const char* label) {
+        if (n > 0) progress() << "    " << n << " " << label << std::endl;
+    };
+
+    if (filter.count(EventType::CLICK)) {
+        for (double t : scan.clicks) {
+            ::tracks::Envelope env; env.set_timestamp(t);
+            env.mutable_click();
+            add_envelope(tl, t, env);
+        }
+        report(scan.clicks.size(), "clicks");
+    }
+
+    if (filter.count(EventType::DISCONTINUITY)) {
+        for (double t : scan.discontinuities) {
+            ::tracks::Envelope env; env.set_timestamp(t);
+            env.mutable_discontinuity();
+            add_envelope(tl, t, env);
+        }
+        report(scan.discontinuities.size(), "discontinuities");
+    }
+
+    if (filter.count(EventType::NOISE_BURST)) {
+        for (double t : scan.noise_bursts) {
+            ::tracks::Envelope env; env.set_timestamp(t);
+            env.mutable_noise_burst();
+            add_envelope(tl, t, env);
+        }
+        report(scan.noise_bursts.size(), "noise bursts");
+    }
+
+    if (filter.count(EventType::SATURATION)) {
+        for (const auto& e : scan.saturation) {
+            ::tracks::Envelope env; env.set_timestamp(e.time);
+            env.mutable_saturation()->set_duration(e.value);
+            add_envelope(tl, e.time, env);
+        }
+        report(scan.saturation.size(), "saturation regions");
+    }
+
+    if (filter.count(EventType::HUM)) {
+        for (const auto& e : scan.hum) {
+            ::tracks::Envelope env; env.set_timestamp(e.time);
+            env.mutable_hum()->set_frequency(e.value);
+            add_envelope(tl, e.time, env);
+            progress() << "    hum: " << e.value << " Hz from " << e.time << "s" << std::endl;
+        }
+    }
+}
+
+static void build_envelope_events(const SignalScan& scan, const EventFilter& filter,
+                                   const Config& cfg, double duration, Timeline& tl) {
+    if (filter.count(EventType::ENVELOPE)) {
+        double interval = cfg.continuous_interval;
+        double last_emit = -interval;
+        int count = 0;
+        for (size_t i = 0; i < scan.envelope.size(); ++i) {
+            double t = frame_to_time(static_cast<int>(i), cfg.hop_size, cfg.sample_rate);
+            if (t > duration) break;
+            if ((t - last_emit) >= interval) {
+                ::tracks::Envelope env; env.set_timestamp(t);
+                env.mutable_envelope_event()->set_value(static_cast<double>(scan.envelope[i]));
+                add_envelope(tl, t, env);
+                last_emit = t;
+                count++;
+            }
+        }
+        progress() << "    " << count << " envelope" << std::endl;
+    }
+
+    if (filter.count(EventType::ATTACK)) {
+        for (const auto& e : scan.attacks) {
+            ::tracks::Envelope env; env.set_timestamp(e.time);
+            env.mutable_attack()->set_log_attack_time(e.value);
+            add_envelope(tl, e.time, env);
+        }
+        if (!scan.attacks.empty()) progress() << "    " << scan.attacks.size() << " attacks" << std::endl;
+    }
+
+    if (filter.count(EventType::DECAY)) {
+        for (const auto& e : scan.decays) {
+            ::tracks::Envelope env; env.set_timestamp(e.time);
+            env.mutable_decay()->set_value(e.value);
+            add_envelope(tl, e.time, env);
+        }
+        if (!scan.decays.empty()) progress() << "    " << scan.decays.size() << " decays" << std::endl;
+    }
+
+    if (filter.count(EventType::FADE_IN)) {
+        for (const auto& e : scan.fade_ins) {
+            ::tracks::Envelope env; env.set_timestamp(e.time);
+            env.mutable_fade_in()->set_end_time(e.value);
+            add_envelope(tl, e.time, env);
+            progress() << "    fade-in " << e.time << "s - " << e.value << "s" << std::endl;
+        }
+    }
+
+    if (filter.count(EventType::FADE_OUT)) {
+        for (const auto& e : scan.fade_outs) {
+            ::tracks::Envelope env; env.set_timestamp(e.time);
+            env.mutable_fade_out()->set_start_time(e.value);
+            add_envelope(tl, e.time, env);
+            progress() << "    fade-out " << e.value << "s - " << e.time << "s" << std::endl;
+        }
+    }
+}
+
+// --- Transport events ---
+
+void append_track_start(const Config& cfg, double duration, Timeline& tl) {
+    ::tracks::Envelope env;
+    env.set_timestamp(0.0);
+    auto* ts = env.mutable_track_start();
+    ts->set_filename(cfg.input_file);
+    ts->set_duration(duration);
+    ts->set_sample_rate(cfg.sample_rate);
+    ts->set_channels(1);
+    add_envelope(tl, 0.0, env);
+}
+
+void append_track_end(const Config& cfg, double duration, Timeline& tl) {
+    // track.position heartbeats
+    for (double t = cfg.position_interval; t < duration; t += cfg.position_interval) {
+        ::tracks::Envelope env;
+        env.set_timestamp(t);
+        env.mutable_track_position()->set_position(t);
+        add_envelope(tl, t, env);
+    }
+
+    // track.end
+    ::tracks::Envelope env;
+    env.set_timestamp(duration);
+    env.mutable_track_end();
+    add_envelope(tl, duration, env);
 }
 
 // --- Main entry point ---
@@ -983,114 +2093,280 @@ Timeline analyze(const Config& cfg) {
     double duration = 0.0;
 
     const auto& filter = cfg.enabled_events;
+    StageTimer total;
+    std::vector<StageStats> stages;
 
     // --- Run analysis passes (only if needed) ---
 
+    AudioSource audio;
+    {
+        StageTimer timer;
+        open_audio(cfg, audio);
+        if (audio.shared) stages.push_back(timer.finish("decode"));
+    }
+
+    // Passes are queued slowest first so the beat tracker and melody
+    // extractor start together when more than one job is available.
+    std::vector<Pass> passes;
+
     // Beat pass
     if (needs_any(filter, {EventType::BEAT, EventType::TEMPO_CHANGE, EventType::DOWNBEAT})) {
-        duration = run_beat_pass(cfg, pool);
+        passes.push_back({"pass.beat", [&](Pool& p) { duration = run_beat_pass(cfg, audio, p); }});
+    } else if (audio.shared) {
+        duration = static_cast<double>(audio.signal.size()) / cfg.sample_rate;
     } else {
         // Still need duration
-        auto& factory = streaming::AlgorithmFactory::instance();
-        Algorithm* loader = factory.create("MonoLoader",
-            "filename", cfg.input_file,
-            "sampleRate", Real(cfg.sample_rate));
-        loader->output("audio") >> NOWHERE;
-        Network network(loader);
+        StageTimer timer;
+        Algorithm* source = create_source(audio);
+        SourceBase& pcm = audio_output(audio, source);
+        pcm >> NOWHERE;
+        Network network(source);
         network.run();
-        long totalSamples = loader->output("audio").totalProduced();
+        long totalSamples = pcm.totalProduced();
         duration = static_cast<double>(totalSamples) / cfg.sample_rate;
+        stages.push_back(timer.finish("decode"));
+    }
+
+    // Melody pass
+    if (filter.count(EventType::MELODY)) {
+        passes.push_back({"pass.melody", [&](Pool& p) { run_melody_pass(cfg, audio, p); }});
+    }
+
+    // Frame pass (silence, loudness/energy, spectral, bands, tonal, pitch,
+    // and the time-domain scan)
+    SignalScanner scanner(cfg.sample_rate, cfg.hop_size);
+    Timeline frame_events;
+    FrameStore frame_store;
+    bool need_scan = needs_scan(filter);
+    bool need_frames = needs_spectral(filter) || need_scan ||
+        needs_any(filter, {EventType::SILENCE_START, EventType::SILENCE_END, EventType::GAP,
+                           EventType::LOUDNESS, EventType::LOUDNESS_PEAK, EventType::ENERGY,
+                           EventType::DYNAMIC_CHANGE});
+    if (need_frames) {
+        passes.push_back({"pass.frames", [&](Pool& p) {
+            run_frame_pass(cfg, audio, p, filter, need_scan ? &scanner : nullptr,
+                           frame_events, frame_store);
+        }});
     }
 
     // Onset pass
-    if (needs_any(filter, {EventType::ONSET, EventType::ONSET_RATE, EventType::NOVELTY})) {
-        run_onset_pass(cfg, pool);
+    if (needs_any(filter, {EventType::ONSET, EventType::ONSET_RATE})) {
+        passes.push_back({"pass.onset", [&](Pool& p) { run_onset_pass(audio, p); }});
     }
 
-    // Silence pass
-    if (needs_any(filter, {EventType::SILENCE_START, EventType::SILENCE_END, EventType::GAP})) {
-        run_silence_pass(cfg, pool);
+    run_passes(passes, cfg.jobs, pool, stages);
+
+    // Every stage so far covered the whole signal; frames count analysis hops
+    uint64_t hops = static_cast<uint64_t>(duration * cfg.sample_rate / cfg.hop_size);
+    for (auto& s : stages) {
+        s.audio_s = duration;
+        if (s.name != "decode") s.frames = hops;
     }
 
-    // Loudness & Energy pass
-    if (needs_any(filter, {EventType::LOUDNESS, EventType::LOUDNESS_PEAK, EventType::ENERGY,
-                           EventType::DYNAMIC_CHANGE})) {
-        run_loudness_energy_pass(cfg, pool);
+    // --- Build timeline ---
+    progress() << "  Building timeline..." << std::endl;
+
+    // The frame pass's events, already in order, become the first run; its
+    // last frames are centered past the end of the signal
+    timeline = std::move(frame_events);
+    timeline.truncate(duration);
+    if (!timeline.empty()) {
+        progress() << "    " << timeline.size() << " frame-local events" << std::endl;
+    }
+
+    append_track_start(cfg, duration, timeline);
+
+    // Times a builder; builders that added nothing and took no time are
+    // disabled and left out. Their "frames" are the events they added.
+    auto build = [&](const char* name, const std::function<void()>& fn) {
+        size_t before = timeline.size();
+        StageTimer timer;
+        fn();
+        StageStats s = timer.finish(name);
+        s.frames  = timeline.size() - before;
+        s.audio_s = duration;
+        if (s.frames > 0 || s.wall_s >= 1e-3) stages.push_back(std::move(s));
+    };
+
+    // Build events from pool data, the frame pass and the signal scan
+    const SignalScan& scan = scanner.result();
+    build("build.beat",         [&] { build_beat_events(pool, filter, timeline); });
+    build("build.tempo",        [&] { build_tempo_events(pool, scan, filter, cfg, timeline); });
+    build("build.onset",        [&] { build_onset_events(pool, filter, timeline); });
+    build("build.onset_rate",   [&] { build_onset_rate_events(pool, filter, cfg, duration, timeline); });
+    build("build.silence",      [&] { build_silence_events(pool, filter, cfg, duration, timeline); });
+    build("build.loudness",     [&] { build_loudness_events(frame_store, filter, cfg, duration, timeline); });
+    build("build.tonal",        [&] { build_tonal_events(pool, filter, cfg, duration, timeline); });
+    build("build.melody",       [&] { build_melody_events(pool, filter, cfg, duration, timeline); });
+    build("build.segmentation", [&] { build_segmentation_events(frame_store, filter, cfg, duration, timeline); });
+    build("build.quality",      [&] { build_quality_events(scan, filter, timeline); });
+    build("build.envelope",     [&] { build_envelope_events(scan, filter, cfg, duration, timeline); });
+
+    append_track_end(cfg, duration, timeline);
+
+    // Merge the per-builder runs into timestamp order
+    {
+        StageTimer timer;
+        timeline.sort();
+        StageStats s = timer.finish("sort");
+        s.frames  = timeline.size();
+        s.audio_s = duration;
+        stages.push_back(std::move(s));
     }
 
-    // Spectral pass (big combined pass for spectral, bands, tonal, pitch)
-    bool need_spectral = needs_any(filter, {
+    progress() << "  Timeline: " << timeline.size() << " events over "
+              << duration << "s" << std::endl;
+
+    AnalysisStats analysis;
+    analysis.input    = cfg.input_file;
+    analysis.duration = duration;
+    analysis.wall_s   = total.finish("analyze").wall_s;
+    analysis.stages   = std::move(stages);
+    stats().record(std::move(analysis));
+
+    return timeline;
+}
+
+// --- Streaming analysis ---
+// analyze_stream() runs only the frame-local descriptors, straight from a
+// MonoLoader, through a FrameAssembler that hands each frame's events to the
+// emitter as soon as every descriptor for it has arrived. onset comes from
+// the frame-wise detector here rather than OnsetRate.
+
+EventFilter streamable_events() {
+    return {
+        EventType::ONSET,
+        EventType::LOUDNESS, EventType::LOUDNESS_PEAK, EventType::ENERGY,
+        EventType::DYNAMIC_CHANGE,
         EventType::SPECTRAL_CENTROID, EventType::SPECTRAL_FLUX,
         EventType::SPECTRAL_COMPLEXITY, EventType::SPECTRAL_CONTRAST,
         EventType::SPECTRAL_ROLLOFF, EventType::MFCC, EventType::TIMBRE_CHANGE,
         EventType::BANDS_MEL, EventType::BANDS_BARK, EventType::BANDS_ERB, EventType::HFC,
-        EventType::CHROMA, EventType::KEY_CHANGE, EventType::CHORD_CHANGE,
-        EventType::TUNING, EventType::DISSONANCE, EventType::INHARMONICITY,
-        EventType::PITCH, EventType::PITCH_CHANGE,
-        EventType::SEGMENT_BOUNDARY});
-    if (need_spectral) {
-        run_spectral_pass(cfg, pool, filter);
+        EventType::CHROMA, EventType::DISSONANCE, EventType::INHARMONICITY,
+        EventType::PITCH, EventType::PITCH_CHANGE, EventType::SEGMENT_BOUNDARY,
+    };
+}
+
+// Streaming source that hands a LiveInput downstream one hop at a time
+class LiveSource : public Algorithm {
+public:
+    LiveSource(LiveInput& input, const EventQueue& queue, int block)
+        : input_(input), queue_(queue), block_(block) {
+        setName("LiveSource");
+        declareOutput(output_, block, "audio", "live mono PCM");
     }
 
-    // Melody pass
-    if (filter.count(EventType::MELODY)) {
-        run_melody_pass(cfg, pool);
+    AlgorithmStatus process() override {
+        if (queue_.cancelled()) {
+            shouldStop(true);
+            return FINISHED;
+        }
+        if (!output_.acquire(block_)) return NO_OUTPUT;
+        size_t n = input_.read(&output_.firstToken(), static_cast<size_t>(block_));
+        output_.release(static_cast<int>(n));
+        if (n < static_cast<size_t>(block_)) {
+            shouldStop(true);
+            return FINISHED;
+        }
+        // Not OK: the scheduler would keep reading, blocking on the input,
+        // before the frames already here reach the taps
+        return NO_OUTPUT;
     }
 
-    // --- Build timeline ---
-    std::cout << "  Building timeline..." << std::endl;
+    void declareParameters() override {}
 
-    // track.start at t=0
-    {
-        ::tracks::Envelope env;
-        env.set_timestamp(0.0);
-        auto* ts = env.mutable_track_start();
-        ts->set_filename(cfg.input_file);
-        ts->set_duration(duration);
-        ts->set_sample_rate(cfg.sample_rate);
-        ts->set_channels(1);
-        add_envelope(timeline, 0.0, env);
-    }
-
-    // Build events from pool data
-    build_beat_events(pool, filter, timeline);
-    build_onset_events(pool, filter, timeline);
-    build_silence_events(pool, filter, cfg, duration, timeline);
-    build_loudness_events(pool, filter, cfg, duration, timeline);
-    build_energy_events(pool, filter, cfg, duration, timeline);
-    build_spectral_events(pool, filter, cfg, duration, timeline);
-    build_band_events(pool, filter, cfg, duration, timeline);
-    build_tonal_events(pool, filter, cfg, duration, timeline);
-    build_pitch_events(pool, filter, cfg, duration, timeline);
-    build_melody_events(pool, filter, cfg, duration, timeline);
-    build_segmentation_events(pool, filter, cfg, duration, timeline);
+private:
+    Source<Real>      output_;
+    LiveInput&        input_;
+    const EventQueue& queue_;
+    int               block_;
+};
 
-    // track.position heartbeats
-    for (double t = cfg.position_interval; t < duration; t += cfg.position_interval) {
-        ::tracks::Envelope env;
-        env.set_timestamp(t);
-        env.mutable_track_position()->set_position(t);
-        add_envelope(timeline, t, env);
+// Frame-local events in cfg.enabled_events, or empty if there are none
+static EventFilter stream_filter(const Config& cfg) {
+    EventFilter filter;
+    for (auto et : streamable_events()) {
+        if (cfg.enabled_events.count(et)) filter.insert(et);
     }
+    return filter;
+}
 
-    // track.end
-    {
-        ::tracks::Envelope env;
-        env.set_timestamp(duration);
-        env.mutable_track_end();
-        add_envelope(timeline, duration, env);
+// Attaches the frame-local consumers to `plan` and runs its network into
+// `queue`. Returns the frames emitted, or -1 if the consumer cancelled.
+// Called with g_build_mutex held; releases it before running.
+static int run_stream_network(const Config& cfg, const EventFilter& filter, FramePlan& plan,
+                              LiveInput* live, EventQueue& queue,
+                              std::unique_lock<std::mutex>& lock) {
+    FrameAssembler out(cfg, filter, queue);
+    out.set_live(live);
+
+    if (needs_any(filter, {EventType::LOUDNESS, EventType::LOUDNESS_PEAK, EventType::ENERGY,
+                           EventType::DYNAMIC_CHANGE})) {
+        attach_loudness_energy(plan, cfg, out);
+    }
+    if (needs_spectral(filter)) {
+        attach_spectral(plan, cfg, out, filter);
+    }
+    if (filter.count(EventType::ONSET)) {
+        attach_onset(plan, cfg, out);
     }
 
-    // Sort by timestamp
-    std::sort(timeline.begin(), timeline.end(),
-        [](const TimelineEvent& a, const TimelineEvent& b) {
-            return a.timestamp < b.timestamp;
-        });
+    Network network(plan.source());
+    lock.unlock();
+    try {
+        network.run();
+        out.finish();
+    } catch (const StreamCancelled&) {
+        return -1;
+    }
+    return out.frames();
+}
 
-    std::cout << "  Timeline: " << timeline.size() << " events over "
-              << duration << "s" << std::endl;
+void analyze_stream(const Config& cfg, EventQueue& queue) {
+    // The emitter waits on finished(), so mark the queue done on every exit
+    struct FinishGuard {
+        EventQueue& queue;
+        ~FinishGuard() { queue.finish(); }
+    } guard{queue};
+
+    EventFilter filter = stream_filter(cfg);
+    if (filter.empty()) return;
+
+    // Decode as we go; the shared decode would be a full-file barrier again
+    AudioSource audio;
+    audio.filename    = cfg.input_file;
+    audio.sample_rate = Real(cfg.sample_rate);
+
+    std::unique_lock<std::mutex> lock(g_build_mutex);
+    FramePlan plan(audio);
+    log_progress("  Streaming frame features...");
+    int frames = run_stream_network(cfg, filter, plan, nullptr, queue, lock);
+    if (frames < 0) return;
+
+    double duration = static_cast<double>(plan.pcm().totalProduced()) / cfg.sample_rate;
+    queue.set_analyzed(duration);
+    log_progress("  Streamed " + std::to_string(frames) + " frames");
+}
 
-    return timeline;
+void analyze_live(const Config& cfg, LiveInput& input, EventQueue& queue) {
+    struct FinishGuard {
+        EventQueue& queue;
+        ~FinishGuard() { queue.finish(); }
+    } guard{queue};
+
+    EventFilter filter = stream_filter(cfg);
+    if (filter.empty()) return;
+
+    std::unique_lock<std::mutex> lock(g_build_mutex);
+    auto* source = new LiveSource(input, queue, cfg.hop_size);
+    FramePlan plan(source, source->output("audio"));
+    log_progress("  Analyzing live input...");
+    int frames = run_stream_network(cfg, filter, plan, &input, queue, lock);
+    if (frames < 0) return;
+
+    double duration = static_cast<double>(plan.pcm().totalProduced()) / cfg.sample_rate;
+    queue.set_analyzed(duration);
+    log_progress("  Analyzed " + std::to_string(frames) + " live frames");
 }
 
 } // namespace tracks
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "config.h"
+#include "event_queue.h"
 #include "events.h"
+#include "live_input.h"
 #include <string>
 
 namespace tracks {
@@ -11,4 +13,29 @@ namespace tracks {
 // Returns a sorted timeline of serialized protobuf Envelope events.
 Timeline analyze(const Config& cfg);
 
+// Per-stage progress lines on stdout (on by default)
+void set_progress_output(bool enabled);
+bool progress_output();
+
+// Transport events analyze() wraps around the analysis results.
+// append_track_start() must precede every other append so track.start wins
+// the tie at t=0; append_track_end() adds the position heartbeats and
+// track.end at `duration`.
+void append_track_start(const Config& cfg, double duration, Timeline& tl);
+void append_track_end(const Config& cfg, double duration, Timeline& tl);
+
+// Event types analyze_stream() can produce frame by frame
+EventFilter streamable_events();
+
+// Streams the frame-local events in cfg.enabled_events into `queue` while
+// decoding, advancing queue.analyzed() as frames complete. Always finishes
+// the queue before returning; returns early if the consumer cancels.
+void analyze_stream(const Config& cfg, EventQueue& queue);
+
+// analyze_stream() on live audio from `input`, read one hop at a time so
+// each frame's events are queued as soon as its last sample arrives. Slots
+// carry the capture time of that sample. Returns at the end of the input
+// or once the consumer cancels; always finishes the queue.
+void analyze_live(const Config& cfg, LiveInput& input, EventQueue& queue);
+
 } // namespace tracks
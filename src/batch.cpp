@@ -0,0 +1,178 @@
+#include "batch.h"
+#include "analyzer.h"
+#include "cache.h"
+#include "emitter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace tracks {
+
+static bool has_audio_extension(const fs::path& p) {
+    static const char* const kExtensions[] = {
+        ".mp3", ".wav", ".flac", ".ogg", ".oga", ".opus", ".m4a", ".aac",
+        ".aif", ".aiff", ".wma",
+    };
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    for (const char* known : kExtensions) {
+        if (ext == known) return true;
+    }
+    return false;
+}
+
+static std::vector<std::string> read_playlist(const fs::path& playlist) {
+    std::vector<std::string> inputs;
+    std::ifstream in(playlist);
+    std::string line;
+    while (std::getline(in, line)) {
+        // Trim whitespace (and the \r of CRLF playlists)
+        size_t start = line.find_first_not_of(" \t\r");
+        size_t end   = line.find_last_not_of(" \t\r");
+        if (start == std::string::npos) continue;
+        line = line.substr(start, end - start + 1);
+        if (line[0] == '#') continue;  // #EXTM3U, #EXTINF, comments
+
+        fs::path entry(line);
+        if (entry.is_relative()) entry = playlist.parent_path() / entry;
+        inputs.push_back(entry.string());
+    }
+    return inputs;
+}
+
+std::vector<std::string> collect_inputs(const std::string& source) {
+    std::error_code ec;
+    fs::path path(source);
+
+    if (fs::is_directory(path, ec)) {
+        std::vector<std::string> inputs;
+        for (fs::recursive_directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->is_regular_file(ec) && has_audio_extension(it->path())) {
+                inputs.push_back(it->path().string());
+            }
+        }
+        if (ec) {
+            std::cerr << "Error: cannot read directory " << source << ": " << ec.message() << "\n";
+            return {};
+        }
+        std::sort(inputs.begin(), inputs.end());
+        return inputs;
+    }
+
+    std::string ext = path.extension().string();
+    if (ext == ".m3u" || ext == ".m3u8") {
+        if (!fs::is_regular_file(path, ec)) {
+            std::cerr << "Error: cannot read playlist " << source << "\n";
+            return {};
+        }
+        return read_playlist(path);
+    }
+
+    std::cerr << "Error: " << source << " is neither a directory nor an .m3u playlist\n";
+    return {};
+}
+
+int run_batch(const Config& cfg, const std::vector<std::string>& inputs) {
+    int workers = cfg.batch_workers > 0 ? cfg.batch_workers
+                                        : static_cast<int>(std::thread::hardware_concurrency());
+    workers = std::max(1, std::min(workers, static_cast<int>(inputs.size())));
+
+    // Files are the unit of parallelism here; passes within a file run one
+    // at a time unless -j says otherwise
+    Config base = cfg;
+    if (base.jobs == 0) base.jobs = 1;
+
+    if (!cfg.cache) {
+        std::cerr << "Warning: analysis cache disabled; results will not be kept\n";
+    }
+    std::cout << "Batch: " << inputs.size() << " files, " << workers << " workers" << std::endl;
+
+    std::atomic<size_t> next{0};
+    std::atomic<int>    failed{0};
+    std::mutex          out_mutex;
+    double total_audio = 0.0;
+    size_t done = 0, hits = 0;
+
+    auto batch_start = std::chrono::steady_clock::now();
+
+    auto worker = [&] {
+        for (;;) {
+            if (g_interrupted.load(std::memory_order_relaxed)) return;
+            size_t i = next.fetch_add(1);
+            if (i >= inputs.size()) return;
+
+            Config file_cfg = base;
+            file_cfg.input_file = inputs[i];
+
+            auto start = std::chrono::steady_clock::now();
+            double duration = 0.0;
+            bool hit = false;
+            std::string error;
+            try {
+                Timeline timeline = analyze_cached(file_cfg, &hit);
+                if (!timeline.empty()) duration = timeline[timeline.size() - 1].timestamp;
+            } catch (const std::exception& e) {
+                error = e.what();
+            } catch (...) {
+                error = "unknown error";
+            }
+            double wall = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+
+            std::lock_guard<std::mutex> lock(out_mutex);
+            ++done;
+            char line[128];
+            if (!error.empty()) {
+                failed++;
+                std::snprintf(line, sizeof(line), "[%zu/%zu] FAILED ", done, inputs.size());
+                std::cout << line << inputs[i] << ": " << error << std::endl;
+                continue;
+            }
+            total_audio += duration;
+            if (hit) hits++;
+            if (hit) {
+                std::snprintf(line, sizeof(line), "[%zu/%zu] %8.1fs audio  cached   ",
+                              done, inputs.size(), duration);
+            } else {
+                std::snprintf(line, sizeof(line), "[%zu/%zu] %8.1fs audio in %6.1fs (%5.1fx)  ",
+                              done, inputs.size(), duration, wall, wall > 0 ? duration / wall : 0.0);
+            }
+            std::cout << line << inputs[i] << std::endl;
+        }
+    };
+
+    // Per-stage progress from concurrent files would interleave
+    bool progress = progress_output();
+    set_progress_output(false);
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    for (int w = 0; w < workers; ++w) threads.emplace_back(worker);
+    for (auto& t : threads) t.join();
+
+    set_progress_output(progress);
+
+    double wall = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - batch_start).count();
+    char line[160];
+    std::snprintf(line, sizeof(line),
+                  "Batch: %zu/%zu files (%zu cached, %d failed), %.1fs audio in %.1fs (%.1fx)",
+                  done, inputs.size(), hits, failed.load(), total_audio, wall,
+                  wall > 0 ? total_audio / wall : 0.0);
+    std::cout << line << std::endl;
+
+    return failed.load();
+}
+
+} // namespace tracks
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "config.h"
+#include <string>
+#include <vector>
+
+namespace tracks {
+
+// Audio files named by `source`: every file with a known audio extension
+// under a directory (recursively, sorted), or the entries of an .m3u/.m3u8
+// playlist (relative entries resolved against the playlist's directory).
+// Prints a message and returns an empty list on error.
+std::vector<std::string> collect_inputs(const std::string& source);
+
+// Analyzes every input into the analysis cache on cfg.batch_workers threads
+// (0 = one per core), printing audio-seconds per wall-second per file and in
+// total. Stops picking up new files once g_interrupted is set.
+// Returns the number of files that failed.
+int run_batch(const Config& cfg, const std::vector<std::string>& inputs);
+
+} // namespace tracks
@@ -0,0 +1,372 @@
+#include "cache.h"
+#include "analyzer.h"
+#include "mapped_file.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tracks {
+
+// Bump whenever the file layout, the EventType numbering, or the analysis
+// itself changes in a way that makes old entries wrong.
+static constexpr uint32_t kCacheVersion = 3;
+static constexpr char     kCacheMagic[8] = {'T', 'R', 'K', 'C', 'A', 'C', 'H', 'E'};
+
+static_assert(kEventTypeCount <= 64,
+              "event type bitmask no longer fits in 64 bits");
+
+// --- File layout ---
+// CacheHeader, then event_count CacheRecords in timestamp order, then
+// arena_bytes of serialized Envelopes. Native byte order; the cache is not
+// meant to be shared across architectures.
+
+struct CacheHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t sample_rate;
+    uint32_t frame_size;
+    uint32_t hop_size;
+    uint64_t content_hash;
+    double   continuous_interval;
+    uint64_t types;
+    double   duration;
+    uint64_t event_count;
+    uint64_t arena_bytes;
+};
+
+struct CacheRecord {
+    double   timestamp;
+    uint32_t offset;   // into the arena
+    uint32_t length;
+    uint32_t type;
+    uint32_t reserved;
+};
+
+static constexpr uint64_t kFnvBasis = 0xcbf29ce484222325ULL;
+static constexpr uint64_t kFnvPrime = 0x100000001b3ULL;
+
+static uint64_t fnv1a(const void* data, size_t len, uint64_t h = kFnvBasis) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < len; ++i) {
+        h ^= p[i];
+        h *= kFnvPrime;
+    }
+    return h;
+}
+
+uint64_t hash_file(const std::string& path) {
+    MappedFile file(path);
+    if (!file.ok()) {
+        throw std::runtime_error("cannot read " + path);
+    }
+    return fnv1a(file.data(), file.size());
+}
+
+uint64_t filter_mask(const EventFilter& filter) {
+    uint64_t mask = 0;
+    for (auto et : filter) {
+        mask |= uint64_t(1) << static_cast<int>(et);
+    }
+    return mask;
+}
+
+static std::string cache_dir(const Config& cfg) {
+    if (!cfg.cache_dir.empty()) return cfg.cache_dir;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME")) {
+        if (*xdg) return std::string(xdg) + "/tracks";
+    }
+    if (const char* home = std::getenv("HOME")) {
+        if (*home) return std::string(home) + "/.cache/tracks";
+    }
+    return ".tracks-cache";
+}
+
+// Unique per process and call: batch and daemon workers store concurrently
+static std::string temp_path(const std::string& path) {
+    static std::atomic<unsigned> stores{0};
+    return path + ".tmp" + std::to_string(::getpid()) + "." +
+           std::to_string(stores.fetch_add(1, std::memory_order_relaxed));
+}
+
+// --- Input hashes ---
+// Hashing reads the whole input, so each input path gets a small record of
+// its hash and the device, inode, size and mtime it was taken at. A run on
+// an unchanged file only stats it.
+
+struct HashRecord {
+    char     magic[8];
+    uint64_t device;
+    uint64_t inode;
+    uint64_t size;
+    int64_t  mtime_ns;
+    uint64_t content_hash;
+};
+
+static constexpr char kHashMagic[8] = {'T', 'R', 'K', 'H', 'A', 'S', 'H', '1'};
+
+uint64_t input_hash(const Config& cfg) {
+    struct stat st;
+    if (::stat(cfg.input_file.c_str(), &st) != 0) {
+        throw std::runtime_error("cannot read " + cfg.input_file);
+    }
+    HashRecord want{};
+    std::memcpy(want.magic, kHashMagic, sizeof(kHashMagic));
+    want.device   = static_cast<uint64_t>(st.st_dev);
+    want.inode    = static_cast<uint64_t>(st.st_ino);
+    want.size     = static_cast<uint64_t>(st.st_size);
+    want.mtime_ns = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+
+    std::error_code ec;
+    std::string input = std::filesystem::absolute(cfg.input_file, ec).string();
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.tlh",
+                  static_cast<unsigned long long>(fnv1a(input.data(), input.size())));
+    std::string dir  = cache_dir(cfg) + "/hashes";
+    std::string path = dir + "/" + name;
+
+    {
+        HashRecord have;
+        std::ifstream in(path, std::ios::binary);
+        if (in.read(reinterpret_cast<char*>(&have), sizeof(have)) &&
+            std::memcmp(&have, &want, offsetof(HashRecord, content_hash)) == 0) {
+            return have.content_hash;
+        }
+    }
+
+    want.content_hash = hash_file(cfg.input_file);
+
+    // A file written within the last couple of seconds may change again
+    // without its mtime moving; hash it again next time
+    if (st.st_mtim.tv_sec + 2 > std::time(nullptr)) return want.content_hash;
+
+    std::filesystem::create_directories(dir, ec);
+    std::string tmp = temp_path(path);
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&want), sizeof(want));
+        if (!out) {
+            std::remove(tmp.c_str());
+            return want.content_hash;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) std::remove(tmp.c_str());
+    return want.content_hash;
+}
+
+std::string cache_path(const Config& cfg, uint64_t content_hash) {
+    // Everything except the event types goes into the name, so one entry
+    // accumulates types across runs
+    uint64_t params = fnv1a(&kCacheVersion, sizeof(kCacheVersion));
+    params = fnv1a(&cfg.sample_rate, sizeof(cfg.sample_rate), params);
+    params = fnv1a(&cfg.frame_size, sizeof(cfg.frame_size), params);
+    params = fnv1a(&cfg.hop_size, sizeof(cfg.hop_size), params);
+    params = fnv1a(&cfg.continuous_interval, sizeof(cfg.continuous_interval), params);
+    params = fnv1a(cfg.segmentation.data(), cfg.segmentation.size(), params);
+    for (const auto& family : resolution_families()) {
+        Resolution r = resolution(cfg, family);
+        params = fnv1a(&r, sizeof(r), params);
+    }
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "%016llx-%016llx.tlc",
+                  static_cast<unsigned long long>(content_hash),
+                  static_cast<unsigned long long>(params));
+    return cache_dir(cfg) + "/" + name;
+}
+
+bool load_cache(const std::string& path, const Config& cfg, uint64_t content_hash,
+                CacheEntry& entry) {
+    auto mapping = std::make_shared<MappedFile>(path);
+    const MappedFile& file = *mapping;
+    if (!file.data() || file.size() < sizeof(CacheHeader)) return false;
+
+    CacheHeader h;
+    std::memcpy(&h, file.data(), sizeof(h));
+    if (std::memcmp(h.magic, kCacheMagic, sizeof(kCacheMagic)) != 0 ||
+        h.version != kCacheVersion ||
+        h.content_hash != content_hash ||
+        h.sample_rate != static_cast<uint32_t>(cfg.sample_rate) ||
+        h.frame_size != static_cast<uint32_t>(cfg.frame_size) ||
+        h.hop_size != static_cast<uint32_t>(cfg.hop_size) ||
+        h.continuous_interval != cfg.continuous_interval) {
+        return false;
+    }
+
+    size_t records_size = sizeof(CacheRecord) * h.event_count;
+    if (h.event_count > file.size() / sizeof(CacheRecord) ||
+        file.size() - sizeof(CacheHeader) < records_size ||
+        file.size() - sizeof(CacheHeader) - records_size != h.arena_bytes) {
+        return false;
+    }
+
+    const uint8_t* records = file.data() + sizeof(CacheHeader);
+    const uint8_t* arena   = records + records_size;
+
+    entry.types    = h.types;
+    entry.duration = h.duration;
+    // The events stay in the mapping, which the timeline keeps open
+    entry.events   = Timeline();
+    entry.events.map(mapping, arena, h.arena_bytes);
+    entry.events.reserve(h.event_count, 0);
+    for (uint64_t i = 0; i < h.event_count; ++i) {
+        CacheRecord r;
+        std::memcpy(&r, records + i * sizeof(CacheRecord), sizeof(r));
+        if (uint64_t(r.offset) + r.length > h.arena_bytes ||
+            r.type >= kEventTypeCount) {
+            return false;
+        }
+        entry.events.append_mapped(r.timestamp, static_cast<EventType>(r.type), r.offset, r.length);
+    }
+    return true;
+}
+
+bool store_cache(const std::string& path, const Config& cfg, uint64_t content_hash,
+                 const CacheEntry& entry) {
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+    CacheHeader h{};
+    std::memcpy(h.magic, kCacheMagic, sizeof(kCacheMagic));
+    h.version             = kCacheVersion;
+    h.sample_rate         = static_cast<uint32_t>(cfg.sample_rate);
+    h.frame_size          = static_cast<uint32_t>(cfg.frame_size);
+    h.hop_size            = static_cast<uint32_t>(cfg.hop_size);
+    h.content_hash        = content_hash;
+    h.continuous_interval = cfg.continuous_interval;
+    h.types               = entry.types;
+    h.duration            = entry.duration;
+    h.event_count         = entry.events.size();
+
+    std::vector<CacheRecord> records;
+    records.reserve(entry.events.size());
+    uint64_t offset = 0;
+    for (const auto& e : entry.events) {
+        records.push_back({e.timestamp, static_cast<uint32_t>(offset), e.length,
+                           static_cast<uint32_t>(e.type), 0});
+        offset += e.length;
+    }
+    h.arena_bytes = offset;
+
+    std::string tmp = temp_path(path);
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char*>(records.data()),
+                  static_cast<std::streamsize>(records.size() * sizeof(CacheRecord)));
+        for (const auto& e : entry.events) {
+            auto bytes = entry.events.bytes(e);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+        if (!out) {
+            std::cerr << "Warning: could not write analysis cache " << tmp << "\n";
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::cerr << "Warning: could not write analysis cache " << path << "\n";
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Timeline for cfg from a cache entry: the requested types plus transport.
+// Events of a loaded entry are served from its mapping, not copied.
+static Timeline timeline_from_entry(const Config& cfg, const CacheEntry& entry) {
+    Timeline timeline;
+    timeline.map(entry.events);
+    timeline.reserve(entry.events.size() + 2, 0);
+    append_track_start(cfg, entry.duration, timeline);
+    for (const auto& e : entry.events) {
+        if (!cfg.enabled_events.count(e.type)) continue;
+        timeline.append(entry.events, e);
+    }
+    append_track_end(cfg, entry.duration, timeline);
+    timeline.sort();
+    return timeline;
+}
+
+Timeline analyze_cached(const Config& cfg, bool* hit) {
+    if (hit) *hit = false;
+    if (!cfg.cache) return analyze(cfg);
+
+    uint64_t content_hash = 0;
+    try {
+        content_hash = input_hash(cfg);
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: " << e.what() << "; analysis cache disabled\n";
+        return analyze(cfg);
+    }
+
+    std::string path = cache_path(cfg, content_hash);
+    CacheEntry entry;
+    if (!load_cache(path, cfg, content_hash, entry)) {
+        entry = CacheEntry();
+    }
+
+    uint64_t missing = filter_mask(cfg.enabled_events) & ~entry.types;
+    if (entry.types != 0 && missing == 0) {
+        Timeline timeline = timeline_from_entry(cfg, entry);
+        if (hit) *hit = true;
+        if (progress_output()) {
+            std::cout << "  Cache hit: " << path << std::endl;
+            std::cout << "  Timeline: " << timeline.size() << " events over "
+                      << entry.duration << "s" << std::endl;
+        }
+        return timeline;
+    }
+
+    // Analyze only what the entry lacks, then fold it in
+    Config partial = cfg;
+    partial.enabled_events.clear();
+    for (auto et : cfg.enabled_events) {
+        if (missing & (uint64_t(1) << static_cast<int>(et))) partial.enabled_events.insert(et);
+    }
+    if (entry.types != 0 && progress_output()) {
+        std::cout << "  Cache: analyzing " << partial.enabled_events.size()
+                  << " event types not yet cached" << std::endl;
+    }
+    Timeline fresh = analyze(partial);
+
+    CacheEntry updated;
+    updated.types = entry.types | missing;
+    updated.events.reserve(entry.events.size() + fresh.size(),
+                           entry.events.arena_bytes() + fresh.arena_bytes());
+    for (const auto& e : entry.events) {
+        auto bytes = entry.events.bytes(e);
+        updated.events.append(e.timestamp, e.type, bytes.data(), bytes.size());
+    }
+    for (const auto& e : fresh) {
+        if (e.type == EventType::TRACK_END) updated.duration = e.timestamp;
+        if (is_transport_event(e.type)) continue;
+        auto bytes = fresh.bytes(e);
+        updated.events.append(e.timestamp, e.type, bytes.data(), bytes.size());
+    }
+    updated.events.sort();
+
+    if (entry.types != 0 && updated.duration != entry.duration) {
+        // Same content and parameters should give the same length
+        std::cerr << "Warning: cached duration " << entry.duration
+                  << "s differs from analyzed " << updated.duration << "s\n";
+    }
+
+    store_cache(path, cfg, content_hash, updated);
+
+    if (entry.types == 0) return fresh;
+    return timeline_from_entry(cfg, updated);
+}
+
+} // namespace tracks
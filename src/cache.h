@@ -0,0 +1,56 @@
+#pragma once
+
+#include "config.h"
+#include "events.h"
+#include <cstdint>
+#include <string>
+
+namespace tracks {
+
+// --- Analysis cache ---
+// Finished timelines are stored on disk, one file per input content hash and
+// analysis parameters (sample_rate, frame and hop sizes of every family,
+// segmentation, continuous_interval). Transport events are not stored: they are rebuilt on
+// load so the entry does not depend on the file name or position_interval.
+//
+// The entry records which event types it holds, so an entry written with
+// --all serves any subset. When some requested types are missing, only those
+// are analyzed and the entry is rewritten with the union.
+
+struct CacheEntry {
+    uint64_t    types    = 0;    // bit i set = EventType(i) analyzed
+    double      duration = 0.0;
+    Timeline    events;          // sorted, no transport events
+};
+
+// FNV-1a over the file contents. Throws std::runtime_error if unreadable.
+uint64_t hash_file(const std::string& path);
+
+// hash_file() of cfg.input_file, remembered in the cache directory against
+// the file's device, inode, size and mtime so an unchanged input is not
+// read again. Throws std::runtime_error if unreadable.
+uint64_t input_hash(const Config& cfg);
+
+// Bitmask of the event types in `filter`
+uint64_t filter_mask(const EventFilter& filter);
+
+// Cache file for `cfg` with content hash `content_hash`
+std::string cache_path(const Config& cfg, uint64_t content_hash);
+
+// Reads a cache file. Returns false if it is missing, truncated, from another
+// format version, or written for different analysis parameters.
+bool load_cache(const std::string& path, const Config& cfg, uint64_t content_hash,
+                CacheEntry& entry);
+
+// Writes a cache file atomically (temporary file + rename).
+// Returns false and prints a warning on failure.
+bool store_cache(const std::string& path, const Config& cfg, uint64_t content_hash,
+                 const CacheEntry& entry);
+
+// analyze() behind the cache: loads the entry for cfg.input_file if it holds
+// every type in cfg.enabled_events, otherwise analyzes the missing types and
+// updates the entry. Falls back to plain analyze() if the cache is disabled.
+// Sets *hit to whether the entry already had everything.
+Timeline analyze_cached(const Config& cfg, bool* hit = nullptr);
+
+} // namespace tracks
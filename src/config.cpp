@@ -1,7 +1,9 @@
 #include "config.h"
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <yaml-cpp/yaml.h>
 #include <boost/program_options.hpp>
 
@@ -9,6 +11,136 @@ namespace po = boost::program_options;
 
 namespace tracks {
 
+// "float", "q8", "q16", "q8-delta" or "q16-delta"
+static bool parse_vector_encoding(const std::string& name, VectorEncoding& out) {
+    static const std::map<std::string, VectorEncoding> modes = {
+        {"float",     {0,  false}},
+        {"q8",        {8,  false}},
+        {"q16",       {16, false}},
+        {"q8-delta",  {8,  true}},
+        {"q16-delta", {16, true}},
+    };
+    auto it = modes.find(name);
+    if (it == modes.end()) return false;
+    out = it->second;
+    return true;
+}
+
+// Sets the encoding of one vector type, or of all of them for "" / "all"
+static bool apply_vector_encoding(Config& cfg, const std::string& type, const std::string& mode) {
+    VectorEncoding enc;
+    if (!parse_vector_encoding(mode, enc)) {
+        std::cerr << "Error: unknown vector encoding '" << mode
+                  << "' (float, q8, q16, q8-delta, q16-delta)\n";
+        return false;
+    }
+    EventFilter types;
+    if (type.empty() || type == "all") {
+        types = vector_events();
+    } else {
+        auto it = event_name_map().find(type);
+        if (it == event_name_map().end() || !vector_events().count(it->second)) {
+            std::cerr << "Error: '" << type << "' is not a vector event type\n";
+            return false;
+        }
+        types.insert(it->second);
+    }
+    for (auto t : types) {
+        if (enc.bits == 0) cfg.vector_encoding.erase(t);
+        else               cfg.vector_encoding[t] = enc;
+    }
+    return true;
+}
+
+// A destination's event list: comma-separated names, or "all" / "" for
+// everything analyzed. False if names were given but none is valid.
+static bool parse_destination_events(const std::string& csv, EventFilter& out) {
+    out.clear();
+    if (csv.empty() || csv == "all") return true;
+    out = parse_event_filter(csv);
+    return !out.empty();
+}
+
+const std::vector<std::string>& resolution_families() {
+    static const std::vector<std::string> families = {
+        "silence", "loudness", "spectral", "tonal", "pitch", "melody",
+    };
+    return families;
+}
+
+Resolution resolution(const Config& cfg, const std::string& family) {
+    Resolution r;
+    auto it = cfg.resolutions.find(family);
+    if (it != cfg.resolutions.end()) r = it->second;
+    if (r.frame_size <= 0) r.frame_size = cfg.frame_size;
+    if (r.hop_size <= 0)   r.hop_size   = cfg.hop_size;
+    return r;
+}
+
+static bool set_resolution(Config& cfg, const std::string& family, const Resolution& r) {
+    const auto& families = resolution_families();
+    if (std::find(families.begin(), families.end(), family) == families.end()) {
+        std::cerr << "Error: unknown feature family '" << family
+                  << "' (silence, loudness, spectral, tonal, pitch, melody)\n";
+        return false;
+    }
+    if (r.frame_size < 0 || r.hop_size < 0) {
+        std::cerr << "Error: negative frame or hop size for '" << family << "'\n";
+        return false;
+    }
+    cfg.resolutions[family] = r;
+    return true;
+}
+
+// "FAMILY=FRAME/HOP", e.g. "tonal=4096/2048"; either size may be left out
+// ("loudness=/256") to keep the default
+static bool parse_resolution(Config& cfg, const std::string& spec) {
+    auto eq = spec.find('=');
+    auto slash = spec.find('/', eq == std::string::npos ? 0 : eq);
+    if (eq == std::string::npos || slash == std::string::npos) {
+        std::cerr << "Error: invalid resolution '" << spec << "' (expected FAMILY=FRAME/HOP)\n";
+        return false;
+    }
+    Resolution r;
+    try {
+        std::string frame = spec.substr(eq + 1, slash - eq - 1);
+        std::string hop   = spec.substr(slash + 1);
+        if (!frame.empty()) r.frame_size = std::stoi(frame);
+        if (!hop.empty())   r.hop_size   = std::stoi(hop);
+    } catch (const std::exception&) {
+        std::cerr << "Error: invalid resolution '" << spec << "' (expected FAMILY=FRAME/HOP)\n";
+        return false;
+    }
+    return set_resolution(cfg, spec.substr(0, eq), r);
+}
+
+// "ADDR[:PORT][/EVENTS][@RATE]", e.g. "192.168.1.40:6000/beat,onset@20"
+static bool parse_destination(const std::string& spec, Destination& out) {
+    std::string rest = spec;
+    out = Destination();
+    try {
+        auto at = rest.find('@');
+        if (at != std::string::npos) {
+            out.max_rate = std::stod(rest.substr(at + 1));
+            rest.resize(at);
+        }
+        auto slash = rest.find('/');
+        if (slash != std::string::npos) {
+            if (!parse_destination_events(rest.substr(slash + 1), out.events)) return false;
+            rest.resize(slash);
+        }
+        auto colon = rest.find(':');
+        if (colon != std::string::npos) {
+            out.port = static_cast<uint16_t>(std::stoi(rest.substr(colon + 1)));
+            rest.resize(colon);
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+    out.address = rest;
+    return !out.address.empty();
+}
+
 static void load_yaml(Config& cfg, const std::string& path) {
     std::ifstream fin(path);
     if (!fin.is_open()) return;
@@ -21,21 +153,94 @@ static void load_yaml(Config& cfg, const std::string& path) {
         if (net["ttl"])             cfg.ttl  = net["ttl"].as<int>();
         if (net["loopback"])        cfg.loopback  = net["loopback"].as<bool>();
         if (net["interface"])       cfg.interface = net["interface"].as<std::string>();
+        if (net["coalesce"])        cfg.coalesce  = net["coalesce"].as<bool>();
+        if (net["mtu"])             cfg.mtu       = net["mtu"].as<int>();
         if (net["enable_unicast"])  cfg.enable_unicast = net["enable_unicast"].as<bool>();
         if (net["unicast_target"])  cfg.unicast_target = net["unicast_target"].as<std::string>();
+        if (auto dests = net["destinations"]) {
+            cfg.destinations.clear();
+            for (const auto& d : dests) {
+                Destination dest;
+                dest.address = d["address"].as<std::string>();
+                if (d["port"])     dest.port     = d["port"].as<uint16_t>();
+                if (d["max_rate"]) dest.max_rate = d["max_rate"].as<double>();
+                if (auto ev = d["events"]) {
+                    std::string csv;
+                    if (ev.IsSequence()) {
+                        for (const auto& name : ev) csv += name.as<std::string>() + ",";
+                    } else {
+                        csv = ev.as<std::string>();
+                    }
+                    if (!parse_destination_events(csv, dest.events)) {
+                        std::cerr << "Error: no valid events for destination " << dest.address
+                                  << "; skipping it\n";
+                        continue;
+                    }
+                }
+                cfg.destinations.push_back(dest);
+            }
+        }
     }
     if (auto an = root["analysis"]) {
         if (an["sample_rate"]) cfg.sample_rate = an["sample_rate"].as<int>();
         if (an["frame_size"])  cfg.frame_size  = an["frame_size"].as<int>();
         if (an["hop_size"])    cfg.hop_size    = an["hop_size"].as<int>();
+        if (an["shared_decode"]) cfg.shared_decode = an["shared_decode"].as<bool>();
+        if (an["shared_decode_max"]) cfg.shared_decode_max = an["shared_decode_max"].as<double>();
+        if (an["jobs"])        cfg.jobs        = an["jobs"].as<int>();
+        if (an["segmentation"]) cfg.segmentation = an["segmentation"].as<std::string>();
+        if (auto res = an["resolution"]) {
+            for (const auto& kv : res) {
+                Resolution r;
+                if (kv.second["frame_size"]) r.frame_size = kv.second["frame_size"].as<int>();
+                if (kv.second["hop_size"])   r.hop_size   = kv.second["hop_size"].as<int>();
+                set_resolution(cfg, kv.first.as<std::string>(), r);
+            }
+        }
+    }
+    if (auto ba = root["batch"]) {
+        if (ba["workers"]) cfg.batch_workers = ba["workers"].as<int>();
+    }
+    if (auto ca = root["cache"]) {
+        if (ca["enabled"]) cfg.cache     = ca["enabled"].as<bool>();
+        if (ca["dir"])     cfg.cache_dir = ca["dir"].as<std::string>();
     }
     if (auto tr = root["transport"]) {
         if (tr["position_interval"]) cfg.position_interval = tr["position_interval"].as<double>();
         if (tr["prepare_time"])      cfg.prepare_time      = tr["prepare_time"].as<double>();
+        if (tr["snapshot"])          cfg.snapshot          = tr["snapshot"].as<bool>();
+    }
+    if (auto ti = root["timing"]) {
+        if (ti["precise"])     cfg.precise_timing = ti["precise"].as<bool>();
+        if (ti["spin_us"])     cfg.spin_us        = ti["spin_us"].as<int>();
+        if (ti["rt_priority"]) cfg.rt_priority    = ti["rt_priority"].as<int>();
+        if (ti["cpu"])         cfg.cpu            = ti["cpu"].as<int>();
+    }
+    if (auto st = root["streaming"]) {
+        if (st["enabled"])    cfg.stream           = st["enabled"].as<bool>();
+        if (st["lookahead"])  cfg.stream_lookahead = st["lookahead"].as<double>();
+        if (st["queue_size"]) cfg.stream_queue     = st["queue_size"].as<int>();
+    }
+    if (auto li = root["live"]) {
+        if (li["input"])    cfg.live_input    = li["input"].as<std::string>();
+        if (li["format"])   cfg.live_format   = li["format"].as<std::string>();
+        if (li["channels"]) cfg.live_channels = li["channels"].as<int>();
+    }
+    if (auto sa = root["stats"]) {
+        if (sa["json"])       cfg.stats_json = sa["json"].as<std::string>();
+        if (sa["prometheus"]) cfg.prometheus = sa["prometheus"].as<std::string>();
     }
     if (auto ev = root["events"]) {
         if (ev["continuous_interval"]) cfg.continuous_interval = ev["continuous_interval"].as<double>();
     }
+    if (auto en = root["encoding"]) {
+        if (en["keyframe_interval"]) cfg.keyframe_interval = en["keyframe_interval"].as<int>();
+        if (auto vec = en["vectors"]) {
+            for (const auto& kv : vec) {
+                apply_vector_encoding(cfg, kv.first.as<std::string>(), kv.second.as<std::string>());
+            }
+        }
+    }
 }
 
 static void print_available_events() {
@@ -61,20 +266,53 @@ bool load_config(Config& cfg, int argc, char* argv[]) {
         ("help,h",    "Show help")
         ("input,i",   po::value<std::string>(), "Input audio file (required)")
         ("config,c",  po::value<std::string>(), "Config YAML file")
+        ("playlist",  po::value<std::string>(), "Play a directory or .m3u playlist back to back without gaps")
+        ("dump-timeline", po::value<std::string>(), "Analyze, write the timeline to this file for `tracks replay`, and exit")
         ("multicast-group", po::value<std::string>(), "Multicast group address")
         ("port,p",    po::value<uint16_t>(),    "UDP port")
         ("ttl",       po::value<int>(),         "Multicast TTL")
         ("loopback",  po::value<bool>(),        "Enable multicast loopback")
         ("interface", po::value<std::string>(), "Outbound interface address")
+        ("coalesce",  "Pack events sharing a deadline into one datagram (receivers must understand EnvelopeBatch)")
+        ("mtu",       po::value<int>(),         "Path MTU bounding a coalesced datagram (default 1500)")
+        ("destination", po::value<std::vector<std::string>>()->composing(),
+                      "Send to ADDR[:PORT][/EVENTS][@RATE] instead of the multicast group; repeatable")
         ("sample-rate",        po::value<int>(),    "Analysis sample rate")
         ("frame-size",         po::value<int>(),    "Analysis frame size")
         ("hop-size",           po::value<int>(),    "Analysis hop size")
+        ("shared-decode",      po::value<bool>(),   "Decode input once and share PCM across passes (default true)")
+        ("shared-decode-max",  po::value<double>(), "Longest input in seconds to decode once; longer ones are decoded per pass (default 600, 0 = no limit)")
+        ("jobs,j",             po::value<int>(),    "Analysis passes run in parallel (default: one per core)")
+        ("resolution",         po::value<std::vector<std::string>>()->composing(),
+                               "Frame and hop size of one feature family, FAMILY=FRAME/HOP (e.g. tonal=4096/2048); repeatable")
+        ("segmentation",       po::value<std::string>(), "segment.boundary detector: online (default) or sbic (whole file, batch only)")
+        ("workers",            po::value<int>(),    "Files analyzed in parallel: analyze-batch (default: one per core), daemon (default: 2)")
+        ("no-cache",           "Always analyze; do not read or write the analysis cache")
+        ("cache-dir",          po::value<std::string>(), "Analysis cache directory (default ~/.cache/tracks)")
         ("position-interval",  po::value<double>(), "Seconds between position heartbeats")
         ("prepare-time",       po::value<double>(), "Seconds before track.start to send track.prepare (default 5.0)")
+        ("no-snapshot",        "Do not send a state snapshot with each track.position")
+        ("precise-timing",     "Sleep to absolute deadlines and spin before each send")
+        ("spin-us",            po::value<int>(),    "Busy-wait window before each deadline with --precise-timing (default 200)")
+        ("rt-priority",        po::value<int>(),    "Run the emitter under SCHED_FIFO with this priority (needs CAP_SYS_NICE)")
+        ("cpu",                po::value<int>(),    "Pin the emitter thread to this CPU")
+        ("stream",             "Start emitting while frame features are still being analyzed")
+        ("lookahead",          po::value<double>(), "Seconds analyzed ahead before streaming playback starts (default 10.0)")
+        ("live",               po::value<std::string>(), "Analyze live input instead of a file: - for raw PCM on stdin"
+#ifdef TRACKS_WITH_ALSA
+                                                         ", alsa:DEVICE for a capture device"
+#endif
+        )
+        ("live-format",        po::value<std::string>(), "Sample format of live PCM on stdin: s16 or f32 (default s16)")
+        ("live-channels",      po::value<int>(),    "Interleaved channels of live PCM, averaged to mono (default 1)")
+        ("stats-json",         po::value<std::string>(), "On exit, write per-stage analysis timings and send counters to this JSON file")
+        ("prometheus",         po::value<std::string>(), "Serve the same as Prometheus text on [ADDR:]PORT/metrics (ADDR defaults to 127.0.0.1)")
         ("events,e",  po::value<std::string>(), "Comma-separated event types (e.g. beat,onset,pitch)")
         ("all",       "Enable all event types")
         ("primary",   "Enable tier 1 events (beat, onset, silence, loudness, energy)")
         ("continuous-interval", po::value<double>(), "Seconds between continuous event emissions (default 0.1)")
+        ("quantize",  po::value<std::string>(), "Vector event encoding, e.g. q8-delta or mfcc=q8,bands.mel=q16 (float, q8, q16, q8-delta, q16-delta)")
+        ("keyframe-interval", po::value<int>(), "With delta encoding, send every Nth frame of a type absolute (default 50)")
         ("list-events", "List all available event types and exit")
         ("enable-unicast", po::bool_switch(), "Also send packets via unicast (WSL2 workaround)")
         ("unicast-target", po::value<std::string>(), "Unicast target IP (default: auto-detect WSL2 host)")
@@ -114,17 +352,69 @@ bool load_config(Config& cfg, int argc, char* argv[]) {
 
     // CLI overrides
     if (vm.count("input"))             cfg.input_file       = vm["input"].as<std::string>();
+    if (vm.count("playlist"))          cfg.playlist         = vm["playlist"].as<std::string>();
+    if (vm.count("dump-timeline"))     cfg.dump_timeline    = vm["dump-timeline"].as<std::string>();
     if (vm.count("multicast-group"))   cfg.multicast_group  = vm["multicast-group"].as<std::string>();
     if (vm.count("port"))              cfg.port             = vm["port"].as<uint16_t>();
     if (vm.count("ttl"))               cfg.ttl              = vm["ttl"].as<int>();
     if (vm.count("loopback"))          cfg.loopback         = vm["loopback"].as<bool>();
     if (vm.count("interface"))         cfg.interface        = vm["interface"].as<std::string>();
+    if (vm.count("coalesce"))          cfg.coalesce         = true;
+    if (vm.count("mtu"))               cfg.mtu              = vm["mtu"].as<int>();
+    if (vm.count("destination")) {
+        cfg.destinations.clear();
+        for (const auto& spec : vm["destination"].as<std::vector<std::string>>()) {
+            Destination dest;
+            if (!parse_destination(spec, dest)) {
+                std::cerr << "Error: invalid destination '" << spec
+                          << "' (expected ADDR[:PORT][/EVENTS][@RATE])\n";
+                return false;
+            }
+            cfg.destinations.push_back(dest);
+        }
+    }
     if (vm.count("sample-rate"))       cfg.sample_rate      = vm["sample-rate"].as<int>();
     if (vm.count("frame-size"))        cfg.frame_size       = vm["frame-size"].as<int>();
     if (vm.count("hop-size"))          cfg.hop_size         = vm["hop-size"].as<int>();
+    if (vm.count("shared-decode"))     cfg.shared_decode    = vm["shared-decode"].as<bool>();
+    if (vm.count("shared-decode-max")) cfg.shared_decode_max = vm["shared-decode-max"].as<double>();
+    if (vm.count("jobs"))              cfg.jobs             = vm["jobs"].as<int>();
+    if (vm.count("segmentation"))      cfg.segmentation     = vm["segmentation"].as<std::string>();
+    if (vm.count("resolution")) {
+        for (const auto& spec : vm["resolution"].as<std::vector<std::string>>()) {
+            if (!parse_resolution(cfg, spec)) return false;
+        }
+    }
+    if (vm.count("workers"))           cfg.batch_workers    = vm["workers"].as<int>();
+    if (vm.count("no-cache"))          cfg.cache            = false;
+    if (vm.count("cache-dir"))         cfg.cache_dir        = vm["cache-dir"].as<std::string>();
     if (vm.count("position-interval")) cfg.position_interval= vm["position-interval"].as<double>();
     if (vm.count("prepare-time"))    cfg.prepare_time     = vm["prepare-time"].as<double>();
+    if (vm.count("no-snapshot"))       cfg.snapshot         = false;
+    if (vm.count("precise-timing"))    cfg.precise_timing   = true;
+    if (vm.count("spin-us"))           cfg.spin_us          = vm["spin-us"].as<int>();
+    if (vm.count("rt-priority"))       cfg.rt_priority      = vm["rt-priority"].as<int>();
+    if (vm.count("cpu"))               cfg.cpu              = vm["cpu"].as<int>();
+    if (vm.count("stream"))            cfg.stream           = true;
+    if (vm.count("lookahead"))         cfg.stream_lookahead = vm["lookahead"].as<double>();
+    if (vm.count("live"))              cfg.live_input       = vm["live"].as<std::string>();
+    if (vm.count("live-format"))       cfg.live_format      = vm["live-format"].as<std::string>();
+    if (vm.count("live-channels"))     cfg.live_channels    = vm["live-channels"].as<int>();
+    if (vm.count("stats-json"))        cfg.stats_json       = vm["stats-json"].as<std::string>();
+    if (vm.count("prometheus"))        cfg.prometheus       = vm["prometheus"].as<std::string>();
     if (vm.count("continuous-interval")) cfg.continuous_interval = vm["continuous-interval"].as<double>();
+    if (vm.count("keyframe-interval"))   cfg.keyframe_interval   = vm["keyframe-interval"].as<int>();
+    if (vm.count("quantize")) {
+        std::istringstream ss(vm["quantize"].as<std::string>());
+        std::string entry;
+        while (std::getline(ss, entry, ',')) {
+            auto eq = entry.find('=');
+            bool ok = eq == std::string::npos
+                ? apply_vector_encoding(cfg, "", entry)
+                : apply_vector_encoding(cfg, entry.substr(0, eq), entry.substr(eq + 1));
+            if (!ok) return false;
+        }
+    }
     if (vm["enable-unicast"].as<bool>())  cfg.enable_unicast = true;
     if (vm.count("unicast-target"))       cfg.unicast_target = vm["unicast-target"].as<std::string>();
 
@@ -142,8 +432,22 @@ bool load_config(Config& cfg, int argc, char* argv[]) {
     } else {
         cfg.enabled_events = default_events();
     }
+    // Events a destination asks for are analyzed even if not selected above,
+    // so one analysis feeds every destination
+    for (const auto& dest : cfg.destinations) {
+        cfg.enabled_events.insert(dest.events.begin(), dest.events.end());
+    }
+
+    if (cfg.segmentation != "online" && cfg.segmentation != "sbic") {
+        std::cerr << "Error: unknown segmentation '" << cfg.segmentation << "' (online, sbic)\n";
+        return false;
+    }
+    if (cfg.live_format != "s16" && cfg.live_format != "f32") {
+        std::cerr << "Error: unknown live format '" << cfg.live_format << "' (s16, f32)\n";
+        return false;
+    }
 
-    if (cfg.input_file.empty()) {
+    if (cfg.input_file.empty() && cfg.playlist.empty() && cfg.live_input.empty()) {
         std::cerr << "Error: no input file specified\n" << desc << "\n";
         return false;
     }
@@ -1,11 +1,33 @@
 #pragma once
 
 #include "events.h"
+#include <map>
 #include <string>
 #include <cstdint>
+#include <vector>
 
 namespace tracks {
 
+// On-wire encoding of a vector event's values
+struct VectorEncoding {
+    int  bits  = 0;      // 8 or 16 = quantized; 0 = plain floats
+    bool delta = false;  // difference from the previous frame of the type
+};
+
+// One receiver address and the part of the stream it gets
+struct Destination {
+    std::string address;          // multicast group or unicast IP
+    uint16_t    port     = 0;     // 0 = Config::port
+    EventFilter events;           // empty = every analyzed event
+    double      max_rate = 0.0;   // events per second of each type (0 = unlimited)
+};
+
+// Frame and hop size of one feature family; 0 = the analysis default
+struct Resolution {
+    int frame_size = 0;
+    int hop_size   = 0;
+};
+
 struct Config {
     // network
     std::string multicast_group = "239.255.0.1";
@@ -13,28 +35,77 @@ struct Config {
     int         ttl             = 1;
     bool        loopback        = true;
     std::string interface       = "0.0.0.0";
+    bool        coalesce        = false;  // pack same-deadline events into EnvelopeBatch datagrams
+    int         mtu             = 1500;   // path MTU bounding a coalesced datagram
+    std::vector<Destination> destinations;  // replaces multicast_group:port when set
 
     // analysis
     int    sample_rate = 44100;
     int    frame_size  = 2048;
     int    hop_size    = 1024;
+    bool   shared_decode = true;  // decode once, share PCM across all passes
+    double shared_decode_max = 600.0;  // seconds; longer inputs are decoded per pass (0 = no limit)
+    int    jobs        = 0;       // analysis worker threads (0 = one per core)
+    std::string segmentation = "online";  // segment.boundary: online (sliding-window BIC) or sbic
+    std::map<std::string, Resolution> resolutions;  // per feature family, see resolution_families()
+
+    // analyze-batch, daemon
+    int    batch_workers = 0;     // files analyzed in parallel (0 = one per core; daemon: 2)
+
+    // analysis cache
+    bool        cache = true;
+    std::string cache_dir;        // empty = $XDG_CACHE_HOME/tracks or ~/.cache/tracks
 
     // transport
     double position_interval = 1.0;
     double prepare_time      = 5.0;  // seconds before track.start to send track.prepare
+    bool   snapshot          = true; // state snapshot with every track.position (late joiners)
+
+    // emission timing
+    bool   precise_timing = false;  // absolute-deadline sleep + spin instead of 100 ms sleeps
+    int    spin_us        = 200;    // busy-wait window before each deadline (precise_timing)
+    int    rt_priority    = 0;      // SCHED_FIFO priority for the emitter (0 = normal)
+    int    cpu            = -1;     // pin the emitter to this CPU (-1 = no pinning)
+
+    // streaming (analyze while emitting)
+    bool   stream           = false;
+    double stream_lookahead = 10.0;  // seconds analyzed ahead before playback starts
+    int    stream_queue     = 8192;  // EventQueue slots between analyzer and emitter
 
     // event filtering
     EventFilter enabled_events;         // which non-transport events to analyze/emit
     double      continuous_interval = 0.1; // seconds between continuous event emissions
 
+    // vector event encoding (chroma, spectral.contrast, mfcc, bands.*)
+    std::map<EventType, VectorEncoding> vector_encoding;  // types not listed send plain floats
+    int         keyframe_interval = 50;  // delta: every Nth frame of a type is absolute
+
     // unicast relay (WSL2 workaround)
     bool        enable_unicast = false;
     std::string unicast_target;  // empty = auto-detect WSL2 host IP
 
     // input
     std::string input_file;
+    std::string playlist;      // directory or .m3u played gaplessly (instead of input_file)
+    std::string dump_timeline; // write the analyzed timeline here instead of emitting it
+
+    // live input (instead of input_file): analyzed and emitted as it arrives
+    std::string live_input;             // "-" = raw PCM on stdin, "alsa:DEVICE" = capture device
+    std::string live_format   = "s16";  // stdin sample format: s16 or f32, little-endian
+    int         live_channels = 1;      // interleaved channels, averaged to mono
+
+    // instrumentation
+    std::string stats_json;   // write per-stage timings and send counters here on exit
+    std::string prometheus;   // "[ADDR:]PORT" serving them as Prometheus text (empty = off)
 };
 
+// Feature families that can run at their own resolution: silence, loudness,
+// spectral, tonal, pitch, melody
+const std::vector<std::string>& resolution_families();
+
+// The frame and hop size `family` is analyzed at, defaults filled in
+Resolution resolution(const Config& cfg, const std::string& family);
+
 // Load config: YAML file first, then CLI args override.
 // Returns true on success, false on error (e.g. --help requested).
 bool load_config(Config& cfg, int argc, char* argv[]);
@@ -0,0 +1,549 @@
+#include "daemon.h"
+#include "replay.h"
+#include "scheduler.h"
+#include "tracks.pb.h"
+
+#include <boost/asio.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tracks {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using local = boost::asio::local::stream_protocol;
+
+// The timer thread wakes this long before a deadline and leaves the rest to
+// the Scheduler, so --precise-timing spins as it does for a single track
+constexpr auto kWakeEarly = std::chrono::milliseconds(2);
+constexpr auto kIdle      = std::chrono::milliseconds(100);  // interrupt check
+
+constexpr int    kDefaultWorkers = 2;   // analyses at once; each runs its passes in parallel
+constexpr size_t kFinishedKept   = 64;  // finished sessions still shown by `list`
+
+const char* kUsage = "error usage: play FILE GROUP[:PORT] [at UNIX_TIME | in SECONDS] | stop ID | list";
+
+Clock::time_point at_offset(Clock::time_point start, double seconds) {
+    return start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(seconds));
+}
+
+double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void send_abort(Transport& transport, double timestamp, const char* reason) {
+    ::tracks::Envelope env;
+    env.set_timestamp(timestamp);
+    env.mutable_track_abort()->set_reason(reason);
+    transport.send(EventType::TRACK_ABORT, env.SerializeAsString());
+}
+
+// One analyzed file, shared by the sessions playing it
+struct Analysis {
+    Timeline    timeline;
+    std::string audio_file;  // named in track.prepare
+};
+
+enum class State { Analyzing, Waiting, Playing, Done, Failed, Stopped };
+
+const char* state_name(State state) {
+    switch (state) {
+        case State::Analyzing: return "analyzing";
+        case State::Waiting:   return "waiting";
+        case State::Playing:   return "playing";
+        case State::Done:      return "done";
+        case State::Failed:    return "failed";
+        case State::Stopped:   return "stopped";
+    }
+    return "?";
+}
+
+struct Session {
+    int         id = 0;
+    std::string file;
+    std::string target;  // GROUP:PORT
+    Config      cfg;     // the daemon's, sending to target only
+    State       state = State::Analyzing;
+
+    bool              timed = false;  // start given by the request
+    Clock::time_point start;          // t=0 of the timeline, once known
+    bool              prepared = false;
+    double            position = 0.0; // last timestamp sent
+
+    // Held while the session is active
+    std::unique_ptr<Transport>      transport;
+    std::shared_ptr<const Analysis> analysis;
+    std::unique_ptr<Playback>       playback;
+};
+
+// A session's next deadline: its track.prepare, then each of its timestamps.
+// An active session has exactly one; a stopped session's is skipped.
+struct Timer {
+    Clock::time_point deadline;
+    int               session;
+
+    bool operator>(const Timer& other) const { return deadline > other.deadline; }
+};
+
+class Daemon {
+public:
+    Daemon(const Config& cfg, const Emitter::Analyze& analyze) : cfg_(cfg), analyze_(analyze) {}
+    ~Daemon();
+
+    bool listen(const std::string& path);
+
+    // Plays sessions until g_interrupted, then aborts the active ones
+    void run();
+
+    // One control command; the reply ends with an "ok" or "error" line
+    std::string handle(const std::string& line);
+
+private:
+    std::string play(std::istream& args);
+    std::string stop(std::istream& args);
+    std::string list();
+    void        accept();
+
+    // The rest run with mutex_ held
+    void ready(Session& s, const std::shared_ptr<const Analysis>& analysis);
+    void schedule(Session& s);
+    void fire(Session& s, Clock::time_point deadline, Scheduler& scheduler);
+    void finish(Session& s, State state, const std::string& why = {});
+
+    void worker();
+    std::shared_ptr<const Analysis> load(const std::string& file) const;
+
+    const Config&    cfg_;
+    Emitter::Analyze analyze_;
+
+    std::mutex              mutex_;
+    std::condition_variable wake_;  // timer thread: a new timer
+    std::map<int, Session>  sessions_;
+    std::deque<int>         finished_;
+    int                     next_id_ = 1;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers_;
+
+    // Analysis pool, and the analyses shared while any session plays them
+    std::condition_variable  work_;
+    std::deque<std::string>  jobs_;
+    std::map<std::string, std::vector<int>> waiting_;  // file -> sessions waiting on it
+    std::map<std::string, std::weak_ptr<const Analysis>> analyses_;
+    bool                     stopping_ = false;
+    std::vector<std::thread> workers_;
+
+    // Control socket
+    boost::asio::io_context         io_;
+    std::unique_ptr<local::acceptor> acceptor_;
+    std::string                     path_;
+    std::thread                     control_;
+};
+
+// One control connection: read a line, answer it, repeat until closed
+struct Connection : std::enable_shared_from_this<Connection> {
+    Connection(Daemon& d, local::socket s) : daemon(d), socket(std::move(s)) {}
+
+    void read() {
+        auto self = shared_from_this();
+        boost::asio::async_read_until(socket, input, '\n',
+            [self](const boost::system::error_code& ec, size_t) {
+                if (ec) return;
+                std::istream in(&self->input);
+                std::string line;
+                std::getline(in, line);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                self->reply = self->daemon.handle(line) + "\n";
+                boost::asio::async_write(self->socket, boost::asio::buffer(self->reply),
+                    [self](const boost::system::error_code& ec, size_t) {
+                        if (!ec) self->read();
+                    });
+            });
+    }
+
+    Daemon&                daemon;
+    local::socket          socket;
+    boost::asio::streambuf input;
+    std::string            reply;
+};
+
+Daemon::~Daemon() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_.notify_all();
+    io_.stop();
+    if (control_.joinable()) control_.join();
+    for (auto& w : workers_) w.join();
+    if (!path_.empty()) ::unlink(path_.c_str());
+}
+
+bool Daemon::listen(const std::string& path) {
+    local::endpoint endpoint(path);
+    boost::system::error_code ec;
+
+    // A socket nobody answers on is left over from a daemon that died;
+    // anything else at the path is not ours to remove
+    struct stat st{};
+    if (::lstat(path.c_str(), &st) == 0) {
+        local::socket probe(io_);
+        probe.connect(endpoint, ec);
+        if (!S_ISSOCK(st.st_mode) || !ec) {
+            std::cerr << "Error: " << path << " exists"
+                      << (S_ISSOCK(st.st_mode) ? " and another daemon is listening on it" : "")
+                      << "\n";
+            return false;
+        }
+        ::unlink(path.c_str());
+    }
+
+    acceptor_ = std::make_unique<local::acceptor>(io_);
+    acceptor_->open(endpoint.protocol(), ec);
+    if (!ec) acceptor_->bind(endpoint, ec);
+    if (!ec) acceptor_->listen(boost::asio::socket_base::max_listen_connections, ec);
+    if (ec) {
+        std::cerr << "Error: cannot listen on " << path << ": " << ec.message() << "\n";
+        return false;
+    }
+    path_ = path;
+
+    int workers = cfg_.batch_workers > 0 ? cfg_.batch_workers : kDefaultWorkers;
+    for (int w = 0; w < workers; ++w) workers_.emplace_back([this] { worker(); });
+    accept();
+    control_ = std::thread([this] { io_.run(); });
+
+    std::cout << "Daemon: listening on " << path << " (" << workers << " analysis workers)"
+              << std::endl;
+    return true;
+}
+
+void Daemon::accept() {
+    acceptor_->async_accept([this](const boost::system::error_code& ec, local::socket s) {
+        if (ec == boost::asio::error::operation_aborted) return;
+        if (!ec) std::make_shared<Connection>(*this, std::move(s))->read();
+        accept();
+    });
+}
+
+std::string Daemon::handle(const std::string& line) {
+    std::istringstream args(line);
+    std::string command;
+    args >> command;
+    if (command == "play") return play(args);
+    if (command == "stop") return stop(args);
+    if (command == "list") return list();
+    return kUsage;
+}
+
+std::string Daemon::play(std::istream& args) {
+    std::string file, target, when;
+    args >> file >> target;
+    if (target.empty()) return kUsage;
+
+    std::optional<Clock::time_point> start;
+    if (args >> when) {
+        double value = 0.0;
+        if (!(args >> value) || (when != "at" && when != "in") || (when == "in" && value < 0)) {
+            return kUsage;
+        }
+        // Wall-clock times are turned into the steady clock once, so
+        // sessions given the same time share their deadlines exactly
+        if (when == "at") {
+            value -= std::chrono::duration<double>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+        start = at_offset(Clock::now(), value);
+    }
+
+    std::string address = target;
+    unsigned long port  = cfg_.port;
+    auto colon = target.rfind(':');
+    if (colon != std::string::npos) {
+        address = target.substr(0, colon);
+        try {
+            port = std::stoul(target.substr(colon + 1));
+        } catch (const std::exception&) {
+            port = 0;
+        }
+    }
+    boost::system::error_code ec;
+    boost::asio::ip::make_address(address, ec);
+    if (ec || port == 0 || port > 65535) return "error invalid group '" + target + "'";
+
+    // Sessions share an analysis by the file's canonical name
+    char* resolved = realpath(file.c_str(), nullptr);
+    if (!resolved) return "error cannot open " + file;
+    file = resolved;
+    free(resolved);
+
+    Config session_cfg = cfg_;
+    session_cfg.destinations.clear();
+    session_cfg.multicast_group = address;
+    session_cfg.port            = static_cast<uint16_t>(port);
+    std::unique_ptr<Transport> transport;
+    try {
+        transport = std::make_unique<Transport>(session_cfg);
+    } catch (const std::exception& e) {
+        return std::string("error ") + e.what();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    int id = next_id_++;
+    Session& s  = sessions_[id];
+    s.id        = id;
+    s.file      = file;
+    s.target    = address + ":" + std::to_string(port);
+    s.cfg       = std::move(session_cfg);
+    s.transport = std::move(transport);
+    if (start) {
+        s.timed = true;
+        s.start = *start;
+    }
+    std::cout << "Session " << id << ": " << file << " -> " << s.target << std::endl;
+
+    auto shared = analyses_.find(file);
+    if (auto analysis = shared != analyses_.end() ? shared->second.lock() : nullptr) {
+        ready(s, analysis);
+    } else {
+        auto& waiting = waiting_[file];
+        if (waiting.empty()) {
+            jobs_.push_back(file);
+            work_.notify_one();
+        }
+        waiting.push_back(id);
+    }
+    return "ok " + std::to_string(id);
+}
+
+std::string Daemon::stop(std::istream& args) {
+    int id = 0;
+    if (!(args >> id)) return kUsage;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sessions_.find(id);
+    if (it == sessions_.end()) return "error no session " + std::to_string(id);
+    Session& s = it->second;
+    if (s.state == State::Done || s.state == State::Failed || s.state == State::Stopped) {
+        return "error session " + std::to_string(id) + " has finished";
+    }
+    if (s.prepared) send_abort(*s.transport, seconds_since(s.start), "stopped");
+    finish(s, State::Stopped);
+    return "ok";
+}
+
+std::string Daemon::list() {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [id, s] : sessions_) {
+        out << id << ' ' << state_name(s.state) << ' ' << s.target << ' '
+            << s.position << ' ' << s.file << '\n';
+    }
+    out << "ok";
+    return out.str();
+}
+
+void Daemon::ready(Session& s, const std::shared_ptr<const Analysis>& analysis) {
+    if (analysis->timeline.empty()) {
+        finish(s, State::Failed, "no events");
+        return;
+    }
+    s.analysis = analysis;
+    s.playback = std::make_unique<Playback>(analysis->timeline, s.cfg);
+    s.state    = State::Waiting;
+
+    double prepare = std::max(cfg_.prepare_time, 0.0);
+    if (!s.timed) s.start = at_offset(Clock::now(), prepare);
+    s.prepared = prepare == 0.0;
+
+    // Too late to start on time: keep the requested clock and join in
+    // progress, as a late receiver would
+    double behind = s.timed ? seconds_since(s.start) : 0.0;
+    if (behind > 0.0) {
+        std::cout << "Session " << s.id << ": started " << behind << "s ago; joining in progress"
+                  << std::endl;
+        s.playback->seek(behind);
+        s.prepared = true;
+        if (s.playback->done()) {
+            finish(s, State::Done);
+            return;
+        }
+    }
+    schedule(s);
+}
+
+void Daemon::schedule(Session& s) {
+    Clock::time_point deadline = s.prepared
+        ? at_offset(s.start, s.playback->next_timestamp())
+        : std::max(Clock::now(), at_offset(s.start, -cfg_.prepare_time));
+    timers_.push({deadline, s.id});
+    wake_.notify_one();
+}
+
+void Daemon::fire(Session& s, Clock::time_point deadline, Scheduler& scheduler) {
+    if (s.state != State::Waiting && s.state != State::Playing) return;
+
+    if (!s.prepared) {
+        double countdown = std::max(0.0, -seconds_since(s.start));
+        Emitter().announce(s.analysis->audio_file, countdown, *s.transport);
+        s.prepared = true;
+    } else {
+        s.state    = State::Playing;
+        s.position = s.playback->next_timestamp();
+        size_t events = s.playback->send_next(*s.transport);
+        for (size_t n = 0; n < events; ++n) scheduler.record(deadline);
+        if (s.playback->done()) {
+            finish(s, State::Done);
+            return;
+        }
+    }
+    schedule(s);
+}
+
+void Daemon::finish(Session& s, State state, const std::string& why) {
+    s.state = state;
+    s.playback.reset();
+    s.analysis.reset();
+    s.transport.reset();
+
+    auto shared = analyses_.find(s.file);
+    if (shared != analyses_.end() && shared->second.expired()) analyses_.erase(shared);
+
+    std::cout << "Session " << s.id << ": " << state_name(state)
+              << (why.empty() ? "" : " (" + why + ")") << std::endl;
+
+    finished_.push_back(s.id);
+    if (finished_.size() > kFinishedKept) {
+        sessions_.erase(finished_.front());
+        finished_.pop_front();
+    }
+}
+
+void Daemon::run() {
+    Scheduler scheduler(cfg_);
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (!g_interrupted.load(std::memory_order_relaxed)) {
+        auto now = Clock::now();
+        if (timers_.empty()) {
+            wake_.wait_until(lock, now + kIdle);
+            continue;
+        }
+        auto deadline = timers_.top().deadline;
+        if (now + kWakeEarly < deadline) {
+            wake_.wait_until(lock, std::min(deadline - kWakeEarly, now + kIdle));
+            continue;
+        }
+
+        lock.unlock();
+        bool on_time = scheduler.wait_until(deadline);
+        lock.lock();
+        if (!on_time) break;
+
+        // Everything due by now, in deadline order: sessions sharing a
+        // start send the same timestamp back to back
+        now = Clock::now();
+        while (!timers_.empty() && timers_.top().deadline <= now) {
+            Timer timer = timers_.top();
+            timers_.pop();
+            auto it = sessions_.find(timer.session);
+            if (it != sessions_.end()) fire(it->second, timer.deadline, scheduler);
+        }
+    }
+
+    int aborted = 0;
+    for (auto& [id, s] : sessions_) {
+        if ((s.state == State::Waiting || s.state == State::Playing) && s.prepared) {
+            send_abort(*s.transport, seconds_since(s.start), "user_interrupt");
+            aborted++;
+        }
+    }
+    if (aborted > 0) {
+        std::cout << "\nInterrupted — sent track.abort to " << aborted << " sessions" << std::endl;
+    }
+    lock.unlock();
+    scheduler.report();
+}
+
+void Daemon::worker() {
+    for (;;) {
+        std::string file;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (stopping_) return;
+            file = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        std::shared_ptr<const Analysis> analysis;
+        std::string error;
+        try {
+            analysis = load(file);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (analysis) analyses_[file] = analysis;
+        std::vector<int> waiting = std::move(waiting_[file]);
+        waiting_.erase(file);
+        for (int id : waiting) {
+            auto it = sessions_.find(id);
+            if (it == sessions_.end() || it->second.state != State::Analyzing) continue;
+            if (analysis) {
+                ready(it->second, analysis);
+            } else {
+                finish(it->second, State::Failed, error);
+            }
+        }
+    }
+}
+
+// A timeline file written by --dump-timeline, or else audio to analyze
+std::shared_ptr<const Analysis> Daemon::load(const std::string& file) const {
+    auto analysis = std::make_shared<Analysis>();
+    Replay replay;
+    if (load_replay(file, replay)) {
+        analysis->timeline   = std::move(replay.events);
+        analysis->audio_file = replay.input_file;
+        return analysis;
+    }
+    if (!analyze_) throw std::runtime_error("not a timeline file, and this build has no analysis");
+
+    Config file_cfg = cfg_;
+    file_cfg.input_file  = file;
+    analysis->timeline   = analyze_(file_cfg);
+    analysis->audio_file = file;
+    return analysis;
+}
+
+} // namespace
+
+int run_daemon(const Config& cfg, const Emitter::Analyze& analyze) {
+    std::cout << "TRACKS - Audio Event Emitter" << std::endl;
+    Daemon daemon(cfg, analyze);
+    if (!daemon.listen(cfg.input_file)) return 1;
+    daemon.run();
+    return 0;
+}
+
+} // namespace tracks
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "config.h"
+#include "emitter.h"
+
+namespace tracks {
+
+// --- Daemon ---
+// `tracks daemon SOCKET`: one long-running process playing any number of
+// timelines at once, each to a group of its own, controlled through a Unix
+// stream socket with one command per line:
+//
+//   play FILE GROUP[:PORT] [at UNIX_TIME | in SECONDS]   -> ok ID
+//   stop ID                                              -> ok
+//   list                                                 -> one line per session, then ok
+//
+// Failures answer "error MESSAGE". FILE is an audio file, analyzed with
+// `analyze` on a pool of cfg.batch_workers threads, or a timeline written by
+// --dump-timeline. Sessions playing the same file share one analysis.
+//
+// All sessions are played from one timer thread, which sleeps to the
+// earliest deadline of any session and sends whatever is due then, so
+// sessions started at the same time send the same timestamp together.
+// Without a time a session starts prepare_time after its analysis is ready;
+// one whose start has passed by then joins in progress.
+//
+// Runs until g_interrupted; returns the process exit status (1 if the
+// socket cannot be set up).
+int run_daemon(const Config& cfg, const Emitter::Analyze& analyze);
+
+} // namespace tracks
@@ -1,94 +1,584 @@
 #include "emitter.h"
+#include "scheduler.h"
+#include "snapshot.h"
+#include "vector_codec.h"
 #include "tracks.pb.h"
+#include <algorithm>
 #include <chrono>
 #include <thread>
 #include <iostream>
 #include <climits>
+#include <cstdio>
 #include <cstdlib>
+#include <limits>
+#include <stdexcept>
 
 namespace tracks {
 
 std::atomic<bool> g_interrupted{false};
 
+using Clock = Emitter::Clock;
+
+static std::atomic<int> g_analyses{0};  // started by start_analysis, not yet done
+
+std::future<Timeline> start_analysis(std::function<Timeline()> analyze) {
+    std::packaged_task<Timeline()> task(std::move(analyze));
+    std::future<Timeline> result = task.get_future();
+    g_analyses++;
+    std::thread([task = std::move(task)]() mutable {
+        task();
+        g_analyses--;
+    }).detach();
+    return result;
+}
+
+bool analysis_running() {
+    return g_analyses.load() > 0;
+}
+
+static Clock::time_point at_offset(Clock::time_point start, double seconds) {
+    return start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(seconds));
+}
+
+// Sleeps until `target` in steps of at most `step` so an interrupt is noticed
+// promptly. Returns false if interrupted.
+static bool sleep_until(Clock::time_point target,
+                        Clock::duration step = std::chrono::milliseconds(100)) {
+    while (Clock::now() < target) {
+        if (g_interrupted.load(std::memory_order_relaxed)) return false;
+        auto remaining = target - Clock::now();
+        auto sleep_time = std::min(remaining, step);
+        if (sleep_time.count() > 0) {
+            std::this_thread::sleep_for(sleep_time);
+        }
+    }
+    return !g_interrupted.load(std::memory_order_relaxed);
+}
+
+static void send_abort(Transport& transport, double timestamp) {
+    ::tracks::Envelope env;
+    env.set_timestamp(timestamp);
+    auto* abort = env.mutable_track_abort();
+    abort->set_reason("user_interrupt");
+    transport.send(EventType::TRACK_ABORT, env.SerializeAsString());
+}
+
+void Emitter::announce(const std::string& input_file, double countdown, Transport& transport) {
+    // Resolve canonical filename
+    std::string canonical = input_file;
+    char* resolved = realpath(input_file.c_str(), nullptr);
+    if (resolved) {
+        canonical = resolved;
+        free(resolved);
+    }
+
+    // Build and send track.prepare
+    ::tracks::Envelope env;
+    env.set_timestamp(-countdown);
+    auto* prep = env.mutable_track_prepare();
+    prep->set_countdown(countdown);
+    prep->set_filename(canonical);
+    transport.send(EventType::TRACK_PREPARE, env.SerializeAsString());
+}
+
+// Sends track.prepare and waits out the countdown if prepare_time > 0.
+// Returns false (after sending track.abort) if interrupted meanwhile.
+static bool send_prepare(Emitter& emitter, Transport& transport, const Config& cfg) {
+    if (cfg.prepare_time <= 0) return true;
+
+    emitter.announce(cfg.input_file, cfg.prepare_time, transport);
+    std::cout << "Prepare: waiting " << cfg.prepare_time << "s before playback" << std::endl;
+
+    if (!sleep_until(at_offset(Clock::now(), cfg.prepare_time))) {
+        std::cout << "\nInterrupted during prepare — sending track.abort" << std::endl;
+        send_abort(transport, -cfg.prepare_time);
+        return false;
+    }
+    return true;
+}
+
 void Emitter::run(const Timeline& timeline, Transport& transport, const Config& cfg) {
     if (timeline.empty()) return;
 
-    // Send track.prepare if prepare_time > 0
-    if (cfg.prepare_time > 0) {
-        // Resolve canonical filename
-        std::string canonical = cfg.input_file;
-        char* resolved = realpath(cfg.input_file.c_str(), nullptr);
-        if (resolved) {
-            canonical = resolved;
-            free(resolved);
-        }
+    if (!send_prepare(*this, transport, cfg)) return;
 
-        // Build and send track.prepare
-        ::tracks::Envelope env;
-        env.set_timestamp(-cfg.prepare_time);
-        auto* prep = env.mutable_track_prepare();
-        prep->set_countdown(cfg.prepare_time);
-        prep->set_filename(canonical);
-        transport.send(env.SerializeAsString());
-
-        std::cout << "Prepare: waiting " << cfg.prepare_time << "s before playback" << std::endl;
-
-        // Sleep for prepare_time with interrupt checking
-        auto prepare_end = std::chrono::steady_clock::now() +
-            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
-                std::chrono::duration<double>(cfg.prepare_time));
-
-        while (std::chrono::steady_clock::now() < prepare_end) {
-            if (g_interrupted.load(std::memory_order_relaxed)) {
-                std::cout << "\nInterrupted during prepare — sending track.abort" << std::endl;
-                ::tracks::Envelope abort_env;
-                abort_env.set_timestamp(-cfg.prepare_time);
-                auto* abort = abort_env.mutable_track_abort();
-                abort->set_reason("user_interrupt");
-                transport.send(abort_env.SerializeAsString());
-                return;
+    play(timeline, transport, cfg, Clock::now());
+}
+
+Playback::Playback(const Timeline& timeline, const Config& cfg)
+    : timeline_(timeline), snapshot_(cfg.snapshot) {}
+
+size_t Playback::send_next(Transport& transport) {
+    const double timestamp = timeline_[next_].timestamp;
+    batch_.clear();
+    types_.clear();
+    bool heartbeat = false;
+    for (; next_ < timeline_.size() && timeline_[next_].timestamp == timestamp; ++next_) {
+        const auto& e = timeline_[next_];
+        batch_.push_back(timeline_.bytes(e));
+        types_.push_back(e.type);
+        state_.record(e.type, timeline_.bytes(e));
+        heartbeat |= e.type == EventType::TRACK_POSITION;
+    }
+    size_t events = batch_.size();
+    if (heartbeat && snapshot_) {
+        // Goes wherever track.position goes
+        batch_.push_back(state_.build(timestamp));
+        types_.push_back(EventType::TRACK_POSITION);
+    }
+    transport.send_batch(types_.data(), batch_.data(), batch_.size());
+    return events;
+}
+
+void Playback::seek(double timestamp) {
+    for (; next_ < timeline_.size() && timeline_[next_].timestamp < timestamp; ++next_) {
+        const auto& e = timeline_[next_];
+        state_.record(e.type, timeline_.bytes(e));
+    }
+}
+
+bool Emitter::play(const Timeline& timeline, Transport& transport, const Config& cfg,
+                   Clock::time_point start, const Cue* cue) {
+    Scheduler scheduler(cfg);
+    Playback playback(timeline, cfg);
+    bool cue_pending = cue != nullptr;
+
+    while (!playback.done()) {
+        double timestamp = playback.next_timestamp();
+        if (cue_pending && cue->timestamp < timestamp) {
+            if (!scheduler.wait_until(at_offset(start, cue->timestamp))) {
+                std::cout << "\nInterrupted — sending track.abort" << std::endl;
+                send_abort(transport, cue->timestamp);
+                return false;
             }
-            auto remaining = prepare_end - std::chrono::steady_clock::now();
-            auto sleep_time = std::min(remaining,
-                std::chrono::steady_clock::duration(std::chrono::milliseconds(100)));
-            if (sleep_time.count() > 0) {
-                std::this_thread::sleep_for(sleep_time);
+            cue->action();
+            cue_pending = false;
+        }
+
+        // Sleep until this event should fire (checking interrupt for responsiveness)
+        auto deadline = at_offset(start, timestamp);
+        if (!scheduler.wait_until(deadline)) {
+            std::cout << "\nInterrupted — sending track.abort" << std::endl;
+            send_abort(transport, timestamp);
+            return false;
+        }
+
+        // Send every event sharing this deadline in one batch
+        size_t events = playback.send_next(transport);
+        for (size_t n = 0; n < events; ++n) scheduler.record(deadline);
+    }
+    scheduler.report();
+
+    // A cue at or past the last event still runs, right after it
+    if (cue_pending) cue->action();
+    return true;
+}
+
+// Waits for a prefetched analysis, checking for interrupts.
+// Returns false if interrupted.
+static bool wait_for_analysis(const std::future<Timeline>& analysis) {
+    while (analysis.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready) {
+        if (g_interrupted.load(std::memory_order_relaxed)) return false;
+    }
+    return true;
+}
+
+// Takes a finished analysis; reports and returns false if it failed.
+static bool take_analysis(std::future<Timeline>& analysis, Timeline& timeline,
+                          const std::string& input_file) {
+    try {
+        timeline = analysis.get();
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Playlist: skipping " << input_file << ": " << e.what() << "\n";
+        return false;
+    }
+}
+
+void Emitter::run_playlist(const std::vector<std::string>& inputs, const Analyze& analyze,
+                           Transport& transport, const Config& cfg) {
+    auto prefetch = [&](size_t i) {
+        Config track_cfg = cfg;
+        track_cfg.input_file = inputs[i];
+        return start_analysis([analyze, track_cfg] { return analyze(track_cfg); });
+    };
+
+    size_t i = 0;
+    std::future<Timeline> next = prefetch(0);
+    Timeline current;
+    Clock::time_point start;
+    bool gapless = false;  // current was announced and starts at `start`
+
+    while (i < inputs.size()) {
+        if (!gapless) {
+            if (!wait_for_analysis(next)) return;
+            if (!take_analysis(next, current, inputs[i])) {
+                if (++i < inputs.size()) next = prefetch(i);
+                continue;
             }
+            Config track_cfg = cfg;
+            track_cfg.input_file = inputs[i];
+            if (!send_prepare(*this, transport, track_cfg)) return;
+            start = Clock::now();
+        }
+
+        std::cout << "Playlist: [" << (i + 1) << "/" << inputs.size() << "] "
+                  << inputs[i] << std::endl;
+
+        // Analyze the following track while this one plays, and announce it
+        // so its track.start lands exactly on this track's track.end
+        size_t upcoming = i + 1;
+        double duration = current.empty() ? 0.0 : current[current.size() - 1].timestamp;
+        Clock::time_point next_start = at_offset(start, duration);
+        Timeline following;
+        bool ready = false, failed = false;
+
+        Cue cue;
+        if (upcoming < inputs.size()) {
+            next = prefetch(upcoming);
+            cue.timestamp = duration - std::max(cfg.prepare_time, 0.0);
+            cue.action = [&] {
+                if (next.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                    std::cout << "Playlist: next track not analyzed in time; "
+                                 "it will start after a gap" << std::endl;
+                    return;
+                }
+                if (!take_analysis(next, following, inputs[upcoming])) {
+                    failed = true;
+                    return;
+                }
+                if (cfg.prepare_time > 0) {
+                    double countdown = std::max(0.0,
+                        std::chrono::duration<double>(next_start - Clock::now()).count());
+                    announce(inputs[upcoming], countdown, transport);
+                }
+                ready = true;
+            };
+        }
+
+        if (!play(current, transport, cfg, start, upcoming < inputs.size() ? &cue : nullptr)) return;
+
+        i = upcoming;
+        gapless = ready;
+        if (ready) {
+            current = std::move(following);
+            start = next_start;
+        } else if (failed && ++i < inputs.size()) {
+            next = prefetch(i);
+        }
+    }
+}
+
+// Whole-file events that describe state rather than a moment; when they
+// arrive after their timestamp they are still worth sending late.
+static bool is_state_event(EventType et) {
+    return et == EventType::KEY_CHANGE || et == EventType::TUNING;
+}
+
+// Streamed events decided only some time after their timestamp, and so
+// queued behind later frames: the online segmenter's segment.boundary, up to
+// its window + hold after the boundary
+static bool is_lookahead_event(EventType et) {
+    return et == EventType::SEGMENT_BOUNDARY;
+}
+
+void Emitter::run_stream(EventQueue& queue, std::future<Timeline>& delayed,
+                         Transport& transport, const Config& cfg) {
+    constexpr double kNever = std::numeric_limits<double>::infinity();
+    const auto poll = std::chrono::milliseconds(10);
+
+    // Let the analyzer get ahead of the clock before anything is announced
+    std::cout << "Stream: buffering " << cfg.stream_lookahead << "s of analysis" << std::endl;
+    while (queue.analyzed() < cfg.stream_lookahead && !queue.finished() && !queue.full()) {
+        if (!sleep_until(Clock::now() + poll)) {
+            queue.cancel();
+            return;
         }
     }
 
-    auto wall_start = std::chrono::steady_clock::now();
+    if (!send_prepare(*this, transport, cfg)) {
+        queue.cancel();
+        return;
+    }
+
+    Scheduler scheduler(cfg);
+    StateSnapshot state;
+    auto wall_start = Clock::now();
+
+    // track.start — duration is unknown until the analyzer finishes
+    {
+        ::tracks::Envelope env;
+        env.set_timestamp(0.0);
+        auto* ts = env.mutable_track_start();
+        ts->set_filename(cfg.input_file);
+        ts->set_duration(0.0);
+        ts->set_sample_rate(cfg.sample_rate);
+        ts->set_channels(1);
+        std::string bytes = env.SerializeAsString();
+        state.record(EventType::TRACK_START, bytes);
+        transport.send(EventType::TRACK_START, bytes);
+    }
+
+    Timeline late;
+    size_t   late_next  = 0;
+    bool     late_ready = !delayed.valid();
+    double   next_position = cfg.position_interval;
+    std::vector<std::string_view> batch;
+    std::vector<EventType>        types;
+    int      dropped = 0, underruns = 0, decided_late = 0;
+    bool     starved = false;
+
+    for (;;) {
+        double now = std::chrono::duration<double>(Clock::now() - wall_start).count();
 
-    for (const auto& event : timeline) {
         if (g_interrupted.load(std::memory_order_relaxed)) {
             std::cout << "\nInterrupted — sending track.abort" << std::endl;
+            send_abort(transport, now);
+            queue.cancel();
+            return;
+        }
+
+        // Pick up the whole-file events once their analysis is done
+        if (!late_ready && delayed.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            late = delayed.get();
+            late_ready = true;
+            for (; late_next < late.size() && late[late_next].timestamp < now; ++late_next) {
+                const auto& e = late[late_next];
+                if (is_transport_event(e.type)) continue;
+                if (is_state_event(e.type)) {
+                    state.record(e.type, late.bytes(e));
+                    transport.send(e.type, late.bytes(e));
+                } else {
+                    dropped++;
+                }
+            }
+        }
+        // The emitter sends its own transport events
+        while (late_next < late.size() && is_transport_event(late[late_next].type)) ++late_next;
+
+        // finished() before peek(): a slot published before finish() is seen
+        bool finished = queue.finished();
+        const EventQueue::Slot* slot = queue.peek();
+
+        // A lookahead event reaching the head after its time goes out now,
+        // outside the schedule and its lateness figures
+        while (slot && is_lookahead_event(slot->type) && slot->timestamp < now) {
+            std::string_view bytes(reinterpret_cast<const char*>(slot->data), slot->length);
+            state.record(slot->type, bytes);
+            transport.send(slot->type, bytes);
+            queue.pop();
+            decided_late++;
+            slot = queue.peek();
+        }
+        bool done = finished && !slot;
+
+        // Apart from lookahead events, every event the queue has yet to
+        // deliver is at or after analyzed()
+        double queue_ts    = slot ? slot->timestamp : (done ? kNever : queue.analyzed());
+        double late_ts     = late_next < late.size() ? late[late_next].timestamp : kNever;
+        double end_ts      = done ? queue.analyzed() : kNever;
+        double position_ts = next_position < end_ts ? next_position : kNever;
+
+        double next = std::min({queue_ts, late_ts, position_ts});
+        if (done && next > end_ts) {
+            // track.end
+            auto deadline = at_offset(wall_start, end_ts);
+            if (!scheduler.wait_until(deadline)) continue;
+            ::tracks::Envelope env;
+            env.set_timestamp(end_ts);
+            env.mutable_track_end();
+            transport.send(EventType::TRACK_END, env.SerializeAsString());
+            scheduler.record(deadline);
+            scheduler.report();
+            break;
+        }
+
+        // Wake up at least every poll interval to pick up new analysis; the
+        // final stretch goes through the scheduler
+        auto target = at_offset(wall_start, next);
+        if (Clock::now() + poll < target) {
+            sleep_until(Clock::now() + poll);
+            continue;
+        }
+        if (!scheduler.wait_until(target)) continue;
+
+        if (next == queue_ts) {
+            if (!slot) {
+                // Playback caught up with the analyzer
+                if (!starved) underruns++;
+                starved = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            starved = false;
+            // Everything already queued for this deadline goes out together
+            batch.clear();
+            types.clear();
+            for (const EventQueue::Slot* s = slot; s && s->timestamp == next;
+                 s = queue.peek(batch.size())) {
+                std::string_view bytes(reinterpret_cast<const char*>(s->data), s->length);
+                batch.push_back(bytes);
+                types.push_back(s->type);
+                state.record(s->type, bytes);
+            }
+            transport.send_batch(types.data(), batch.data(), batch.size());
+            queue.pop(batch.size());
+            // One lateness sample per event; the loop end records the last
+            for (size_t n = 1; n < batch.size(); ++n) scheduler.record(target);
+        } else if (next == late_ts) {
+            const auto& e = late[late_next++];
+            state.record(e.type, late.bytes(e));
+            transport.send(e.type, late.bytes(e));
+        } else {
             ::tracks::Envelope env;
-            env.set_timestamp(event.timestamp);
-            auto* abort = env.mutable_track_abort();
-            abort->set_reason("user_interrupt");
-            transport.send(env.SerializeAsString());
+            env.set_timestamp(next_position);
+            env.mutable_track_position()->set_position(next_position);
+            std::string position = env.SerializeAsString();
+            if (cfg.snapshot) {
+                std::string_view heartbeat[2] = {position, state.build(next_position)};
+                EventType        kinds[2]     = {EventType::TRACK_POSITION, EventType::TRACK_POSITION};
+                transport.send_batch(kinds, heartbeat, 2);
+            } else {
+                transport.send(EventType::TRACK_POSITION, position);
+            }
+            next_position += cfg.position_interval;
+        }
+        scheduler.record(target);
+    }
+
+    if (!late_ready) {
+        std::cout << "Stream: whole-file analysis did not finish before track.end" << std::endl;
+    }
+    if (dropped > 0) {
+        std::cout << "Stream: dropped " << dropped
+                  << " whole-file events that were ready only after their time" << std::endl;
+    }
+    if (underruns > 0) {
+        std::cout << "Stream: analysis fell behind playback " << underruns << " time(s)" << std::endl;
+    }
+    if (decided_late > 0) {
+        std::cout << "Stream: sent " << decided_late
+                  << " segment boundaries late, once the segmenter had decided them" << std::endl;
+    }
+}
+
+// Prints p50/p99/max of `latency` (seconds) and starts over
+static void report_latency(const char* label, std::vector<double>& latency) {
+    if (latency.empty()) return;
+
+    Percentiles p = percentiles(latency);
+    char line[160];
+    std::snprintf(line, sizeof(line),
+                  "%s: %zu events, capture to send p50 %.1f ms, p99 %.1f ms, max %.1f ms",
+                  label, latency.size(), p.p50 * 1e3, p.p99 * 1e3, p.max * 1e3);
+    std::cout << line << std::endl;
+    latency.clear();
+}
+
+void Emitter::run_live(EventQueue& queue, const LiveInput& input,
+                       Transport& transport, const Config& cfg) {
+    // Polled rather than waited for, so this bounds the added latency
+    const auto poll   = std::chrono::milliseconds(1);
+    const auto report = std::chrono::seconds(10);
+
+    std::cout << "Live: waiting for audio from " << input.name() << std::endl;
+    while (input.origin_ns() == 0 && !queue.finished()) {
+        if (!sleep_until(Clock::now() + std::chrono::milliseconds(10))) {
+            queue.cancel();
             return;
         }
+    }
+    auto wall_start = Clock::time_point(std::chrono::nanoseconds(input.origin_ns()));
+
+    StateSnapshot state;
+
+    // track.start — there is no file, and the duration is unknown
+    {
+        ::tracks::Envelope env;
+        env.set_timestamp(0.0);
+        auto* ts = env.mutable_track_start();
+        ts->set_duration(0.0);
+        ts->set_sample_rate(cfg.sample_rate);
+        ts->set_channels(1);
+        std::string bytes = env.SerializeAsString();
+        state.record(EventType::TRACK_START, bytes);
+        transport.send(EventType::TRACK_START, bytes);
+    }
+
+    double next_position = cfg.position_interval;
+    auto   next_report   = Clock::now() + report;
+    std::vector<std::string_view> batch;
+    std::vector<EventType>        types;
+    std::vector<double>           latency;  // seconds, since the last report
+
+    for (;;) {
+        auto   wall = Clock::now();
+        double now  = std::chrono::duration<double>(wall - wall_start).count();
+
+        if (g_interrupted.load(std::memory_order_relaxed)) {
+            std::cout << "\nInterrupted — sending track.abort" << std::endl;
+            send_abort(transport, now);
+            queue.cancel();
+            break;
+        }
+        if (wall >= next_report) {
+            report_latency("Live", latency);
+            next_report += report;
+        }
 
-        // Calculate when this event should fire
-        auto target = wall_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
-            std::chrono::duration<double>(event.timestamp));
+        bool finished = queue.finished();
+        if (const EventQueue::Slot* slot = queue.peek()) {
+            // Everything queued so far goes out together
+            batch.clear();
+            types.clear();
+            for (const EventQueue::Slot* s = slot; s; s = queue.peek(batch.size())) {
+                std::string_view bytes(reinterpret_cast<const char*>(s->data), s->length);
+                batch.push_back(bytes);
+                types.push_back(s->type);
+                state.record(s->type, bytes);
+            }
+            transport.send_batch(types.data(), batch.data(), batch.size());
+            int64_t sent_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now().time_since_epoch()).count();
+            for (size_t n = 0; n < batch.size(); ++n) {
+                int64_t captured = queue.peek(n)->captured_ns;
+                if (captured) latency.push_back(static_cast<double>(sent_ns - captured) / 1e9);
+            }
+            queue.pop(batch.size());
+            continue;
+        }
+
+        if (finished) {
+            ::tracks::Envelope env;
+            env.set_timestamp(queue.analyzed());
+            env.mutable_track_end();
+            transport.send(EventType::TRACK_END, env.SerializeAsString());
+            break;
+        }
 
-        // Sleep until it's time (check interrupt periodically for responsiveness)
-        while (std::chrono::steady_clock::now() < target) {
-            if (g_interrupted.load(std::memory_order_relaxed)) break;
-            auto remaining = target - std::chrono::steady_clock::now();
-            auto sleep_time = std::min(remaining,
-                std::chrono::steady_clock::duration(std::chrono::milliseconds(100)));
-            if (sleep_time.count() > 0) {
-                std::this_thread::sleep_for(sleep_time);
+        if (now >= next_position) {
+            ::tracks::Envelope env;
+            env.set_timestamp(next_position);
+            env.mutable_track_position()->set_position(next_position);
+            std::string position = env.SerializeAsString();
+            if (cfg.snapshot) {
+                std::string_view heartbeat[2] = {position, state.build(next_position)};
+                EventType        kinds[2]     = {EventType::TRACK_POSITION, EventType::TRACK_POSITION};
+                transport.send_batch(kinds, heartbeat, 2);
+            } else {
+                transport.send(EventType::TRACK_POSITION, position);
             }
+            next_position += cfg.position_interval;
         }
 
-        if (g_interrupted.load(std::memory_order_relaxed)) continue; // will be caught at top of loop
+        std::this_thread::sleep_for(poll);
+    }
 
-        // Send the event
-        transport.send(event.serialized);
+    report_latency("Live", latency);
+    if (input.overruns() > 0) {
+        std::cout << "Live: analysis fell behind the input; " << input.overruns()
+                  << " samples dropped" << std::endl;
     }
 }
 
@@ -1,20 +1,105 @@
 #pragma once
 
 #include "events.h"
+#include "event_queue.h"
 #include "transport.h"
 #include "config.h"
+#include "live_input.h"
+#include "snapshot.h"
 #include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
 
 namespace tracks {
 
 // Global interrupt flag — set by signal handler
 extern std::atomic<bool> g_interrupted;
 
+// Runs `analyze` on a detached thread. Unlike a std::async future, the one
+// returned does not wait for the analysis when destroyed, so an interrupt
+// need not outlast it. While analysis_running(), the process must end with
+// std::_Exit rather than unwind under the thread.
+std::future<Timeline> start_analysis(std::function<Timeline()> analyze);
+bool analysis_running();
+
+// Sends a timeline deadline by deadline: every event sharing a timestamp
+// goes out in one batch, each track.position followed by a state snapshot
+// (cfg.snapshot). Waiting for the deadlines is up to the caller.
+class Playback {
+public:
+    Playback(const Timeline& timeline, const Config& cfg);
+
+    bool   done() const           { return next_ >= timeline_.size(); }
+    double next_timestamp() const { return timeline_[next_].timestamp; }
+
+    // Sends the events at next_timestamp(); returns how many
+    size_t send_next(Transport& transport);
+
+    // Skips the events before `timestamp` without sending them; their state
+    // still goes out with the next snapshot
+    void seek(double timestamp);
+
+private:
+    const Timeline&               timeline_;
+    bool                          snapshot_;
+    StateSnapshot                 state_;
+    size_t                        next_ = 0;
+    std::vector<std::string_view> batch_;
+    std::vector<EventType>        types_;
+};
+
 class Emitter {
 public:
+    using Clock = std::chrono::steady_clock;
+
+    // Something to do at a point of a timeline being played, between events
+    struct Cue {
+        double                timestamp;
+        std::function<void()> action;
+    };
+
     // Plays back the timeline in real-time, sending each event via transport.
     // If g_interrupted becomes true, sends TrackAbort and returns.
     void run(const Timeline& timeline, Transport& transport, const Config& cfg);
+
+    // Sends track.prepare for `input_file`, announcing its track.start
+    // `countdown` seconds from now. Does not wait.
+    void announce(const std::string& input_file, double countdown, Transport& transport);
+
+    // Plays the timeline with t=0 at `start`, running cue->action (if any)
+    // once the timeline reaches cue->timestamp. Returns false if interrupted,
+    // after sending TrackAbort. Prints send lateness statistics at the end.
+    bool play(const Timeline& timeline, Transport& transport, const Config& cfg,
+              Clock::time_point start, const Cue* cue = nullptr);
+
+    // Gapless playback of several files. Each track is analyzed with
+    // `analyze` (see start_analysis) while the previous one plays; its track.prepare goes out
+    // prepare_time before the previous track.end so track.start follows it
+    // without a gap. A track still being analyzed at that point starts after
+    // its own countdown instead. Tracks whose analysis throws are skipped.
+    using Analyze = std::function<Timeline(const Config&)>;
+    void run_playlist(const std::vector<std::string>& inputs, const Analyze& analyze,
+                      Transport& transport, const Config& cfg);
+
+    // Streaming playback: waits until cfg.stream_lookahead seconds have been
+    // analyzed, then plays events from `queue` as the analyzer produces them.
+    // `delayed`, if valid, yields the whole-file events, which are merged in
+    // once ready. segment.boundary, queued once decided, goes out as soon as
+    // it reaches the head. Sends its own track.start/position/end. Cancels
+    // the queue if interrupted.
+    void run_stream(EventQueue& queue, std::future<Timeline>& delayed,
+                    Transport& transport, const Config& cfg);
+
+    // Live playback: media time 0 is when `input` captured its first sample.
+    // Events from `queue` go out as soon as they are queued, since their
+    // audio has already been heard; heartbeats follow the capture clock.
+    // Prints the capture-to-send latency every 10 seconds and at the end.
+    // Cancels the queue if interrupted.
+    void run_live(EventQueue& queue, const LiveInput& input,
+                  Transport& transport, const Config& cfg);
 };
 
 } // namespace tracks
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace tracks {
+
+// --- Wire-level envelope peek ---
+// Reads an Envelope's top-level fields from its wire bytes without parsing
+// it: which oneof member it holds and where that member's bytes are, plus
+// the per-datagram fields. A receiver that acts on a few event types can
+// skip parsing the rest, vector events in particular. Header-only and
+// independent of the generated code, so clients that carry their own copy
+// of tracks.proto can use it too.
+
+struct EnvelopePeek {
+    uint32_t       event = 0;            // oneof field number (= Envelope::EventCase), 0 if none
+    const uint8_t* payload = nullptr;    // the member's serialized message
+    size_t         payload_size = 0;
+    double         timestamp = 0.0;
+    uint64_t       seq = 0;
+    uint64_t       sent_ns = 0;
+};
+
+namespace wire {
+
+inline bool read_varint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t b = *p++;
+        v |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+inline bool read_fixed64(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    if (end - p < 8) return false;
+    v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];  // little-endian on the wire
+    p += 8;
+    return true;
+}
+
+// Reads one field's tag and value; `data`/`size` are set for length-delimited
+// fields, `value` for the others. False at a malformed or group field.
+inline bool read_field(const uint8_t*& p, const uint8_t* end, uint32_t& field,
+                       uint64_t& value, const uint8_t*& data, size_t& size) {
+    uint64_t tag;
+    if (!read_varint(p, end, tag) || (tag >> 3) == 0 || (tag >> 3) > 0x1fffffff) return false;
+    field = static_cast<uint32_t>(tag >> 3);
+    switch (tag & 7) {
+        case 0: return read_varint(p, end, value);
+        case 1: return read_fixed64(p, end, value);
+        case 2:
+            if (!read_varint(p, end, value) || value > static_cast<uint64_t>(end - p)) return false;
+            data = p;
+            size = static_cast<size_t>(value);
+            p += size;
+            return true;
+        case 5:
+            if (end - p < 4) return false;
+            value = static_cast<uint64_t>(p[0]) | static_cast<uint64_t>(p[1]) << 8 |
+                    static_cast<uint64_t>(p[2]) << 16 | static_cast<uint64_t>(p[3]) << 24;
+            p += 4;
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace wire
+
+// Fills `out` from a serialized Envelope. False if the bytes are malformed.
+inline bool peek_envelope(const void* data, size_t size, EnvelopePeek& out) {
+    const auto* p   = static_cast<const uint8_t*>(data);
+    const auto* end = p + size;
+    out = EnvelopePeek();
+    while (p < end) {
+        uint32_t       field;
+        uint64_t       value = 0;
+        const uint8_t* bytes = nullptr;
+        size_t         length = 0;
+        if (!wire::read_field(p, end, field, value, bytes, length)) return false;
+        if (field == 1) {
+            std::memcpy(&out.timestamp, &value, sizeof(double));
+        } else if (field == 2) {
+            out.seq = value;
+        } else if (field == 3) {
+            out.sent_ns = value;
+        } else if (field >= 10 && bytes) {
+            // Event members are all messages; the last one wins, as in a parse
+            out.event        = field;
+            out.payload      = bytes;
+            out.payload_size = length;
+        }
+    }
+    return true;
+}
+
+// Calls fn(data, size) for each serialized Envelope in the `events` field of
+// an EnvelopeBatch or Snapshot payload, in order. False if it is malformed.
+template <class Fn>
+inline bool for_each_envelope(const uint8_t* data, size_t size, Fn&& fn) {
+    const uint8_t* p   = data;
+    const uint8_t* end = data + size;
+    while (p < end) {
+        uint32_t       field;
+        uint64_t       value = 0;
+        const uint8_t* bytes = nullptr;
+        size_t         length = 0;
+        if (!wire::read_field(p, end, field, value, bytes, length)) return false;
+        if (field == 1 && bytes) fn(bytes, length);
+    }
+    return true;
+}
+
+} // namespace tracks
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "events.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace tracks {
+
+// --- EventQueue ---
+// Bounded single-producer/single-consumer queue between the streaming
+// analyzer and the Emitter. Each slot holds one serialized Envelope inline,
+// so neither side allocates per event. The producer also publishes a
+// watermark: the media time up to which every frame-local event has been
+// queued, which is what the Emitter compares its lookahead against. The
+// exception is segment.boundary, which the online segmenter decides up to
+// its window + hold after the boundary; it is queued then, behind later
+// frames, and the Emitter sends it as soon as it reaches the head.
+
+class EventQueue {
+public:
+    // Largest serialized Envelope a slot can hold
+    static constexpr size_t kMaxBytes = 1024;
+
+    struct Slot {
+        double    timestamp;
+        EventType type;
+        uint32_t  length;
+        int64_t   captured_ns;  // live input: steady_clock time its audio was in, else 0
+        uint8_t   data[kMaxBytes];
+    };
+
+    // Capacity is rounded up to a power of two
+    explicit EventQueue(size_t capacity)
+        : mask_(round_up(capacity) - 1), slots_(new Slot[mask_ + 1]) {}
+
+    EventQueue(const EventQueue&) = delete;
+    EventQueue& operator=(const EventQueue&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // --- Producer side ---
+
+    // Next free slot, waiting while the queue is full.
+    // Returns nullptr once the consumer has cancelled.
+    Slot* claim() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        while (head - tail_.load(std::memory_order_acquire) > mask_) {
+            if (cancelled()) return nullptr;
+            std::this_thread::yield();
+        }
+        if (cancelled()) return nullptr;
+        return &slots_[head & mask_];
+    }
+
+    // Makes the slot returned by claim() visible to the consumer
+    void publish() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void set_analyzed(double t) { analyzed_.store(t, std::memory_order_release); }
+
+    // No more events will be published
+    void finish() { finished_.store(true, std::memory_order_release); }
+
+    // --- Consumer side ---
+
+    // i-th oldest published slot, or nullptr if fewer are queued
+    const Slot* peek(size_t i = 0) const {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (head_.load(std::memory_order_acquire) - tail <= i) return nullptr;
+        return &slots_[(tail + i) & mask_];
+    }
+
+    // Releases the n oldest slots (all previously peeked)
+    void pop(size_t n = 1) {
+        tail_.store(tail_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    // Asks the producer to stop; claim() returns nullptr from now on
+    void cancel() { cancelled_.store(true, std::memory_order_release); }
+
+    // --- Either side ---
+
+    double analyzed() const  { return analyzed_.load(std::memory_order_acquire); }
+    bool   finished() const  { return finished_.load(std::memory_order_acquire); }
+    bool   cancelled() const { return cancelled_.load(std::memory_order_acquire); }
+    bool   full() const {
+        return head_.load(std::memory_order_acquire) -
+               tail_.load(std::memory_order_acquire) > mask_;
+    }
+
+private:
+    static size_t round_up(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    const size_t            mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    // Producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+
+    std::atomic<double> analyzed_{0.0};
+    std::atomic<bool>   finished_{false};
+    std::atomic<bool>   cancelled_{false};
+};
+
+} // namespace tracks
@@ -1,6 +1,10 @@
 #include "events.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <sstream>
+#include <stdexcept>
 
 namespace tracks {
 
@@ -172,6 +176,17 @@ EventFilter all_events() {
     return filter;
 }
 
+EventFilter vector_events() {
+    return {
+        EventType::CHROMA,
+        EventType::SPECTRAL_CONTRAST,
+        EventType::MFCC,
+        EventType::BANDS_MEL,
+        EventType::BANDS_BARK,
+        EventType::BANDS_ERB,
+    };
+}
+
 EventFilter parse_event_filter(const std::string& csv) {
     EventFilter filter;
     const auto& names = event_name_map();
@@ -200,4 +215,116 @@ EventFilter parse_event_filter(const std::string& csv) {
     return filter;
 }
 
+// --- Timeline ---
+
+void Timeline::reserve(size_t events, size_t bytes) {
+    events_.reserve(events);
+    arena_.reserve(bytes);
+}
+
+void Timeline::index(double timestamp, EventType type, size_t offset, size_t length) {
+    if (events_.empty() || timestamp < events_.back().timestamp) {
+        run_starts_.push_back(events_.size());
+    }
+    events_.push_back({timestamp, static_cast<uint32_t>(offset),
+                       static_cast<uint32_t>(length), type});
+}
+
+uint8_t* Timeline::append(double timestamp, EventType type, size_t length) {
+    size_t offset = mapped_size_ + arena_.size();
+    if (offset + length > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("timeline arena exceeds 4 GiB");
+    }
+    arena_.resize(arena_.size() + length);
+    index(timestamp, type, offset, length);
+    return arena_.data() + (offset - mapped_size_);
+}
+
+void Timeline::append(double timestamp, EventType type, const void* data, size_t length) {
+    std::memcpy(append(timestamp, type, length), data, length);
+}
+
+void Timeline::map(std::shared_ptr<const void> owner, const uint8_t* data, size_t size) {
+    if (!events_.empty() || !arena_.empty()) {
+        throw std::logic_error("timeline mapped after events were added");
+    }
+    if (size > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("timeline arena exceeds 4 GiB");
+    }
+    mapping_ = std::move(owner);
+    mapped_ = data;
+    mapped_size_ = size;
+}
+
+void Timeline::map(const Timeline& other) {
+    map(other.mapping_, other.mapped_, other.mapped_size_);
+}
+
+void Timeline::append_mapped(double timestamp, EventType type, uint32_t offset, uint32_t length) {
+    if (static_cast<size_t>(offset) + length > mapped_size_) {
+        throw std::out_of_range("event outside the mapped arena");
+    }
+    index(timestamp, type, offset, length);
+}
+
+void Timeline::append(const Timeline& from, const TimelineEvent& e) {
+    if (from.mapped_ && from.mapped_ == mapped_ && e.offset + e.length <= mapped_size_) {
+        index(e.timestamp, e.type, e.offset, e.length);
+    } else {
+        std::string_view b = from.bytes(e);
+        append(e.timestamp, e.type, b.data(), b.size());
+    }
+}
+
+void Timeline::truncate(double until) {
+    while (!events_.empty() && events_.back().timestamp > until) {
+        const TimelineEvent& e = events_.back();
+        if (e.offset >= mapped_size_ && e.offset + e.length == mapped_size_ + arena_.size()) {
+            arena_.resize(e.offset - mapped_size_);
+        }
+        events_.pop_back();
+    }
+    while (!run_starts_.empty() && run_starts_.back() >= events_.size()) {
+        run_starts_.pop_back();
+    }
+}
+
+void Timeline::sort() {
+    if (run_starts_.size() <= 1) return;
+
+    // Heap of the next unmerged event of each run. Ties go to the earlier
+    // run, which keeps the merge stable.
+    struct Cursor {
+        size_t pos;
+        size_t end;
+    };
+    std::vector<Cursor> heap;
+    heap.reserve(run_starts_.size());
+    for (size_t r = 0; r < run_starts_.size(); ++r) {
+        size_t end = (r + 1 < run_starts_.size()) ? run_starts_[r + 1] : events_.size();
+        heap.push_back({run_starts_[r], end});
+    }
+    auto later = [this](const Cursor& a, const Cursor& b) {
+        double ta = events_[a.pos].timestamp, tb = events_[b.pos].timestamp;
+        return ta > tb || (ta == tb && a.pos > b.pos);
+    };
+    std::make_heap(heap.begin(), heap.end(), later);
+
+    std::vector<TimelineEvent> merged;
+    merged.reserve(events_.size());
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        Cursor& c = heap.back();
+        merged.push_back(events_[c.pos]);
+        if (++c.pos < c.end) {
+            std::push_heap(heap.begin(), heap.end(), later);
+        } else {
+            heap.pop_back();
+        }
+    }
+
+    events_.swap(merged);
+    run_starts_.assign(1, 0);
+}
+
 } // namespace tracks
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
 #include <unordered_map>
@@ -81,8 +85,13 @@ enum class EventType {
     ENVELOPE,
     ATTACK,
     DECAY,
+
+    COUNT_  // not an event type; add new types above it
 };
 
+// Number of event types, for tables indexed by EventType
+inline constexpr size_t kEventTypeCount = static_cast<size_t>(EventType::COUNT_);
+
 using EventFilter = std::set<EventType>;
 
 // Name-to-enum mapping (lowercase dotted names like "beat", "key.change")
@@ -96,6 +105,7 @@ EventFilter default_events();   // beat + onset (backward compatible)
 EventFilter tier1_events();     // beat, onset, silence, loudness, energy
 EventFilter tier2_events();     // tier1 + spectral, tonal, pitch, melody, segmentation
 EventFilter all_events();       // everything (excluding transport, which is always on)
+EventFilter vector_events();    // events carrying a float vector (chroma, mfcc, bands.*, ...)
 
 // Transport events are always emitted regardless of filter
 bool is_transport_event(EventType et);
@@ -105,12 +115,87 @@ bool is_transport_event(EventType et);
 EventFilter parse_event_filter(const std::string& csv);
 
 // --- Timeline ---
+// Serialized protobuf Envelopes live back to back in one byte arena; each
+// event is a fixed-size index record pointing into it. Appending does no
+// per-event heap allocation beyond amortized arena growth, and sorting only
+// reorders the index.
+//
+// Builders emit their own stream in time order, so the index naturally
+// consists of a few sorted runs; append() starts a new run whenever the
+// timestamp goes backwards and sort() k-way merges them.
+//
+// The arena can start with bytes the timeline does not own, such as a
+// mapped cache file: events index them in place and later appends go after
+// them.
 
 struct TimelineEvent {
-    double      timestamp;   // seconds from start of file
-    std::string serialized;  // serialized protobuf Envelope
+    double    timestamp;  // seconds from start of file
+    uint32_t  offset;     // start of the serialized Envelope in the arena
+    uint32_t  length;     // serialized Envelope size in bytes
+    EventType type;
 };
 
-using Timeline = std::vector<TimelineEvent>;
+class Timeline {
+public:
+    using const_iterator = std::vector<TimelineEvent>::const_iterator;
+
+    void reserve(size_t events, size_t bytes);
+
+    // Adds an event of `length` bytes and returns where to write its
+    // serialized Envelope. The pointer is invalidated by the next append.
+    uint8_t* append(double timestamp, EventType type, size_t length);
+
+    // Adds an already serialized Envelope.
+    void append(double timestamp, EventType type, const void* data, size_t length);
+
+    // Makes `data` the front of the arena, kept alive by `owner`. Call on an
+    // empty timeline.
+    void map(std::shared_ptr<const void> owner, const uint8_t* data, size_t size);
+    // Shares the mapping of `other`, so events in it can be added in place
+    void map(const Timeline& other);
+
+    // Adds an Envelope already in the mapping
+    void append_mapped(double timestamp, EventType type, uint32_t offset, uint32_t length);
+
+    // Adds event `e` of `from`: in place when it lies in a mapping both
+    // timelines share, copied otherwise
+    void append(const Timeline& from, const TimelineEvent& e);
+
+    // Orders events by timestamp; equal timestamps keep insertion order.
+    // O(n log k) for k sorted runs.
+    void sort();
+
+    // Drops the events stamped after `until` from the end of a timeline
+    // whose last run holds them (a sorted one, say)
+    void truncate(double until);
+
+    size_t runs() const { return run_starts_.size(); }
+
+    // Serialized Envelope of an event of this timeline
+    std::string_view bytes(const TimelineEvent& e) const {
+        const uint8_t* p = e.offset < mapped_size_ ? mapped_ + e.offset
+                                                   : arena_.data() + (e.offset - mapped_size_);
+        return {reinterpret_cast<const char*>(p), e.length};
+    }
+
+    size_t size() const  { return events_.size(); }
+    bool   empty() const { return events_.empty(); }
+    size_t arena_bytes() const { return mapped_size_ + arena_.size(); }
+
+    const TimelineEvent& operator[](size_t i) const { return events_[i]; }
+    const_iterator begin() const { return events_.begin(); }
+    const_iterator end() const   { return events_.end(); }
+
+private:
+    std::vector<TimelineEvent> events_;
+    std::vector<uint8_t>       arena_;
+    std::vector<size_t>        run_starts_;  // index of the first event of each run
+
+    std::shared_ptr<const void> mapping_;    // keeps mapped_ alive
+    const uint8_t*              mapped_ = nullptr;
+    size_t                      mapped_size_ = 0;
+
+    void index(double timestamp, EventType type, size_t offset, size_t length);
+};
 
 } // namespace tracks
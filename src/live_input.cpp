@@ -0,0 +1,216 @@
+#include "live_input.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include <poll.h>
+#include <unistd.h>
+
+#ifdef TRACKS_WITH_ALSA
+#include <alsa/asoundlib.h>
+#endif
+
+namespace tracks {
+
+static constexpr double kRingSeconds = 10.0;  // analyzer may fall this far behind
+static constexpr double kMarkSeconds = 2.0;   // capture times kept behind the reader
+
+static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static float to_float(int16_t s) { return static_cast<float>(s) / 32768.0f; }
+static float to_float(float s)   { return s; }
+
+LiveInput::LiveInput(const Config& cfg)
+    : sample_rate_(cfg.sample_rate),
+      channels_(std::max(cfg.live_channels, 1)),
+      float_samples_(cfg.live_format == "f32"),
+      chunk_frames_(static_cast<size_t>(std::max(cfg.hop_size, 1))),
+      source_(cfg.live_input),
+      ring_(static_cast<size_t>(kRingSeconds * cfg.sample_rate)) {
+    name_ = source_ == "-" ? "stdin" : source_;
+}
+
+LiveInput::~LiveInput() {
+    stop();
+}
+
+bool LiveInput::start() {
+    if (source_ == "-") {
+        thread_ = std::thread([this] { capture_stdin(); });
+        return true;
+    }
+#ifdef TRACKS_WITH_ALSA
+    if (source_.compare(0, 5, "alsa:") == 0) {
+        std::string device = source_.substr(5);
+        snd_pcm_t* pcm = nullptr;
+        int err = snd_pcm_open(&pcm, device.c_str(), SND_PCM_STREAM_CAPTURE, 0);
+        if (err >= 0) {
+            // Periods of about one hop keep the wait for audio under a hop
+            unsigned latency_us = static_cast<unsigned>(
+                2 * chunk_frames_ * 1000000ull / static_cast<unsigned>(sample_rate_));
+            err = snd_pcm_set_params(pcm, SND_PCM_FORMAT_FLOAT_LE,
+                                     SND_PCM_ACCESS_RW_INTERLEAVED,
+                                     static_cast<unsigned>(channels_),
+                                     static_cast<unsigned>(sample_rate_), 1, latency_us);
+            if (err < 0) snd_pcm_close(pcm);
+        }
+        if (err < 0) {
+            std::cerr << "Error: cannot open capture device " << device << ": "
+                      << snd_strerror(err) << "\n";
+            return false;
+        }
+        pcm_ = pcm;
+        thread_ = std::thread([this] { capture_alsa(); });
+        return true;
+    }
+#endif
+    std::cerr << "Error: unknown live input '" << source_ << "' (expected - for stdin"
+#ifdef TRACKS_WITH_ALSA
+              << " or alsa:DEVICE"
+#endif
+              << ")\n";
+    return false;
+}
+
+void LiveInput::stop() {
+    stop_.store(true, std::memory_order_relaxed);
+    if (thread_.joinable()) thread_.join();
+#ifdef TRACKS_WITH_ALSA
+    if (pcm_) {
+        snd_pcm_close(static_cast<snd_pcm_t*>(pcm_));
+        pcm_ = nullptr;
+    }
+#endif
+    std::lock_guard<std::mutex> lock(mutex_);
+    ended_ = true;
+    ready_.notify_all();
+}
+
+template <typename T>
+void LiveInput::deliver(const T* interleaved, size_t frames, int64_t arrival_ns) {
+    if (origin_ns() == 0) {
+        origin_ns_.store(arrival_ns - static_cast<int64_t>(frames * 1000000000ull /
+                                                           static_cast<uint64_t>(sample_rate_)),
+                         std::memory_order_release);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t room = ring_.size() - size_;
+    size_t keep = std::min(frames, room);
+    if (keep < frames) overruns_.fetch_add(frames - keep, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < keep; ++i) {
+        float sum = 0.0f;
+        for (int c = 0; c < channels_; ++c) sum += to_float(interleaved[i * channels_ + c]);
+        ring_[head_] = sum / static_cast<float>(channels_);
+        head_ = (head_ + 1) % ring_.size();
+    }
+    size_ += keep;
+    captured_ += keep;
+    if (keep > 0) marks_.push_back(Mark{captured_, arrival_ns});
+    ready_.notify_one();
+}
+
+void LiveInput::capture_stdin() {
+    const size_t sample_bytes = float_samples_ ? sizeof(float) : sizeof(int16_t);
+    const size_t frame_bytes  = sample_bytes * static_cast<size_t>(channels_);
+    std::vector<char>    buf(chunk_frames_ * frame_bytes);
+    std::vector<float>   floats(float_samples_ ? chunk_frames_ * channels_ : 0);
+    std::vector<int16_t> shorts(float_samples_ ? 0 : chunk_frames_ * channels_);
+    size_t have = 0;  // bytes of a partial frame carried over
+
+    while (!stop_.load(std::memory_order_relaxed)) {
+        pollfd pfd{STDIN_FILENO, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, 100);  // wake up to notice stop()
+        if (ready < 0 && errno != EINTR) break;
+        if (ready <= 0) continue;
+
+        ssize_t n = ::read(STDIN_FILENO, buf.data() + have, buf.size() - have);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;  // end of stream (or a read error)
+        have += static_cast<size_t>(n);
+
+        size_t frames = have / frame_bytes;
+        if (frames == 0) continue;
+        int64_t arrival = now_ns();
+        size_t used = frames * frame_bytes;
+        if (float_samples_) {
+            std::memcpy(floats.data(), buf.data(), used);
+            deliver(floats.data(), frames, arrival);
+        } else {
+            std::memcpy(shorts.data(), buf.data(), used);
+            deliver(shorts.data(), frames, arrival);
+        }
+        std::memmove(buf.data(), buf.data() + used, have - used);
+        have -= used;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ended_ = true;
+    ready_.notify_all();
+}
+
+#ifdef TRACKS_WITH_ALSA
+void LiveInput::capture_alsa() {
+    auto* pcm = static_cast<snd_pcm_t*>(pcm_);
+    std::vector<float> buf(chunk_frames_ * static_cast<size_t>(channels_));
+
+    while (!stop_.load(std::memory_order_relaxed)) {
+        snd_pcm_sframes_t n = snd_pcm_readi(pcm, buf.data(), chunk_frames_);
+        if (n < 0) {
+            // An overrun (-EPIPE) loses what the device could not hold
+            if (n == -EPIPE) overruns_.fetch_add(chunk_frames_, std::memory_order_relaxed);
+            if (snd_pcm_recover(pcm, static_cast<int>(n), 1) < 0) {
+                std::cerr << "Error: capture failed: " << snd_strerror(static_cast<int>(n)) << "\n";
+                break;
+            }
+            continue;
+        }
+        deliver(buf.data(), static_cast<size_t>(n), now_ns());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ended_ = true;
+    ready_.notify_all();
+}
+#endif
+
+size_t LiveInput::read(float* out, size_t n) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready_.wait(lock, [&] { return size_ >= n || ended_; });
+
+    size_t count = std::min(n, size_);
+    size_t tail  = (head_ + ring_.size() - size_) % ring_.size();
+    for (size_t i = 0; i < count; ++i) out[i] = ring_[(tail + i) % ring_.size()];
+    size_ -= count;
+    read_ += count;
+
+    // Capture times of what has been read move to the reader's side, up to
+    // the chunk holding the last sample read
+    while (!marks_.empty()) {
+        bool last = marks_.front().end >= read_;
+        seen_.push_back(marks_.front());
+        marks_.pop_front();
+        if (last) break;
+    }
+    lock.unlock();
+
+    uint64_t keep = static_cast<uint64_t>(kMarkSeconds * sample_rate_);
+    while (seen_.size() > 1 && seen_.front().end + keep < read_) seen_.pop_front();
+    return count;
+}
+
+int64_t LiveInput::captured_ns(uint64_t index) {
+    // The first chunk that ends after `index` contains it
+    auto it = std::upper_bound(seen_.begin(), seen_.end(), index,
+                               [](uint64_t i, const Mark& m) { return i < m.end; });
+    return it == seen_.end() ? 0 : it->arrival_ns;
+}
+
+} // namespace tracks
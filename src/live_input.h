@@ -0,0 +1,103 @@
+#pragma once
+
+#include "config.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tracks {
+
+// --- Live input ---
+// Captures PCM from a live source instead of a file: raw interleaved PCM on
+// stdin (cfg.live_input "-", in cfg.live_format with cfg.live_channels) or,
+// built with TRACKS_WITH_ALSA, an ALSA capture device ("alsa:DEVICE"). It
+// must already be at cfg.sample_rate; there is no resampling. A capture
+// thread downmixes to mono and queues the samples for the analyzer, and
+// notes when each chunk arrived so events can carry their capture time.
+//
+// PulseAudio/PipeWire sources work through stdin:
+//   parec --format=s16le --rate=44100 --channels=1 | tracks --live -
+
+class LiveInput {
+public:
+    explicit LiveInput(const Config& cfg);
+    ~LiveInput();
+
+    LiveInput(const LiveInput&) = delete;
+    LiveInput& operator=(const LiveInput&) = delete;
+
+    // Opens the source and starts capturing. Prints why and returns false if
+    // the source cannot be opened.
+    bool start();
+
+    // Stops capturing; read() returns what is queued, then end of stream
+    void stop();
+
+    // Waits for `n` samples and copies them to `out`. Returns fewer only at
+    // the end of the stream.
+    size_t read(float* out, size_t n);
+
+    // steady_clock time (ns) by which sample `index` had been captured, or 0
+    // if it is not known (yet, or any more). Same thread as read().
+    int64_t captured_ns(uint64_t index);
+
+    // steady_clock time (ns) of sample 0, once the first chunk has arrived
+    int64_t origin_ns() const { return origin_ns_.load(std::memory_order_acquire); }
+
+    // Samples dropped because the analyzer fell behind the source
+    uint64_t overruns() const { return overruns_.load(std::memory_order_relaxed); }
+
+    // "stdin" or the capture device, for track.start and progress lines
+    const std::string& name() const { return name_; }
+
+private:
+    // Chunk boundary: samples [.., end) had all arrived by arrival_ns
+    struct Mark {
+        uint64_t end;
+        int64_t  arrival_ns;
+    };
+
+    void capture_stdin();
+#ifdef TRACKS_WITH_ALSA
+    void capture_alsa();
+#endif
+
+    // Capture thread: queues `frames` interleaved samples that arrived at `arrival_ns`
+    template <typename T>
+    void deliver(const T* interleaved, size_t frames, int64_t arrival_ns);
+
+    const int   sample_rate_;
+    const int   channels_;
+    const bool  float_samples_;   // f32 rather than s16
+    const size_t chunk_frames_;   // one hop: the most audio a read waits for
+    std::string source_;
+    std::string name_;
+
+    std::thread       thread_;
+    std::atomic<bool> stop_{false};
+    void*             pcm_ = nullptr;  // snd_pcm_t* with ALSA
+
+    // Samples between the capture thread and read(), under mutex_
+    std::mutex              mutex_;
+    std::condition_variable ready_;
+    std::vector<float>      ring_;
+    size_t                  head_ = 0;      // next write
+    size_t                  size_ = 0;      // queued samples
+    uint64_t                captured_ = 0;  // samples queued so far (index of the next)
+    bool                    ended_ = false;
+    std::deque<Mark>        marks_;
+
+    std::atomic<int64_t>  origin_ns_{0};
+    std::atomic<uint64_t> overruns_{0};
+
+    // Reader side
+    uint64_t          read_ = 0;            // samples returned by read()
+    std::deque<Mark>  seen_;                // marks moved over from marks_
+};
+
+} // namespace tracks
@@ -1,52 +1,297 @@
 #include "config.h"
-#include "analyzer.h"
+#include "daemon.h"
 #include "emitter.h"
+#include "replay.h"
+#include "stats.h"
 #include "transport.h"
 
+#ifdef TRACKS_WITH_ESSENTIA
+#include "analyzer.h"
+#include "batch.h"
+#include "cache.h"
 #include <essentia/algorithmfactory.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <future>
 #include <iostream>
 #include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
 
 static void signal_handler(int) {
     tracks::g_interrupted.store(true, std::memory_order_relaxed);
 }
 
-int main(int argc, char* argv[]) {
-    tracks::Config cfg;
-    if (!tracks::load_config(cfg, argc, argv)) {
+static void print_destinations(const tracks::Config& cfg) {
+    if (cfg.destinations.empty()) {
+        std::cout << "Multicast: " << cfg.multicast_group << ":" << cfg.port << std::endl;
+        return;
+    }
+    for (const auto& d : cfg.destinations) {
+        std::cout << "Destination: " << d.address << ":" << (d.port ? d.port : cfg.port);
+        if (d.events.empty()) {
+            std::cout << " (all events";
+        } else {
+            std::cout << " (" << d.events.size() << " event types";
+        }
+        if (d.max_rate > 0) std::cout << ", at most " << d.max_rate << "/s each";
+        std::cout << ")" << std::endl;
+    }
+}
+
+// tracks replay FILE [options]: emit a timeline written by --dump-timeline
+static int replay(tracks::Config& cfg) {
+    auto t0 = std::chrono::steady_clock::now();
+    tracks::Replay rep;
+    if (!tracks::load_replay(cfg.input_file, rep)) {
+        std::cerr << "Error: " << cfg.input_file << " is not a readable timeline file\n";
         return 1;
     }
+    double load_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t0).count();
 
     std::cout << "TRACKS - Audio Event Emitter" << std::endl;
-    std::cout << "Input: " << cfg.input_file << std::endl;
-    std::cout << "Multicast: " << cfg.multicast_group << ":" << cfg.port << std::endl;
-    std::cout << "Events: " << cfg.enabled_events.size() << " types enabled" << std::endl;
+    std::cout << "Replay: " << cfg.input_file << " (" << rep.events.size() << " events, "
+              << rep.duration << "s, loaded in " << load_ms << " ms)" << std::endl;
+    std::cout << "Track: " << rep.input_file << std::endl;
+    print_destinations(cfg);
+
+    std::signal(SIGINT,  signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    // track.prepare announces the audio file the timeline was made from
+    cfg.input_file = rep.input_file;
+
+    std::cout << "\n--- Emission Phase ---" << std::endl;
+    tracks::Transport transport(cfg);
+    tracks::Emitter emitter;
+    emitter.run(rep.events, transport, cfg);
+
+    if (tracks::g_interrupted.load()) {
+        std::cout << "Aborted." << std::endl;
+        return 130;
+    }
+    std::cout << "\nDone." << std::endl;
+    return 0;
+}
+
+// tracks daemon SOCKET [options]: play timelines on request, many at once
+static int daemon(const tracks::Config& cfg) {
+    std::signal(SIGINT,  signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+#ifdef TRACKS_WITH_ESSENTIA
+    essentia::init();
+    int status = tracks::run_daemon(cfg, [](const tracks::Config& c) { return tracks::analyze_cached(c); });
+    essentia::shutdown();
+    return status;
+#else
+    // Timeline files only
+    return tracks::run_daemon(cfg, nullptr);
+#endif
+}
+
+#ifdef TRACKS_WITH_ESSENTIA
+
+// tracks analyze-batch DIR|PLAYLIST [options]: fill the analysis cache
+static int analyze_batch(const tracks::Config& cfg) {
+    auto inputs = tracks::collect_inputs(cfg.input_file);
+    if (inputs.empty()) {
+        std::cerr << "Error: no audio files in " << cfg.input_file << "\n";
+        return 1;
+    }
 
-    // Install signal handlers
     std::signal(SIGINT,  signal_handler);
     std::signal(SIGTERM, signal_handler);
 
     essentia::init();
+    int failed = tracks::run_batch(cfg, inputs);
+    essentia::shutdown();
+
+    if (tracks::g_interrupted.load()) {
+        std::cout << "Interrupted." << std::endl;
+        return 130;
+    }
+    return failed > 0 ? 1 : 0;
+}
 
-    // Phase 1: Analyze
-    std::cout << "\n--- Analysis Phase ---" << std::endl;
-    auto timeline = tracks::analyze(cfg);
+// tracks --dump-timeline OUT FILE: analyze and write the timeline for replay
+static int dump_timeline(const tracks::Config& cfg) {
+    if (!cfg.playlist.empty()) {
+        std::cerr << "Error: --dump-timeline takes a single input file, not --playlist\n";
+        return 1;
+    }
+
+    std::signal(SIGINT,  signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    essentia::init();
+    auto timeline = tracks::analyze_cached(cfg);
+    essentia::shutdown();
 
     if (tracks::g_interrupted.load()) {
         std::cout << "\nInterrupted during analysis." << std::endl;
-        essentia::shutdown();
         return 130;
     }
 
-    // Phase 2: Emit in real-time
-    std::cout << "\n--- Emission Phase ---" << std::endl;
+    // Absolute, so replay announces the same file from any directory
+    std::string input_file = cfg.input_file;
+    if (char* resolved = realpath(cfg.input_file.c_str(), nullptr)) {
+        input_file = resolved;
+        free(resolved);
+    }
+    if (!tracks::store_replay(cfg.dump_timeline, input_file, cfg.sample_rate, timeline)) {
+        return 1;
+    }
+    std::cout << "Timeline: " << timeline.size() << " events written to "
+              << cfg.dump_timeline << std::endl;
+    return 0;
+}
+
+// tracks --live SOURCE: analyze live audio and emit events as it arrives
+static int live(const tracks::Config& cfg) {
+    int streamable = 0;
+    for (auto et : tracks::streamable_events()) streamable += cfg.enabled_events.count(et);
+    if (streamable == 0) {
+        std::cerr << "Error: --live needs frame-local events (loudness, energy, spectral, "
+                     "bands, pitch, ...)\n";
+        return 1;
+    }
+
+    std::cout << "TRACKS - Audio Event Emitter" << std::endl;
+    print_destinations(cfg);
+    std::cout << "Events: " << streamable << " types enabled" << std::endl;
+    int skipped = static_cast<int>(cfg.enabled_events.size()) - streamable;
+    if (skipped > 0) {
+        std::cout << "Live: " << skipped
+                  << " enabled types need the whole signal and are not emitted" << std::endl;
+    }
+
+    tracks::LiveInput input(cfg);
+    if (!input.start()) return 1;
+    std::cout << "Live input: " << input.name() << " at " << cfg.sample_rate << " Hz, "
+              << "hop " << 1e3 * cfg.hop_size / cfg.sample_rate << " ms" << std::endl;
+
+    std::signal(SIGINT,  signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    essentia::init();
+    std::cout << "\n--- Live Phase ---" << std::endl;
+    tracks::EventQueue queue(static_cast<size_t>(std::max(cfg.stream_queue, 1)));
+    std::thread analyzer([&] { tracks::analyze_live(cfg, input, queue); });
+
     tracks::Transport transport(cfg);
     tracks::Emitter emitter;
-    emitter.run(timeline, transport, cfg);
+    emitter.run_live(queue, input, transport, cfg);
+    input.stop();
+    analyzer.join();
+    essentia::shutdown();
+
+    if (tracks::g_interrupted.load()) {
+        std::cout << "Aborted." << std::endl;
+        return 130;
+    }
+    std::cout << "\nDone." << std::endl;
+    return 0;
+}
+
+// Default mode: analyze the input (or playlist) and emit it
+static int analyze_and_emit(const tracks::Config& cfg) {
+    if (!cfg.dump_timeline.empty()) {
+        return dump_timeline(cfg);
+    }
+
+    // Playlist mode replaces the single input file
+    std::vector<std::string> playlist;
+    if (!cfg.playlist.empty()) {
+        playlist = tracks::collect_inputs(cfg.playlist);
+        if (playlist.empty()) {
+            std::cerr << "Error: no audio files in " << cfg.playlist << "\n";
+            return 1;
+        }
+    }
+
+    std::cout << "TRACKS - Audio Event Emitter" << std::endl;
+    if (playlist.empty()) {
+        std::cout << "Input: " << cfg.input_file << std::endl;
+    } else {
+        std::cout << "Playlist: " << cfg.playlist << " (" << playlist.size() << " tracks)" << std::endl;
+    }
+    print_destinations(cfg);
+    std::cout << "Events: " << cfg.enabled_events.size() << " types enabled" << std::endl;
+
+    // Install signal handlers
+    std::signal(SIGINT,  signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    essentia::init();
+
+    // Streaming needs at least one frame-local event; otherwise it would only
+    // delay the whole-file analysis it is waiting on anyway
+    bool stream = false;
+    if (cfg.stream && !playlist.empty()) {
+        std::cout << "--stream is not supported with --playlist; ignored" << std::endl;
+    } else if (cfg.stream) {
+        for (auto et : tracks::streamable_events()) {
+            if (cfg.enabled_events.count(et)) stream = true;
+        }
+        if (!stream) {
+            std::cout << "No frame-local events enabled; --stream ignored" << std::endl;
+        }
+    }
+
+    if (!playlist.empty()) {
+        std::cout << "\n--- Playlist Phase ---" << std::endl;
+        tracks::Transport transport(cfg);
+        tracks::Emitter emitter;
+        emitter.run_playlist(playlist,
+                             [](const tracks::Config& c) { return tracks::analyze_cached(c); },
+                             transport, cfg);
+    } else if (stream) {
+        // Frame-local events stream through the queue; the rest are analyzed
+        // as a whole in the background and merged in by the emitter
+        tracks::Config delayed_cfg = cfg;
+        for (auto et : tracks::streamable_events()) delayed_cfg.enabled_events.erase(et);
+
+        std::cout << "\n--- Streaming Phase ---" << std::endl;
+        tracks::EventQueue queue(static_cast<size_t>(std::max(cfg.stream_queue, 1)));
+        std::future<tracks::Timeline> delayed;
+        if (!delayed_cfg.enabled_events.empty()) {
+            // Detached, so an interrupt does not wait for it
+            delayed = tracks::start_analysis(
+                [delayed_cfg] { return tracks::analyze_cached(delayed_cfg); });
+        }
+        std::thread analyzer([&] { tracks::analyze_stream(cfg, queue); });
+
+        tracks::Transport transport(cfg);
+        tracks::Emitter emitter;
+        emitter.run_stream(queue, delayed, transport, cfg);
+        analyzer.join();
+    } else {
+        // Phase 1: Analyze
+        std::cout << "\n--- Analysis Phase ---" << std::endl;
+        auto timeline = tracks::analyze_cached(cfg);
+
+        if (tracks::g_interrupted.load()) {
+            std::cout << "\nInterrupted during analysis." << std::endl;
+            essentia::shutdown();
+            return 130;
+        }
+
+        // Phase 2: Emit in real-time
+        std::cout << "\n--- Emission Phase ---" << std::endl;
+        tracks::Transport transport(cfg);
+        tracks::Emitter emitter;
+        emitter.run(timeline, transport, cfg);
+    }
 
     if (tracks::g_interrupted.load()) {
         std::cout << "Aborted." << std::endl;
-        essentia::shutdown();
+        // A prefetched or delayed analysis may still be using Essentia
+        if (!tracks::analysis_running()) essentia::shutdown();
         return 130;
     }
 
@@ -54,3 +299,62 @@ int main(int argc, char* argv[]) {
     essentia::shutdown();
     return 0;
 }
+#endif
+
+static int run(const std::string& command, tracks::Config& cfg) {
+    if (command == "replay") {
+        return replay(cfg);
+    }
+    if (command == "daemon") {
+        return daemon(cfg);
+    }
+#ifdef TRACKS_WITH_ESSENTIA
+    if (command == "analyze-batch") {
+        return analyze_batch(cfg);
+    }
+    if (!cfg.live_input.empty()) {
+        return live(cfg);
+    }
+    return analyze_and_emit(cfg);
+#else
+    std::cerr << "Error: this build has no analysis (Essentia); use `tracks replay FILE`\n";
+    return 1;
+#endif
+}
+
+int main(int argc, char* argv[]) {
+    // Subcommands: the remaining arguments are parsed as usual, with the
+    // subcommand's operand (directory, playlist, timeline file or control
+    // socket) in place of the input file
+    std::string command;
+    if (argc > 1 && (std::strcmp(argv[1], "analyze-batch") == 0 ||
+                     std::strcmp(argv[1], "replay") == 0 ||
+                     std::strcmp(argv[1], "daemon") == 0)) {
+        command = argv[1];
+        argv[1] = argv[0];
+        argc--;
+        argv++;
+    }
+
+    tracks::Config cfg;
+    if (!tracks::load_config(cfg, argc, argv)) {
+        return 1;
+    }
+
+    tracks::MetricsServer metrics;
+    if (!cfg.prometheus.empty() && !metrics.start(cfg.prometheus)) {
+        return 1;
+    }
+
+    int status = run(command, cfg);
+    if (!cfg.stats_json.empty() && !tracks::stats().write_json(cfg.stats_json) && status == 0) {
+        status = 1;
+    }
+    if (tracks::analysis_running()) {
+        // Interrupted with an analysis still running detached: don't wait
+        // for it, nor destroy what it uses
+        std::cout.flush();
+        std::_Exit(status);
+    }
+    return status;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tracks {
+
+// Read-only mapping of a whole file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (::fstat(fd, &st) == 0) {
+            ok_ = true;
+            if (st.st_size > 0) {
+                void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                                 MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    data_ = static_cast<const uint8_t*>(p);
+                    size_ = static_cast<size_t>(st.st_size);
+                } else {
+                    ok_ = false;
+                }
+            }
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (data_) ::munmap(const_cast<uint8_t*>(data_), size_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool           ok() const   { return ok_; }  // false if unreadable
+    const uint8_t* data() const { return data_; }
+    size_t         size() const { return size_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t         size_ = 0;
+    bool           ok_   = false;
+};
+
+} // namespace tracks
@@ -0,0 +1,112 @@
+#include "replay.h"
+#include "mapped_file.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <unistd.h>
+
+namespace tracks {
+
+// Bump whenever the layout or the EventType numbering changes
+static constexpr uint32_t kReplayVersion = 1;
+static constexpr char     kReplayMagic[8] = {'T', 'R', 'K', 'R', 'E', 'P', 'L', 'Y'};
+
+struct ReplayHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t sample_rate;
+    double   duration;
+    uint64_t event_count;
+    uint32_t filename_length;
+    uint32_t reserved;
+};
+
+struct ReplayRecord {
+    double   timestamp;
+    uint32_t type;
+    uint32_t length;  // serialized Envelope bytes that follow
+};
+
+bool store_replay(const std::string& path, const std::string& input_file, int sample_rate,
+                  const Timeline& timeline) {
+    ReplayHeader h{};
+    std::memcpy(h.magic, kReplayMagic, sizeof(kReplayMagic));
+    h.version         = kReplayVersion;
+    h.sample_rate     = static_cast<uint32_t>(sample_rate);
+    h.duration        = timeline.empty() ? 0.0 : timeline[timeline.size() - 1].timestamp;
+    h.event_count     = timeline.size();
+    h.filename_length = static_cast<uint32_t>(input_file.size());
+
+    // Unique per process and call: batch and daemon workers store concurrently
+    static std::atomic<unsigned> stores{0};
+    std::string tmp = path + ".tmp" + std::to_string(::getpid()) + "." +
+                      std::to_string(stores.fetch_add(1, std::memory_order_relaxed));
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(input_file.data(), static_cast<std::streamsize>(input_file.size()));
+        for (const auto& e : timeline) {
+            ReplayRecord r{e.timestamp, static_cast<uint32_t>(e.type), e.length};
+            out.write(reinterpret_cast<const char*>(&r), sizeof(r));
+            auto bytes = timeline.bytes(e);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+        if (!out) {
+            std::cerr << "Warning: could not write timeline " << tmp << "\n";
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::cerr << "Warning: could not write timeline " << path << "\n";
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool load_replay(const std::string& path, Replay& replay) {
+    MappedFile file(path);
+    if (!file.data() || file.size() < sizeof(ReplayHeader)) return false;
+
+    ReplayHeader h;
+    std::memcpy(&h, file.data(), sizeof(h));
+    if (std::memcmp(h.magic, kReplayMagic, sizeof(kReplayMagic)) != 0 ||
+        h.version != kReplayVersion ||
+        h.filename_length > file.size() - sizeof(ReplayHeader)) {
+        return false;
+    }
+
+    const uint8_t* p   = file.data() + sizeof(ReplayHeader);
+    const uint8_t* end = file.data() + file.size();
+    replay.input_file.assign(reinterpret_cast<const char*>(p), h.filename_length);
+    replay.sample_rate = static_cast<int>(h.sample_rate);
+    replay.duration    = h.duration;
+    p += h.filename_length;
+
+    // Every record needs at least its fixed part
+    if (h.event_count > static_cast<size_t>(end - p) / sizeof(ReplayRecord)) return false;
+    size_t arena = static_cast<size_t>(end - p) - h.event_count * sizeof(ReplayRecord);
+
+    replay.events = Timeline();
+    replay.events.reserve(h.event_count, arena);
+    for (uint64_t i = 0; i < h.event_count; ++i) {
+        if (static_cast<size_t>(end - p) < sizeof(ReplayRecord)) return false;
+        ReplayRecord r;
+        std::memcpy(&r, p, sizeof(r));
+        p += sizeof(r);
+        if (r.length > static_cast<size_t>(end - p) ||
+            r.type >= kEventTypeCount) {
+            return false;
+        }
+        replay.events.append(r.timestamp, static_cast<EventType>(r.type), p, r.length);
+        p += r.length;
+    }
+    return p == end;
+}
+
+} // namespace tracks
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "events.h"
+#include <string>
+
+namespace tracks {
+
+// --- Timeline files ---
+// A finished timeline, transport events included, with enough metadata to
+// play it back without analysis: `tracks --dump-timeline FILE song.mp3`
+// writes one and `tracks replay FILE` emits it. Replay needs neither
+// Essentia nor the audio file, so it also works on a build without analysis.
+//
+// Layout: ReplayHeader, the input file name, then event_count records of
+// {timestamp, type, length} each followed by its serialized Envelope.
+// Native byte order, like the analysis cache.
+
+struct Replay {
+    std::string input_file;   // audio file the timeline was analyzed from
+    int         sample_rate = 0;
+    double      duration    = 0.0;
+    Timeline    events;       // sorted, transport events included
+};
+
+// Writes `timeline` for `input_file` atomically (temporary file + rename).
+// Returns false and prints a warning on failure.
+bool store_replay(const std::string& path, const std::string& input_file, int sample_rate,
+                  const Timeline& timeline);
+
+// Reads a timeline file. Returns false if it is missing, truncated or from
+// another format version.
+bool load_replay(const std::string& path, Replay& replay);
+
+} // namespace tracks
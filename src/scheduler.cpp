@@ -0,0 +1,134 @@
+#include "scheduler.h"
+#include "emitter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace tracks {
+
+static void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// steady_clock is CLOCK_MONOTONIC on Linux, so its epoch matches
+static timespec to_timespec(Scheduler::Clock::time_point t) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    timespec ts;
+    ts.tv_sec  = static_cast<time_t>(ns / 1000000000);
+    ts.tv_nsec = static_cast<long>(ns % 1000000000);
+    return ts;
+}
+
+Scheduler::Scheduler(const Config& cfg)
+    : precise_(cfg.precise_timing),
+      spin_(std::chrono::microseconds(std::max(cfg.spin_us, 0))) {
+    pthread_t self = pthread_self();
+
+    if (cfg.rt_priority > 0) {
+        if (pthread_getschedparam(self, &saved_policy_, &saved_param_) == 0) {
+            sched_param param{};
+            param.sched_priority = cfg.rt_priority;
+            int err = pthread_setschedparam(self, SCHED_FIFO, &param);
+            if (err == 0) {
+                restore_sched_ = true;
+            } else {
+                std::cerr << "Warning: SCHED_FIFO priority " << cfg.rt_priority
+                          << " not applied: " << std::strerror(err) << "\n";
+            }
+        }
+    }
+
+    if (cfg.cpu >= 0) {
+        if (pthread_getaffinity_np(self, sizeof(saved_affinity_), &saved_affinity_) == 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cfg.cpu, &set);
+            int err = pthread_setaffinity_np(self, sizeof(set), &set);
+            if (err == 0) {
+                restore_affinity_ = true;
+            } else {
+                std::cerr << "Warning: could not pin emitter to CPU " << cfg.cpu
+                          << ": " << std::strerror(err) << "\n";
+            }
+        }
+    }
+}
+
+Scheduler::~Scheduler() {
+    pthread_t self = pthread_self();
+    if (restore_sched_)    pthread_setschedparam(self, saved_policy_, &saved_param_);
+    if (restore_affinity_) pthread_setaffinity_np(self, sizeof(saved_affinity_), &saved_affinity_);
+}
+
+bool Scheduler::wait_until(Clock::time_point deadline) {
+    const auto chunk = std::chrono::milliseconds(100);
+
+    if (!precise_) {
+        while (Clock::now() < deadline) {
+            if (g_interrupted.load(std::memory_order_relaxed)) return false;
+            auto sleep_time = std::min(Clock::duration(deadline - Clock::now()), Clock::duration(chunk));
+            if (sleep_time.count() > 0) {
+                std::this_thread::sleep_for(sleep_time);
+            }
+        }
+        return !g_interrupted.load(std::memory_order_relaxed);
+    }
+
+    // Absolute-deadline sleeps (no drift from relative sleeps adding up),
+    // still in chunks so an interrupt is seen promptly
+    auto spin_from = deadline - spin_;
+    while (Clock::now() < spin_from) {
+        if (g_interrupted.load(std::memory_order_relaxed)) return false;
+        timespec wake = to_timespec(std::min(spin_from, Clock::now() + chunk));
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, nullptr);  // EINTR: re-check
+    }
+
+    // Spin the rest
+    while (Clock::now() < deadline) {
+        if (g_interrupted.load(std::memory_order_relaxed)) return false;
+        cpu_relax();
+    }
+    return !g_interrupted.load(std::memory_order_relaxed);
+}
+
+Percentiles percentiles(std::vector<double>& samples) {
+    Percentiles p;
+    size_t n = samples.size();
+    if (n == 0) return p;
+    auto at = [&](double q) {
+        size_t k = std::min(n - 1, static_cast<size_t>(q * static_cast<double>(n)));
+        std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+        return samples[k];
+    };
+    p.p50 = at(0.50);
+    p.p99 = at(0.99);
+    p.max = *std::max_element(samples.begin(), samples.end());
+    return p;
+}
+
+void Scheduler::report() {
+    if (lateness_.empty()) return;
+
+    Percentiles p = percentiles(lateness_);
+    char line[160];
+    std::snprintf(line, sizeof(line),
+                  "Timing: %zu sends, lateness p50 %.0f us, p99 %.0f us, max %.0f us%s",
+                  lateness_.size(), p.p50 * 1e6, p.p99 * 1e6, p.max * 1e6,
+                  precise_ ? " (precise)" : "");
+    std::cout << line << std::endl;
+    lateness_.clear();
+}
+
+} // namespace tracks
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "config.h"
+#include <chrono>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+
+namespace tracks {
+
+// --- Scheduler ---
+// Waits for event deadlines on behalf of the Emitter and measures how late
+// each send actually went out.
+//
+// By default it sleeps in 100 ms chunks. With cfg.precise_timing it sleeps
+// to an absolute deadline with clock_nanosleep(TIMER_ABSTIME) and spins the
+// last cfg.spin_us microseconds, which takes scheduler wake-up jitter out of
+// the send time.
+//
+// For its lifetime the calling thread optionally runs under SCHED_FIFO
+// (cfg.rt_priority) and/or pinned to one CPU (cfg.cpu). Both are restored on
+// destruction, so threads started outside a Scheduler's lifetime keep
+// normal scheduling.
+
+// Median, 99th percentile and maximum of `samples` (reordered). The send
+// lateness report and the live capture-to-send report both use these.
+struct Percentiles {
+    double p50 = 0.0, p99 = 0.0, max = 0.0;
+};
+Percentiles percentiles(std::vector<double>& samples);
+
+class Scheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Scheduler(const Config& cfg);
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    // Returns once `deadline` has passed; false if interrupted first
+    bool wait_until(Clock::time_point deadline);
+
+    // Records now - deadline for the lateness statistics
+    void record(Clock::time_point deadline) {
+        lateness_.push_back(std::chrono::duration<double>(Clock::now() - deadline).count());
+    }
+
+    // Prints p50/p99/max lateness of the recorded sends and starts over
+    void report();
+
+private:
+    bool                  precise_;
+    Clock::duration       spin_;
+    std::vector<double>   lateness_;  // seconds
+
+    // Saved thread settings, restored by the destructor
+    bool        restore_sched_    = false;
+    int         saved_policy_     = SCHED_OTHER;
+    sched_param saved_param_{};
+    bool        restore_affinity_ = false;
+    cpu_set_t   saved_affinity_;
+};
+
+} // namespace tracks
@@ -0,0 +1,115 @@
+#include "segmenter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tracks {
+
+// Window either side of a candidate, and how long a peak must stay the
+// highest score before it is a boundary (also the shortest segment)
+static constexpr double kWindow = 4.0;   // s
+static constexpr double kHold   = 4.0;   // s
+
+// Weight of the BIC model-complexity term (SBic's default cpw)
+static constexpr double kPenalty = 1.5;
+
+// Keeps a constant coefficient (digital silence) from taking log(0)
+static constexpr double kMinVariance = 1e-6;
+
+static size_t to_frames(double seconds, int sample_rate, int hop_size) {
+    return std::max<size_t>(2, static_cast<size_t>(seconds * sample_rate / hop_size));
+}
+
+OnlineSegmenter::OnlineSegmenter(int sample_rate, int hop_size)
+    : window_(to_frames(kWindow, sample_rate, hop_size)),
+      hold_(to_frames(kHold, sample_rate, hop_size)) {}
+
+void OnlineSegmenter::Moments::add(const float* x, double sign) {
+    for (size_t d = 0; d < sum.size(); ++d) {
+        double v = static_cast<double>(x[d]);
+        sum[d]    += sign * v;
+        sum_sq[d] += sign * v * v;
+    }
+    count = sign > 0 ? count + 1 : count - 1;
+}
+
+double OnlineSegmenter::Moments::log_det(const Moments* other) const {
+    double n = static_cast<double>(count + (other ? other->count : 0));
+    double total = 0.0;
+    for (size_t d = 0; d < sum.size(); ++d) {
+        double s  = sum[d]    + (other ? other->sum[d]    : 0.0);
+        double sq = sum_sq[d] + (other ? other->sum_sq[d] : 0.0);
+        double mean = s / n;
+        total += std::log(std::max(sq / n - mean * mean, kMinVariance));
+    }
+    return total;
+}
+
+// How much better two Gaussians explain the window than one, less the BIC
+// penalty for the extra mean and variance per coefficient
+double OnlineSegmenter::delta_bic() const {
+    double n  = static_cast<double>(left_.count + right_.count);
+    double nl = static_cast<double>(left_.count);
+    double nr = static_cast<double>(right_.count);
+    double gain = 0.5 * (n * left_.log_det(&right_) - nl * left_.log_det(nullptr)
+                         - nr * right_.log_det(nullptr));
+    return gain - kPenalty * static_cast<double>(dims_) * std::log(n);
+}
+
+int64_t OnlineSegmenter::push(const float* mfcc, size_t n) {
+    if (dims_ == 0) {
+        if (n == 0) return -1;
+        dims_ = n;
+        ring_.assign((2 * window_ + 1) * dims_, 0.0f);
+        for (Moments* m : {&left_, &right_}) {
+            m->sum.assign(dims_, 0.0);
+            m->sum_sq.assign(dims_, 0.0);
+        }
+    }
+
+    // Pad or cut to the first frame's size
+    const size_t slots = 2 * window_ + 1;
+    float* frame = &ring_[(frames_ % slots) * dims_];
+    size_t copy = std::min(n, dims_);
+    std::copy(mfcc, mfcc + copy, frame);
+    std::fill(frame + copy, frame + dims_, 0.0f);
+    ++frames_;
+
+    // Right half: the last window_ frames; left half: the window_ before
+    right_.add(frame, 1.0);
+    if (frames_ > window_) {
+        const float* moved = &ring_[((frames_ - window_ - 1) % slots) * dims_];
+        right_.add(moved, -1.0);
+        left_.add(moved, 1.0);
+    }
+    if (frames_ > 2 * window_) {
+        left_.add(&ring_[((frames_ - 2 * window_ - 1) % slots) * dims_], -1.0);
+    }
+    if (frames_ < 2 * window_) return -1;
+
+    // The split between the halves, at the first frame of the right one
+    uint64_t candidate = frames_ - window_;
+    if (candidate >= quiet_until_) {
+        double score = delta_bic();
+        if (score > 0.0 && (!have_peak_ || score > peak_score_)) {
+            have_peak_  = true;
+            peak_score_ = score;
+            peak_at_    = candidate;
+        }
+    }
+
+    if (have_peak_ && candidate >= peak_at_ + hold_) {
+        have_peak_   = false;
+        quiet_until_ = peak_at_ + hold_;
+        return static_cast<int64_t>(peak_at_);
+    }
+    return -1;
+}
+
+int64_t OnlineSegmenter::finish() {
+    if (!have_peak_) return -1;
+    have_peak_ = false;
+    return static_cast<int64_t>(peak_at_);
+}
+
+} // namespace tracks
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tracks {
+
+// --- Online segmentation ---
+// Sliding-window BIC over the MFCC stream: every frame splits the window
+// around it into a left and a right half, each modelled as a Gaussian with
+// diagonal covariance, and scores the split against one Gaussian for the
+// whole window. Running sums keep this O(coefficients) per frame, and a
+// boundary is decided at most window + hold seconds after it happened, so
+// streaming mode can send segment.boundary as it goes. SBic over the whole
+// MFCC matrix remains the offline option.
+
+class OnlineSegmenter {
+public:
+    OnlineSegmenter(int sample_rate, int hop_size);
+
+    // Adds the next frame's coefficients. Returns the frame index of a
+    // boundary decided by this frame, or -1.
+    int64_t push(const float* mfcc, size_t n);
+
+    // After the last frame: the boundary still held back, or -1
+    int64_t finish();
+
+private:
+    struct Moments {
+        std::vector<double> sum, sum_sq;
+        size_t              count = 0;
+
+        void add(const float* x, double sign);
+        // Log-determinant of the diagonal covariance, pooled with `other` if set
+        double log_det(const Moments* other) const;
+    };
+
+    double delta_bic() const;
+
+    const size_t window_;     // frames either side of a candidate
+    const size_t hold_;       // frames a peak must stay the maximum
+    size_t       dims_ = 0;
+
+    std::vector<float> ring_;  // last 2 * window_ + 1 frames
+    uint64_t           frames_ = 0;
+    Moments            left_, right_;
+
+    bool     have_peak_ = false;
+    double   peak_score_ = 0.0;
+    uint64_t peak_at_ = 0;
+    uint64_t quiet_until_ = 0;  // no candidates before this frame
+};
+
+} // namespace tracks
@@ -0,0 +1,342 @@
+#include "signal_scan.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tracks {
+
+// Saturation: runs of samples at or above -0.1 dBFS
+static constexpr float  kClipLevel   = 0.989f;
+static constexpr int    kMinClipRun  = 3;       // samples; a single full-scale sample is not clipping
+static constexpr double kClipGap     = 0.05;    // s; runs closer than this form one region
+
+// Clicks and discontinuities: a residual this far above its running RMS
+// triggers; the next kSettle samples decide what it was
+static constexpr float  kClickRatio   = 10.0f;
+static constexpr float  kClickFloor   = 0.05f;
+static constexpr int    kSettle       = 32;     // samples
+static constexpr double kSettledRatio = 4.0;    // max residual RMS rise after a defect
+static constexpr double kTriggerHold  = 0.01;   // s
+static constexpr double kResidualTime = 0.02;   // s, residual RMS time constant
+
+// Envelope follower (as Essentia's Envelope defaults)
+static constexpr double kAttackTime  = 0.01;    // s
+static constexpr double kReleaseTime = 1.5;     // s
+
+// Noise bursts: a noisy hop well above the background level
+static constexpr double kBurstZcr      = 0.3;   // zero crossings per sample
+static constexpr double kBurstRatio    = 2.0;   // RMS over the background (6 dB)
+static constexpr double kBurstFloor    = 1e-3;
+static constexpr double kBurstHold     = 0.1;   // s
+static constexpr double kBackgroundTime = 1.0;  // s
+
+// Hum: a line at a mains frequency or its second harmonic that stands
+// out from its neighbours in kHumBlocks one-second blocks in a row
+static constexpr double kHumSpacing  = 4.0;     // Hz to the neighbour bins
+static constexpr double kHumContrast = 10.0;    // power over the neighbours
+static constexpr double kHumFloor    = 1e-4;    // line amplitude (-80 dBFS)
+static constexpr int    kHumBlocks   = 5;
+static constexpr int    kHumMisses   = 2;       // blocks a run survives without the line
+
+// Attack/decay: local maxima of the per-hop peak
+static constexpr double kAttackWindow = 0.05;   // s either side
+static constexpr double kAttackRange  = 0.01;   // ignore peaks 40 dB under the track maximum
+static constexpr double kAttackRise   = 3.16;   // 10 dB over the preceding minimum
+static constexpr double kMinAttack    = 0.001;  // s
+static constexpr double kMinDecay     = 6.0;    // dB
+
+// Fades (after Essentia's FadeDetection): the smoothed level crosses these
+// fractions of its mean over at least kFadeLength
+static constexpr double kFadeLow    = 0.2;
+static constexpr double kFadeHigh   = 0.85;
+static constexpr double kFadeLength = 2.0;      // s
+static constexpr double kFadeSmooth = 0.5;      // s moving average
+
+static double one_pole(double seconds, int sample_rate) {
+    return std::exp(-1.0 / (seconds * sample_rate));
+}
+
+SignalScanner::SignalScanner(int sample_rate, int hop_size)
+    : sample_rate_(sample_rate),
+      hop_size_(std::max(hop_size, 1)),
+      hop_seconds_(static_cast<double>(hop_size_) / sample_rate),
+      attack_coeff_(one_pole(kAttackTime, sample_rate)),
+      release_coeff_(one_pole(kReleaseTime, sample_rate)) {
+    quiet_until_ = static_cast<uint64_t>(kResidualTime * sample_rate);  // let the RMS settle
+
+    const double two_pi = 2.0 * M_PI;
+    for (double mains : {50.0, 60.0}) {
+        for (int harmonic = 1; harmonic <= 2; ++harmonic) {
+            HumLine line;
+            line.frequency   = mains * harmonic;
+            line.at.coeff    = 2.0 * std::cos(two_pi * line.frequency / sample_rate);
+            line.below.coeff = 2.0 * std::cos(two_pi * (line.frequency - kHumSpacing) / sample_rate);
+            line.above.coeff = 2.0 * std::cos(two_pi * (line.frequency + kHumSpacing) / sample_rate);
+            hum_lines_.push_back(line);
+        }
+    }
+}
+
+void SignalScanner::process(const float* x, size_t n) {
+    for (size_t i = 0; i < n; ++i) scan_sample(x[i]);
+}
+
+void SignalScanner::scan_sample(float x) {
+    float ax = std::fabs(x);
+
+    // --- Clicks and discontinuities ---
+    float  e  = x - (2.0f * x1_ - x2_);
+    double e2 = static_cast<double>(e) * e;
+    if (pending_) {
+        uint64_t since = index_ - pending_at_;
+        if (since == 1) {
+            // An impulse is gone by the next sample; a step is not
+            pending_displaced_ = std::fabs(x - pending_next_) > 0.5f * std::fabs(pending_step_);
+        } else if (since > 2) {
+            pending_sum_ += e2;  // residual once an impulse has passed
+            ++pending_count_;
+        }
+        if (since >= static_cast<uint64_t>(kSettle)) {
+            // A new sound keeps the residual up; a defect leaves it where it
+            // was.
+            double settled = pending_sum_ / pending_count_;
+            if (settled <= kSettledRatio * kSettledRatio * residual_ms_) {
+                (pending_displaced_ ? scan_.discontinuities : scan_.clicks).push_back(time_of(pending_at_));
+            }
+            pending_ = false;
+        }
+    } else {
+        bool clipped = ax >= kClipLevel || std::fabs(x1_) >= kClipLevel;
+        if (!clipped && index_ >= quiet_until_ && std::fabs(e) > kClickFloor &&
+            e2 > static_cast<double>(kClickRatio * kClickRatio) * residual_ms_) {
+            pending_       = true;
+            pending_at_    = index_;
+            float predicted = 2.0f * x1_ - x2_;
+            pending_next_  = predicted + (x1_ - x2_);
+            pending_step_  = x - predicted;
+            pending_sum_   = 0.0;
+            pending_count_ = 0;
+            quiet_until_   = index_ + static_cast<uint64_t>(kTriggerHold * sample_rate_);
+        } else {
+            residual_ms_ += (e2 - residual_ms_) / (kResidualTime * sample_rate_);
+        }
+    }
+
+    // --- Saturation ---
+    if (ax >= kClipLevel) {
+        ++clip_run_;
+    } else if (clip_run_ > 0) {
+        if (clip_run_ >= kMinClipRun) {
+            uint64_t start = index_ - static_cast<uint64_t>(clip_run_);
+            if (clip_open_ && time_of(start) - time_of(clip_end_) > kClipGap) close_saturation();
+            if (!clip_open_) {
+                clip_open_  = true;
+                clip_start_ = start;
+            }
+            clip_end_ = index_;
+        }
+        clip_run_ = 0;
+    }
+
+    // --- Envelope and per-hop level ---
+    double coeff = ax > follower_ ? attack_coeff_ : release_coeff_;
+    follower_ = coeff * follower_ + (1.0 - coeff) * ax;
+    hop_peak_ = std::max(hop_peak_, ax);
+    hop_energy_ += static_cast<double>(x) * x;
+    if ((x >= 0.0f) != (x1_ >= 0.0f)) ++hop_crossings_;
+
+    // --- Hum ---
+    for (auto& line : hum_lines_) {
+        line.at.push(x);
+        line.below.push(x);
+        line.above.push(x);
+    }
+
+    x2_ = x1_;
+    x1_ = x;
+    ++index_;
+    if (++hop_fill_ == hop_size_) end_hop();
+    if (++hum_fill_ == sample_rate_) end_hum_block();
+}
+
+void SignalScanner::end_hop() {
+    size_t hop = scan_.peak.size();
+    scan_.envelope.push_back(static_cast<float>(follower_));
+    scan_.peak.push_back(hop_peak_);
+
+    double rms = std::sqrt(hop_energy_ / hop_fill_);
+    double zcr = static_cast<double>(hop_crossings_) / hop_fill_;
+    if (hop == 0) background_rms_ = rms;
+    if (hop >= burst_quiet_until_ && zcr > kBurstZcr && rms > kBurstFloor &&
+        rms > kBurstRatio * background_rms_) {
+        scan_.noise_bursts.push_back(hop * hop_seconds_);
+        burst_quiet_until_ = hop + static_cast<uint64_t>(kBurstHold / hop_seconds_);
+    }
+    background_rms_ += (rms - background_rms_) * hop_seconds_ / kBackgroundTime;
+
+    hop_fill_      = 0;
+    hop_peak_      = 0.0f;
+    hop_energy_    = 0.0;
+    hop_crossings_ = 0;
+}
+
+void SignalScanner::end_hum_block() {
+    double start = static_cast<double>(hum_blocks_);  // one-second blocks
+    for (size_t m = 0; m < 2; ++m) {
+        // Lines are stored per mains frequency: fundamental, then harmonic
+        double best_power = 0.0, best_frequency = 0.0;
+        for (size_t h = 0; h < 2; ++h) {
+            const HumLine& line = hum_lines_[m * 2 + h];
+            double p    = line.at.power();
+            double side = 0.5 * (line.below.power() + line.above.power());
+            double amp  = 2.0 * std::sqrt(std::max(p, 0.0)) / sample_rate_;
+            if (p > kHumContrast * side && amp > kHumFloor && p > best_power) {
+                best_power     = p;
+                best_frequency = line.frequency;
+            }
+        }
+
+        HumRun& run = hum_runs_[m];
+        if (best_power > 0.0) {
+            if (run.blocks == 0) run.start = start;
+            if (!run.reported) run.frequency = best_frequency;
+            run.misses = 0;
+            if (++run.blocks >= kHumBlocks && !run.reported) {
+                scan_.hum.push_back({run.start, run.frequency});
+                run.reported = true;
+            }
+        } else if (run.blocks > 0 && ++run.misses > kHumMisses) {
+            run = HumRun();
+        }
+    }
+
+    for (auto& line : hum_lines_) {
+        line.at.s1 = line.at.s2 = 0.0;
+        line.below.s1 = line.below.s2 = 0.0;
+        line.above.s1 = line.above.s2 = 0.0;
+    }
+    hum_fill_ = 0;
+    ++hum_blocks_;
+}
+
+void SignalScanner::close_saturation() {
+    if (!clip_open_) return;
+    scan_.saturation.push_back({time_of(clip_start_), time_of(clip_end_) - time_of(clip_start_)});
+    clip_open_ = false;
+}
+
+void SignalScanner::finish() {
+    if (clip_run_ >= kMinClipRun) {
+        uint64_t start = index_ - static_cast<uint64_t>(clip_run_);
+        if (clip_open_ && time_of(start) - time_of(clip_end_) > kClipGap) close_saturation();
+        if (!clip_open_) {
+            clip_open_  = true;
+            clip_start_ = start;
+        }
+        clip_end_ = index_;
+    }
+    clip_run_ = 0;
+    close_saturation();
+
+    if (hop_fill_ > 0) end_hop();
+    find_attacks();
+    find_fades();
+}
+
+// Sound events from the per-hop peak: each local maximum that rises 10 dB
+// over the minimum since the previous one. The attack is timed between the
+// 20% and 90% levels of that rise (as LogAttackTime), the decay is the fall
+// to the minimum before the next event.
+void SignalScanner::find_attacks() {
+    const auto& p = scan_.peak;
+    if (p.size() < 3) return;
+    float top = *std::max_element(p.begin(), p.end());
+    if (top <= 0.0f) return;
+
+    size_t half = std::max<size_t>(1, static_cast<size_t>(kAttackWindow / hop_seconds_));
+    auto crossing = [&](size_t lo, size_t hi, double level) {
+        for (size_t j = lo + 1; j <= hi; ++j) {
+            if (p[j] >= level) {
+                double frac = (level - p[j - 1]) / std::max(p[j] - p[j - 1], 1e-9f);
+                return (static_cast<double>(j - 1) + frac) * hop_seconds_;
+            }
+        }
+        return hi * hop_seconds_;
+    };
+    auto lowest = [&](size_t lo, size_t hi) {
+        return static_cast<size_t>(std::min_element(p.begin() + lo, p.begin() + hi + 1) - p.begin());
+    };
+    auto decay = [&](size_t peak, size_t low) {
+        double drop = 20.0 * std::log10(p[peak] / std::max(p[low], 1e-6f));
+        if (low > peak && drop >= kMinDecay) {
+            scan_.decays.push_back({peak * hop_seconds_, drop / ((low - peak) * hop_seconds_)});
+        }
+    };
+
+    bool   have_prev = false;
+    size_t prev = 0;
+    for (size_t i = 1; i < p.size(); ++i) {
+        if (p[i] < top * kAttackRange || p[i] <= p[i - 1]) continue;
+        size_t from = i > half ? i - half : 0;
+        size_t to   = std::min(i + half, p.size() - 1);
+        if (*std::max_element(p.begin() + from, p.begin() + to + 1) > p[i]) continue;
+
+        size_t lo = lowest(have_prev ? prev : 0, i);
+        if (p[i] < kAttackRise * std::max(p[lo], 1e-6f)) continue;
+
+        double range = p[i] - p[lo];
+        double t20 = crossing(lo, i, p[lo] + 0.2 * range);
+        double t90 = crossing(lo, i, p[lo] + 0.9 * range);
+        scan_.attacks.push_back({t20, std::log10(std::max(t90 - t20, kMinAttack))});
+
+        if (have_prev) decay(prev, lo);
+        have_prev = true;
+        prev = i;
+    }
+    if (have_prev) decay(prev, lowest(prev, p.size() - 1));
+}
+
+// Fade-in at the start and fade-out at the end of the track
+void SignalScanner::find_fades() {
+    const auto& p = scan_.peak;
+    size_t width = std::max<size_t>(1, static_cast<size_t>(kFadeSmooth / hop_seconds_));
+    if (p.size() < 2 * width) return;
+
+    // Centered moving average of the per-hop peak
+    std::vector<double> sum(p.size() + 1, 0.0);
+    for (size_t i = 0; i < p.size(); ++i) sum[i + 1] = sum[i] + p[i];
+    std::vector<double> level(p.size());
+    size_t half = width / 2;
+    for (size_t i = 0; i < p.size(); ++i) {
+        size_t lo = i > half ? i - half : 0;
+        size_t hi = std::min(i + half + 1, p.size());
+        level[i] = (sum[hi] - sum[lo]) / static_cast<double>(hi - lo);
+    }
+    double mean = 0.0;
+    for (double v : level) mean += v;
+    mean /= static_cast<double>(level.size());
+    if (mean <= 0.0) return;
+
+    double low = kFadeLow * mean, high = kFadeHigh * mean;
+    size_t min_hops = static_cast<size_t>(kFadeLength / hop_seconds_);
+
+    auto first_above = [&](double v) {
+        return static_cast<size_t>(std::find_if(level.begin(), level.end(),
+                                                [v](double l) { return l >= v; }) - level.begin());
+    };
+    size_t in_begin = first_above(low), in_end = first_above(high);
+    if (in_end < level.size() && in_end >= in_begin + min_hops) {
+        scan_.fade_ins.push_back({in_begin * hop_seconds_, in_end * hop_seconds_});
+    }
+
+    auto last_above = [&](double v) {
+        auto it = std::find_if(level.rbegin(), level.rend(), [v](double l) { return l >= v; });
+        return static_cast<size_t>(level.rend() - it);  // one past it; 0 if none
+    };
+    size_t out_start = last_above(high), out_end = last_above(low);
+    if (out_start > 0 && out_end >= out_start + min_hops && out_start > in_end) {
+        scan_.fade_outs.push_back({(out_end - 1) * hop_seconds_, (out_start - 1) * hop_seconds_});
+    }
+}
+
+} // namespace tracks
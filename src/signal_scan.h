@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tracks {
+
+// --- Time-domain signal scan ---
+// One pass over the decoded mono signal feeds every time-domain detector:
+// clicks, discontinuities, saturation, noise bursts and mains hum per
+// sample or per block, plus the per-hop envelope that attack, decay and fade
+// detection work from once the signal has ended. The analyzer hangs it off
+// the PCM of the frame network, so it costs no extra decode.
+
+struct ScanEvent {
+    double time;
+    double value;
+};
+
+struct SignalScan {
+    std::vector<double>    clicks;
+    std::vector<double>    discontinuities;
+    std::vector<double>    noise_bursts;
+    std::vector<ScanEvent> saturation;   // value: region duration (s)
+    std::vector<ScanEvent> hum;          // value: frequency (Hz)
+    std::vector<ScanEvent> attacks;      // value: log10 of the 20%-90% rise time (s)
+    std::vector<ScanEvent> decays;       // value: fall after the peak (dB/s)
+    std::vector<ScanEvent> fade_ins;     // value: end of the fade (s)
+    std::vector<ScanEvent> fade_outs;    // at the end of the fade; value: its start (s)
+
+    // Per hop, stamped like the frame features (hop i at i * hop / rate)
+    std::vector<float> envelope;         // attack/release follower of |x|
+    std::vector<float> peak;             // max |x| within the hop
+};
+
+class SignalScanner {
+public:
+    SignalScanner(int sample_rate, int hop_size);
+
+    void process(const float* x, size_t n);
+
+    // Closes open regions and runs the envelope-based detectors
+    void finish();
+
+    const SignalScan& result() const { return scan_; }
+    SignalScan&       result()       { return scan_; }
+
+private:
+    struct Goertzel {
+        double coeff = 0.0;
+        double s1 = 0.0, s2 = 0.0;
+        void   push(double x) { double s = x + coeff * s1 - s2; s2 = s1; s1 = s; }
+        double power() const  { return s1 * s1 + s2 * s2 - coeff * s1 * s2; }
+    };
+
+    // A mains hum line and its two neighbours
+    struct HumLine {
+        double   frequency;
+        Goertzel at, below, above;
+    };
+
+    // A hum candidate (mains 50 or 60 Hz) across blocks
+    struct HumRun {
+        int    blocks = 0;      // consecutive blocks with a line present
+        int    misses = 0;      // blocks without since
+        double start  = 0.0;
+        double frequency = 0.0;
+        bool   reported = false;
+    };
+
+    double time_of(uint64_t sample) const {
+        return static_cast<double>(sample) / sample_rate_;
+    }
+
+    void scan_sample(float x);
+    void end_hop();
+    void end_hum_block();
+    void close_saturation();
+    void find_attacks();
+    void find_fades();
+
+    const int    sample_rate_;
+    const int    hop_size_;
+    const double hop_seconds_;
+
+    SignalScan scan_;
+    uint64_t   index_ = 0;              // of the next sample
+
+    // Click / discontinuity: residual of a linear extrapolation
+    float    x1_ = 0.0f, x2_ = 0.0f;   // previous two samples
+    double   residual_ms_ = 0.0;       // running mean square of the residual
+    uint64_t quiet_until_ = 0;         // no triggers before this sample
+    bool     pending_ = false;         // a trigger waiting for the signal to settle
+    uint64_t pending_at_ = 0;
+    float    pending_step_ = 0.0f;     // jump away from the extrapolation
+    float    pending_next_ = 0.0f;     // extrapolated sample after it
+    bool     pending_displaced_ = false;
+    double   pending_sum_ = 0.0;       // squared residual after it
+    int      pending_count_ = 0;
+
+    // Saturation
+    int      clip_run_ = 0;
+    bool     clip_open_ = false;
+    uint64_t clip_start_ = 0, clip_end_ = 0;
+
+    // Envelope follower and per-hop accumulators
+    double follower_ = 0.0;
+    double attack_coeff_, release_coeff_;
+    int    hop_fill_ = 0;
+    float  hop_peak_ = 0.0f;
+    double hop_energy_ = 0.0;
+    int    hop_crossings_ = 0;
+
+    // Noise bursts
+    double   background_rms_ = 0.0;
+    uint64_t burst_quiet_until_ = 0;   // in hops
+
+    // Hum
+    std::vector<HumLine> hum_lines_;
+    HumRun               hum_runs_[2];  // 50 Hz, 60 Hz mains
+    int                  hum_fill_ = 0;
+    uint64_t             hum_blocks_ = 0;
+};
+
+} // namespace tracks
@@ -0,0 +1,41 @@
+#include "snapshot.h"
+
+namespace tracks {
+
+// Slot an event's state is kept under; TRACK_POSITION (no slot) otherwise.
+// silence.start and silence.end share one: only the latest of them matters.
+static EventType state_slot(EventType type) {
+    switch (type) {
+        case EventType::TRACK_START:
+        case EventType::KEY_CHANGE:
+        case EventType::TEMPO_CHANGE:
+        case EventType::CHORD_CHANGE:
+        case EventType::TUNING:
+        case EventType::SEGMENT_BOUNDARY:
+        case EventType::SILENCE_START:
+            return type;
+        case EventType::SILENCE_END:
+            return EventType::SILENCE_START;
+        default:
+            return EventType::TRACK_POSITION;
+    }
+}
+
+void StateSnapshot::record(EventType type, std::string_view serialized) {
+    EventType slot = state_slot(type);
+    if (slot == EventType::TRACK_POSITION) return;
+    latest_[slot].assign(serialized.data(), serialized.size());
+}
+
+const std::string& StateSnapshot::build(double position) {
+    scratch_.Clear();
+    scratch_.set_timestamp(position);
+    auto* snap = scratch_.mutable_snapshot();
+    for (const auto& [slot, bytes] : latest_) {
+        snap->add_events()->ParseFromString(bytes);
+    }
+    scratch_.SerializeToString(&out_);
+    return out_;
+}
+
+} // namespace tracks
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "events.h"
+#include "tracks.pb.h"
+#include <map>
+#include <string>
+#include <string_view>
+
+namespace tracks {
+
+// --- StateSnapshot ---
+// Latest value of each state-like event type of the playing track (its
+// track.start, key, tempo, chord, tuning, segment, silence), published as
+// an Envelope.snapshot with every track.position so a receiver that joined
+// mid-track learns the current state within one heartbeat instead of at
+// the next change. One instance per played track.
+
+class StateSnapshot {
+public:
+    // Remembers the envelope if `type` describes lasting state
+    void record(EventType type, std::string_view serialized);
+
+    // Serialized Envelope.snapshot at `position`; valid until the next call
+    const std::string& build(double position);
+
+private:
+    std::map<EventType, std::string> latest_;  // by state slot, see record()
+    Envelope                         scratch_;
+    std::string                      out_;
+};
+
+} // namespace tracks
@@ -0,0 +1,326 @@
+#include "stats.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <sys/resource.h>
+#include <time.h>
+
+namespace tracks {
+
+static constexpr size_t kRecentAnalyses = 256;  // per-file detail kept for the JSON
+
+static double thread_cpu_seconds() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + ts.tv_nsec * 1e-9;
+}
+
+static long peak_rss_kb() {
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_maxrss;  // kilobytes on Linux
+}
+
+// --- StageTimer ---
+
+StageTimer::StageTimer()
+    : wall_start_(std::chrono::steady_clock::now()),
+      cpu_start_(thread_cpu_seconds()),
+      rss_start_kb_(peak_rss_kb()) {}
+
+StageStats StageTimer::finish(std::string name) const {
+    StageStats s;
+    s.name         = std::move(name);
+    s.wall_s       = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start_).count();
+    s.cpu_s        = thread_cpu_seconds() - cpu_start_;
+    s.rss_delta_kb = peak_rss_kb() - rss_start_kb_;
+    return s;
+}
+
+// --- SendStats ---
+
+void SendStats::sent(uint64_t count, uint64_t payload_bytes, int64_t now_ns) {
+    datagrams.fetch_add(count, std::memory_order_relaxed);
+    bytes.fetch_add(payload_bytes, std::memory_order_relaxed);
+    int64_t none = 0;
+    first_ns.compare_exchange_strong(none, now_ns, std::memory_order_relaxed);
+    last_ns.store(now_ns, std::memory_order_relaxed);
+}
+
+// --- Stats ---
+
+Stats::Stats() : start_(std::chrono::steady_clock::now()) {}
+
+Stats& stats() {
+    static Stats instance;
+    return instance;
+}
+
+void Stats::record(AnalysisStats analysis) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& s : analysis.stages) {
+        Totals& t = stage_totals_[s.name];
+        t.runs++;
+        t.wall_s  += s.wall_s;
+        t.cpu_s   += s.cpu_s;
+        t.frames  += s.frames;
+        t.audio_s += s.audio_s;
+    }
+    analyses_++;
+    audio_s_ += analysis.duration;
+    wall_s_  += analysis.wall_s;
+    last_rtf_ = analysis.wall_s > 0.0 ? analysis.duration / analysis.wall_s : 0.0;
+
+    recent_.push_back(std::move(analysis));
+    if (recent_.size() > kRecentAnalyses) recent_.pop_front();
+}
+
+static std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (unsigned char c : s) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+    return out + "\"";
+}
+
+// Prometheus label values escape the same three characters
+static std::string label_value(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '\n') { out += "\\n"; continue; }
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+std::string Stats::json() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream o;
+    o.precision(6);
+
+    double uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    o << "{\n  \"uptime_s\": " << uptime << ",\n";
+
+    o << "  \"analyses_total\": " << analyses_ << ",\n";
+    o << "  \"analyses\": [";
+    for (size_t i = 0; i < recent_.size(); ++i) {
+        const auto& a = recent_[i];
+        o << (i ? "," : "") << "\n    {\"input\": " << json_string(a.input)
+          << ", \"duration_s\": " << a.duration << ", \"wall_s\": " << a.wall_s
+          << ", \"realtime_factor\": " << (a.wall_s > 0.0 ? a.duration / a.wall_s : 0.0)
+          << ", \"stages\": [";
+        for (size_t j = 0; j < a.stages.size(); ++j) {
+            const auto& s = a.stages[j];
+            o << (j ? "," : "") << "\n      {\"name\": " << json_string(s.name)
+              << ", \"wall_s\": " << s.wall_s << ", \"cpu_s\": " << s.cpu_s
+              << ", \"rss_delta_kb\": " << s.rss_delta_kb << ", \"frames\": " << s.frames
+              << ", \"realtime_factor\": " << s.realtime_factor() << "}";
+        }
+        o << (a.stages.empty() ? "]}" : "\n    ]}");
+    }
+    o << (recent_.empty() ? "],\n" : "\n  ],\n");
+
+    o << "  \"stage_totals\": {";
+    bool first = true;
+    for (const auto& [name, t] : stage_totals_) {
+        o << (first ? "" : ",") << "\n    " << json_string(name) << ": {\"runs\": " << t.runs
+          << ", \"wall_s\": " << t.wall_s << ", \"cpu_s\": " << t.cpu_s
+          << ", \"frames\": " << t.frames
+          << ", \"realtime_factor\": " << (t.wall_s > 0.0 ? t.audio_s / t.wall_s : 0.0) << "}";
+        first = false;
+    }
+    o << (stage_totals_.empty() ? "},\n" : "\n  },\n");
+
+    // Rates over the span from the first send to the latest
+    uint64_t datagrams = sends_.datagrams.load(std::memory_order_relaxed);
+    uint64_t bytes     = sends_.bytes.load(std::memory_order_relaxed);
+    double span = (sends_.last_ns.load(std::memory_order_relaxed) -
+                   sends_.first_ns.load(std::memory_order_relaxed)) * 1e-9;
+    o << "  \"send\": {\"events\": " << sends_.events.load(std::memory_order_relaxed)
+      << ", \"datagrams\": " << datagrams << ", \"bytes\": " << bytes
+      << ", \"errors\": " << sends_.errors.load(std::memory_order_relaxed)
+      << ", \"seconds\": " << span
+      << ", \"datagrams_per_s\": " << (span > 0.0 ? datagrams / span : 0.0)
+      << ", \"bytes_per_s\": " << (span > 0.0 ? bytes / span : 0.0) << "}\n}\n";
+    return o.str();
+}
+
+std::string Stats::prometheus() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream o;
+    o.precision(9);
+
+    auto metric = [&](const char* name, const char* type, const char* help) {
+        o << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n";
+    };
+    auto per_stage = [&](const char* name, const char* help, auto value) {
+        metric(name, "counter", help);
+        for (const auto& [stage, t] : stage_totals_) {
+            o << name << "{stage=\"" << label_value(stage) << "\"} " << value(t) << "\n";
+        }
+    };
+
+    metric("tracks_uptime_seconds", "gauge", "Seconds since tracks started");
+    o << "tracks_uptime_seconds "
+      << std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count() << "\n";
+
+    metric("tracks_analyses_total", "counter", "Files analyzed (cache hits excluded)");
+    o << "tracks_analyses_total " << analyses_ << "\n";
+    metric("tracks_analyzed_audio_seconds_total", "counter", "Audio seconds analyzed");
+    o << "tracks_analyzed_audio_seconds_total " << audio_s_ << "\n";
+    metric("tracks_analysis_seconds_total", "counter", "Wall seconds spent analyzing");
+    o << "tracks_analysis_seconds_total " << wall_s_ << "\n";
+    metric("tracks_last_analysis_realtime_factor", "gauge",
+           "Audio seconds per wall second of the latest analysis");
+    o << "tracks_last_analysis_realtime_factor " << last_rtf_ << "\n";
+
+    per_stage("tracks_stage_runs_total", "Times an analysis stage ran",
+              [](const Totals& t) { return static_cast<double>(t.runs); });
+    per_stage("tracks_stage_seconds_total", "Wall seconds spent in an analysis stage",
+              [](const Totals& t) { return t.wall_s; });
+    per_stage("tracks_stage_cpu_seconds_total", "CPU seconds spent in an analysis stage",
+              [](const Totals& t) { return t.cpu_s; });
+    per_stage("tracks_stage_frames_total", "Frames (passes) or events (builders) an analysis stage produced",
+              [](const Totals& t) { return static_cast<double>(t.frames); });
+
+    metric("tracks_events_sent_total", "counter", "Envelopes handed to the transport");
+    o << "tracks_events_sent_total " << sends_.events.load(std::memory_order_relaxed) << "\n";
+    metric("tracks_datagrams_sent_total", "counter", "UDP datagrams sent, counting each destination");
+    o << "tracks_datagrams_sent_total " << sends_.datagrams.load(std::memory_order_relaxed) << "\n";
+    metric("tracks_sent_bytes_total", "counter", "UDP payload bytes sent");
+    o << "tracks_sent_bytes_total " << sends_.bytes.load(std::memory_order_relaxed) << "\n";
+    metric("tracks_send_errors_total", "counter", "Datagrams a send failed for");
+    o << "tracks_send_errors_total " << sends_.errors.load(std::memory_order_relaxed) << "\n";
+    return o.str();
+}
+
+bool Stats::write_json(const std::string& path) const {
+    std::ofstream out(path);
+    if (out) out << json();
+    if (!out) {
+        std::cerr << "Error: cannot write stats to " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+// --- MetricsServer ---
+
+namespace {
+
+// One request: read the header, answer, close
+struct MetricsSession : std::enable_shared_from_this<MetricsSession> {
+    explicit MetricsSession(boost::asio::ip::tcp::socket s) : socket(std::move(s)) {}
+
+    void run() {
+        auto self = shared_from_this();
+        boost::asio::async_read_until(socket, request, "\r\n\r\n",
+            [self](const boost::system::error_code& ec, size_t) {
+                if (ec) return;
+                self->respond();
+            });
+    }
+
+    void respond() {
+        std::istream in(&request);
+        std::string method, target;
+        in >> method >> target;
+
+        std::string status = "200 OK", body;
+        if (method != "GET") {
+            status = "405 Method Not Allowed";
+        } else if (target == "/metrics" || target == "/") {
+            body = stats().prometheus();
+        } else {
+            status = "404 Not Found";
+        }
+        response = "HTTP/1.0 " + status + "\r\n"
+                   "Content-Type: text/plain; version=0.0.4\r\n"
+                   "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                   "Connection: close\r\n\r\n" + body;
+
+        auto self = shared_from_this();
+        boost::asio::async_write(socket, boost::asio::buffer(response),
+            [self](const boost::system::error_code&, size_t) {
+                boost::system::error_code ignored;
+                self->socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored);
+            });
+    }
+
+    boost::asio::ip::tcp::socket socket;
+    boost::asio::streambuf       request{8192};  // bounds the header a client can send
+    std::string                  response;
+};
+
+} // namespace
+
+MetricsServer::~MetricsServer() {
+    io_.stop();
+    if (thread_.joinable()) thread_.join();
+}
+
+bool MetricsServer::start(const std::string& spec) {
+    using boost::asio::ip::tcp;
+    std::string address = "127.0.0.1", port = spec;
+    auto colon = spec.rfind(':');
+    if (colon != std::string::npos) {
+        address = spec.substr(0, colon);
+        port    = spec.substr(colon + 1);
+    }
+
+    boost::system::error_code ec;
+    auto ip = boost::asio::ip::make_address(address, ec);
+    unsigned long number = 0;
+    try {
+        number = std::stoul(port);
+    } catch (const std::exception&) {
+        number = 0;
+    }
+    if (ec || number == 0 || number > 65535) {
+        std::cerr << "Error: invalid --prometheus address '" << spec << "' (expected [ADDR:]PORT)\n";
+        return false;
+    }
+
+    tcp::endpoint endpoint(ip, static_cast<unsigned short>(number));
+    acceptor_ = std::make_unique<tcp::acceptor>(io_);
+    acceptor_->open(endpoint.protocol(), ec);
+    if (!ec) acceptor_->set_option(tcp::acceptor::reuse_address(true), ec);
+    if (!ec) acceptor_->bind(endpoint, ec);
+    if (!ec) acceptor_->listen(boost::asio::socket_base::max_listen_connections, ec);
+    if (ec) {
+        std::cerr << "Error: cannot listen on " << spec << " for metrics: " << ec.message() << "\n";
+        return false;
+    }
+
+    accept();
+    thread_ = std::thread([this] { io_.run(); });
+    std::cout << "Metrics: http://" << address << ":" << number << "/metrics" << std::endl;
+    return true;
+}
+
+void MetricsServer::accept() {
+    acceptor_->async_accept([this](const boost::system::error_code& ec, boost::asio::ip::tcp::socket s) {
+        if (ec == boost::asio::error::operation_aborted) return;
+        if (!ec) std::make_shared<MetricsSession>(std::move(s))->run();
+        accept();
+    });
+}
+
+} // namespace tracks
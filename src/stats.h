@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+
+namespace tracks {
+
+// --- Instrumentation ---
+// Process-wide analysis timings and send counters. analyze() records a
+// StageStats for the decode, every pass and every timeline builder of each
+// file it analyzes; Transport counts what it sends. --stats-json writes the
+// lot when tracks exits, and --prometheus serves it as Prometheus text
+// while it runs (a playlist can run for days).
+
+struct StageStats {
+    std::string name;               // "decode", "pass.beat", "build.spectral", ...
+    double      wall_s = 0.0;
+    double      cpu_s  = 0.0;       // CPU time of the thread that ran the stage
+    long        rss_delta_kb = 0;   // growth of the process's peak RSS meanwhile
+    uint64_t    frames = 0;         // passes: analysis frames; builders: events added
+    double      audio_s = 0.0;      // audio the stage covered
+
+    double realtime_factor() const { return wall_s > 0.0 ? audio_s / wall_s : 0.0; }
+};
+
+// Measures a stage from construction to finish(). CPU time is the calling
+// thread's, so start and finish on the thread that does the work.
+class StageTimer {
+public:
+    StageTimer();
+    StageStats finish(std::string name) const;
+
+private:
+    std::chrono::steady_clock::time_point wall_start_;
+    double                                cpu_start_;
+    long                                  rss_start_kb_;
+};
+
+struct AnalysisStats {
+    std::string             input;
+    double                  duration = 0.0;  // audio seconds
+    double                  wall_s   = 0.0;
+    std::vector<StageStats> stages;
+};
+
+// Bumped by Transport for every sendmmsg
+struct SendStats {
+    std::atomic<uint64_t> events{0};     // envelopes handed to the transport
+    std::atomic<uint64_t> datagrams{0};  // datagrams sent, counting each destination
+    std::atomic<uint64_t> bytes{0};      // UDP payload bytes of those
+    std::atomic<uint64_t> errors{0};     // datagrams a send failed for
+    std::atomic<int64_t>  first_ns{0};   // steady_clock of the first and latest send
+    std::atomic<int64_t>  last_ns{0};
+
+    void sent(uint64_t count, uint64_t payload_bytes, int64_t now_ns);
+};
+
+class Stats {
+public:
+    Stats();
+
+    void record(AnalysisStats analysis);
+    SendStats& sends() { return sends_; }
+
+    std::string json() const;
+    std::string prometheus() const;
+
+    // Writes json() to `path`; prints why and returns false if it cannot
+    bool write_json(const std::string& path) const;
+
+private:
+    struct Totals {
+        uint64_t runs   = 0;
+        double   wall_s = 0.0;
+        double   cpu_s  = 0.0;
+        uint64_t frames = 0;
+        double   audio_s = 0.0;
+    };
+
+    mutable std::mutex            mutex_;
+    std::deque<AnalysisStats>     recent_;          // the last kRecentAnalyses
+    std::map<std::string, Totals> stage_totals_;
+    uint64_t                      analyses_ = 0;
+    double                        audio_s_  = 0.0;
+    double                        wall_s_   = 0.0;
+    double                        last_rtf_ = 0.0;
+    SendStats                     sends_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+Stats& stats();
+
+// Serves stats().prometheus() over HTTP ("GET /metrics") from a background
+// thread for as long as it lives.
+class MetricsServer {
+public:
+    MetricsServer() = default;
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    // Listens on "[ADDR:]PORT" (127.0.0.1 without ADDR). Prints why and
+    // returns false if it cannot.
+    bool start(const std::string& spec);
+
+private:
+    void accept();
+
+    boost::asio::io_context                         io_;
+    std::unique_ptr<boost::asio::ip::tcp::acceptor> acceptor_;
+    std::thread                                     thread_;
+};
+
+} // namespace tracks
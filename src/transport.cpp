@@ -1,10 +1,49 @@
 #include "transport.h"
+#include "stats.h"
 #include <iostream>
+#include <algorithm>
 #include <array>
+#include <cerrno>
+#include <chrono>
 #include <cstdio>
+#include <cstring>
+#include <limits>
 
 namespace tracks {
 
+// Hand-encoded wrapper tags, so coalescing is a copy of the already
+// serialized envelopes rather than a re-serialization:
+// Envelope.batch = 130 and EnvelopeBatch.events = 1, both length-delimited
+static constexpr uint32_t kBatchTag  = (130 << 3) | 2;
+static constexpr uint32_t kEventsTag = (1 << 3) | 2;
+
+// Envelope.seq = 2 (varint) and Envelope.sent_ns = 3 (fixed64)
+static constexpr uint8_t kSeqTag    = (2 << 3) | 0;
+static constexpr uint8_t kSentNsTag = (3 << 3) | 1;
+
+static uint64_t monotonic_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static size_t varint_size(uint64_t v) {
+    size_t n = 1;
+    while (v >= 0x80) { v >>= 7; ++n; }
+    return n;
+}
+
+static void put_varint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+static size_t field_size(uint32_t tag, size_t length) {
+    return varint_size(tag) + varint_size(length) + length;
+}
+
 std::string Transport::detect_wsl2_host() {
     std::array<char, 256> buf;
     std::string result;
@@ -25,8 +64,11 @@ std::string Transport::detect_wsl2_host() {
 }
 
 Transport::Transport(const Config& cfg)
-    : endpoint_(boost::asio::ip::address::from_string(cfg.multicast_group), cfg.port)
-    , socket_(io_, endpoint_.protocol())
+    : socket_(io_, boost::asio::ip::udp::v4())
+    , coalesce_(cfg.coalesce)
+    // IPv4 + UDP headers and the seq/sent_ns trailer come off the MTU
+    , max_datagram_(static_cast<size_t>(
+          std::max(cfg.mtu - 28 - static_cast<int>(sizeof(Trailer::bytes)), 64)))
 {
     // Set multicast TTL
     socket_.set_option(boost::asio::ip::multicast::hops(cfg.ttl));
@@ -40,6 +82,13 @@ Transport::Transport(const Config& cfg)
             boost::asio::ip::address_v4::from_string(cfg.interface)));
     }
 
+    if (cfg.destinations.empty()) {
+        add_route(cfg, cfg.multicast_group, cfg.port, {}, 0.0);
+    }
+    for (const auto& dest : cfg.destinations) {
+        add_route(cfg, dest.address, dest.port ? dest.port : cfg.port, dest.events, dest.max_rate);
+    }
+
     // Unicast dual-send for WSL2
     if (cfg.enable_unicast) {
         std::string target = cfg.unicast_target;
@@ -50,27 +99,174 @@ Transport::Transport(const Config& cfg)
             std::cerr << "Warning: --enable-unicast set but could not detect WSL2 host IP. "
                          "Use --unicast-target to specify manually.\n";
         } else {
-            unicast_enabled_ = true;
-            unicast_endpoint_ = boost::asio::ip::udp::endpoint(
-                boost::asio::ip::address::from_string(target), cfg.port);
+            add_route(cfg, target, cfg.port, {}, 0.0);
             std::cout << "Unicast enabled: also sending to " << target << ":" << cfg.port << std::endl;
         }
     }
 }
 
-void Transport::send(const std::string& serialized_envelope) {
-    boost::system::error_code ec;
-    socket_.send_to(boost::asio::buffer(serialized_envelope), endpoint_, 0, ec);
-    if (ec) {
-        std::cerr << "send error: " << ec.message() << "\n";
+void Transport::add_route(const Config& cfg, const std::string& address, uint16_t port,
+                          const EventFilter& events, double max_rate) {
+    Route r;
+    r.endpoint = boost::asio::ip::udp::endpoint(boost::asio::ip::address::from_string(address), port);
+    r.events   = events;
+    if (!cfg.vector_encoding.empty()) r.vectors = std::make_unique<VectorEncoder>(cfg);
+    if (max_rate > 0) {
+        r.min_interval_ns = static_cast<int64_t>(1e9 / max_rate);
+        r.last_sent_ns.assign(kEventTypeCount, std::numeric_limits<int64_t>::min());
+    }
+    routes_.push_back(std::move(r));
+}
+
+bool Transport::accepts(Route& route, EventType type, int64_t now_ns) {
+    // Transport events reach every destination, unthrottled
+    if (is_transport_event(type)) return true;
+    if (!route.events.empty() && !route.events.count(type)) return false;
+    if (route.min_interval_ns > 0) {
+        int64_t& last = route.last_sent_ns[static_cast<size_t>(type)];
+        if (last != std::numeric_limits<int64_t>::min() && now_ns - last < route.min_interval_ns) {
+            return false;
+        }
+        last = now_ns;
+    }
+    return true;
+}
+
+void Transport::make_trailer(Trailer& t, uint64_t seq, uint64_t sent_ns) {
+    size_t n = 0;
+    t.bytes[n++] = static_cast<char>(kSeqTag);
+    while (seq >= 0x80) {
+        t.bytes[n++] = static_cast<char>((seq & 0x7f) | 0x80);
+        seq >>= 7;
+    }
+    t.bytes[n++] = static_cast<char>(seq);
+    t.bytes[n++] = static_cast<char>(kSentNsTag);
+    for (int i = 0; i < 8; ++i) t.bytes[n++] = static_cast<char>(sent_ns >> (8 * i));  // little-endian
+    t.length = n;
+}
+
+void Transport::send(EventType type, std::string_view serialized_envelope) {
+    send_batch(&type, &serialized_envelope, 1);
+}
+
+void Transport::send_batch(const EventType* types, const std::string_view* serialized_envelopes,
+                           size_t count) {
+    if (count == 0) return;
+    stats().sends().events.fetch_add(count, std::memory_order_relaxed);
+
+    // Worst case every envelope gets its own wrapper, for every route;
+    // reserving that up front keeps packed_ from reallocating under the
+    // views taken into it
+    packed_.clear();
+    if (coalesce_ && count > 1) {
+        size_t bound = 0;
+        for (size_t i = 0; i < count; ++i) {
+            bound += field_size(kEventsTag, serialized_envelopes[i].size()) + 16;
+        }
+        packed_.reserve(bound * routes_.size());
+    }
+    views_.clear();
+
+    int64_t now = static_cast<int64_t>(monotonic_ns());
+    for (auto& route : routes_) {
+        selected_.clear();
+        if (route.vectors) route.vectors->clear();
+        for (size_t i = 0; i < count; ++i) {
+            if (!accepts(route, types[i], now)) continue;
+            selected_.push_back(route.vectors
+                ? route.vectors->encode(types[i], serialized_envelopes[i])
+                : serialized_envelopes[i]);
+        }
+        route.first = views_.size();
+        pack(selected_.data(), selected_.size());
+        route.count = views_.size() - route.first;
+    }
+    send_datagrams();
+}
+
+void Transport::pack(const std::string_view* serialized_envelopes, size_t count) {
+    if (!coalesce_ || count < 2) {
+        views_.insert(views_.end(), serialized_envelopes, serialized_envelopes + count);
+        return;
+    }
+
+    size_t first = 0;
+    while (first < count) {
+        // Greedily take envelopes while the wrapped datagram still fits
+        size_t inner = field_size(kEventsTag, serialized_envelopes[first].size());
+        size_t last  = first + 1;
+        while (last < count) {
+            size_t next = inner + field_size(kEventsTag, serialized_envelopes[last].size());
+            if (field_size(kBatchTag, next) > max_datagram_) break;
+            inner = next;
+            ++last;
+        }
+
+        if (last - first == 1) {
+            // Alone (or too large to share): send it as a plain envelope
+            views_.push_back(serialized_envelopes[first]);
+        } else {
+            size_t start = packed_.size();
+            put_varint(packed_, kBatchTag);
+            put_varint(packed_, inner);
+            for (size_t i = first; i < last; ++i) {
+                put_varint(packed_, kEventsTag);
+                put_varint(packed_, serialized_envelopes[i].size());
+                packed_.append(serialized_envelopes[i].data(), serialized_envelopes[i].size());
+            }
+            views_.emplace_back(packed_.data() + start, packed_.size() - start);
+        }
+        first = last;
+    }
+}
+
+void Transport::send_datagrams() {
+    size_t total = views_.size();
+    if (total == 0) return;
+
+    msgs_.assign(total, mmsghdr{});
+    iovs_.resize(2 * total);
+    trailers_.resize(total);
+
+    uint64_t sent_ns = monotonic_ns();
+    for (auto& route : routes_) {
+        for (size_t k = route.first; k < route.first + route.count; ++k) {
+            make_trailer(trailers_[k], ++route.seq, sent_ns);
+            iovs_[2 * k].iov_base     = const_cast<char*>(views_[k].data());
+            iovs_[2 * k].iov_len      = views_[k].size();
+            iovs_[2 * k + 1].iov_base = trailers_[k].bytes;
+            iovs_[2 * k + 1].iov_len  = trailers_[k].length;
+
+            msghdr& h = msgs_[k].msg_hdr;
+            h.msg_name    = const_cast<sockaddr*>(route.endpoint.data());
+            h.msg_namelen = static_cast<socklen_t>(route.endpoint.size());
+            h.msg_iov     = &iovs_[2 * k];
+            h.msg_iovlen  = 2;
+        }
     }
 
-    if (unicast_enabled_) {
-        socket_.send_to(boost::asio::buffer(serialized_envelope), unicast_endpoint_, 0, ec);
-        if (ec) {
-            std::cerr << "unicast send error: " << ec.message() << "\n";
+    // sendmmsg may stop early (a full socket buffer, or the kernel's
+    // per-call limit); resume there. An error is about the message at
+    // `next` alone (an unreachable destination, say): skip it and go on
+    size_t next   = 0;
+    size_t failed = 0;
+    while (next < total) {
+        int r = ::sendmmsg(socket_.native_handle(), msgs_.data() + next,
+                           static_cast<unsigned int>(total - next), 0);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            if (failed++ == 0) std::cerr << "send error: " << std::strerror(errno) << "\n";
+            next += 1;
+            continue;
         }
+        next += static_cast<size_t>(r);
     }
+
+    uint64_t bytes = 0;  // msg_len stays 0 for a failed message
+    for (size_t k = 0; k < total; ++k) bytes += msgs_[k].msg_len;
+    auto& counters = stats().sends();
+    counters.sent(total - failed, bytes, static_cast<int64_t>(sent_ns));
+    if (failed) counters.errors.fetch_add(failed, std::memory_order_relaxed);
 }
 
 } // namespace tracks
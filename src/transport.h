@@ -1,24 +1,90 @@
 #pragma once
 
 #include "config.h"
+#include "events.h"
+#include "vector_codec.h"
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <boost/asio.hpp>
+#include <sys/socket.h>
 
 namespace tracks {
 
+// Sends to every configured destination (Config::destinations, or the
+// multicast group, plus the WSL2 unicast relay) through one socket. Each
+// destination has its own event filter, rate limit and sequence numbers, so
+// a receiver sees a gapless seq for the events it is sent.
+//
+// Every datagram gets Envelope.seq and Envelope.sent_ns appended as a
+// trailer of its own iovec (protobuf takes the last occurrence of a field),
+// so the serialized envelopes are sent as they are.
+//
+// Vector events are quantized (Config::vector_encoding) per destination,
+// after its filter and rate limit, so every destination's delta chain only
+// spans the frames it is actually sent.
+
 class Transport {
 public:
     explicit Transport(const Config& cfg);
-    void send(const std::string& serialized_envelope);
+
+    // Sends one envelope of event type `type`
+    void send(EventType type, std::string_view serialized_envelope);
+
+    // Sends `count` envelopes (types[i] is the type of the i-th) to every
+    // destination that takes them, with as few sendmmsg calls as possible.
+    // With cfg.coalesce, each destination's envelopes are first packed into
+    // EnvelopeBatch datagrams of at most the MTU payload; one that fits
+    // alone goes out unwrapped.
+    void send_batch(const EventType* types, const std::string_view* serialized_envelopes,
+                    size_t count);
 
 private:
     static std::string detect_wsl2_host();
 
-    boost::asio::io_context        io_;
-    boost::asio::ip::udp::endpoint endpoint_;
-    boost::asio::ip::udp::socket   socket_;
-    bool                           unicast_enabled_ = false;
-    boost::asio::ip::udp::endpoint unicast_endpoint_;
+    struct Route {
+        boost::asio::ip::udp::endpoint endpoint;
+        EventFilter           events;               // empty = everything
+        int64_t               min_interval_ns = 0;  // per event type (max_rate)
+        std::vector<int64_t>  last_sent_ns;         // by EventType, for the rate limit
+        std::unique_ptr<VectorEncoder> vectors;     // null without vector_encoding
+        uint64_t              seq   = 0;            // last sequence number sent
+        size_t                first = 0;            // this call's datagrams in views_
+        size_t                count = 0;
+    };
+
+    void add_route(const Config& cfg, const std::string& address, uint16_t port,
+                   const EventFilter& events, double max_rate);
+    bool accepts(Route& route, EventType type, int64_t now_ns);
+
+    // Appends the datagrams for `count` envelopes to views_ (coalesced into
+    // packed_ when enabled)
+    void pack(const std::string_view* serialized_envelopes, size_t count);
+    void send_datagrams();
+
+    // Encoded seq + sent_ns fields to append to a datagram
+    struct Trailer {
+        char   bytes[20];
+        size_t length;
+    };
+    static void make_trailer(Trailer& t, uint64_t seq, uint64_t sent_ns);
+
+    boost::asio::io_context      io_;
+    boost::asio::ip::udp::socket socket_;
+    std::vector<Route>           routes_;
+
+    // Scratch space for send_batch, kept to avoid per-call allocation
+    std::vector<std::string_view> selected_;  // one route's envelopes
+    std::vector<std::string_view> views_;     // datagrams of all routes
+    std::vector<mmsghdr>          msgs_;
+    std::vector<iovec>            iovs_;      // two per datagram: envelope, trailer
+    std::vector<Trailer>          trailers_;
+
+    // Coalescing (cfg.coalesce)
+    bool        coalesce_     = false;
+    size_t      max_datagram_ = 0;  // envelope bytes per coalesced datagram
+    std::string packed_;
 };
 
 } // namespace tracks
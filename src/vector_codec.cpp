@@ -0,0 +1,152 @@
+#include "vector_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace tracks {
+
+// Calls fn(msg) with the vector message in `env`; false if it holds none
+template <class Fn>
+static bool with_vector(Envelope& env, Fn&& fn) {
+    switch (env.event_case()) {
+        case Envelope::kChroma:           fn(*env.mutable_chroma());            return true;
+        case Envelope::kSpectralContrast: fn(*env.mutable_spectral_contrast()); return true;
+        case Envelope::kMfcc:             fn(*env.mutable_mfcc());              return true;
+        case Envelope::kBandsMel:         fn(*env.mutable_bands_mel());         return true;
+        case Envelope::kBandsBark:        fn(*env.mutable_bands_bark());        return true;
+        case Envelope::kBandsErb:         fn(*env.mutable_bands_erb());         return true;
+        default:                          return false;
+    }
+}
+
+// Shared by both sides so sender and receiver reconstruct identical floats
+static float dequantize(uint32_t sample, float offset, float scale, float base) {
+    return base + (offset + static_cast<float>(sample) * scale);
+}
+
+// Quantizes `values` (minus `reference` when given, otherwise as a
+// keyframe) into `q` and writes what a receiver will reconstruct to
+// `decoded`, which may be `reference`
+static void quantize(const std::vector<float>& values, int bits, uint32_t index,
+                     const std::vector<float>* reference,
+                     QuantizedVector& q, std::vector<float>& decoded) {
+    const size_t   n      = values.size();
+    const size_t   width  = static_cast<size_t>(bits / 8);
+    const uint32_t levels = (1u << bits) - 1;
+
+    auto diff = [&](size_t i) {
+        float v = std::isfinite(values[i]) ? values[i] : 0.0f;
+        return reference ? v - (*reference)[i] : v;
+    };
+
+    float lo = std::numeric_limits<float>::infinity();
+    float hi = -lo;
+    for (size_t i = 0; i < n; ++i) {
+        float d = diff(i);
+        lo = std::min(lo, d);
+        hi = std::max(hi, d);
+    }
+    if (n == 0) lo = hi = 0.0f;
+    float scale = hi > lo ? (hi - lo) / static_cast<float>(levels) : 0.0f;
+
+    q.set_bits(static_cast<uint32_t>(bits));
+    q.set_scale(scale);
+    q.set_offset(lo);
+    q.set_index(index);
+    q.set_keyframe(reference == nullptr);
+    std::string& data = *q.mutable_data();
+    data.resize(n * width);
+    decoded.resize(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        float    d = diff(i);
+        uint32_t s = 0;
+        if (scale > 0.0f) {
+            float steps = std::clamp((d - lo) / scale, 0.0f, static_cast<float>(levels));
+            s = static_cast<uint32_t>(std::lround(steps));
+        }
+        data[i * width] = static_cast<char>(s & 0xff);
+        if (width == 2) data[i * width + 1] = static_cast<char>(s >> 8);
+        decoded[i] = dequantize(s, lo, scale, reference ? (*reference)[i] : 0.0f);
+    }
+}
+
+// --- VectorEncoder ---
+
+VectorEncoder::VectorEncoder(const Config& cfg)
+    : keyframe_interval_(static_cast<uint32_t>(std::max(cfg.keyframe_interval, 1))) {
+    for (const auto& [type, mode] : cfg.vector_encoding) {
+        if (mode.bits == 8 || mode.bits == 16) states_[type].mode = mode;
+    }
+}
+
+std::string_view VectorEncoder::encode(EventType type, std::string_view serialized) {
+    if (states_.empty()) return serialized;
+    auto it = states_.find(type);
+    if (it == states_.end()) return serialized;
+    State& st = it->second;
+
+    if (!scratch_.ParseFromArray(serialized.data(), static_cast<int>(serialized.size()))) {
+        return serialized;
+    }
+    bool is_vector = with_vector(scratch_, [&](auto& msg) {
+        values_.assign(msg.values().begin(), msg.values().end());
+        bool delta = st.mode.delta && st.since_key > 0 && st.since_key < keyframe_interval_ &&
+                     st.reference.size() == values_.size();
+        if (!delta) st.since_key = 0;
+        quantize(values_, st.mode.bits, st.index, delta ? &st.reference : nullptr,
+                 *msg.mutable_quantized(), st.reference);
+        msg.clear_values();
+        st.index++;
+        st.since_key++;
+    });
+    if (!is_vector) return serialized;
+
+    if (used_ == out_.size()) out_.emplace_back();
+    std::string& buf = out_[used_++];
+    scratch_.SerializeToString(&buf);
+    return buf;
+}
+
+// --- VectorDecoder ---
+
+bool VectorDecoder::decode(Envelope& env) {
+    bool ok = true;
+    int  kind = env.event_case();
+    with_vector(env, [&](auto& msg) {
+        if (!msg.has_quantized()) return;
+        const QuantizedVector& q = msg.quantized();
+        if (q.bits() != 8 && q.bits() != 16) {
+            ok = false;
+            return;
+        }
+        const size_t width = q.bits() / 8;
+        const size_t n     = q.data().size() / width;
+        const auto*  data  = reinterpret_cast<const unsigned char*>(q.data().data());
+
+        // A delta needs exactly the frame before it
+        Frame& prev  = previous_[kind];
+        bool   delta = !q.keyframe();
+        if (delta && (!prev.seen || prev.index + 1 != q.index() || prev.values.size() != n)) {
+            ok = false;
+            return;
+        }
+
+        auto* values = msg.mutable_values();
+        values->Resize(static_cast<int>(n), 0.0f);
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t s = data[i * width];
+            if (width == 2) s |= static_cast<uint32_t>(data[i * width + 1]) << 8;
+            (*values)[static_cast<int>(i)] =
+                dequantize(s, q.offset(), q.scale(), delta ? prev.values[i] : 0.0f);
+        }
+        prev.seen  = true;
+        prev.index = q.index();
+        prev.values.assign(values->begin(), values->end());
+        msg.clear_quantized();
+    });
+    return ok;
+}
+
+} // namespace tracks
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "config.h"
+#include "tracks.pb.h"
+#include <deque>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tracks {
+
+// --- Vector encoding ---
+// Vector events (chroma, spectral.contrast, mfcc, bands.*) carry their values
+// as repeated floats. A type listed in Config::vector_encoding is sent as a
+// QuantizedVector instead: one 8- or 16-bit sample per value with a
+// per-message scale/offset, optionally as the difference from the previous
+// frame of the same type. Deltas are taken against what the receiver will
+// reconstruct, so quantization error does not accumulate; every
+// keyframe_interval-th frame is absolute so a receiver that lost a frame
+// (or joined late) recovers.
+//
+// Encoding happens at send time, so cached timelines stay plain floats.
+
+// Sender side. One instance per destination, owned by the Transport, which
+// encodes after the destination's filter and rate limit.
+class VectorEncoder {
+public:
+    explicit VectorEncoder(const Config& cfg);
+
+    // The datagram to send for an event: `serialized` itself, or its
+    // quantized re-encoding, which stays valid until the next clear()
+    std::string_view encode(EventType type, std::string_view serialized);
+
+    // Releases the buffers behind previously returned views
+    void clear() { used_ = 0; }
+
+private:
+    struct State {
+        VectorEncoding     mode;
+        std::vector<float> reference;      // receiver's reconstruction of the last frame
+        uint32_t           index     = 0;  // QuantizedVector.index of the next frame
+        uint32_t           since_key = 0;  // frames since the last absolute one
+    };
+
+    std::map<EventType, State> states_;
+    uint32_t                   keyframe_interval_;
+    Envelope                   scratch_;
+    std::vector<float>         values_;
+    std::deque<std::string>    out_;   // deque: growing keeps earlier views valid
+    size_t                     used_ = 0;
+};
+
+// Receiver side. Keeps the previous frame of each type for deltas; use
+// one instance per sender.
+class VectorDecoder {
+public:
+    // Replaces a quantized payload in `env` with plain values; other events
+    // pass through. Returns false for a delta whose reference frame was
+    // never seen (lost, or before joining); drop such an event.
+    bool decode(Envelope& env);
+
+private:
+    struct Frame {
+        bool               seen  = false;
+        uint32_t           index = 0;
+        std::vector<float> values;
+    };
+    std::map<int, Frame> previous_;  // by Envelope::EventCase
+};
+
+} // namespace tracks